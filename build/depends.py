@@ -493,6 +493,7 @@ class MixxxCore(Feature):
                    "configobject.cpp",
                    "control/control.cpp",
                    "control/controlbehavior.cpp",
+                   "control/controlrecorder.cpp",
                    "control/controlmodel.cpp",
                    "controlobject.cpp",
                    "controlobjectslave.cpp",
@@ -576,7 +577,10 @@ class MixxxCore(Feature):
 
                    "engine/engineworker.cpp",
                    "engine/engineworkerscheduler.cpp",
+                   "engine/enginegarbagecollector.cpp",
+                   "engine/enginetaskpool.cpp",
                    "engine/enginebuffer.cpp",
+                   "engine/deckparams.cpp",
                    "engine/enginebufferscale.cpp",
                    "engine/enginebufferscaledummy.cpp",
                    "engine/enginebufferscalelinear.cpp",
@@ -597,6 +601,9 @@ class MixxxCore(Feature):
                    "engine/enginevumeter.cpp",
                    "engine/enginesidechaincompressor.cpp",
                    "engine/sidechain/enginesidechain.cpp",
+                   "engine/metering/enginemetering.cpp",
+                   "engine/metering/meteringanalyser.cpp",
+                   "engine/metering/meteringtap.cpp",
                    "engine/enginexfader.cpp",
                    "engine/enginemicrophone.cpp",
                    "engine/enginedeck.cpp",
@@ -616,11 +623,17 @@ class MixxxCore(Feature):
                    "engine/enginetalkoverducking.cpp",
                    "cachingreader.cpp",
                    "cachingreaderworker.cpp",
+                   "trackprestager.cpp",
+                   "sharedchunkcache.cpp",
 
                    "analyserrg.cpp",
                    "analyserqueue.cpp",
                    "analyserwaveform.cpp",
                    "analyserkey.cpp",
+                   "analyserfingerprint.cpp",
+                   "analysis/decimator.cpp",
+                   "analysis/nativebeattracker.cpp",
+                   "analysis/nativekeydetector.cpp",
 
                    "controllers/controller.cpp",
                    "controllers/controllerengine.cpp",
@@ -661,6 +674,7 @@ class MixxxCore(Feature):
                    "sharedglcontext.cpp",
                    "widget/controlwidgetconnection.cpp",
                    "widget/wbasewidget.cpp",
+                   "widget/repaintscheduler.cpp",
                    "widget/wwidget.cpp",
                    "widget/wwidgetgroup.cpp",
                    "widget/wwidgetstack.cpp",
@@ -789,6 +803,7 @@ class MixxxCore(Feature):
                    "library/dao/libraryhashdao.cpp",
                    "library/dao/settingsdao.cpp",
                    "library/dao/analysisdao.cpp",
+                   "library/dao/analysisjobdao.cpp",
 
                    "library/librarycontrol.cpp",
                    "library/schemamanager.cpp",
@@ -816,6 +831,7 @@ class MixxxCore(Feature):
 
                    "waveform/waveform.cpp",
                    "waveform/waveformfactory.cpp",
+                   "waveform/waveformfilterbank.cpp",
                    "waveform/waveformwidgetfactory.cpp",
                    "waveform/vsyncthread.cpp",
                    "waveform/guitick.cpp",
@@ -878,6 +894,7 @@ class MixxxCore(Feature):
                    "track/beatmap.cpp",
                    "track/beatfactory.cpp",
                    "track/beatutils.cpp",
+                   "track/compactserialization.cpp",
                    "track/keys.cpp",
                    "track/keyfactory.cpp",
                    "track/keyutils.cpp",
@@ -914,12 +931,16 @@ class MixxxCore(Feature):
                    "util/threadcputimer.cpp",
                    "util/version.cpp",
                    "util/rlimit.cpp",
+                   "util/threadplacement.cpp",
                    "util/valuetransformer.cpp",
                    "util/sandbox.cpp",
                    "util/file.cpp",
+                   "util/backgroundfilewriter.cpp",
                    "util/mac.cpp",
                    "util/task.cpp",
+                   "util/startupgraph.cpp",
                    "util/experiment.cpp",
+                   "util/fft.cpp",
 
                    '#res/mixxx.qrc'
                    ]
@@ -432,6 +432,43 @@ class ModPlug(Feature):
         return ['soundsourcemodplug.cpp', 'dlgprefmodplug.cpp']
 
 
+class LiLV(Feature):
+    def description(self):
+        return "LV2 effect plugins via lilv"
+
+    def enabled(self, build):
+        build.flags['lilv'] = util.get_flags(build.env, 'lilv', 0)
+        if int(build.flags['lilv']):
+            return True
+        return False
+
+    def add_options(self, build, vars):
+        vars.Add('lilv',
+                 'Set to 1 to enable LV2 effect plugins via lilv.', 0)
+
+    def configure(self, build, conf):
+        if not self.enabled(build):
+            return
+
+        build.env.Append(CPPDEFINES='__LILV__')
+
+        if build.platform_is_windows and build.static_dependencies:
+            conf.CheckLib(['lilv-0', 'sratom-0', 'sord-0', 'serd-0'])
+        else:
+            build.env.ParseConfig(
+                'pkg-config lilv-0 --silence-errors --cflags --libs')
+
+        if not conf.CheckHeader('lilv/lilv.h'):
+            raise Exception('Could not find lilv development headers.')
+
+    def sources(self, build):
+        return ['effects/lv2/lv2backend.cpp',
+                'effects/lv2/lv2effectprocessor.cpp',
+                'effects/lv2/lv2manifest.cpp',
+                'effects/lv2/lv2manifestindex.cpp',
+                'effects/lv2/lv2worker.cpp']
+
+
 class FAAD(Feature):
     def description(self):
         return "FAAD AAC audio file decoder plugin"
@@ -688,6 +725,28 @@ class Profiling(Feature):
             build.env.Append(LINKFLAGS='-lSaturn')
 
 
+class Bench(Feature):
+    def description(self):
+        return "Mixxx engine benchmark (mixxx-bench)"
+
+    def enabled(self, build):
+        build.flags['bench'] = util.get_flags(build.env, 'bench', 0) or \
+            'mixxx-bench' in SCons.BUILD_TARGETS
+        if int(build.flags['bench']):
+            return True
+        return False
+
+    def add_options(self, build, vars):
+        vars.Add('bench', 'Set to 1 to build the mixxx-bench engine benchmark.', 0)
+
+    def configure(self, build, conf):
+        if not self.enabled(build):
+            return
+
+    def sources(self, build):
+        return []
+
+
 class TestSuite(Feature):
     def description(self):
         return "Mixxx Test Suite"
@@ -11,6 +11,7 @@
 #include <QString>
 
 #include "trackinfoobject.h"
+#include "analysis/nativebeattracker.h"
 #include "track/beatmap.h"
 #include "track/beatfactory.h"
 #include "analyserbeats.h"
@@ -20,6 +21,7 @@
 AnalyserBeats::AnalyserBeats(ConfigObject<ConfigValue>* pConfig)
         : m_pConfig(pConfig),
           m_pVamp(NULL),
+          m_pNative(NULL),
           m_bPreferencesReanalyzeOldBpm(false),
           m_bPreferencesFixedTempo(true),
           m_bPreferencesOffsetCorrection(false),
@@ -31,6 +33,8 @@ AnalyserBeats::AnalyserBeats(ConfigObject<ConfigValue>* pConfig)
 }
 
 AnalyserBeats::~AnalyserBeats() {
+    delete m_pVamp;
+    delete m_pNative;
 }
 
 bool AnalyserBeats::initialise(TrackPointer tio, int sampleRate, int totalSamples) {
@@ -87,7 +91,9 @@ bool AnalyserBeats::initialise(TrackPointer tio, int sampleRate, int totalSample
     // if we can load a stored track don't reanalyze it
     bool bShouldAnalyze = !loadStored(tio);
 
-    if (bShouldAnalyze) {
+    if (bShouldAnalyze && pluginID == NATIVE_ANALYSER_BEAT_PLUGIN_ID) {
+        m_pNative = new NativeBeatTracker(m_iSampleRate, m_bPreferencesFastAnalysis);
+    } else if (bShouldAnalyze) {
         m_pVamp = new VampAnalyser();
         bShouldAnalyze = m_pVamp->Init(library, pluginID, m_iSampleRate, totalSamples,
                                        m_bPreferencesFastAnalysis);
@@ -178,6 +184,10 @@ bool AnalyserBeats::loadStored(TrackPointer tio) const {
 }
 
 void AnalyserBeats::process(const CSAMPLE *pIn, const int iLen) {
+    if (m_pNative != NULL) {
+        m_pNative->process(pIn, iLen);
+        return;
+    }
     if (m_pVamp == NULL)
         return;
     bool success = m_pVamp->Process(pIn, iLen);
@@ -191,24 +201,31 @@ void AnalyserBeats::cleanup(TrackPointer tio) {
     Q_UNUSED(tio);
     delete m_pVamp;
     m_pVamp = NULL;
+    delete m_pNative;
+    m_pNative = NULL;
 }
 
 void AnalyserBeats::finalise(TrackPointer tio) {
-    if (m_pVamp == NULL) {
+    QVector<double> beats;
+    if (m_pNative != NULL) {
+        beats = m_pNative->finalise();
+        delete m_pNative;
+        m_pNative = NULL;
+    } else if (m_pVamp != NULL) {
+        // Call End() here, because the number of total samples may have been
+        // estimated incorrectly.
+        bool success = m_pVamp->End();
+        qDebug() << "Beat Calculation" << (success ? "complete" : "failed");
+
+        beats = m_pVamp->GetInitFramesVector();
+        delete m_pVamp;
+        m_pVamp = NULL;
+    } else {
         return;
     }
 
-    // Call End() here, because the number of total samples may have been
-    // estimated incorrectly.
-    bool success = m_pVamp->End();
-    qDebug() << "Beat Calculation" << (success ? "complete" : "failed");
-
-    QVector<double> beats = m_pVamp->GetInitFramesVector();
-    delete m_pVamp;
-    m_pVamp = NULL;
-
     if (beats.isEmpty()) {
-        qDebug() << "Could not detect beat positions from Vamp.";
+        qDebug() << "Could not detect beat positions.";
         return;
     }
 
@@ -14,6 +14,8 @@
 #include "configobject.h"
 #include "vamp/vampanalyser.h"
 
+class NativeBeatTracker;
+
 class AnalyserBeats: public Analyser {
   public:
     AnalyserBeats(ConfigObject<ConfigValue>* pConfig);
@@ -31,6 +33,7 @@ class AnalyserBeats: public Analyser {
 
     ConfigObject<ConfigValue>* m_pConfig;
     VampAnalyser* m_pVamp;
+    NativeBeatTracker* m_pNative;
     QString m_pluginId;
     bool m_bPreferencesReanalyzeOldBpm;
     bool m_bPreferencesFixedTempo;
@@ -0,0 +1,58 @@
+#include <QtDebug>
+
+#include "analyserfingerprint.h"
+
+AnalyserFingerprint::AnalyserFingerprint()
+        : m_bActive(false),
+          m_pBuffer(NULL),
+          m_iBufferSize(0) {
+}
+
+AnalyserFingerprint::~AnalyserFingerprint() {
+    delete [] m_pBuffer;
+}
+
+bool AnalyserFingerprint::initialise(TrackPointer tio, int sampleRate, int totalSamples) {
+    if (loadStored(tio) || totalSamples == 0) {
+        return false;
+    }
+    m_bActive = m_chromaPrinter.start(sampleRate);
+    return m_bActive;
+}
+
+bool AnalyserFingerprint::loadStored(TrackPointer tio) const {
+    return !tio->getFingerprint().isEmpty();
+}
+
+void AnalyserFingerprint::process(const CSAMPLE* pIn, const int iLen) {
+    if (!m_bActive) {
+        return;
+    }
+    if (iLen > m_iBufferSize) {
+        delete [] m_pBuffer;
+        m_pBuffer = new SAMPLE[iLen];
+        m_iBufferSize = iLen;
+    }
+    // Undo the conversion of AnalyserQueue since chromaprint takes 16 bit
+    // samples. The input was converted from 16 bit samples so this is exact.
+    for (int i = 0; i < iLen; ++i) {
+        m_pBuffer[i] = static_cast<SAMPLE>(pIn[i] * 0x8000);
+    }
+    // Only the beginning of the track is fingerprinted. Stop converting once
+    // the fingerprint has all the audio it needs.
+    m_bActive = m_chromaPrinter.feed(m_pBuffer, iLen);
+}
+
+void AnalyserFingerprint::cleanup(TrackPointer tio) {
+    Q_UNUSED(tio);
+    m_bActive = false;
+    m_chromaPrinter.reset();
+}
+
+void AnalyserFingerprint::finalise(TrackPointer tio) {
+    m_bActive = false;
+    QString fingerprint = m_chromaPrinter.finish();
+    if (!fingerprint.isEmpty()) {
+        tio->setFingerprint(fingerprint);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef ANALYSERFINGERPRINT_H
+#define ANALYSERFINGERPRINT_H
+
+#include "analyser.h"
+#include "musicbrainz/chromaprinter.h"
+#include "trackinfoobject.h"
+
+// Calculates the AcoustID fingerprint of tracks that are decoded for other
+// analysers anyway and caches it on the track, so that the tag fetcher and
+// duplicate detection do not have to decode the track again.
+class AnalyserFingerprint : public Analyser {
+  public:
+    AnalyserFingerprint();
+    virtual ~AnalyserFingerprint();
+
+    bool initialise(TrackPointer tio, int sampleRate, int totalSamples);
+    bool loadStored(TrackPointer tio) const;
+    void process(const CSAMPLE* pIn, const int iLen);
+    void cleanup(TrackPointer tio);
+    void finalise(TrackPointer tio);
+
+  private:
+    ChromaPrinter m_chromaPrinter;
+    bool m_bActive;
+    SAMPLE* m_pBuffer;
+    int m_iBufferSize;
+};
+
+#endif /* ANALYSERFINGERPRINT_H */
@@ -2,6 +2,7 @@
 #include <QVector>
 
 #include "analyserkey.h"
+#include "analysis/nativekeydetector.h"
 #include "track/key_preferences.h"
 #include "proto/keys.pb.h"
 #include "track/keyfactory.h"
@@ -12,6 +13,7 @@ using mixxx::track::io::key::ChromaticKey_IsValid;
 AnalyserKey::AnalyserKey(ConfigObject<ConfigValue>* pConfig)
         : m_pConfig(pConfig),
           m_pVamp(NULL),
+          m_pNative(NULL),
           m_iSampleRate(0),
           m_iTotalSamples(0),
           m_bPreferencesKeyDetectionEnabled(true),
@@ -21,6 +23,7 @@ AnalyserKey::AnalyserKey(ConfigObject<ConfigValue>* pConfig)
 
 AnalyserKey::~AnalyserKey() {
     delete m_pVamp;
+    delete m_pNative;
 }
 
 bool AnalyserKey::initialise(TrackPointer tio, int sampleRate, int totalSamples) {
@@ -55,7 +58,10 @@ bool AnalyserKey::initialise(TrackPointer tio, int sampleRate, int totalSamples)
     // if we can't load a stored track reanalyze it
     bool bShouldAnalyze = !loadStored(tio);
 
-    if (bShouldAnalyze) {
+    if (bShouldAnalyze && m_pluginId == NATIVE_ANALYSER_KEY_PLUGIN_ID) {
+        m_pNative = new NativeKeyDetector(sampleRate,
+                                          m_bPreferencesFastAnalysisEnabled);
+    } else if (bShouldAnalyze) {
         m_pVamp = new VampAnalyser();
         bShouldAnalyze = m_pVamp->Init(
             library, m_pluginId, sampleRate, totalSamples,
@@ -123,6 +129,10 @@ bool AnalyserKey::loadStored(TrackPointer tio) const {
 }
 
 void AnalyserKey::process(const CSAMPLE *pIn, const int iLen) {
+    if (m_pNative != NULL) {
+        m_pNative->process(pIn, iLen);
+        return;
+    }
     if (m_pVamp == NULL)
         return;
     bool success = m_pVamp->Process(pIn, iLen);
@@ -136,33 +146,43 @@ void AnalyserKey::cleanup(TrackPointer tio) {
     Q_UNUSED(tio);
     delete m_pVamp;
     m_pVamp = NULL;
+    delete m_pNative;
+    m_pNative = NULL;
 }
 
 void AnalyserKey::finalise(TrackPointer tio) {
-    if (m_pVamp == NULL) {
-        return;
-    }
-
-    bool success = m_pVamp->End();
-    qDebug() << "Key Detection" << (success ? "complete" : "failed");
+    KeyChangeList key_changes;
+    if (m_pNative != NULL) {
+        key_changes = m_pNative->finalise();
+        delete m_pNative;
+        m_pNative = NULL;
+        if (key_changes.isEmpty()) {
+            qDebug() << "AnalyserKey: No key detected.";
+            return;
+        }
+    } else if (m_pVamp != NULL) {
+        bool success = m_pVamp->End();
+        qDebug() << "Key Detection" << (success ? "complete" : "failed");
 
-    QVector<double> frames = m_pVamp->GetInitFramesVector();
-    QVector<double> keys = m_pVamp->GetLastValuesVector();
-    delete m_pVamp;
-    m_pVamp = NULL;
+        QVector<double> frames = m_pVamp->GetInitFramesVector();
+        QVector<double> keys = m_pVamp->GetLastValuesVector();
+        delete m_pVamp;
+        m_pVamp = NULL;
 
-    if (frames.size() == 0 || frames.size() != keys.size()) {
-        qWarning() << "AnalyserKey: Key sequence and list of times do not match.";
-        return;
-    }
+        if (frames.size() == 0 || frames.size() != keys.size()) {
+            qWarning() << "AnalyserKey: Key sequence and list of times do not match.";
+            return;
+        }
 
-    KeyChangeList key_changes;
-    for (int i = 0; i < keys.size(); ++i) {
-        if (ChromaticKey_IsValid(keys[i])) {
-            key_changes.push_back(qMakePair(
-                // int() intermediate cast required by MSVC.
-                static_cast<ChromaticKey>(int(keys[i])), frames[i]));
+        for (int i = 0; i < keys.size(); ++i) {
+            if (ChromaticKey_IsValid(keys[i])) {
+                key_changes.push_back(qMakePair(
+                    // int() intermediate cast required by MSVC.
+                    static_cast<ChromaticKey>(int(keys[i])), frames[i]));
+            }
         }
+    } else {
+        return;
     }
 
     QHash<QString, QString> extraVersionInfo = getExtraVersionInfo(
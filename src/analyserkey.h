@@ -9,6 +9,8 @@
 #include "trackinfoobject.h"
 #include "vamp/vampanalyser.h"
 
+class NativeKeyDetector;
+
 class AnalyserKey : public Analyser {
   public:
     AnalyserKey(ConfigObject<ConfigValue>* pConfig);
@@ -26,6 +28,7 @@ class AnalyserKey : public Analyser {
 
     ConfigObject<ConfigValue>* m_pConfig;
     VampAnalyser* m_pVamp;
+    NativeKeyDetector* m_pNative;
     QString m_pluginId;
     int m_iSampleRate;
     int m_iTotalSamples;
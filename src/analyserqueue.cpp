@@ -15,9 +15,13 @@
 #include "analyserrg.h"
 #include "analyserbeats.h"
 #include "analyserkey.h"
+#include "analyserfingerprint.h"
 #include "vamp/vampanalyser.h"
 #include "util/compatibility.h"
 #include "util/event.h"
+#include "util/math.h"
+#include "util/threadcputimer.h"
+#include "util/threadplacement.h"
 #include "util/trace.h"
 
 // Measured in 0.1%,
@@ -31,10 +35,15 @@
 // 8192 seems to do fine.
 const int kAnalysisBlockSize = 8192;
 
+// Analysers that are cheap enough to run whenever a track is decoded but that
+// never cause a track to be decoded on their own.
+const int kOpportunisticAnalysers = AnalyserQueue::FINGERPRINT;
+
 AnalyserQueue::AnalyserQueue(TrackCollection* pTrackCollection)
         : m_aq(),
           m_exit(false),
           m_aiCheckPriorities(false),
+          m_iCpuSharePercent(100),
           m_pSamplesPCM(new SAMPLE[kAnalysisBlockSize]),
           m_pSamples(new CSAMPLE[kAnalysisBlockSize]),
           m_tioq(),
@@ -63,8 +72,23 @@ AnalyserQueue::~AnalyserQueue() {
     delete [] m_pSamples;
 }
 
-void AnalyserQueue::addAnalyser(Analyser* an) {
+void AnalyserQueue::addAnalyser(Analyser* an, AnalyserType type) {
     m_aq.push_back(an);
+    m_aqTypes.push_back(type);
+}
+
+QList<Analyser*> AnalyserQueue::selectAnalysers(int analysers) const {
+    QList<Analyser*> selected;
+    for (int i = 0; i < m_aq.size(); ++i) {
+        if (analysers & m_aqTypes[i]) {
+            selected.append(m_aq[i]);
+        }
+    }
+    return selected;
+}
+
+void AnalyserQueue::setCpuShare(int percent) {
+    m_iCpuSharePercent = math_clamp(percent, 1, 100);
 }
 
 // This is called from the AnalyserQueue thread
@@ -81,6 +105,7 @@ bool AnalyserQueue::isLoadedTrackWaiting(TrackPointer tio) {
             it.remove();
             continue;
         }
+        const int analysers = m_tioAnalysers.value(pTrack.data(), ALL_ANALYSERS);
         if (!trackWaiting) {
             trackWaiting = info.isTrackLoaded(pTrack);
         }
@@ -90,7 +115,8 @@ bool AnalyserQueue::isLoadedTrackWaiting(TrackPointer tio) {
         int progress = pTrack->getAnalyserProgress();
         if (progress < 0) {
             // Load stored analysis
-            QListIterator<Analyser*> ita(m_aq);
+            QListIterator<Analyser*> ita(
+                    selectAnalysers(analysers & ~kOpportunisticAnalysers));
             bool processTrack = false;
             while (ita.hasNext()) {
                 if (!ita.next()->loadStored(pTrack)) {
@@ -99,11 +125,15 @@ bool AnalyserQueue::isLoadedTrackWaiting(TrackPointer tio) {
             }
             if (!processTrack) {
                 emitUpdateProgress(pTrack, 1000);
+                emit(analysersFinished(pTrack, analysers));
+                m_tioAnalysers.remove(pTrack.data());
                 it.remove();
             } else {
                 emitUpdateProgress(pTrack, 0);
             }
         } else if (progress == 1000) {
+            emit(analysersFinished(pTrack, analysers));
+            m_tioAnalysers.remove(pTrack.data());
             it.remove();
         }
     }
@@ -114,7 +144,7 @@ bool AnalyserQueue::isLoadedTrackWaiting(TrackPointer tio) {
 }
 
 // This is called from the AnalyserQueue thread
-TrackPointer AnalyserQueue::dequeueNextBlocking() {
+TrackPointer AnalyserQueue::dequeueNextBlocking(int* pAnalysers) {
     m_qm.lock();
     if (m_tioq.isEmpty()) {
         Event::end("AnalyserQueue process");
@@ -148,6 +178,7 @@ TrackPointer AnalyserQueue::dequeueNextBlocking() {
     if (!pLoadTrack && !m_tioq.isEmpty()) {
         pLoadTrack = m_tioq.dequeue();
     }
+    *pAnalysers = m_tioAnalysers.take(pLoadTrack.data());
 
     m_qm.unlock();
 
@@ -159,7 +190,8 @@ TrackPointer AnalyserQueue::dequeueNextBlocking() {
 }
 
 // This is called from the AnalyserQueue thread
-bool AnalyserQueue::doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer& pSoundSource) {
+bool AnalyserQueue::doAnalysis(TrackPointer tio, const QList<Analyser*>& analysers,
+                               const Mixxx::SoundSourcePointer& pSoundSource) {
     int totalSamples = pSoundSource->length();
     //qDebug() << tio->getFilename() << " has " << totalSamples << " samples.";
     int processedSamples = 0;
@@ -172,7 +204,18 @@ bool AnalyserQueue::doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer
     bool cancelled = false;
     int progress; // progress in 0 ... 100
 
+    ThreadCpuTimer cpuTimer;
+    qint64 blockCpuNanos = 0;
+
     do {
+        // Keep the CPU time spent on analysis within the configured share by
+        // sleeping in proportion to the time the last block took.
+        const int cpuShare = load_atomic(m_iCpuSharePercent);
+        if (cpuShare < 100 && blockCpuNanos > 0) {
+            usleep(blockCpuNanos * (100 - cpuShare) / cpuShare / 1000);
+        }
+        cpuTimer.start();
+
         ScopedTimer t("AnalyserQueue::doAnalysis block");
         read = pSoundSource->read(kAnalysisBlockSize, m_pSamplesPCM);
 
@@ -199,7 +242,7 @@ bool AnalyserQueue::doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer
 
         SampleUtil::convertS16ToFloat32(m_pSamples, m_pSamplesPCM, read);
 
-        QListIterator<Analyser*> it(m_aq);
+        QListIterator<Analyser*> it(analysers);
 
         while (it.hasNext()) {
             Analyser* an =  it.next();
@@ -250,6 +293,7 @@ bool AnalyserQueue::doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer
         if (dieflag || cancelled) {
             t.cancel();
         }
+        blockCpuNanos = cpuTimer.elapsed();
     } while(read == kAnalysisBlockSize && !dieflag);
 
     return !cancelled; //don't return !dieflag or we might reanalyze over and over
@@ -265,6 +309,7 @@ void AnalyserQueue::stop() {
 void AnalyserQueue::run() {
     unsigned static id = 0; //the id of this thread, for debugging purposes
     QThread::currentThread()->setObjectName(QString("AnalyserQueue %1").arg(++id));
+    ThreadPlacement::placeCurrentThread(ThreadPlacement::IDLE);
 
     // If there are no analyzers, don't waste time running.
     if (m_aq.size() == 0)
@@ -276,7 +321,8 @@ void AnalyserQueue::run() {
     m_progressInfo.sema.release(); // Initalise with one
 
     while (!m_exit) {
-        TrackPointer nextTrack = dequeueNextBlocking();
+        int analysers = 0;
+        TrackPointer nextTrack = dequeueNextBlocking(&analysers);
 
         // It's important to check for m_exit here in case we decided to exit
         // while blocking for a new track.
@@ -303,6 +349,7 @@ void AnalyserQueue::run() {
         Mixxx::SoundSourcePointer pSoundSource(soundSourceProxy.open());
         if (pSoundSource.isNull()) {
             qWarning() << "Failed to open file for analyzing:" << nextTrack->getLocation();
+            emit(analysersFinished(nextTrack, analysers));
             continue;
         }
 
@@ -311,10 +358,13 @@ void AnalyserQueue::run() {
 
         if (iNumSamples == 0 || iSampleRate == 0) {
             qWarning() << "Skipping invalid file:" << nextTrack->getLocation();
+            emit(analysersFinished(nextTrack, analysers));
             continue;
         }
 
-        QListIterator<Analyser*> it(m_aq);
+        QList<Analyser*> trackAnalysers =
+                selectAnalysers(analysers & ~kOpportunisticAnalysers);
+        QListIterator<Analyser*> it(trackAnalysers);
         bool processTrack = false;
         while (it.hasNext()) {
             // Make sure not to short-circuit initialise(...)
@@ -322,6 +372,16 @@ void AnalyserQueue::run() {
                 processTrack = true;
             }
         }
+        if (processTrack) {
+            // The track is decoded anyway, so let the opportunistic analysers
+            // share the decode.
+            foreach (Analyser* an,
+                     selectAnalysers(analysers & kOpportunisticAnalysers)) {
+                if (an->initialise(nextTrack, iSampleRate, iNumSamples)) {
+                    trackAnalysers.append(an);
+                }
+            }
+        }
 
         m_qm.lock();
         m_queue_size = m_tioq.size();
@@ -329,27 +389,29 @@ void AnalyserQueue::run() {
 
         if (processTrack) {
             emitUpdateProgress(nextTrack, 0);
-            bool completed = doAnalysis(nextTrack, pSoundSource);
+            bool completed = doAnalysis(nextTrack, trackAnalysers, pSoundSource);
             if (!completed) {
                 //This track was cancelled
-                QListIterator<Analyser*> itf(m_aq);
+                QListIterator<Analyser*> itf(trackAnalysers);
                 while (itf.hasNext()) {
                     itf.next()->cleanup(nextTrack);
                 }
-                queueAnalyseTrack(nextTrack);
+                queueAnalyseTrack(nextTrack, analysers);
                 emitUpdateProgress(nextTrack, 0);
             } else {
                 // 100% - FINALIZE_PERCENT finished
                 emitUpdateProgress(nextTrack, 1000 - FINALIZE_PERCENT);
                 // This takes around 3 sec on a Atom Netbook
-                QListIterator<Analyser*> itf(m_aq);
+                QListIterator<Analyser*> itf(trackAnalysers);
                 while (itf.hasNext()) {
                     itf.next()->finalise(nextTrack);
                 }
                 emit(trackDone(nextTrack));
+                emit(analysersFinished(nextTrack, analysers));
                 emitUpdateProgress(nextTrack, 1000); // 100%
             }
         } else {
+            emit(analysersFinished(nextTrack, analysers));
             emitUpdateProgress(nextTrack, 1000); // 100%
             qDebug() << "Skipping track analysis because no analyzer initialized.";
         }
@@ -406,12 +468,13 @@ void AnalyserQueue::slotAnalyseTrack(TrackPointer tio) {
 }
 
 // This is called from the GUI and from the AnalyserQueue thread
-void AnalyserQueue::queueAnalyseTrack(TrackPointer tio) {
+void AnalyserQueue::queueAnalyseTrack(TrackPointer tio, int analysers) {
     m_qm.lock();
     if (!m_tioq.contains(tio)) {
         m_tioq.enqueue(tio);
         m_qwait.wakeAll();
     }
+    m_tioAnalysers[tio.data()] |= analysers;
     m_qm.unlock();
 }
 
@@ -420,11 +483,12 @@ AnalyserQueue* AnalyserQueue::createDefaultAnalyserQueue(
         ConfigObject<ConfigValue>* pConfig, TrackCollection* pTrackCollection) {
     AnalyserQueue* ret = new AnalyserQueue(pTrackCollection);
 
-    ret->addAnalyser(new AnalyserWaveform(pConfig));
-    ret->addAnalyser(new AnalyserGain(pConfig));
+    ret->addAnalyser(new AnalyserWaveform(pConfig), WAVEFORM);
+    ret->addAnalyser(new AnalyserGain(pConfig), REPLAYGAIN);
     VampAnalyser::initializePluginPaths();
-    ret->addAnalyser(new AnalyserBeats(pConfig));
-    ret->addAnalyser(new AnalyserKey(pConfig));
+    ret->addAnalyser(new AnalyserBeats(pConfig), BEATS);
+    ret->addAnalyser(new AnalyserKey(pConfig), KEY);
+    ret->addAnalyser(new AnalyserFingerprint(), FINGERPRINT);
 
     ret->start(QThread::LowPriority);
     return ret;
@@ -435,10 +499,13 @@ AnalyserQueue* AnalyserQueue::createAnalysisFeatureAnalyserQueue(
         ConfigObject<ConfigValue>* pConfig, TrackCollection* pTrackCollection) {
     AnalyserQueue* ret = new AnalyserQueue(pTrackCollection);
 
-    ret->addAnalyser(new AnalyserGain(pConfig));
+    // Waveforms are only generated for tracks queued with WAVEFORM.
+    ret->addAnalyser(new AnalyserWaveform(pConfig), WAVEFORM);
+    ret->addAnalyser(new AnalyserGain(pConfig), REPLAYGAIN);
     VampAnalyser::initializePluginPaths();
-    ret->addAnalyser(new AnalyserBeats(pConfig));
-    ret->addAnalyser(new AnalyserKey(pConfig));
+    ret->addAnalyser(new AnalyserBeats(pConfig), BEATS);
+    ret->addAnalyser(new AnalyserKey(pConfig), KEY);
+    ret->addAnalyser(new AnalyserFingerprint(), FINGERPRINT);
 
     ret->start(QThread::LowPriority);
     return ret;
@@ -1,6 +1,7 @@
 #ifndef ANALYSERQUEUE_H
 #define ANALYSERQUEUE_H
 
+#include <QHash>
 #include <QList>
 #include <QThread>
 #include <QQueue>
@@ -18,10 +19,29 @@ class AnalyserQueue : public QThread {
     Q_OBJECT
 
   public:
+    // Identifies the analysers of a queue so that only some of them can be
+    // run on a track.
+    enum AnalyserType {
+        WAVEFORM = 0x01,
+        REPLAYGAIN = 0x02,
+        BEATS = 0x04,
+        KEY = 0x08,
+        // Only runs on tracks that are decoded for another analyser.
+        FINGERPRINT = 0x10,
+        ALL_ANALYSERS = 0x1F
+    };
+
     AnalyserQueue(TrackCollection* pTrackCollection);
     virtual ~AnalyserQueue();
     void stop();
-    void queueAnalyseTrack(TrackPointer tio);
+    // Queues tio for the given analysers. Analysers are merged if tio is
+    // already queued.
+    void queueAnalyseTrack(TrackPointer tio, int analysers = ALL_ANALYSERS);
+
+    // Limits the analysis thread to percent of the CPU time of one core by
+    // sleeping after each block in proportion to the time spent analysing
+    // it. 100 disables the limit. Can be called from any thread.
+    void setCpuShare(int percent);
 
     static AnalyserQueue* createDefaultAnalyserQueue(
             ConfigObject<ConfigValue>* pConfig, TrackCollection* pTrackCollection);
@@ -36,6 +56,9 @@ class AnalyserQueue : public QThread {
     void trackProgress(int progress);
     void trackDone(TrackPointer track);
     void trackFinished(int size);
+    // Emitted when analysers are done with track, including when it could
+    // not be analysed at all. Not emitted for analysis that was interrupted.
+    void analysersFinished(TrackPointer track, int analysers);
     // Signals from AnalyserQueue Thread:
     void queueEmpty();
     void updateProgress();
@@ -52,22 +75,30 @@ class AnalyserQueue : public QThread {
         QSemaphore sema;
     };
 
-    void addAnalyser(Analyser* an);
+    void addAnalyser(Analyser* an, AnalyserType type);
+    // Returns the analysers of the queue selected by the analysers flags.
+    QList<Analyser*> selectAnalysers(int analysers) const;
 
     QList<Analyser*> m_aq;
+    QList<AnalyserType> m_aqTypes;
 
     bool isLoadedTrackWaiting(TrackPointer tio);
-    TrackPointer dequeueNextBlocking();
-    bool doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer& pSoundSource);
+    TrackPointer dequeueNextBlocking(int* pAnalysers);
+    bool doAnalysis(TrackPointer tio, const QList<Analyser*>& analysers,
+                    const Mixxx::SoundSourcePointer& pSoundSource);
     void emitUpdateProgress(TrackPointer tio, int progress);
 
     bool m_exit;
     QAtomicInt m_aiCheckPriorities;
+    QAtomicInt m_iCpuSharePercent;
     SAMPLE* m_pSamplesPCM;
     CSAMPLE* m_pSamples;
 
     // The processing queue and associated mutex
     QQueue<TrackPointer> m_tioq;
+    // The analysers to run on each queued track. The tracks are kept alive by
+    // m_tioq.
+    QHash<TrackInfoObject*, int> m_tioAnalysers;
     QMutex m_qm;
     QWaitCondition m_qwait;
     struct progress_info m_progressInfo;
@@ -4,9 +4,6 @@
 #include <QtDebug>
 
 #include "analyserwaveform.h"
-#include "engine/engineobject.h"
-#include "engine/enginefilterbutterworth8.h"
-#include "engine/enginefilterbessel4.h"
 #include "library/trackcollection.h"
 #include "library/dao/analysisdao.h"
 #include "trackinfoobject.h"
@@ -18,13 +15,10 @@ AnalyserWaveform::AnalyserWaveform(ConfigObject<ConfigValue>* pConfig) :
         m_waveformSummaryData(NULL),
         m_stride(0, 0),
         m_currentStride(0),
-        m_currentSummaryStride(0) {
+        m_currentSummaryStride(0),
+        m_pFilterBank(NULL) {
     qDebug() << "AnalyserWaveform::AnalyserWaveform()";
 
-    m_filter[0] = 0;
-    m_filter[1] = 0;
-    m_filter[2] = 0;
-
     static int i = 0;
     m_database = QSqlDatabase::addDatabase("QSQLITE", "WAVEFORM_ANALYSIS" + QString::number(i++));
     if (!m_database.isOpen()) {
@@ -85,6 +79,7 @@ bool AnalyserWaveform::initialise(TrackPointer tio, int sampleRate, int totalSam
         // the TIO. Be aware that other threads of Mixxx can touch them from
         // now.
         tio->setWaveform(m_waveform);
+        m_waveformSummary->setDirty(true);
         tio->setWaveformSummary(m_waveformSummary);
 
         m_waveformData = m_waveform->data();
@@ -165,74 +160,55 @@ bool AnalyserWaveform::loadStored(TrackPointer tio) const {
     return false;
 }
 
+namespace {
+
+// The position of the last frame of the stride after the given number of
+// strides has been stored. A stride ends at the first frame where
+// fmod(position, length) < 1.
+inline int strideEnd(int storedStrides, double length, int position) {
+    return math_max(static_cast<int>(ceil((storedStrides + 1) * length)),
+                    position + 1);
+}
+
+}  // namespace
+
 void AnalyserWaveform::resetFilters(TrackPointer tio, int sampleRate) {
     Q_UNUSED(tio);
-    Q_UNUSED(sampleRate);
     //TODO: (vRince) bind this with *actual* filter values ...
-    // m_filter[Low] = new EngineFilterButterworth8(FILTER_LOWPASS, sampleRate, 200);
-    // m_filter[Mid] = new EngineFilterButterworth8(FILTER_BANDPASS, sampleRate, 200, 2000);
-    // m_filter[High] = new EngineFilterButterworth8(FILTER_HIGHPASS, sampleRate, 2000);
-    m_filter[Low] = new EngineFilterBessel4Low(sampleRate, 600);
-    m_filter[Mid] = new EngineFilterBessel4Band(sampleRate, 600, 4000);
-    m_filter[High] = new EngineFilterBessel4High(sampleRate, 4000);
+    m_pFilterBank = new WaveformFilterBank(sampleRate, 600, 4000);
+    for (int i = 0; i < WaveformFilterBank::kLanes; ++i) {
+        m_peaks[i] = 0.0f;
+    }
 }
 
 void AnalyserWaveform::destroyFilters() {
-    for (int i = 0; i < FilterCount; ++i) {
-        if (m_filter[i]) {
-            delete m_filter[i];
-            m_filter[i] = 0;
-        }
-    }
+    delete m_pFilterBank;
+    m_pFilterBank = NULL;
 }
 
 void AnalyserWaveform::process(const CSAMPLE* buffer, const int bufferLength) {
     if (m_skipProcessing || !m_waveform || !m_waveformSummary)
         return;
 
-    //this should only append once if bufferLength is constant
-    if (bufferLength > (int)m_buffers[0].size()) {
-        m_buffers[Low].resize(bufferLength);
-        m_buffers[Mid].resize(bufferLength);
-        m_buffers[High].resize(bufferLength);
-    }
-
-    m_filter[Low]->process(buffer, &m_buffers[Low][0], bufferLength);
-    m_filter[Mid]->process(buffer, &m_buffers[Mid][0], bufferLength);
-    m_filter[High]->process(buffer, &m_buffers[High][0], bufferLength);
-
-
-    for (int i = 0; i < bufferLength; i+=2) {
-        // Take max value, not average of data
-        CSAMPLE cover[2] = { fabs(buffer[i]), fabs(buffer[i + 1]) };
-        CSAMPLE clow[2] =  { fabs(m_buffers[Low][i]), fabs(m_buffers[Low][i + 1]) };
-        CSAMPLE cmid[2] =  { fabs(m_buffers[Mid][i]), fabs(m_buffers[Mid][i + 1]) };
-        CSAMPLE chigh[2] = { fabs(m_buffers[High][i]), fabs(m_buffers[High][i + 1]) };
-
-        // This is for if you want to experiment with averaging instead of
-        // maxing.
-        // m_stride.m_overallData[Right] += buffer[i]*buffer[i];
-        // m_stride.m_overallData[Left] += buffer[i + 1]*buffer[i + 1];
-        // m_stride.m_filteredData[Right][Low] += m_buffers[Low][i]*m_buffers[Low][i];
-        // m_stride.m_filteredData[Left][Low] += m_buffers[Low][i + 1]*m_buffers[Low][i + 1];
-        // m_stride.m_filteredData[Right][Mid] += m_buffers[Mid][i]*m_buffers[Mid][i];
-        // m_stride.m_filteredData[Left][Mid] += m_buffers[Mid][i + 1]*m_buffers[Mid][i + 1];
-        // m_stride.m_filteredData[Right][High] += m_buffers[High][i]*m_buffers[High][i];
-        // m_stride.m_filteredData[Left][High] += m_buffers[High][i + 1]*m_buffers[High][i + 1];
-
-        // Record the max across this stride.
-        storeIfGreater(&m_stride.m_overallData[Left], cover[Left]);
-        storeIfGreater(&m_stride.m_overallData[Right], cover[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][Low], clow[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][Low], clow[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][Mid], cmid[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][Mid], cmid[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][High], chigh[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][High], chigh[Right]);
-
-        m_stride.m_position++;
-
-        if (fmod(m_stride.m_position, m_stride.m_length) < 1) {
+    const int frames = bufferLength / 2;
+    int frame = 0;
+    while (frame < frames) {
+        // Filter all frames up to the end of the next stride in one go, the
+        // filter bank records the peaks.
+        const int strideEndPosition = strideEnd(
+                m_currentStride / ChannelCount, m_stride.m_length,
+                m_stride.m_position);
+        const int summaryStrideEndPosition = strideEnd(
+                m_currentSummaryStride / ChannelCount, m_stride.m_averageLength,
+                m_stride.m_position);
+        const int chunk = math_min(frames - frame, math_min(
+                strideEndPosition, summaryStrideEndPosition) - m_stride.m_position);
+        m_pFilterBank->process(&buffer[frame * 2], chunk, m_peaks);
+        frame += chunk;
+        m_stride.m_position += chunk;
+
+        if (m_stride.m_position == strideEndPosition) {
+            mergePeaks();
             if (m_currentStride + ChannelCount > m_waveform->getDataSize()) {
                 qWarning() << "AnalyserWaveform::process - currentStride >= waveform size";
                 return;
@@ -242,7 +218,8 @@ void AnalyserWaveform::process(const CSAMPLE* buffer, const int bufferLength) {
             m_waveform->setCompletion(m_currentStride);
         }
 
-        if (fmod(m_stride.m_position, m_stride.m_averageLength) < 1) {
+        if (m_stride.m_position == summaryStrideEndPosition) {
+            mergePeaks();
             if (m_currentSummaryStride + ChannelCount > m_waveformSummary->getDataSize()) {
                 qWarning() << "AnalyserWaveform::process - current summary stride >= waveform summary size";
                 return;
@@ -268,6 +245,22 @@ void AnalyserWaveform::process(const CSAMPLE* buffer, const int bufferLength) {
     //qDebug() << "AnalyserWaveform::process - m_waveformSummary->getCompletion()" << m_waveformSummary->getCompletion() << "off" << m_waveformSummary->getDataSize();
 }
 
+void AnalyserWaveform::mergePeaks() {
+    // Take max value, not average of data
+    for (int i = 0; i < ChannelCount; ++i) {
+        ChannelIndex channel = static_cast<ChannelIndex>(i);
+        CSAMPLE* pPeak = &m_peaks[WaveformFilterBank::overallLane(channel)];
+        storeIfGreater(&m_stride.m_overallData[channel], *pPeak);
+        *pPeak = 0.0f;
+        for (int f = 0; f < FilterCount; ++f) {
+            FilterIndex filter = static_cast<FilterIndex>(f);
+            pPeak = &m_peaks[WaveformFilterBank::lane(filter, channel)];
+            storeIfGreater(&m_stride.m_filteredData[channel][filter], *pPeak);
+            *pPeak = 0.0f;
+        }
+    }
+}
+
 void AnalyserWaveform::cleanup(TrackPointer tio) {
     Q_UNUSED(tio);
     if (m_skipProcessing) {
@@ -297,6 +290,10 @@ void AnalyserWaveform::finalise(TrackPointer tio) {
         m_waveform->setCompletion(m_waveform->getDataSize());
         m_waveform->setVersion(WaveformFactory::currentWaveformVersion());
         m_waveform->setDescription(WaveformFactory::currentWaveformDescription());
+        // The track may have been saved while the waveform was analysed.
+        // Hand the finished waveform to it again so it is saved once more.
+        m_waveform->setDirty(true);
+        tio->setWaveform(m_waveform);
         // Since clear() could delete the waveform, clear our pointer to the
         // waveform's vector data first.
         m_waveformData = NULL;
@@ -308,6 +305,7 @@ void AnalyserWaveform::finalise(TrackPointer tio) {
         m_waveformSummary->setCompletion(m_waveformSummary->getDataSize());
         m_waveformSummary->setVersion(WaveformFactory::currentWaveformSummaryVersion());
         m_waveformSummary->setDescription(WaveformFactory::currentWaveformSummaryDescription());
+        tio->setWaveformSummary(m_waveformSummary);
         // Since clear() could delete the waveform, clear our pointer to the
         // waveform's vector data first.
         m_waveformSummaryData = NULL;
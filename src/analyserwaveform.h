@@ -9,14 +9,12 @@
 #include "configobject.h"
 #include "analyser.h"
 #include "waveform/waveform.h"
+#include "waveform/waveformfilterbank.h"
 #include "util/math.h"
 
 //NOTS vrince some test to segment sound, to apply color in the waveform
 //#define TEST_HEAT_MAP
 
-class EngineObjectConstIn;
-class EngineFilterButterworth8;
-class EngineFilterBessel4;
 class Waveform;
 class AnalysisDao;
 
@@ -155,6 +153,9 @@ class AnalyserWaveform : public Analyser {
 
     void resetFilters(TrackPointer tio, int sampleRate);
     void destroyFilters();
+    // Moves the peaks the filter bank found since the last call into the
+    // current stride.
+    void mergePeaks();
     void storeIfGreater(float* pDest, float source);
 
   private:
@@ -170,8 +171,8 @@ class AnalyserWaveform : public Analyser {
     int m_currentStride;
     int m_currentSummaryStride;
 
-    EngineObjectConstIn* m_filter[FilterCount];
-    std::vector<float> m_buffers[FilterCount];
+    WaveformFilterBank* m_pFilterBank;
+    CSAMPLE m_peaks[WaveformFilterBank::kLanes];
 
     QTime* m_timer;
     QSqlDatabase m_database;
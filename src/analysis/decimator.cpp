@@ -0,0 +1,64 @@
+#include <math.h>
+
+#include "analysis/decimator.h"
+#include "util/math.h"
+
+namespace {
+
+// Taps per factor of the low pass.
+const int kTapsPerFactor = 8;
+
+}  // namespace
+
+Decimator::Decimator(int factor)
+        : m_factor(math_max(factor, 1)) {
+    if (m_factor == 1) {
+        m_taps.append(1.0f);
+    } else {
+        // Blackman windowed sinc with the cutoff a bit below the new
+        // Nyquist frequency, normalized to unity gain at DC.
+        const int length = kTapsPerFactor * m_factor + 1;
+        const double cutoff = 0.45 / m_factor;
+        const int center = length / 2;
+        double sum = 0.0;
+        for (int i = 0; i < length; ++i) {
+            const int n = i - center;
+            double sinc = n == 0 ? 2 * cutoff :
+                    sin(2 * M_PI * cutoff * n) / (M_PI * n);
+            double window = 0.42 - 0.5 * cos(2 * M_PI * i / (length - 1)) +
+                    0.08 * cos(4 * M_PI * i / (length - 1));
+            m_taps.append(static_cast<float>(sinc * window));
+            sum += sinc * window;
+        }
+        for (int i = 0; i < length; ++i) {
+            m_taps[i] /= sum;
+        }
+    }
+    // Start as if the signal was preceded by silence.
+    m_input.fill(0.0f, m_taps.size() - 1);
+}
+
+// static
+int Decimator::factorForRate(int sampleRate, int targetRate) {
+    return math_max(sampleRate / math_max(targetRate, 1), 1);
+}
+
+void Decimator::process(const CSAMPLE* pIn, int iLen,
+                        QVector<float>* pOutput) {
+    for (int i = 0; i + 1 < iLen; i += 2) {
+        m_input.append(0.5f * (pIn[i] + pIn[i + 1]));
+    }
+
+    const int taps = m_taps.size();
+    const float* pTaps = m_taps.constData();
+    const float* pInput = m_input.constData();
+    int position = 0;
+    for (; position + taps <= m_input.size(); position += m_factor) {
+        float sum = 0.0f;
+        for (int tap = 0; tap < taps; ++tap) {
+            sum += pTaps[tap] * pInput[position + tap];
+        }
+        pOutput->append(sum);
+    }
+    m_input.remove(0, position);
+}
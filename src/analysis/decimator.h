@@ -0,0 +1,41 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <QVector>
+
+#include "util/types.h"
+
+// Mixes interleaved stereo down to mono and reduces the sample rate by an
+// integer factor. A windowed sinc low pass keeps the frequencies above the
+// new Nyquist frequency from folding back. Only the samples that are kept
+// are filtered.
+class Decimator {
+  public:
+    explicit Decimator(int factor);
+
+    int factor() const {
+        return m_factor;
+    }
+
+    // The delay of the low pass in frames of the input.
+    int delay() const {
+        return (m_taps.size() - 1) / 2;
+    }
+
+    // The factor that brings sampleRate closest to, but not below,
+    // targetRate.
+    static int factorForRate(int sampleRate, int targetRate);
+
+    // Appends the decimated mono signal of iLen interleaved stereo samples
+    // to pOutput.
+    void process(const CSAMPLE* pIn, int iLen, QVector<float>* pOutput);
+
+  private:
+    int m_factor;
+    QVector<float> m_taps;
+    // The mono input that has not been consumed yet, starting with the
+    // history the next output sample needs.
+    QVector<float> m_input;
+};
+
+#endif /* DECIMATOR_H */
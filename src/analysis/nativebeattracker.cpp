@@ -0,0 +1,214 @@
+#include <math.h>
+#include <algorithm>
+
+#include <QtDebug>
+
+#include "analysis/nativebeattracker.h"
+#include "util/math.h"
+
+namespace {
+
+// The onset curve does not need more than 11 kHz.
+const int kTargetRate = 11025;
+const int kFrameSize = 1024;
+const int kHopSize = 128;
+// Compression of the magnitudes before the flux is taken. Stronger
+// compression lets broadband noise like hi-hats outweigh the kick drum.
+const float kLogCompression = 1.0f;
+// Removes slow changes of loudness from the onset curve, in onset frames.
+const int kMeanWindow = 32;
+
+// The range the tempo is searched in and the tempo that is preferred when
+// more than one fits, with the width of the preference in octaves.
+const double kMinBpm = 50.0;
+const double kMaxBpm = 220.0;
+const double kPreferredBpm = 120.0;
+const double kTempoSpread = 1.0;
+// How much a beat may deviate from the tempo to land on a stronger onset.
+const double kTightness = 100.0;
+
+}  // namespace
+
+NativeBeatTracker::NativeBeatTracker(int sampleRate, bool bFastAnalysis)
+        : m_iSampleRate(sampleRate),
+          // Like VampAnalyser, only consider the first minute.
+          m_iMaxSamplesToAnalyse(bFastAnalysis ? 120 * sampleRate : 0),
+          m_iSampleCount(0),
+          m_decimator(Decimator::factorForRate(sampleRate, kTargetRate)),
+          m_fft(kFrameSize),
+          m_window(kFrameSize),
+          m_frame(kFrameSize),
+          m_magnitudes(kFrameSize / 2 + 1),
+          m_bpm(0.0) {
+    for (int i = 0; i < kFrameSize; ++i) {
+        m_window[i] = 0.5f - 0.5f * cos(2 * M_PI * i / kFrameSize);
+    }
+}
+
+void NativeBeatTracker::process(const CSAMPLE* pIn, const int iLen) {
+    if (m_iMaxSamplesToAnalyse > 0 && m_iSampleCount >= m_iMaxSamplesToAnalyse) {
+        return;
+    }
+    m_iSampleCount += iLen;
+    m_decimator.process(pIn, iLen, &m_signal);
+    processFrames();
+}
+
+void NativeBeatTracker::processFrames() {
+    const int bins = m_magnitudes.size();
+    int position = 0;
+    for (; position + kFrameSize <= m_signal.size(); position += kHopSize) {
+        const float* pSignal = m_signal.constData() + position;
+        for (int i = 0; i < kFrameSize; ++i) {
+            m_frame[i] = pSignal[i] * m_window[i];
+        }
+        m_fft.magnitudes(m_frame.constData(), m_magnitudes.data());
+        for (int i = 0; i < bins; ++i) {
+            m_magnitudes[i] = log(1.0f + kLogCompression * m_magnitudes[i]);
+        }
+
+        // Spectral flux: the sum of all increases of the magnitudes since
+        // the last frame.
+        float flux = 0.0f;
+        if (!m_previousLogMagnitudes.isEmpty()) {
+            for (int i = 0; i < bins; ++i) {
+                flux += math_max(m_magnitudes[i] - m_previousLogMagnitudes[i],
+                                 0.0f);
+            }
+        }
+        m_onsets.append(flux);
+        m_previousLogMagnitudes = m_magnitudes;
+    }
+    m_signal.remove(0, position);
+}
+
+double NativeBeatTracker::estimateBeatPeriod(
+        const QVector<double>& onsets) const {
+    const double onsetRate = static_cast<double>(m_iSampleRate) /
+            m_decimator.factor() / kHopSize;
+    const int minLag = static_cast<int>(60.0 * onsetRate / kMaxBpm);
+    const int maxLag = math_min(static_cast<int>(60.0 * onsetRate / kMinBpm) + 1,
+                                onsets.size() / 2);
+    const double preferredLag = 60.0 * onsetRate / kPreferredBpm;
+    if (maxLag <= minLag + 1) {
+        return preferredLag;
+    }
+
+    // Autocorrelation of the onset curve, weighted towards the preferred
+    // tempo so that the beat wins over its multiples.
+    QVector<double> scores(maxLag + 2, 0.0);
+    for (int lag = minLag; lag <= maxLag + 1; ++lag) {
+        double sum = 0.0;
+        for (int t = lag; t < onsets.size(); ++t) {
+            sum += onsets[t] * onsets[t - lag];
+        }
+        double octaves = log(lag / preferredLag) / log(2.0);
+        scores[lag] = sum / (onsets.size() - lag) *
+                exp(-0.5 * octaves * octaves / (kTempoSpread * kTempoSpread));
+    }
+    int bestLag = minLag + 1;
+    for (int lag = minLag + 1; lag <= maxLag; ++lag) {
+        if (scores[lag] > scores[bestLag]) {
+            bestLag = lag;
+        }
+    }
+
+    // Refine the period between the lags by fitting a parabola.
+    const double left = scores[bestLag - 1];
+    const double center = scores[bestLag];
+    const double right = scores[bestLag + 1];
+    const double denominator = left - 2 * center + right;
+    double period = bestLag;
+    if (denominator < 0.0) {
+        period += math_clamp(0.5 * (left - right) / denominator, -0.5, 0.5);
+    }
+    return period;
+}
+
+QVector<double> NativeBeatTracker::finalise() {
+    QVector<double> beats;
+    m_bpm = 0.0;
+    const int frames = m_onsets.size();
+    if (frames < 2 * kMeanWindow) {
+        qDebug() << "NativeBeatTracker: Track too short for beat tracking.";
+        return beats;
+    }
+
+    // Remove the local mean and normalize, only the rises remain.
+    QVector<double> onsets(frames);
+    double sum = 0.0;
+    for (int t = 0; t < frames; ++t) {
+        sum += m_onsets[t];
+        if (t >= kMeanWindow) {
+            sum -= m_onsets[t - kMeanWindow];
+        }
+        const int window = math_min(t + 1, kMeanWindow);
+        onsets[t] = math_max(m_onsets[t] - sum / window, 0.0);
+    }
+    double squares = 0.0;
+    for (int t = 0; t < frames; ++t) {
+        squares += onsets[t] * onsets[t];
+    }
+    const double deviation = sqrt(squares / frames);
+    if (deviation <= 0.0) {
+        qDebug() << "NativeBeatTracker: No onsets found.";
+        return beats;
+    }
+    for (int t = 0; t < frames; ++t) {
+        onsets[t] /= deviation;
+    }
+
+    const double period = estimateBeatPeriod(onsets);
+    const double onsetRate = static_cast<double>(m_iSampleRate) /
+            m_decimator.factor() / kHopSize;
+    m_bpm = 60.0 * onsetRate / period;
+
+    // Every onset frame gets the score of the best chain of beats ending in
+    // it. The previous beat is searched between half and twice the period.
+    const int minStep = math_max(static_cast<int>(period / 2), 1);
+    const int maxStep = static_cast<int>(period * 2);
+    QVector<double> penalty(maxStep + 1, 0.0);
+    for (int step = minStep; step <= maxStep; ++step) {
+        const double deviation = log(step / period);
+        penalty[step] = kTightness * deviation * deviation;
+    }
+    QVector<double> scores(frames);
+    QVector<int> previous(frames, -1);
+    for (int t = 0; t < frames; ++t) {
+        double best = 0.0;
+        for (int step = minStep; step <= maxStep && step <= t; ++step) {
+            const double score = scores[t - step] - penalty[step];
+            if (previous[t] == -1 || score > best) {
+                best = score;
+                previous[t] = t - step;
+            }
+        }
+        if (previous[t] != -1 && best < 0.0) {
+            // Starting a new chain is better than continuing any.
+            previous[t] = -1;
+            best = 0.0;
+        }
+        scores[t] = onsets[t] + best;
+    }
+
+    // Follow the best chain back from the last period.
+    int last = frames - 1;
+    for (int t = math_max(frames - static_cast<int>(period), 0); t < frames; ++t) {
+        if (scores[t] > scores[last]) {
+            last = t;
+        }
+    }
+    // An onset shows in the flux once it reaches the last quarter of the
+    // frame. The low pass of the decimator delays everything a bit more.
+    const double frameOffset = 3 * kFrameSize / 4;
+    for (int t = last; t != -1; t = previous[t]) {
+        const double frame = (t * kHopSize + frameOffset) * m_decimator.factor()
+                - m_decimator.delay();
+        beats.append(math_max(frame, 0.0));
+    }
+    std::reverse(beats.begin(), beats.end());
+
+    qDebug() << "NativeBeatTracker: Found" << beats.size() << "beats at"
+             << m_bpm << "BPM";
+    return beats;
+}
@@ -0,0 +1,52 @@
+#ifndef NATIVEBEATTRACKER_H
+#define NATIVEBEATTRACKER_H
+
+#include <QVector>
+
+#include "analysis/decimator.h"
+#include "util/fft.h"
+#include "util/types.h"
+
+// Finds the beats of a track without a Vamp plugin.
+//
+// The signal is decimated to about 11 kHz. An onset strength curve is built
+// from the spectral flux of overlapping frames while the track is decoded.
+// When the track is complete the tempo is taken from the autocorrelation of
+// the onset curve and the beats are placed by dynamic programming, trading
+// onset strength against deviation from the tempo (Ellis, "Beat Tracking by
+// Dynamic Programming", 2007).
+class NativeBeatTracker {
+  public:
+    NativeBeatTracker(int sampleRate, bool bFastAnalysis);
+
+    // Takes iLen interleaved stereo samples.
+    void process(const CSAMPLE* pIn, const int iLen);
+
+    // Returns the beat positions in frames of the original sample rate.
+    QVector<double> finalise();
+
+    // The tempo estimated by the last call to finalise().
+    double bpm() const {
+        return m_bpm;
+    }
+
+  private:
+    void processFrames();
+    double estimateBeatPeriod(const QVector<double>& onsets) const;
+
+    const int m_iSampleRate;
+    int m_iMaxSamplesToAnalyse;
+    int m_iSampleCount;
+
+    Decimator m_decimator;
+    FFT m_fft;
+    QVector<float> m_window;
+    QVector<float> m_signal;
+    QVector<float> m_frame;
+    QVector<float> m_magnitudes;
+    QVector<float> m_previousLogMagnitudes;
+    QVector<float> m_onsets;
+    double m_bpm;
+};
+
+#endif /* NATIVEBEATTRACKER_H */
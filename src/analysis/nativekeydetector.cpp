@@ -0,0 +1,173 @@
+#include <math.h>
+
+#include <QtDebug>
+
+#include "analysis/nativekeydetector.h"
+#include "util/math.h"
+
+using mixxx::track::io::key::ChromaticKey;
+
+namespace {
+
+// Everything up to the 7th octave fits below the Nyquist frequency of
+// 5.5 kHz.
+const int kTargetRate = 5512;
+const int kFrameSize = 4096;
+const int kHopSize = 2048;
+const double kMinFrequency = 80.0;
+const double kMaxFrequency = 2000.0;
+const double kMiddleC = 261.6256;
+// The chroma of this many frames around a frame decides its key, about six
+// seconds.
+const int kKeyWindow = 16;
+const int kPitchClasses = 12;
+
+// Krumhansl-Kessler key profiles, starting with the tonic.
+const double kMajorProfile[kPitchClasses] = {
+    6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88
+};
+const double kMinorProfile[kPitchClasses] = {
+    6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17
+};
+
+double correlation(const double* pChroma, const double* pProfile, int tonic) {
+    double chromaMean = 0.0;
+    double profileMean = 0.0;
+    for (int i = 0; i < kPitchClasses; ++i) {
+        chromaMean += pChroma[i];
+        profileMean += pProfile[i];
+    }
+    chromaMean /= kPitchClasses;
+    profileMean /= kPitchClasses;
+
+    double product = 0.0;
+    double chromaSquares = 0.0;
+    double profileSquares = 0.0;
+    for (int i = 0; i < kPitchClasses; ++i) {
+        const double chroma = pChroma[(tonic + i) % kPitchClasses] - chromaMean;
+        const double profile = pProfile[i] - profileMean;
+        product += chroma * profile;
+        chromaSquares += chroma * chroma;
+        profileSquares += profile * profile;
+    }
+    if (chromaSquares <= 0.0) {
+        return 0.0;
+    }
+    return product / sqrt(chromaSquares * profileSquares);
+}
+
+}  // namespace
+
+NativeKeyDetector::NativeKeyDetector(int sampleRate, bool bFastAnalysis)
+        : m_iSampleRate(sampleRate),
+          // Like VampAnalyser, only consider the first minute.
+          m_iMaxSamplesToAnalyse(bFastAnalysis ? 120 * sampleRate : 0),
+          m_iSampleCount(0),
+          m_decimator(Decimator::factorForRate(sampleRate, kTargetRate)),
+          m_fft(kFrameSize),
+          m_window(kFrameSize),
+          m_pitchClasses(kFrameSize / 2 + 1, -1),
+          m_pitchWeights(kFrameSize / 2 + 1, 0.0f),
+          m_frame(kFrameSize),
+          m_magnitudes(kFrameSize / 2 + 1) {
+    for (int i = 0; i < kFrameSize; ++i) {
+        m_window[i] = 0.5f - 0.5f * cos(2 * M_PI * i / kFrameSize);
+    }
+
+    const double decimatedRate =
+            static_cast<double>(sampleRate) / m_decimator.factor();
+    for (int bin = 1; bin < m_pitchClasses.size(); ++bin) {
+        const double frequency = bin * decimatedRate / kFrameSize;
+        if (frequency < kMinFrequency || frequency > kMaxFrequency) {
+            continue;
+        }
+        const double pitch = 12.0 * log(frequency / kMiddleC) / log(2.0);
+        const double nearest = floor(pitch + 0.5);
+        m_pitchClasses[bin] = (static_cast<int>(nearest) % kPitchClasses +
+                               kPitchClasses) % kPitchClasses;
+        // Bins between two pitches say little about either.
+        m_pitchWeights[bin] = 1.0f - 2.0f * fabs(pitch - nearest);
+    }
+}
+
+void NativeKeyDetector::process(const CSAMPLE* pIn, const int iLen) {
+    if (m_iMaxSamplesToAnalyse > 0 && m_iSampleCount >= m_iMaxSamplesToAnalyse) {
+        return;
+    }
+    m_iSampleCount += iLen;
+    m_decimator.process(pIn, iLen, &m_signal);
+    processFrames();
+}
+
+void NativeKeyDetector::processFrames() {
+    const int bins = m_magnitudes.size();
+    int position = 0;
+    for (; position + kFrameSize <= m_signal.size(); position += kHopSize) {
+        const float* pSignal = m_signal.constData() + position;
+        for (int i = 0; i < kFrameSize; ++i) {
+            m_frame[i] = pSignal[i] * m_window[i];
+        }
+        m_fft.magnitudes(m_frame.constData(), m_magnitudes.data());
+
+        double chroma[kPitchClasses] = { 0.0 };
+        for (int bin = 0; bin < bins; ++bin) {
+            if (m_pitchClasses[bin] >= 0) {
+                chroma[m_pitchClasses[bin]] +=
+                        m_pitchWeights[bin] * m_magnitudes[bin];
+            }
+        }
+        for (int i = 0; i < kPitchClasses; ++i) {
+            m_chromagram.append(chroma[i]);
+        }
+    }
+    m_signal.remove(0, position);
+}
+
+// static
+ChromaticKey NativeKeyDetector::estimateKey(const double* pChroma) {
+    ChromaticKey bestKey = mixxx::track::io::key::INVALID;
+    double bestCorrelation = 0.0;
+    for (int tonic = 0; tonic < kPitchClasses; ++tonic) {
+        // The major keys start with C_MAJOR, the minor ones with C_MINOR,
+        // both counting up by semitones.
+        const double major = correlation(pChroma, kMajorProfile, tonic);
+        if (major > bestCorrelation) {
+            bestCorrelation = major;
+            bestKey = static_cast<ChromaticKey>(
+                    mixxx::track::io::key::C_MAJOR + tonic);
+        }
+        const double minor = correlation(pChroma, kMinorProfile, tonic);
+        if (minor > bestCorrelation) {
+            bestCorrelation = minor;
+            bestKey = static_cast<ChromaticKey>(
+                    mixxx::track::io::key::C_MINOR + tonic);
+        }
+    }
+    return bestKey;
+}
+
+KeyChangeList NativeKeyDetector::finalise() {
+    KeyChangeList keyChanges;
+    const int frames = m_chromagram.size() / kPitchClasses;
+    ChromaticKey currentKey = mixxx::track::io::key::INVALID;
+    for (int frame = 0; frame < frames; ++frame) {
+        const int first = math_max(frame - kKeyWindow / 2, 0);
+        const int last = math_min(frame + kKeyWindow / 2, frames - 1);
+        double chroma[kPitchClasses] = { 0.0 };
+        for (int i = first; i <= last; ++i) {
+            for (int pitchClass = 0; pitchClass < kPitchClasses; ++pitchClass) {
+                chroma[pitchClass] += m_chromagram[i * kPitchClasses + pitchClass];
+            }
+        }
+
+        ChromaticKey key = estimateKey(chroma);
+        if (key != mixxx::track::io::key::INVALID && key != currentKey) {
+            currentKey = key;
+            keyChanges.push_back(qMakePair(
+                    key, static_cast<double>(frame * kHopSize * m_decimator.factor())));
+        }
+    }
+    qDebug() << "NativeKeyDetector: Found" << keyChanges.size()
+             << "key changes in" << frames << "frames";
+    return keyChanges;
+}
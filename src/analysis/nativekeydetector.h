@@ -0,0 +1,55 @@
+#ifndef NATIVEKEYDETECTOR_H
+#define NATIVEKEYDETECTOR_H
+
+#include <QVector>
+
+#include "analysis/decimator.h"
+#include "proto/keys.pb.h"
+#include "track/keys.h"
+#include "util/fft.h"
+#include "util/types.h"
+
+// Estimates the key of a track without a Vamp plugin.
+//
+// The signal is decimated to about 5.5 kHz and the magnitudes of each frame
+// are folded into a chromagram, the energy of the 12 pitch classes. The
+// chroma of a few seconds around every frame is correlated with the
+// Krumhansl-Kessler profiles of the 24 major and minor keys and the best
+// match becomes the key at that position.
+class NativeKeyDetector {
+  public:
+    NativeKeyDetector(int sampleRate, bool bFastAnalysis);
+
+    // Takes iLen interleaved stereo samples.
+    void process(const CSAMPLE* pIn, const int iLen);
+
+    // Returns the key changes, positioned in frames of the original sample
+    // rate.
+    KeyChangeList finalise();
+
+    // The key whose profile correlates best with the 12 pitch class
+    // energies in pChroma, starting with C. INVALID for silence.
+    static mixxx::track::io::key::ChromaticKey estimateKey(const double* pChroma);
+
+  private:
+    void processFrames();
+
+    const int m_iSampleRate;
+    int m_iMaxSamplesToAnalyse;
+    int m_iSampleCount;
+
+    Decimator m_decimator;
+    FFT m_fft;
+    QVector<float> m_window;
+    // The pitch class of every FFT bin, -1 if the bin is not used, and how
+    // close the bin is to the center of the pitch.
+    QVector<int> m_pitchClasses;
+    QVector<float> m_pitchWeights;
+    QVector<float> m_signal;
+    QVector<float> m_frame;
+    QVector<float> m_magnitudes;
+    // 12 values per frame.
+    QVector<double> m_chromagram;
+};
+
+#endif /* NATIVEKEYDETECTOR_H */
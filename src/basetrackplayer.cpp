@@ -4,6 +4,7 @@
 #include "playerinfo.h"
 
 #include "controlobject.h"
+#include "control/controlrecorder.h"
 #include "controlpotmeter.h"
 #include "trackinfoobject.h"
 #include "engine/enginebuffer.h"
@@ -132,6 +133,8 @@ void BaseTrackPlayerImpl::slotLoadTrack(TrackPointer track, bool bPlay) {
         // We don't have access.
         return;
     }
+    ControlRecorder::recordTrackLoad(
+            getGroup(), track ? track->getLocation() : QString(), bPlay);
 
     //Disconnect the old track's signals.
     if (m_pLoadedTrack) {
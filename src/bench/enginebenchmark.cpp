@@ -0,0 +1,293 @@
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QtDebug>
+#include <QStringList>
+
+#include "bench/enginebenchmark.h"
+
+#include "controlobject.h"
+#include "controlobjectslave.h"
+#include "deck.h"
+#include "effects/effectsmanager.h"
+#include "effects/native/nativebackend.h"
+#include "engine/enginemaster.h"
+#include "playermanager.h"
+#include "trackinfoobject.h"
+#include "util/defs.h"
+#include "util/math.h"
+#include "util/sleepableqthread.h"
+#include "util/time.h"
+
+#ifdef __LINUX__
+extern "C" {
+    #include <sys/time.h>
+    #include <sys/resource.h>
+}
+#endif
+
+namespace {
+
+// When no duration is given, keep running this long after the last session
+// event so that its effect on the engine is measured too.
+const double kSessionTailSeconds = 5.0;
+const double kDefaultDurationSeconds = 60.0;
+
+const qint64 kNanosPerSecond = 1000000000LL;
+
+// Returns the peak resident set size of the process in kilobytes or -1 if it
+// is not known on this platform.
+long peakResidentSetKB() {
+#ifdef __LINUX__
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return usage.ru_maxrss;
+    }
+#endif
+    return -1;
+}
+
+double nanosToMillis(qint64 nanos) {
+    return nanos / 1000000.0;
+}
+
+}  // anonymous namespace
+
+EngineBenchmark::EngineBenchmark(ConfigObject<ConfigValue>* pConfig,
+                                 const Options& options)
+        : m_pConfig(pConfig),
+          m_options(options),
+          m_pEffectsManager(NULL),
+          m_pEngineMaster(NULL),
+          m_pNumDecks(NULL),
+          m_iNextEvent(0),
+          m_cpuNanos(0),
+          m_iDeadlineMisses(0),
+          m_deadlineNanos(0) {
+}
+
+EngineBenchmark::~EngineBenchmark() {
+    qDeleteAll(m_controls);
+    m_controls.clear();
+    // The decks delete their EngineDecks through the EngineMaster.
+    qDeleteAll(m_decks);
+    m_decks.clear();
+    delete m_pNumDecks;
+    delete m_pEngineMaster;
+    delete m_pEffectsManager;
+}
+
+bool EngineBenchmark::setup() {
+    if (!m_options.sessionPath.isEmpty() &&
+            !ControlRecorder::readSession(m_options.sessionPath, &m_events)) {
+        return false;
+    }
+    if (m_options.numDecks <= 0 || m_options.bufferFrames <= 0 ||
+            m_options.bufferFrames * 2 > static_cast<int>(MAX_BUFFER_LEN) ||
+            m_options.sampleRate <= 0) {
+        qWarning() << "EngineBenchmark: invalid engine options";
+        return false;
+    }
+
+    // Same order as MixxxMainWindow.
+    m_pEffectsManager = new EffectsManager(NULL, m_pConfig);
+    m_pEngineMaster = new EngineMaster(m_pConfig, "[Master]",
+                                       m_pEffectsManager, false, true);
+    m_pEffectsManager->addEffectsBackend(new NativeBackend(m_pEffectsManager));
+    m_pEffectsManager->setupDefaults();
+
+    ControlObject::set(ConfigKey("[Master]", "samplerate"),
+                       m_options.sampleRate);
+    ControlObject::set(ConfigKey("[Master]", "audio_buffer_size"),
+                       m_options.bufferFrames * 1000.0 / m_options.sampleRate);
+
+    m_pNumDecks = new ControlObjectSlave("[Master]", "num_decks");
+    for (int i = 0; i < m_options.numDecks; ++i) {
+        QString group = PlayerManager::groupForDeck(i);
+        EngineChannel::ChannelOrientation orientation =
+                i % 2 == 0 ? EngineChannel::LEFT : EngineChannel::RIGHT;
+        Deck* pDeck = new Deck(NULL, m_pConfig, m_pEngineMaster,
+                               m_pEffectsManager, orientation, group);
+        // Same setup as PlayerManager::addDeckInner().
+        EqualizerRackPointer pEqRack = m_pEffectsManager->getEqualizerRack(0);
+        if (pEqRack) {
+            pEqRack->addEffectChainSlotForGroup(group);
+        }
+        pDeck->setupEqControls();
+        QuickEffectRackPointer pQuickEffectRack =
+                m_pEffectsManager->getQuickEffectRack(0);
+        if (pQuickEffectRack) {
+            pQuickEffectRack->addEffectChainSlotForGroup(group);
+        }
+        m_decks.insert(group, pDeck);
+    }
+    if (m_pNumDecks->valid()) {
+        m_pNumDecks->set(m_options.numDecks);
+    }
+
+    for (QMap<QString, QString>::const_iterator it = m_options.tracks.begin();
+         it != m_options.tracks.end(); ++it) {
+        loadTrack(it.key(), it.value(), false);
+    }
+    return true;
+}
+
+void EngineBenchmark::loadTrack(const QString& group, const QString& location,
+                                bool bPlay) {
+    Deck* pDeck = m_decks.value(group, NULL);
+    if (pDeck == NULL) {
+        qWarning() << "EngineBenchmark: no player" << group
+                   << "to load" << location;
+        return;
+    }
+    TrackPointer pTrack;
+    if (!location.isEmpty()) {
+        // The benchmark runs without a GUI, so avoid the message box that a
+        // failed load pops up.
+        if (!QFileInfo(location).exists()) {
+            qWarning() << "EngineBenchmark: track does not exist" << location;
+            return;
+        }
+        pTrack = TrackPointer(new TrackInfoObject(location),
+                              &QObject::deleteLater);
+    }
+    pDeck->slotLoadTrack(pTrack, bPlay);
+}
+
+void EngineBenchmark::applyEvent(const ControlSessionEvent& event) {
+    if (event.type == ControlSessionEvent::LOAD) {
+        loadTrack(event.key.group, event.location, event.value > 0.0);
+        return;
+    }
+
+    ControlObjectSlave* pControl = m_controls.value(event.key, NULL);
+    if (pControl == NULL) {
+        if (m_missingControls.contains(event.key)) {
+            return;
+        }
+        if (ControlObject::getControl(event.key, false) == NULL) {
+            qWarning() << "EngineBenchmark: ignoring unknown control"
+                       << event.key.group << event.key.item;
+            m_missingControls.insert(event.key);
+            return;
+        }
+        pControl = new ControlObjectSlave(event.key);
+        m_controls.insert(event.key, pControl);
+    }
+    // Sets through a slave like the GUI and controllers do, so that the
+    // change is seen by the engine as a change made by a user.
+    pControl->set(event.value);
+}
+
+void EngineBenchmark::applyEventsUntil(qint64 nanos) {
+    while (m_iNextEvent < m_events.size() &&
+            m_events[m_iNextEvent].nanos <= nanos) {
+        applyEvent(m_events[m_iNextEvent++]);
+    }
+}
+
+void EngineBenchmark::run() {
+    const int bufferSamples = m_options.bufferFrames * 2;
+    m_deadlineNanos = kNanosPerSecond * m_options.bufferFrames /
+            m_options.sampleRate;
+
+    double durationSeconds = m_options.durationSeconds;
+    if (durationSeconds <= 0.0) {
+        durationSeconds = m_events.isEmpty() ? kDefaultDurationSeconds :
+                m_events.last().nanos / static_cast<double>(kNanosPerSecond) +
+                kSessionTailSeconds;
+    }
+    const int numCallbacks = static_cast<int>(
+            durationSeconds * m_options.sampleRate / m_options.bufferFrames);
+
+    m_callbackNanos.clear();
+    m_callbackNanos.reserve(numCallbacks);
+    m_cpuNanos = 0;
+    m_iDeadlineMisses = 0;
+
+    qDebug() << "EngineBenchmark: running" << numCallbacks << "callbacks of"
+             << m_options.bufferFrames << "frames at" << m_options.sampleRate
+             << "Hz," << m_events.size() << "session events";
+
+    PerformanceTimer runTimer;
+    runTimer.start();
+    PerformanceTimer callbackTimer;
+    ThreadCpuTimer cpuTimer;
+    for (int i = 0; i < numCallbacks; ++i) {
+        const qint64 streamNanos = m_deadlineNanos * i;
+        applyEventsUntil(streamNanos);
+
+        cpuTimer.start();
+        callbackTimer.start();
+        m_pEngineMaster->process(bufferSamples);
+        const qint64 callbackNanos = callbackTimer.elapsed();
+        m_cpuNanos += cpuTimer.elapsed();
+
+        m_callbackNanos.append(callbackNanos);
+        if (callbackNanos > m_deadlineNanos) {
+            ++m_iDeadlineMisses;
+        }
+
+        // Deliver the queued signals of the reader and analysis threads.
+        QCoreApplication::processEvents();
+
+        if (m_options.speed > 0.0) {
+            const qint64 wallNanos = static_cast<qint64>(
+                    m_deadlineNanos * (i + 1) / m_options.speed);
+            const qint64 aheadNanos = wallNanos - runTimer.elapsed();
+            if (aheadNanos > 0) {
+                SleepableQThread::usleep(aheadNanos / 1000);
+            }
+        }
+    }
+}
+
+QString EngineBenchmark::report() const {
+    QStringList lines;
+    lines << "mixxx-bench report";
+    if (!m_options.sessionPath.isEmpty()) {
+        lines << QString("session: %1 (%2 events)")
+                .arg(m_options.sessionPath).arg(m_events.size());
+    }
+    lines << QString("engine: %1 decks, %2 frames at %3 Hz, deadline %4 ms")
+            .arg(m_options.numDecks).arg(m_options.bufferFrames)
+            .arg(m_options.sampleRate)
+            .arg(nanosToMillis(m_deadlineNanos), 0, 'f', 3);
+
+    const int count = m_callbackNanos.size();
+    if (count == 0) {
+        lines << "no callbacks were run";
+        return lines.join("\n");
+    }
+
+    QVector<qint64> sorted = m_callbackNanos;
+    qSort(sorted);
+    qint64 total = 0;
+    foreach (qint64 nanos, sorted) {
+        total += nanos;
+    }
+    const qint64 median = sorted[count / 2];
+    const qint64 p99 = sorted[math_min(count - 1, count * 99 / 100)];
+    const qint64 max = sorted[count - 1];
+
+    lines << QString("callbacks: %1").arg(count);
+    lines << QString("callback time (ms): mean %1, median %2, p99 %3, max %4")
+            .arg(nanosToMillis(total / count), 0, 'f', 3)
+            .arg(nanosToMillis(median), 0, 'f', 3)
+            .arg(nanosToMillis(p99), 0, 'f', 3)
+            .arg(nanosToMillis(max), 0, 'f', 3);
+    lines << QString("engine thread CPU: %1 ms per callback, %2% of real time")
+            .arg(nanosToMillis(m_cpuNanos / count), 0, 'f', 3)
+            .arg(100.0 * m_cpuNanos / (m_deadlineNanos * count), 0, 'f', 1);
+    lines << QString("deadline misses: %1 (%2%)")
+            .arg(m_iDeadlineMisses)
+            .arg(100.0 * m_iDeadlineMisses / count, 0, 'f', 2);
+    const long peakKB = peakResidentSetKB();
+    lines << QString("peak memory: %1")
+            .arg(peakKB < 0 ? QString("unknown") :
+                 QString("%1 MB").arg(peakKB / 1024.0, 0, 'f', 1));
+    if (!m_missingControls.isEmpty()) {
+        lines << QString("unknown controls ignored: %1")
+                .arg(m_missingControls.size());
+    }
+    return lines.join("\n");
+}
@@ -0,0 +1,85 @@
+#ifndef ENGINEBENCHMARK_H
+#define ENGINEBENCHMARK_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include "configobject.h"
+#include "control/controlrecorder.h"
+
+class ControlObjectSlave;
+class Deck;
+class EffectsManager;
+class EngineMaster;
+
+// EngineBenchmark drives EngineMaster without a sound device, the way the
+// SoundManager callback would, and measures how long each callback takes.
+// Control changes and track loads are replayed from a session recorded with
+// mixxx --recordSessionPath so that a real set can be reproduced on any
+// machine.
+class EngineBenchmark {
+  public:
+    struct Options {
+        Options()
+                : numDecks(4),
+                  bufferFrames(512),
+                  sampleRate(44100),
+                  durationSeconds(0.0),
+                  speed(1.0) {
+        }
+
+        QString sessionPath;
+        // Tracks to load before the session starts, keyed by player group.
+        QMap<QString, QString> tracks;
+        int numDecks;
+        int bufferFrames;
+        int sampleRate;
+        // 0 means run until the last session event plus a short tail.
+        double durationSeconds;
+        // Callbacks are paced at speed times real time. 0 runs them back to
+        // back. Track loading happens in the background so anything other
+        // than 1 changes how much of a track is cached when it is played.
+        double speed;
+    };
+
+    EngineBenchmark(ConfigObject<ConfigValue>* pConfig,
+                    const Options& options);
+    virtual ~EngineBenchmark();
+
+    // Reads the session and builds the engine. Returns false on error.
+    bool setup();
+    void run();
+    QString report() const;
+
+  private:
+    // Applies all session events up to (and including) nanos.
+    void applyEventsUntil(qint64 nanos);
+    void applyEvent(const ControlSessionEvent& event);
+    void loadTrack(const QString& group, const QString& location, bool bPlay);
+
+    ConfigObject<ConfigValue>* m_pConfig;
+    const Options m_options;
+
+    EffectsManager* m_pEffectsManager;
+    EngineMaster* m_pEngineMaster;
+    ControlObjectSlave* m_pNumDecks;
+    QHash<QString, Deck*> m_decks;
+    QHash<ConfigKey, ControlObjectSlave*> m_controls;
+    // Keys that were in the session but do not exist in this engine.
+    QSet<ConfigKey> m_missingControls;
+
+    QList<ControlSessionEvent> m_events;
+    int m_iNextEvent;
+
+    // Results
+    QVector<qint64> m_callbackNanos;
+    qint64 m_cpuNanos;
+    int m_iDeadlineMisses;
+    qint64 m_deadlineNanos;
+};
+
+#endif /* ENGINEBENCHMARK_H */
@@ -0,0 +1,130 @@
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QtDebug>
+
+#include <stdio.h>
+
+#include "bench/enginebenchmark.h"
+#include "configobject.h"
+#include "util/statsmanager.h"
+#include "util/time.h"
+
+namespace {
+
+void printUsage() {
+    fputs("mixxx-bench - Replays a recorded control session against the\n\
+Mixxx engine without a sound device and reports callback timings.\n\
+\n\
+    --session PATH          Session recorded with mixxx --recordSessionPath.\n\
+\n\
+    --track GROUP=PATH      Loads PATH into the player GROUP (e.g.\n\
+                            [Channel1]) before the session starts. May be\n\
+                            given more than once.\n\
+\n\
+    --decks N               Number of decks. Default: 4\n\
+\n\
+    --buffer-size FRAMES    Frames per engine callback. Default: 512\n\
+\n\
+    --samplerate HZ         Engine sample rate. Default: 44100\n\
+\n\
+    --duration SECONDS      Length of the run. Default: the length of the\n\
+                            session plus 5 seconds, or 60 seconds.\n\
+\n\
+    --speed FACTOR          Paces callbacks at FACTOR times real time. 0 runs\n\
+                            them back to back. Default: 1\n\
+\n\
+    --report PATH           Also writes the report to PATH.\n\
+\n\
+    --stats                 Collects Mixxx's internal stats and prints them\n\
+                            on exit.\n\
+\n\
+    -h, --help              Display this help message and exit\n", stdout);
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+    QApplication app(argc, argv, false);
+    QStringList args = app.arguments();
+
+    EngineBenchmark::Options options;
+    QString reportPath;
+    bool bStats = false;
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (arg == "--session" && hasValue) {
+            options.sessionPath = args[++i];
+        } else if (arg == "--track" && hasValue) {
+            QString track = args[++i];
+            int separator = track.indexOf('=');
+            if (separator <= 0) {
+                fprintf(stderr, "Invalid --track argument: %s\n",
+                        track.toLocal8Bit().constData());
+                return 1;
+            }
+            options.tracks.insert(track.left(separator),
+                                  track.mid(separator + 1));
+        } else if (arg == "--decks" && hasValue) {
+            options.numDecks = args[++i].toInt();
+        } else if (arg == "--buffer-size" && hasValue) {
+            options.bufferFrames = args[++i].toInt();
+        } else if (arg == "--samplerate" && hasValue) {
+            options.sampleRate = args[++i].toInt();
+        } else if (arg == "--duration" && hasValue) {
+            options.durationSeconds = args[++i].toDouble();
+        } else if (arg == "--speed" && hasValue) {
+            options.speed = args[++i].toDouble();
+        } else if (arg == "--report" && hasValue) {
+            reportPath = args[++i];
+        } else if (arg == "--stats") {
+            bStats = true;
+        } else {
+            fprintf(stderr, "Unknown argument: %s\n",
+                    arg.toLocal8Bit().constData());
+            printUsage();
+            return 1;
+        }
+    }
+
+    Time::start();
+    if (bStats) {
+        StatsManager::create();
+    }
+
+    // Use a throw-away configuration so that the results do not depend on
+    // the settings of the user running the benchmark. It is never saved.
+    ConfigObject<ConfigValue> config(
+            QDir::temp().filePath("mixxx-bench.cfg"));
+
+    int result = 0;
+    {
+        EngineBenchmark benchmark(&config, options);
+        if (!benchmark.setup()) {
+            result = 1;
+        } else {
+            benchmark.run();
+            QString report = benchmark.report();
+            fprintf(stdout, "%s\n", report.toLocal8Bit().constData());
+            if (!reportPath.isEmpty()) {
+                QFile file(reportPath);
+                if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                    QTextStream stream(&file);
+                    stream << report << "\n";
+                } else {
+                    qWarning() << "Could not write report to" << reportPath;
+                    result = 1;
+                }
+            }
+        }
+    }
+
+    StatsManager::destroy();
+    return result;
+}
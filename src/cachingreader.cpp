@@ -8,6 +8,7 @@
 #include "trackinfoobject.h"
 #include "soundsourceproxy.h"
 #include "sampleutil.h"
+#include "sharedchunkcache.h"
 #include "util/counter.h"
 #include "util/math.h"
 #include "util/assert.h"
@@ -22,13 +23,19 @@ CachingReader::CachingReader(QString group,
         : m_pConfig(config),
           m_chunkReadRequestFIFO(1024),
           m_readerStatusFIFO(1024),
+          m_sharedChunkReleaseFIFO(1024),
           m_readerStatus(INVALID),
           m_mruChunk(NULL),
           m_lruChunk(NULL),
           m_pRawMemoryBuffer(NULL),
           m_iTrackNumSamplesCallbackSafe(0) {
-    int rawMemoryBufferLength = CachingReaderWorker::kSamplesPerChunk * maximumChunksInMemory;
-    m_pRawMemoryBuffer = new CSAMPLE[rawMemoryBufferLength];
+    // With a SharedChunkCache most chunks point at shared data, so the
+    // worker only allocates memory for the chunks the cache cannot take, and
+    // the cache counts it against its limit.
+    if (SharedChunkCache::instance() == NULL) {
+        int rawMemoryBufferLength = CachingReaderWorker::kSamplesPerChunk * maximumChunksInMemory;
+        m_pRawMemoryBuffer = new CSAMPLE[rawMemoryBufferLength];
+    }
 
     m_allocatedChunks.reserve(maximumChunksInMemory);
 
@@ -42,6 +49,8 @@ CachingReader::CachingReader(QString group,
         c->chunk_number = -1;
         c->length = 0;
         c->data = bufferStart;
+        c->own_data = bufferStart;
+        c->shared = NULL;
         c->next_lru = NULL;
         c->prev_lru = NULL;
         c->state = Chunk::FREE;
@@ -49,12 +58,15 @@ CachingReader::CachingReader(QString group,
         m_chunks.push_back(c);
         m_freeChunks.push_back(c);
 
-        bufferStart += CachingReaderWorker::kSamplesPerChunk;
+        if (bufferStart != NULL) {
+            bufferStart += CachingReaderWorker::kSamplesPerChunk;
+        }
     }
 
     m_pWorker = new CachingReaderWorker(group,
             &m_chunkReadRequestFIFO,
-            &m_readerStatusFIFO);
+            &m_readerStatusFIFO,
+            &m_sharedChunkReleaseFIFO);
 
     // Forward signals from worker
     connect(m_pWorker, SIGNAL(trackLoading()),
@@ -75,6 +87,19 @@ CachingReader::~CachingReader() {
 
     m_pWorker->quitWait();
     delete m_pWorker;
+    CachingReaderWorker::releaseFreedSharedChunks(&m_sharedChunkReleaseFIFO);
+    int numPrivateChunks = 0;
+    foreach (Chunk* pChunk, m_chunks) {
+        CachingReaderWorker::releaseSharedChunk(pChunk);
+        if (m_pRawMemoryBuffer == NULL && pChunk->own_data != NULL) {
+            SampleUtil::free(pChunk->own_data);
+            ++numPrivateChunks;
+        }
+    }
+    SharedChunkCache* pCache = SharedChunkCache::instance();
+    if (pCache && numPrivateChunks > 0) {
+        pCache->removePrivateChunks(numPrivateChunks);
+    }
     m_freeChunks.clear();
     m_allocatedChunks.clear();
     m_lruChunk = m_mruChunk = NULL;
@@ -152,9 +177,20 @@ void CachingReader::freeChunk(Chunk* pChunk) {
     pChunk->state = Chunk::FREE;
     pChunk->chunk_number = -1;
     pChunk->length = 0;
+    releaseSharedData(pChunk);
     m_freeChunks.push_back(pChunk);
 }
 
+void CachingReader::releaseSharedData(Chunk* pChunk) {
+    // The engine must not lock the SharedChunkCache, so the worker drops the
+    // reference. If the FIFO is full, the chunk keeps it until it is reused.
+    if (pChunk->shared != NULL &&
+            m_sharedChunkReleaseFIFO.write(&pChunk->shared, 1) == 1) {
+        pChunk->shared = NULL;
+        pChunk->data = pChunk->own_data;
+    }
+}
+
 void CachingReader::freeAllChunks() {
     m_allocatedChunks.clear();
     m_mruChunk = NULL;
@@ -175,6 +211,7 @@ void CachingReader::freeAllChunks() {
             pChunk->length = 0;
             pChunk->next_lru = NULL;
             pChunk->prev_lru = NULL;
+            releaseSharedData(pChunk);
             m_freeChunks.append(pChunk);
         }
     }
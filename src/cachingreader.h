@@ -121,6 +121,7 @@ class CachingReader : public QObject {
     // reader thread.
     FIFO<ChunkReadRequest> m_chunkReadRequestFIFO;
     FIFO<ReaderStatusUpdate> m_readerStatusFIFO;
+    FIFO<SharedChunk*> m_sharedChunkReleaseFIFO;
 
     // Looks for the provided chunk number in the index of in-memory chunks and
     // returns it if it is present. If not, returns NULL. If it is present then
@@ -137,6 +138,10 @@ class CachingReader : public QObject {
     // Returns a Chunk to the free list
     void freeChunk(Chunk* pChunk);
 
+    // Hands the reference of a freed chunk to its SharedChunk over to the
+    // worker, so that the SharedChunkCache can evict the data.
+    void releaseSharedData(Chunk* pChunk);
+
     // Returns all allocated chunks to the free list
     void freeAllChunks();
 
@@ -163,7 +168,8 @@ class CachingReader : public QObject {
     Chunk* m_mruChunk;
     Chunk* m_lruChunk;
 
-    // The raw memory buffer which is divided up into chunks.
+    // The raw memory buffer which is divided up into chunks. NULL if the
+    // chunks get their own memory from the worker when they need it.
     CSAMPLE* m_pRawMemoryBuffer;
 
     int m_iTrackNumSamplesCallbackSafe;
@@ -8,9 +8,12 @@
 #include "trackinfoobject.h"
 #include "soundsourceproxy.h"
 #include "sampleutil.h"
+#include "sharedchunkcache.h"
 #include "util/compatibility.h"
+#include "util/counter.h"
 #include "util/event.h"
 #include "util/math.h"
+#include "util/threadplacement.h"
 
 // There's a little math to this, but not much: 48khz stereo audio is 384kb/sec
 // if using float samples. We want the chunk size to be a power of 2 so it's
@@ -28,12 +31,15 @@ const int CachingReaderWorker::kSamplesPerChunk = CHUNK_LENGTH / sizeof(CSAMPLE)
 
 CachingReaderWorker::CachingReaderWorker(QString group,
         FIFO<ChunkReadRequest>* pChunkReadRequestFIFO,
-        FIFO<ReaderStatusUpdate>* pReaderStatusFIFO)
+        FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
+        FIFO<SharedChunk*>* pSharedChunkReleaseFIFO)
         : m_group(group),
           m_tag(QString("CachingReaderWorker %1").arg(m_group)),
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
+          m_pSharedChunkReleaseFIFO(pSharedChunkReleaseFIFO),
           m_iTrackNumSamples(0),
+          m_iTrackId(-1),
           m_pSample(NULL),
           m_stop(0) {
     m_pSample = new SAMPLE[kSamplesPerChunk];
@@ -43,6 +49,45 @@ CachingReaderWorker::~CachingReaderWorker() {
     delete [] m_pSample;
 }
 
+// static
+void CachingReaderWorker::releaseSharedChunk(Chunk* pChunk) {
+    if (pChunk->shared == NULL) {
+        return;
+    }
+    SharedChunkCache* pCache = SharedChunkCache::instance();
+    if (pCache) {
+        pCache->release(pChunk->shared);
+    }
+    pChunk->shared = NULL;
+    pChunk->data = pChunk->own_data;
+}
+
+// static
+void CachingReaderWorker::releaseFreedSharedChunks(
+        FIFO<SharedChunk*>* pSharedChunkReleaseFIFO) {
+    SharedChunkCache* pCache = SharedChunkCache::instance();
+    SharedChunk* pShared = NULL;
+    while (pSharedChunkReleaseFIFO->read(&pShared, 1) == 1) {
+        if (pCache) {
+            pCache->release(pShared);
+        }
+    }
+}
+
+// static
+void CachingReaderWorker::useOwnData(Chunk* pChunk) {
+    if (pChunk->own_data == NULL) {
+        // Only readers that use a SharedChunkCache start without memory, so
+        // the cache accounts for it.
+        pChunk->own_data = SampleUtil::alloc(kSamplesPerChunk);
+        SharedChunkCache* pCache = SharedChunkCache::instance();
+        if (pCache) {
+            pCache->addPrivateChunk();
+        }
+    }
+    pChunk->data = pChunk->own_data;
+}
+
 void CachingReaderWorker::processChunkReadRequest(ChunkReadRequest* request,
         ReaderStatusUpdate* update) {
     int chunk_number = request->chunk->chunk_number;
@@ -50,6 +95,10 @@ void CachingReaderWorker::processChunkReadRequest(ChunkReadRequest* request,
     update->chunk = request->chunk;
     update->chunk->length = 0;
 
+    // The chunk is reused for another chunk number, so it lets go of the
+    // shared data it pointed at before.
+    releaseSharedChunk(request->chunk);
+
     if (!m_pCurrentSoundSource || chunk_number < 0) {
         update->status = CHUNK_READ_INVALID;
         return;
@@ -66,6 +115,50 @@ void CachingReaderWorker::processChunkReadRequest(ChunkReadRequest* request,
         return;
     }
 
+    // Another CachingReader playing the same track may have decoded it.
+    SharedChunkCache* pCache = SharedChunkCache::instance();
+    if (pCache) {
+        SharedChunk* pShared = pCache->acquire(m_iTrackId, chunk_number);
+        if (pShared) {
+            Counter("CachingReaderWorker shared chunk hit")++;
+            request->chunk->shared = pShared;
+            request->chunk->data = pShared->data;
+            update->status = CHUNK_READ_SUCCESS;
+            update->chunk->length = pShared->length;
+            return;
+        }
+    }
+
+    // Hand over the chunk if the TrackPrestager already decoded it. It goes
+    // into the shared cache like a decoded chunk, so that other readers of
+    // this track find it there.
+    if (m_pPrestagedTrack) {
+        SharedChunk* pShared = pCache ?
+                pCache->allocate(m_iTrackId, chunk_number) : NULL;
+        if (pShared == NULL) {
+            useOwnData(request->chunk);
+        }
+        CSAMPLE* pDest = pShared ? pShared->data : request->chunk->data;
+        int samples_staged = m_pPrestagedTrack->takeChunk(chunk_number, pDest);
+        if (m_pPrestagedTrack->chunkCount() == 0) {
+            m_pPrestagedTrack.clear();
+        }
+        if (pShared) {
+            // Publishing 0 samples discards the chunk again.
+            pCache->publish(pShared, samples_staged);
+        }
+        if (samples_staged > 0) {
+            Counter("CachingReaderWorker prestaged chunk hit")++;
+            if (pShared) {
+                request->chunk->shared = pShared;
+                request->chunk->data = pShared->data;
+            }
+            update->status = CHUNK_READ_SUCCESS;
+            update->chunk->length = samples_staged;
+            return;
+        }
+    }
+
     m_pCurrentSoundSource->seek(sample_position);
     int samples_read = m_pCurrentSoundSource->read(samples_to_read,
                                                    m_pSample);
@@ -78,9 +171,23 @@ void CachingReaderWorker::processChunkReadRequest(ChunkReadRequest* request,
         return;
     }
 
+    // Decode into the shared cache so that other readers of this track can
+    // use the chunk, unless it is full of chunks that are in use.
+    SharedChunk* pShared = pCache ?
+            pCache->allocate(m_iTrackId, chunk_number) : NULL;
+    if (pShared) {
+        request->chunk->shared = pShared;
+        request->chunk->data = pShared->data;
+    } else {
+        useOwnData(request->chunk);
+    }
+
     CSAMPLE* buffer = request->chunk->data;
     //qDebug() << "Reading into " << buffer;
     SampleUtil::convertS16ToFloat32(buffer, m_pSample, samples_read);
+    if (pShared) {
+        pCache->publish(pShared, samples_read);
+    }
 
     update->status = CHUNK_READ_SUCCESS;
     update->chunk->length = samples_read;
@@ -96,6 +203,7 @@ void CachingReaderWorker::newTrack(TrackPointer pTrack) {
 void CachingReaderWorker::run() {
     unsigned static id = 0; //the id of this thread, for debugging purposes
     QThread::currentThread()->setObjectName(QString("CachingReaderWorker %1").arg(++id));
+    ThreadPlacement::placeCurrentThread(ThreadPlacement::REALTIME_WORKER);
 
     TrackPointer pLoadTrack;
     ChunkReadRequest request;
@@ -103,6 +211,7 @@ void CachingReaderWorker::run() {
 
     Event::start(m_tag);
     while (!load_atomic(m_stop)) {
+        releaseFreedSharedChunks(m_pSharedChunkReleaseFIFO);
         if (m_newTrack) {
             m_newTrackMutex.lock();
             pLoadTrack = m_newTrack;
@@ -152,7 +261,9 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     status.trackNumSamples = 0;
 
     m_pCurrentSoundSource.clear();
+    m_pPrestagedTrack.clear();
     m_iTrackNumSamples = 0;
+    m_iTrackId = pTrack->getId();
 
     QString filename = pTrack->getLocation();
 
@@ -166,7 +277,18 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         return;
     }
 
-    m_pCurrentSoundSource = openSoundSourceForReading(pTrack);
+    // Pick up the SoundSource and decoded chunks if the track was staged.
+    TrackPrestager* pPrestager = TrackPrestager::instance();
+    if (pPrestager) {
+        m_pPrestagedTrack = pPrestager->takeStagedTrack(pTrack);
+        if (m_pPrestagedTrack) {
+            m_pCurrentSoundSource = m_pPrestagedTrack->takeSoundSource();
+        }
+    }
+    if (m_pCurrentSoundSource.isNull()) {
+        m_pPrestagedTrack.clear();
+        m_pCurrentSoundSource = openSoundSourceForReading(pTrack);
+    }
     if (m_pCurrentSoundSource.isNull()) {
         // Must unlock before emitting to avoid deadlock
         qDebug() << m_group << "CachingReaderWorker::loadTrack() load failed for\""
@@ -11,9 +11,11 @@
 #include "soundsource.h"
 #include "trackinfoobject.h"
 #include "engine/engineworker.h"
+#include "trackprestager.h"
 #include "util/fifo.h"
 #include "util/types.h"
 
+struct SharedChunk;
 
 // A Chunk is a section of audio that is being cached. The chunk_number can be
 // used to figure out the sample number of the first sample in data by using
@@ -21,7 +23,15 @@
 typedef struct Chunk {
     int chunk_number;
     int length;
+    // Points either at own_data or at the data of shared.
     CSAMPLE* data;
+    // The part of the CachingReader's memory that belongs to this chunk. NULL
+    // until it is needed if the reader uses a SharedChunkCache.
+    CSAMPLE* own_data;
+    // The chunk of the SharedChunkCache this chunk holds a reference to, if
+    // any. Only touched by the CachingReaderWorker while a read of the chunk
+    // is in progress, and by the CachingReader when it frees the chunk.
+    SharedChunk* shared;
     Chunk* prev_lru;
     Chunk* next_lru;
 
@@ -67,7 +77,8 @@ class CachingReaderWorker : public EngineWorker {
     // Construct a CachingReader with the given group.
     CachingReaderWorker(QString group,
             FIFO<ChunkReadRequest>* pChunkReadRequestFIFO,
-            FIFO<ReaderStatusUpdate>* pReaderStatusFIFO);
+            FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
+            FIFO<SharedChunk*>* pSharedChunkReleaseFIFO);
     virtual ~CachingReaderWorker();
 
     // Request to load a new track. wake() must be called afterwards.
@@ -79,6 +90,14 @@ class CachingReaderWorker : public EngineWorker {
 
     void quitWait();
 
+    // Drops the reference of pChunk to a SharedChunk, if it has one, and
+    // points it back at its own memory.
+    static void releaseSharedChunk(Chunk* pChunk);
+
+    // Drops the references the CachingReader gave up when it freed chunks.
+    static void releaseFreedSharedChunks(
+            FIFO<SharedChunk*>* pSharedChunkReleaseFIFO);
+
     // A Chunk is a memory-resident section of audio that has been cached. Each
     // chunk holds a fixed number of samples given by kSamplesPerChunk.
     const static int kChunkLength, kSamplesPerChunk;
@@ -103,6 +122,9 @@ class CachingReaderWorker : public EngineWorker {
     // reader thread.
     FIFO<ChunkReadRequest>* m_pChunkReadRequestFIFO;
     FIFO<ReaderStatusUpdate>* m_pReaderStatusFIFO;
+    // References to SharedChunks that the CachingReader dropped in the engine
+    // callback, where it must not lock the SharedChunkCache.
+    FIFO<SharedChunk*>* m_pSharedChunkReleaseFIFO;
 
     // Queue of Tracks to load, and the corresponding lock. Must acquire the
     // lock to touch.
@@ -117,9 +139,19 @@ class CachingReaderWorker : public EngineWorker {
     void processChunkReadRequest(ChunkReadRequest* request,
                                  ReaderStatusUpdate* update);
 
+    // Points pChunk at its own memory and allocates it if it has none yet.
+    static void useOwnData(Chunk* pChunk);
+
     // The current sound source of the track loaded
     Mixxx::SoundSourcePointer m_pCurrentSoundSource;
     int m_iTrackNumSamples;
+    // The library id of the current track, the key of its chunks in the
+    // SharedChunkCache.
+    int m_iTrackId;
+
+    // Chunks of the current track that were decoded ahead of time by the
+    // TrackPrestager. Consumed as the CachingReader requests them.
+    PrestagedTrackPointer m_pPrestagedTrack;
 
     // Temporary buffer for reading from SoundSources
     SAMPLE* m_pSample;
@@ -19,13 +19,22 @@
 #include <QIODevice>
 #include <QTextStream>
 #include <QApplication>
+#include <QDataStream>
 #include <QDir>
 #include <QtDebug>
 
 #include "widget/wwidget.h"
+#include "util/backgroundfilewriter.h"
 #include "util/cmdlineargs.h"
 #include "xmlparse.h"
 
+namespace {
+
+const quint32 kSnapshotMagic = 0x4d584353; // "MXCS"
+const quint32 kSnapshotVersion = 1;
+
+}  // anonymous namespace
+
 ConfigKey::ConfigKey() {
 }
 
@@ -110,6 +119,8 @@ template <class ValueType> ConfigObject<ValueType>::ConfigObject(QString file)
 
 template <class ValueType> ConfigObject<ValueType>::~ConfigObject()
 {
+    // Make sure that everything saved is on disk.
+    BackgroundFileWriter::flush();
     while (m_list.size() > 0) {
         ConfigOption<ValueType>* pConfigOption = m_list.takeLast();
         delete pConfigOption;
@@ -228,6 +239,9 @@ QString ConfigObject<ValueType>::getValueString(ConfigKey k, const QString& defa
 
 template <class ValueType> bool ConfigObject<ValueType>::Parse()
 {
+    // A Save() of this file may still be queued.
+    BackgroundFileWriter::flush();
+
     // Open file for reading
     QFile configfile(m_filename);
     if (m_filename.length()<1 || !configfile.open(QIODevice::ReadOnly))
@@ -237,11 +251,17 @@ template <class ValueType> bool ConfigObject<ValueType>::Parse()
     }
     else
     {
+        QByteArray contents = configfile.readAll();
+        configfile.close();
+        if (parseSnapshot(contents)) {
+            return true;
+        }
+
         //qDebug() << "ConfigObject: Parse" << m_filename;
         // Parse the file
         int group = 0;
         QString groupStr, line;
-        QTextStream text(&configfile);
+        QTextStream text(&contents, QIODevice::ReadOnly);
         text.setCodec("UTF-8");
 
         while (!text.atEnd())
@@ -269,11 +289,67 @@ template <class ValueType> bool ConfigObject<ValueType>::Parse()
                 }
             }
         }
-        configfile.close();
     }
     return true;
 }
 
+template <class ValueType>
+QByteArray ConfigObject<ValueType>::serializeSnapshot(const QByteArray& text) const
+{
+    QByteArray snapshot;
+    QDataStream out(&snapshot, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_6);
+    // The snapshot is only valid for exactly this text.
+    out << kSnapshotMagic << kSnapshotVersion
+        << static_cast<quint32>(text.size()) << static_cast<quint32>(qHash(text))
+        << static_cast<qint32>(m_list.size());
+    foreach (const ConfigOption<ValueType>* pOption, m_list) {
+        out << pOption->key->group << pOption->key->item << pOption->val->value;
+    }
+    return snapshot;
+}
+
+template <class ValueType>
+bool ConfigObject<ValueType>::parseSnapshot(const QByteArray& text)
+{
+    // The snapshot skips the lookups of set(), so it can only fill an empty
+    // ConfigObject.
+    if (!m_list.isEmpty()) {
+        return false;
+    }
+    QFile file(snapshotPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic, version, size, hash;
+    qint32 count;
+    in >> magic >> version >> size >> hash >> count;
+    if (in.status() != QDataStream::Ok || magic != kSnapshotMagic ||
+            version != kSnapshotVersion ||
+            size != static_cast<quint32>(text.size()) ||
+            hash != static_cast<quint32>(qHash(text))) {
+        // The file was edited by hand or written by another version.
+        return false;
+    }
+
+    QList<ConfigOption<ValueType>*> options;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString group, item, value;
+        in >> group >> item >> value;
+        options.append(new ConfigOption<ValueType>(
+                new ConfigKey(group, item), new ValueType(value)));
+    }
+    if (in.status() != QDataStream::Ok) {
+        qDeleteAll(options);
+        return false;
+    }
+    m_list = options;
+    return true;
+}
+
 template <class ValueType> void ConfigObject<ValueType>::clear()
 {
     //Delete the pointers, because that's what we did before we
@@ -296,39 +372,35 @@ template <class ValueType> void ConfigObject<ValueType>::reopen(QString file)
 
 template <class ValueType> void ConfigObject<ValueType>::Save()
 {
-    QFile file(m_filename);
-    if (!QDir(QFileInfo(file).absolutePath()).exists()) {
-        QDir().mkpath(QFileInfo(file).absolutePath());
-    }
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        qDebug() << "Could not write file" << m_filename << ", don't worry.";
+    if (m_filename.isEmpty()) {
         return;
     }
-    else
-    {
-        QTextStream stream(&file);
-        stream.setCodec("UTF-8");
 
-        QString grp = "";
+    QByteArray text;
+    QTextStream stream(&text, QIODevice::WriteOnly);
+    stream.setCodec("UTF-8");
+
+    QString grp = "";
 
-        QListIterator<ConfigOption<ValueType>* > iterator(m_list);
-        ConfigOption<ValueType>* it;
-        while (iterator.hasNext())
+    QListIterator<ConfigOption<ValueType>* > iterator(m_list);
+    ConfigOption<ValueType>* it;
+    while (iterator.hasNext())
+    {
+        it = iterator.next();
+//        qDebug() << "group:" << it->key->group << "item" << it->key->item << "val" << it->val->value;
+        if (it->key->group != grp)
         {
-            it = iterator.next();
-//            qDebug() << "group:" << it->key->group << "item" << it->key->item << "val" << it->val->value;
-            if (it->key->group != grp)
-            {
-                grp = it->key->group;
-                stream << "\n" << it->key->group << "\n";
-            }
-            stream << it->key->item << " " << it->val->value << "\n";
+            grp = it->key->group;
+            stream << "\n" << it->key->group << "\n";
         }
-        file.close();
-        if (file.error()!=QFile::NoError) //could be better... should actually say what the error was..
-      qDebug() << "Error while writing configuration file:" << file.errorString();
+        stream << it->key->item << " " << it->val->value << "\n";
     }
+    stream.flush();
+
+    // Writing the file takes tens of milliseconds on slow storage, so it is
+    // done in the background.
+    BackgroundFileWriter::write(m_filename, text);
+    BackgroundFileWriter::write(snapshotPath(), serializeSnapshot(text));
 }
 
 template <class ValueType>
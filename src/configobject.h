@@ -129,6 +129,9 @@ template <class ValueType> class ConfigObject {
 
     void clear();
     void reopen(QString file);
+    // Queues the configuration to be written to disk in the background. The
+    // file is written atomically, and repeated saves are coalesced. Everything
+    // is on disk once the ConfigObject is destroyed.
     void Save();
 
     // Returns the resource path -- the path where controller presets, skins,
@@ -146,6 +149,16 @@ template <class ValueType> class ConfigObject {
     // Loads and parses the configuration file. Returns false if the file could
     // not be opened; otherwise true.
     bool Parse();
+
+  private:
+    // Save() also writes a binary snapshot of the options next to the file.
+    // It is used instead of parsing the text as long as the file has not been
+    // edited since.
+    QString snapshotPath() const {
+        return m_filename + ".snapshot";
+    }
+    QByteArray serializeSnapshot(const QByteArray& text) const;
+    bool parseSnapshot(const QByteArray& text);
 };
 
 #endif
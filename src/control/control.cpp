@@ -3,6 +3,7 @@
 
 #include "control/control.h"
 
+#include "control/controlrecorder.h"
 #include "util/stat.h"
 #include "util/timer.h"
 
@@ -173,11 +174,14 @@ void ControlDoublePrivate::reset() {
 }
 
 void ControlDoublePrivate::set(double value, QObject* pSender) {
+    // Record the requested value, the behavior filters it again on replay.
+    const double requestedValue = value;
     // If the behavior says to ignore the set, ignore it.
     QSharedPointer<ControlNumericBehavior> pBehavior = m_pBehavior;
     if (!pBehavior.isNull() && !pBehavior->setFilter(&value)) {
         return;
     }
+    ControlRecorder::recordSet(m_key, requestedValue);
     if (m_confirmRequired) {
         emit(valueChangeRequest(value));
     } else {
@@ -0,0 +1,198 @@
+#include <QtDebug>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThread>
+
+#include "control/controlrecorder.h"
+
+#include "control/control.h"
+#include "util/time.h"
+
+namespace {
+
+const char* kSessionHeader = "# mixxx control session v1";
+const char* kSetType = "set";
+const char* kLoadType = "load";
+
+}  // anonymous namespace
+
+ControlRecorder ControlRecorder::s_recorder;
+volatile bool ControlRecorder::s_bRecording = false;
+QMutex ControlRecorder::s_threadsMutex;
+QSet<Qt::HANDLE> ControlRecorder::s_recordedThreads;
+
+// static
+bool ControlRecorder::start(const QString& sessionPath) {
+    if (s_bRecording) {
+        qWarning() << "ControlRecorder: already recording";
+        return false;
+    }
+
+    ControlRecorder& recorder = s_recorder;
+    QMutexLocker locker(&recorder.m_mutex);
+    recorder.m_file.setFileName(sessionPath);
+    if (!recorder.m_file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                              QIODevice::Text)) {
+        qWarning() << "ControlRecorder: could not open" << sessionPath
+                   << "for writing";
+        return false;
+    }
+    recorder.m_stream.setDevice(&recorder.m_file);
+    recorder.m_stream.setCodec("UTF-8");
+    recorder.m_stream << kSessionHeader << "\n";
+
+    {
+        QMutexLocker threadsLocker(&s_threadsMutex);
+        recorder.m_recordedThreads = s_recordedThreads;
+    }
+    recorder.m_recordedThreads.insert(QThread::currentThreadId());
+
+    // Write the initial state. Controls at their default value are left out
+    // since a fresh Mixxx has them already.
+    QList<QSharedPointer<ControlDoublePrivate> > controls;
+    ControlDoublePrivate::getControls(&controls);
+    foreach (QSharedPointer<ControlDoublePrivate> pControl, controls) {
+        if (pControl.isNull()) {
+            continue;
+        }
+        double value = pControl->get();
+        if (value == pControl->defaultValue()) {
+            continue;
+        }
+        ControlSessionEvent event;
+        event.type = ControlSessionEvent::SET;
+        event.key = pControl->getKey();
+        event.value = value;
+        recorder.writeEventLocked(event);
+    }
+
+    recorder.m_startNanos = Time::elapsed();
+    s_bRecording = true;
+    qDebug() << "ControlRecorder: recording session to" << sessionPath;
+    return true;
+}
+
+// static
+void ControlRecorder::stop() {
+    if (!s_bRecording) {
+        return;
+    }
+    s_bRecording = false;
+    ControlRecorder& recorder = s_recorder;
+    QMutexLocker locker(&recorder.m_mutex);
+    recorder.m_stream.flush();
+    recorder.m_stream.setDevice(NULL);
+    recorder.m_file.close();
+    qDebug() << "ControlRecorder: stopped recording";
+}
+
+// static
+void ControlRecorder::addRecordedThread() {
+    QMutexLocker locker(&s_threadsMutex);
+    s_recordedThreads.insert(QThread::currentThreadId());
+}
+
+// static
+void ControlRecorder::removeRecordedThread() {
+    QMutexLocker locker(&s_threadsMutex);
+    s_recordedThreads.remove(QThread::currentThreadId());
+}
+
+ControlRecorder::ControlRecorder()
+        : m_startNanos(0) {
+}
+
+ControlRecorder::~ControlRecorder() {
+}
+
+void ControlRecorder::record(ControlSessionEvent::Type type,
+                             const ConfigKey& key, double value,
+                             const QString& location) {
+    if (!m_recordedThreads.contains(QThread::currentThreadId())) {
+        return;
+    }
+    ControlSessionEvent event;
+    event.type = type;
+    event.nanos = Time::elapsed() - m_startNanos;
+    event.key = key;
+    event.value = value;
+    event.location = location;
+
+    QMutexLocker locker(&m_mutex);
+    // Recording may have stopped while we waited for the lock.
+    if (m_file.isOpen()) {
+        writeEventLocked(event);
+    }
+}
+
+void ControlRecorder::writeEventLocked(const ControlSessionEvent& event) {
+    m_stream << event.nanos << '\t';
+    if (event.type == ControlSessionEvent::LOAD) {
+        m_stream << kLoadType << '\t' << event.key.group << '\t'
+                 << QString::number(event.value) << '\t' << event.location;
+    } else {
+        m_stream << kSetType << '\t' << event.key.group << '\t'
+                 << event.key.item << '\t'
+                 << QString::number(event.value, 'g', 17);
+    }
+    m_stream << '\n';
+}
+
+// static
+bool ControlRecorder::readSession(const QString& sessionPath,
+                                  QList<ControlSessionEvent>* pEvents) {
+    QFile file(sessionPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "ControlRecorder: could not open" << sessionPath;
+        return false;
+    }
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+
+    if (stream.readLine() != kSessionHeader) {
+        qWarning() << "ControlRecorder:" << sessionPath
+                   << "is not a control session";
+        return false;
+    }
+
+    int lineNumber = 1;
+    while (!stream.atEnd()) {
+        QString line = stream.readLine();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        // The location of a load may contain tabs, so split it off last.
+        QStringList fields = line.split('\t');
+        if (fields.size() < 5) {
+            qWarning() << "ControlRecorder: skipping malformed line"
+                       << lineNumber << "of" << sessionPath;
+            continue;
+        }
+
+        ControlSessionEvent event;
+        bool nanosOk = false;
+        bool valueOk = false;
+        event.nanos = fields[0].toLongLong(&nanosOk);
+        if (fields[1] == kLoadType) {
+            event.type = ControlSessionEvent::LOAD;
+            event.key = ConfigKey(fields[2], "");
+            event.value = fields[3].toDouble(&valueOk);
+            event.location = QStringList(fields.mid(4)).join("\t");
+        } else if (fields[1] == kSetType) {
+            event.type = ControlSessionEvent::SET;
+            event.key = ConfigKey(fields[2], fields[3]);
+            event.value = fields[4].toDouble(&valueOk);
+        } else {
+            valueOk = false;
+        }
+        if (!nanosOk || !valueOk) {
+            qWarning() << "ControlRecorder: skipping malformed line"
+                       << lineNumber << "of" << sessionPath;
+            continue;
+        }
+        pEvents->append(event);
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+#ifndef CONTROLRECORDER_H
+#define CONTROLRECORDER_H
+
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QTextStream>
+#include <QThread>
+
+#include "configobject.h"
+
+// A single recorded event of a control session.
+struct ControlSessionEvent {
+    enum Type {
+        // A control was set to value.
+        SET,
+        // The track at location was loaded into the player key.group. value
+        // is 1 if the track should start playing once it is loaded.
+        LOAD,
+    };
+
+    ControlSessionEvent()
+            : type(SET),
+              nanos(0),
+              value(0.0) {
+    }
+
+    Type type;
+    // Nanoseconds since the recording was started.
+    qint64 nanos;
+    ConfigKey key;
+    double value;
+    QString location;
+};
+
+// ControlRecorder captures the control changes and track loads that a user
+// (through the GUI, keyboard or a controller) makes during a session into a
+// plain text session file. The session can later be replayed by mixxx-bench
+// to reproduce performance problems seen in the field without the hardware
+// that caused them.
+//
+// Only changes made from the main thread and from threads registered with
+// addRecordedThread() are recorded. Changes made by the engine are a product
+// of the recorded ones and are not written to the session. Threads are told
+// apart by their native id, since QThread::currentThread() would create a
+// QThread for the audio callback thread the first time the engine sets a
+// control.
+class ControlRecorder {
+  public:
+    // Starts recording to sessionPath. Every control whose value differs from
+    // its default is written as the initial state of the session. Must be
+    // called from the main thread. Returns false if the session file could
+    // not be opened.
+    static bool start(const QString& sessionPath);
+    // Stops recording and closes the session file. Must be called from the
+    // main thread after all recorded threads have stopped.
+    static void stop();
+    static bool isRecording() {
+        return s_bRecording;
+    }
+
+    // Adds the calling thread to the set of threads whose control changes are
+    // recorded. Only threads added before start() are recorded so that the
+    // engine thread can check its membership without locking.
+    static void addRecordedThread();
+    static void removeRecordedThread();
+
+    // Called from ControlDoublePrivate::set().
+    static inline void recordSet(const ConfigKey& key, double value) {
+        if (s_bRecording) {
+            s_recorder.record(ControlSessionEvent::SET, key, value, QString());
+        }
+    }
+
+    // Called from BaseTrackPlayerImpl::slotLoadTrack().
+    static inline void recordTrackLoad(const QString& group,
+                                       const QString& location, bool bPlay) {
+        if (s_bRecording) {
+            s_recorder.record(ControlSessionEvent::LOAD, ConfigKey(group, ""),
+                              bPlay ? 1.0 : 0.0, location);
+        }
+    }
+
+    // Reads the session file at sessionPath into pEvents. Returns false if
+    // the file could not be read or is not a control session.
+    static bool readSession(const QString& sessionPath,
+                            QList<ControlSessionEvent>* pEvents);
+
+  private:
+    ControlRecorder();
+    ~ControlRecorder();
+
+    void record(ControlSessionEvent::Type type, const ConfigKey& key,
+                double value, const QString& location);
+    void writeEventLocked(const ControlSessionEvent& event);
+
+    // Copy of s_recordedThreads taken on start(). Not modified while
+    // recording.
+    QSet<Qt::HANDLE> m_recordedThreads;
+    // Guards the members below.
+    QMutex m_mutex;
+    QFile m_file;
+    QTextStream m_stream;
+    qint64 m_startNanos;
+
+    // The recorder is a static object rather than a heap allocated one so
+    // that a thread that raced with stop() never touches a deleted recorder.
+    static ControlRecorder s_recorder;
+    static volatile bool s_bRecording;
+    static QMutex s_threadsMutex;
+    static QSet<Qt::HANDLE> s_recordedThreads;
+};
+
+#endif /* CONTROLRECORDER_H */
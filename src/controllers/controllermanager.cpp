@@ -9,6 +9,7 @@
 
 #include "util/trace.h"
 #include "controllers/controllermanager.h"
+#include "control/controlrecorder.h"
 #include "controllers/defs_controllers.h"
 #include "controllers/controllerlearningeventfilter.h"
 #include "util/cmdlineargs.h"
@@ -60,7 +61,8 @@ ControllerManager::ControllerManager(ConfigObject<ConfigValue>* pConfig)
           // ControllerManager because the CM is moved to its own thread and runs
           // its own event loop.
           m_pControllerLearningEventFilter(new ControllerLearningEventFilter()),
-          m_pollTimer(this) {
+          m_pollTimer(this),
+          m_bDevicesEnumerated(false) {
     qRegisterMetaType<ControllerPresetPointer>("ControllerPresetPointer");
 
     // Create controller mapping paths in the user's home directory.
@@ -105,6 +107,11 @@ ControllerManager::ControllerManager(ConfigObject<ConfigValue>* pConfig)
     // audio directly, like when scratching
     m_pThread->start(QThread::HighPriority);
 
+    // Controller input is part of a recorded control session. The thread
+    // registers itself since the recorder tells threads apart by native id.
+    QMetaObject::invokeMethod(this, "slotAddRecordedThread",
+                              Qt::BlockingQueuedConnection);
+
     connect(this, SIGNAL(requestSetUpDevices()),
             this, SLOT(slotSetUpDevices()));
     connect(this, SIGNAL(requestShutdown()),
@@ -125,7 +132,12 @@ ControllerLearningEventFilter* ControllerManager::getControllerLearningEventFilt
     return m_pControllerLearningEventFilter;
 }
 
+void ControllerManager::slotAddRecordedThread() {
+    ControlRecorder::addRecordedThread();
+}
+
 void ControllerManager::slotShutdown() {
+    ControlRecorder::removeRecordedThread();
     stopPolling();
 
     // Clear m_enumerators before deleting the enumerators to prevent other code
@@ -191,14 +203,28 @@ QList<Controller*> ControllerManager::getControllerList(bool bOutputDevices, boo
     return filteredDeviceList;
 }
 
+void ControllerManager::enumerateDevices() {
+    QMetaObject::invokeMethod(this, "slotEnumerateDevices",
+                              Qt::BlockingQueuedConnection);
+}
+
+void ControllerManager::slotEnumerateDevices() {
+    updateControllerList();
+    m_bDevicesEnumerated = true;
+}
+
 int ControllerManager::slotSetUpDevices() {
     qDebug() << "ControllerManager: Setting up devices";
 
-    updateControllerList();
+    if (!m_bDevicesEnumerated) {
+        updateControllerList();
+    }
+    m_bDevicesEnumerated = false;
     QList<Controller*> deviceList = getControllerList(false, true);
 
     QSet<QString> filenames;
     int error = 0;
+    m_pendingPresetFiles.clear();
 
     foreach (Controller* pController, deviceList) {
         QString name = pController->getName();
@@ -214,21 +240,24 @@ int ControllerManager::slotSetUpDevices() {
         // if we have already seen a controller by this name on this run of
         // Mixxx.
         presetBaseName = firstAvailableFilename(filenames, presetBaseName);
+        const QString presetFile = presetBaseName + pController->presetExtension();
+
+        // Parsing a preset is slow. Defer it for controllers that are not
+        // going to be opened.
+        if (m_pConfig->getValueString(ConfigKey("[Controller]", presetBaseName)) != "1") {
+            m_pendingPresetFiles.insert(pController, presetFile);
+            continue;
+        }
 
         ControllerPresetPointer pPreset =
                 ControllerPresetFileHandler::loadPreset(
-                    presetBaseName + pController->presetExtension(),
-                    getPresetPaths(m_pConfig));
+                    presetFile, getPresetPaths(m_pConfig));
 
         if (!loadPreset(pController, pPreset)) {
             // TODO(XXX) : auto load midi preset here.
             continue;
         }
 
-        if (m_pConfig->getValueString(ConfigKey("[Controller]", presetBaseName)) != "1") {
-            continue;
-        }
-
         // If we are in safe mode, skip opening controllers.
         if (CmdlineArgs::Instance().getSafeMode()) {
             qDebug() << "We are in safe mode -- skipping opening controller.";
@@ -301,6 +330,7 @@ void ControllerManager::openController(Controller* pController) {
     if (!pController) {
         return;
     }
+    loadPendingPreset(pController);
     if (pController->isOpen()) {
         pController->close();
     }
@@ -329,11 +359,22 @@ void ControllerManager::closeController(Controller* pController) {
         "[Controller]", presetFilenameFromName(pController->getName())), 0);
 }
 
+void ControllerManager::loadPendingPreset(Controller* pController) {
+    if (!pController || !m_pendingPresetFiles.contains(pController)) {
+        return;
+    }
+    ControllerPresetPointer pPreset = ControllerPresetFileHandler::loadPreset(
+            m_pendingPresetFiles.take(pController), getPresetPaths(m_pConfig));
+    loadPreset(pController, pPreset);
+}
+
 bool ControllerManager::loadPreset(Controller* pController,
                                    ControllerPresetPointer preset) {
     if (!preset) {
         return false;
     }
+    // A preset chosen by the user replaces the one we did not load yet.
+    m_pendingPresetFiles.remove(pController);
     pController->setPreset(*preset.data());
     // Save the file path/name in the config so it can be auto-loaded at
     // startup next time
@@ -359,6 +400,10 @@ void ControllerManager::slotSavePresets(bool onlyActive) {
         if (onlyActive && !pController->isOpen()) {
             continue;
         }
+        // The preset was never loaded, so the file on disk is up to date.
+        if (m_pendingPresetFiles.contains(pController)) {
+            continue;
+        }
         QString name = pController->getName();
         QString filename = firstAvailableFilename(
             filenames, presetFilenameFromName(name));
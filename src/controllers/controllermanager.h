@@ -36,6 +36,12 @@ class ControllerManager : public QObject {
     void setUpDevices() { emit(requestSetUpDevices()); };
     void savePresets(bool onlyActive=false) { emit(requestSave(onlyActive)); };
 
+    // Enumerates the controllers in the controller thread and returns when
+    // done. setUpDevices() then uses this list instead of enumerating again,
+    // which lets startup look for controllers while it creates the skin.
+    // Must not be called from the controller thread.
+    void enumerateDevices();
+
     static QList<QString> getPresetPaths(ConfigObject<ConfigValue>* pConfig);
 
     // If pathOrFilename is an absolute path, returns it. If it is a relative
@@ -59,6 +65,10 @@ class ControllerManager : public QObject {
     void openController(Controller* pController);
     void closeController(Controller* pController);
 
+    // Loads the preset of a controller that was not enabled at startup, if
+    // it has not been loaded yet.
+    void loadPendingPreset(Controller* pController);
+
     // Writes out presets for currently connected input devices
     void slotSavePresets(bool onlyActive=false);
 
@@ -67,6 +77,8 @@ class ControllerManager : public QObject {
     // only runs on start-up but maybe should instead be signaled by the
     // preferences dialog on apply, and only open/close changed devices
     int slotSetUpDevices();
+    void slotEnumerateDevices();
+    void slotAddRecordedThread();
     void slotShutdown();
     bool loadPreset(Controller* pController,
                     ControllerPresetPointer preset);
@@ -89,6 +101,13 @@ class ControllerManager : public QObject {
     QList<Controller*> m_controllers;
     QThread* m_pThread;
     PresetInfoEnumerator* m_pMainThreadPresetEnumerator;
+    // Preset files of the controllers that were not enabled at startup. Their
+    // presets are only loaded when they are opened or shown in the
+    // preferences. Only accessed from the controller thread.
+    QHash<Controller*, QString> m_pendingPresetFiles;
+    // Whether enumerateDevices() ran since the last slotSetUpDevices(). Only
+    // accessed from the controller thread.
+    bool m_bDevicesEnumerated;
 };
 
 #endif  // CONTROLLERMANAGER_H
@@ -9,13 +9,25 @@
 * show details for a mapping.
 */
 
+#include <QDir>
 #include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
 
 #include "controllers/controllerpresetinfo.h"
 
 #include "controllers/defs_controllers.h"
 #include "xmlparse.h"
 
+namespace {
+
+const quint32 kPresetIndexMagic = 0x4d504958; // "MPIX"
+// Increase when the fields written by operator<<(PresetInfo) change.
+const quint32 kPresetIndexVersion = 1;
+
+}  // anonymous namespace
+
 PresetInfo::PresetInfo()
         : m_valid(false) {
 }
@@ -134,7 +146,25 @@ QHash<QString,QString> PresetInfo::parseOSCProduct(const QDomElement& element) c
     return product;
 }
 
-PresetInfoEnumerator::PresetInfoEnumerator(ConfigObject<ConfigValue>* pConfig) {
+QDataStream& operator<<(QDataStream& out, const PresetInfo& info) {
+    out << info.m_valid << info.path << info.name << info.author
+        << info.description << info.forumlink << info.wikilink
+        << info.products;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, PresetInfo& info) {
+    in >> info.m_valid >> info.path >> info.name >> info.author
+       >> info.description >> info.forumlink >> info.wikilink
+       >> info.products;
+    return in;
+}
+
+PresetInfoEnumerator::PresetInfoEnumerator(ConfigObject<ConfigValue>* pConfig)
+        : m_indexPath(QDir(pConfig->getSettingsPath()).filePath(
+                  "controller_preset_index.dat")),
+          m_bIndexDirty(false),
+          m_iNumParsedPresets(0) {
     controllerDirPaths.append(localPresetsPath(pConfig));
     controllerDirPaths.append(resourcePresetsPath(pConfig));
 
@@ -143,6 +173,7 @@ PresetInfoEnumerator::PresetInfoEnumerator(ConfigObject<ConfigValue>* pConfig) {
     fileExtensions.append(QString(HID_PRESET_EXTENSION));
     fileExtensions.append(QString(BULK_PRESET_EXTENSION));
 
+    loadIndex();
     loadSupportedPresets();
 }
 
@@ -219,6 +250,7 @@ void PresetInfoEnumerator::addExtension(const QString extension) {
 }
 
 void PresetInfoEnumerator::loadSupportedPresets() {
+    QSet<QString> seenPaths;
     foreach (QString dirPath, controllerDirPaths) {
         QDirIterator it(dirPath);
         while (it.hasNext()) {
@@ -230,11 +262,24 @@ void PresetInfoEnumerator::loadSupportedPresets() {
                 if (!presetsByExtension.contains(extension)) {
                     addExtension(extension);
                 }
-                presetsByExtension[extension][path] = PresetInfo(path);
+                presetsByExtension[extension][path] = getIndexedPresetInfo(path);
+                seenPaths.insert(path);
             }
         }
     }
 
+    // Forget presets that were deleted.
+    for (QHash<QString, IndexEntry>::iterator it = m_index.begin();
+         it != m_index.end();) {
+        if (!seenPaths.contains(it.key())) {
+            it = m_index.erase(it);
+            m_bIndexDirty = true;
+        } else {
+            ++it;
+        }
+    }
+    saveIndex();
+
     foreach (QString extension, presetsByExtension.keys()) {
         QMap<QString,PresetInfo> presets = presetsByExtension[extension];
         qDebug() << "Extension" << extension << "total" << presets.keys().length() << "presets";
@@ -254,9 +299,94 @@ void PresetInfoEnumerator::updatePresets(const QString extension) {
             const QString path = it.filePath();
             if (!path.endsWith(extension))
                 continue;
-            presets[path] = PresetInfo(path);
+            presets[path] = getIndexedPresetInfo(path);
         }
     }
 
     presetsByExtension[extension] = presets;
+    saveIndex();
+}
+
+PresetInfo PresetInfoEnumerator::getIndexedPresetInfo(const QString& path) {
+    QFileInfo fileInfo(path);
+    const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    const qint64 size = fileInfo.size();
+
+    QHash<QString, IndexEntry>::const_iterator it = m_index.find(path);
+    if (it != m_index.end() &&
+            it->modified == modified && it->size == size) {
+        return it->info;
+    }
+
+    IndexEntry entry;
+    entry.modified = modified;
+    entry.size = size;
+    entry.info = PresetInfo(path);
+    ++m_iNumParsedPresets;
+    m_index.insert(path, entry);
+    m_bIndexDirty = true;
+    return entry.info;
+}
+
+void PresetInfoEnumerator::loadIndex() {
+    m_index.clear();
+    QFile file(m_indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != kPresetIndexMagic || version != kPresetIndexVersion) {
+        return;
+    }
+
+    qint32 numEntries;
+    in >> numEntries;
+    for (qint32 i = 0; i < numEntries && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        IndexEntry entry;
+        in >> path >> entry.modified >> entry.size >> entry.info;
+        m_index.insert(path, entry);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Ignoring corrupt controller preset index" << m_indexPath;
+        m_index.clear();
+    }
+}
+
+void PresetInfoEnumerator::saveIndex() {
+    if (!m_bIndexDirty) {
+        return;
+    }
+    // Write to a temporary file first so that a crash does not leave a
+    // truncated index behind.
+    const QString tempPath = m_indexPath + ".tmp";
+    QFile file(tempPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not write controller preset index" << tempPath;
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+
+    out << kPresetIndexMagic << kPresetIndexVersion;
+    out << static_cast<qint32>(m_index.size());
+    for (QHash<QString, IndexEntry>::const_iterator it = m_index.begin();
+         it != m_index.end(); ++it) {
+        out << it.key() << it->modified << it->size << it->info;
+    }
+    file.close();
+
+    if (out.status() != QDataStream::Ok) {
+        QFile::remove(tempPath);
+        return;
+    }
+    QFile::remove(m_indexPath);
+    if (QFile::rename(tempPath, m_indexPath)) {
+        m_bIndexDirty = false;
+    }
 }
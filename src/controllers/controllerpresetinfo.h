@@ -16,6 +16,7 @@
 #include <QMap>
 #include <QList>
 #include <QHash>
+#include <QDataStream>
 #include <QDomElement>
 
 #include "configobject.h"
@@ -42,6 +43,10 @@ class PresetInfo {
 
     inline const QList<QHash<QString,QString> > getProducts() const { return products; };
 
+    // Used by PresetInfoEnumerator to store the parsed info in its index.
+    friend QDataStream& operator<<(QDataStream& out, const PresetInfo& info);
+    friend QDataStream& operator>>(QDataStream& in, PresetInfo& info);
+
   private:
     QHash<QString,QString> parseBulkProduct(const QDomElement& element) const;
     QHash<QString,QString> parseHIDProduct(const QDomElement& element) const;
@@ -77,11 +82,31 @@ class PresetInfoEnumerator {
     // Updates presets matching given extension
     void updatePresets(const QString extension);
 
+    // The number of preset files that were parsed rather than taken from the
+    // index.
+    int numParsedPresets() const {
+        return m_iNumParsedPresets;
+    }
+
   protected:
     void addExtension(QString extension);
     void loadSupportedPresets();
 
   private:
+    // An entry of the preset index. The info is reused as long as the file
+    // keeps its size and modification time.
+    struct IndexEntry {
+        qint64 modified;
+        qint64 size;
+        PresetInfo info;
+    };
+
+    // Returns the info of the preset at path from the index, parsing the file
+    // only if it is new or has changed since it was indexed.
+    PresetInfo getIndexedPresetInfo(const QString& path);
+    void loadIndex();
+    void saveIndex();
+
     QList<QString> fileExtensions;
 
     // List of paths for controller presets
@@ -91,6 +116,13 @@ class PresetInfoEnumerator {
     // [extension,[preset_path,preset]]
     QMap<QString, QMap<QString, PresetInfo> > presetsByExtension;
     QMap<QString, ControllerPresetFileHandler*> m_presetFileHandlersByExtension;
+
+    // Parsing hundreds of XML files is slow, so the <info> of every preset is
+    // kept in an index in the settings directory. Keyed by path.
+    QString m_indexPath;
+    QHash<QString, IndexEntry> m_index;
+    bool m_bIndexDirty;
+    int m_iNumParsedPresets;
 };
 
 #endif
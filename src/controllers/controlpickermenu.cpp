@@ -427,8 +427,8 @@ ControlPickerMenu::ControlPickerMenu(QWidget* pParent)
                                descriptionPrefix,
                                effectUnitMenu, true);
             addPrefixedControl(effectUnitGroup, "insertion_type",
-                               tr("Insert/Send Toggle"),
-                               tr("Insert/Send Toggle"),
+                               tr("Insert/Send/Bus Toggle"),
+                               tr("Insert/Send/Bus Toggle"),
                                descriptionPrefix,
                                effectUnitMenu);
             addPrefixedControl(effectUnitGroup, "next_chain",
@@ -476,6 +476,22 @@ ControlPickerMenu::ControlPickerMenu(QWidget* pParent)
                                    effectUnitGroups);
             }
 
+            QString sendLevel = tr("Bus Send Level");
+            QMenu* effectUnitSends = addSubmenu(sendLevel, effectUnitMenu);
+            QString sendDescriptionPrefix = QString("%1, %2 %3").arg(
+                    m_effectRackStr.arg(iRackNumber),
+                    m_effectUnitStr.arg(iEffectUnitNumber),
+                    sendLevel);
+            for (int iDeckNumber = 1; iDeckNumber <= iNumDecks; ++iDeckNumber) {
+                QString playerGroup = PlayerManager::groupForDeck(iDeckNumber - 1);
+                addPrefixedControl(effectUnitGroup,
+                                   QString("group_%1_send").arg(playerGroup),
+                                   m_deckStr.arg(iDeckNumber),
+                                   m_deckStr.arg(iDeckNumber),
+                                   sendDescriptionPrefix,
+                                   effectUnitSends, true);
+            }
+
             const int iNumSamplers = ControlObject::get(
                 ConfigKey("[Master]", "num_samplers"));
             for (int iSamplerNumber = 1; iSamplerNumber <= iNumSamplers;
@@ -72,6 +72,8 @@ DlgPrefController::DlgPrefController(QWidget* parent, Controller* controller,
             m_pControllerManager, SLOT(closeController(Controller*)));
     connect(this, SIGNAL(loadPreset(Controller*, ControllerPresetPointer)),
             m_pControllerManager, SLOT(loadPreset(Controller*, ControllerPresetPointer)));
+    connect(this, SIGNAL(loadPendingPreset(Controller*)),
+            m_pControllerManager, SLOT(loadPendingPreset(Controller*)));
 
     // Input mappings
     connect(m_ui.btnAddInputMapping, SIGNAL(clicked()),
@@ -272,6 +274,9 @@ void DlgPrefController::enumeratePresets() {
 }
 
 void DlgPrefController::slotUpdate() {
+    // The presets of disabled controllers are not loaded at startup. Ask for
+    // it now, it arrives through presetLoaded().
+    emit(loadPendingPreset(m_pController));
     enumeratePresets();
 
     // Check if the controller is open.
@@ -54,6 +54,7 @@ class DlgPrefController : public DlgPreferencePage {
     void closeController(Controller* pController);
     void loadPreset(Controller* pController, QString controllerName);
     void loadPreset(Controller* pController, ControllerPresetPointer pPreset);
+    void loadPendingPreset(Controller* pController);
     void mappingStarted();
     void mappingEnded();
 
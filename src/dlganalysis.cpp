@@ -6,8 +6,16 @@
 #include "widget/wanalysislibrarytableview.h"
 #include "library/trackcollection.h"
 #include "dlganalysis.h"
+#include "analyserqueue.h"
 #include "util/assert.h"
 
+namespace {
+
+const ConfigKey kAnalysersConfigKey("[Library]", "AnalysisAnalysers");
+const ConfigKey kCpuShareConfigKey("[Library]", "AnalysisCpuShare");
+
+}  // anonymous namespace
+
 DlgAnalysis::DlgAnalysis(QWidget* parent,
                        ConfigObject<ConfigValue>* pConfig,
                        TrackCollection* pTrackCollection)
@@ -56,6 +64,30 @@ DlgAnalysis::DlgAnalysis(QWidget* parent,
     connect(pushButtonSelectAll, SIGNAL(clicked()),
             this, SLOT(selectAll()));
 
+    QString analysers = m_pConfig->getValueString(kAnalysersConfigKey);
+    if (!analysers.isEmpty()) {
+        int flags = analysers.toInt();
+        checkBoxBeats->setChecked(flags & AnalyserQueue::BEATS);
+        checkBoxKey->setChecked(flags & AnalyserQueue::KEY);
+        checkBoxReplayGain->setChecked(flags & AnalyserQueue::REPLAYGAIN);
+        checkBoxWaveform->setChecked(flags & AnalyserQueue::WAVEFORM);
+    }
+    connect(checkBoxBeats, SIGNAL(toggled(bool)),
+            this, SLOT(slotAnalysersChanged()));
+    connect(checkBoxKey, SIGNAL(toggled(bool)),
+            this, SLOT(slotAnalysersChanged()));
+    connect(checkBoxReplayGain, SIGNAL(toggled(bool)),
+            this, SLOT(slotAnalysersChanged()));
+    connect(checkBoxWaveform, SIGNAL(toggled(bool)),
+            this, SLOT(slotAnalysersChanged()));
+
+    QString cpuShare = m_pConfig->getValueString(kCpuShareConfigKey);
+    if (!cpuShare.isEmpty()) {
+        spinBoxCpuShare->setValue(cpuShare.toInt());
+    }
+    connect(spinBoxCpuShare, SIGNAL(valueChanged(int)),
+            this, SLOT(slotCpuShareChanged(int)));
+
     connect(m_pAnalysisLibraryTableView->selectionModel(),
             SIGNAL(selectionChanged(const QItemSelection &, const QItemSelection&)),
             this,
@@ -156,6 +188,36 @@ int DlgAnalysis::getNumTracks() {
 	return m_tracksInQueue;
 }
 
+int DlgAnalysis::selectedAnalysers() const {
+    int analysers = 0;
+    if (checkBoxBeats->isChecked()) {
+        analysers |= AnalyserQueue::BEATS;
+    }
+    if (checkBoxKey->isChecked()) {
+        analysers |= AnalyserQueue::KEY;
+    }
+    if (checkBoxReplayGain->isChecked()) {
+        analysers |= AnalyserQueue::REPLAYGAIN;
+    }
+    if (checkBoxWaveform->isChecked()) {
+        analysers |= AnalyserQueue::WAVEFORM;
+    }
+    return analysers;
+}
+
+int DlgAnalysis::cpuShare() const {
+    return spinBoxCpuShare->value();
+}
+
+void DlgAnalysis::slotAnalysersChanged() {
+    m_pConfig->set(kAnalysersConfigKey, ConfigValue(selectedAnalysers()));
+}
+
+void DlgAnalysis::slotCpuShareChanged(int percent) {
+    m_pConfig->set(kCpuShareConfigKey, ConfigValue(percent));
+    emit(cpuShareChanged(percent));
+}
+
 void DlgAnalysis::trackAnalysisStarted(int size) {
     m_tracksInQueue = size;
 }
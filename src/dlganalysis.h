@@ -28,6 +28,9 @@ class DlgAnalysis : public QWidget, public Ui::DlgAnalysis, public virtual Libra
         return m_pAnalysisLibraryTableModel->currentSearch();
     }
     int getNumTracks();
+    // The AnalyserQueue::AnalyserType flags of the checked analyses.
+    int selectedAnalysers() const;
+    int cpuShare() const;
 
   public slots:
     void tableSelectionChanged(const QItemSelection& selected,
@@ -42,12 +45,17 @@ class DlgAnalysis : public QWidget, public Ui::DlgAnalysis, public virtual Libra
     void installEventFilter(QObject* pFilter);
     void analysisActive(bool bActive);
 
+  private slots:
+    void slotAnalysersChanged();
+    void slotCpuShareChanged(int percent);
+
   signals:
     void loadTrack(TrackPointer pTrack);
     void loadTrackToPlayer(TrackPointer pTrack, QString player);
     void analyzeTracks(QList<int> trackIds);
     void stopAnalysis();
     void trackSelected(TrackPointer pTrack);
+    void cpuShareChanged(int percent);
 
   private:
     //Note m_pTrackTablePlaceholder is defined in the .ui file
@@ -2,7 +2,9 @@
 
 #include "control/control.h"
 #include "util/cmdlineargs.h"
+#include "util/startupgraph.h"
 #include "util/statsmanager.h"
+#include "util/threadplacement.h"
 
 DlgDeveloperTools::DlgDeveloperTools(QWidget* pParent,
                                      ConfigObject<ConfigValue>* pConfig)
@@ -68,6 +70,13 @@ DlgDeveloperTools::DlgDeveloperTools(QWidget* pParent,
 
     m_logCursor = logTextView->textCursor();
 
+    // Startup is over by now, the report does not change anymore. Its
+    // columns line up in a fixed width font.
+    QFont startupFont("Monospace");
+    startupFont.setStyleHint(QFont::TypeWriter);
+    startupTextView->setFont(startupFont);
+    startupTextView->setPlainText(StartupGraph::lastReport());
+
     // Update at 2FPS.
     startTimer(500);
 
@@ -105,6 +114,12 @@ void DlgDeveloperTools::timerEvent(QTimerEvent* pEvent) {
         if (pManager) {
             pManager->updateStats();
         }
+    } else if (toolTabWidget->currentWidget() == threadsTab) {
+        // Only replace the text when it changed so the selection is kept.
+        QString report = ThreadPlacement::report();
+        if (report != threadsTextView->toPlainText()) {
+            threadsTextView->setPlainText(report);
+        }
     }
 }
 
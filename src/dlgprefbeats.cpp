@@ -161,7 +161,8 @@ void DlgPrefBeats::slotUpdate() {
         return;
     }
 
-    if (m_selectedAnalyser != "qm-tempotracker:0") {
+    if (m_selectedAnalyser != "qm-tempotracker:0" &&
+            m_selectedAnalyser != NATIVE_ANALYSER_BEAT_PLUGIN_ID) {
         bfixedtempo->setEnabled(false);
         boffset->setEnabled(false);
     }
@@ -261,4 +262,10 @@ void DlgPrefBeats::populate() {
             plugin = 0;
         }
     }
+
+    // The built-in beat tracker needs no plugin.
+    m_listName << tr("Mixxx Beat Tracker");
+    m_listLibrary << NATIVE_ANALYSER_LIBRARY;
+    m_listIdentifier << NATIVE_ANALYSER_BEAT_PLUGIN_ID;
+    plugincombo->addItem(tr("Mixxx Beat Tracker"), NATIVE_ANALYSER_BEAT_PLUGIN_ID);
 }
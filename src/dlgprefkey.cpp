@@ -155,8 +155,9 @@ void DlgPrefKey::slotResetToDefaults() {
     m_bReanalyzeEnabled = false;
     m_selectedAnalyser = VAMP_ANALYSER_KEY_DEFAULT_PLUGIN_ID;
     if (!m_listIdentifier.contains(m_selectedAnalyser)) {
-        qDebug() << "DlgPrefKey: qm-keydetector Vamp plugin not found";
-        m_bAnalyserEnabled = false;
+        qDebug() << "DlgPrefKey: qm-keydetector Vamp plugin not found,"
+                 << "using the built-in key detector";
+        m_selectedAnalyser = NATIVE_ANALYSER_KEY_PLUGIN_ID;
     }
 
     radioNotationTraditional->setChecked(true);
@@ -313,6 +314,12 @@ void DlgPrefKey::populate() {
            plugin = 0;
        }
    }
+
+   // The built-in key detector needs no plugin.
+   m_listName << tr("Mixxx Key Detector");
+   m_listLibrary << NATIVE_ANALYSER_LIBRARY;
+   m_listIdentifier << NATIVE_ANALYSER_KEY_PLUGIN_ID;
+   plugincombo->addItem(tr("Mixxx Key Detector"), NATIVE_ANALYSER_KEY_PLUGIN_ID);
 }
 
 void DlgPrefKey::setNotationCustom(bool active) {
@@ -39,13 +39,13 @@ Effect::~Effect() {
     }
 }
 
-void Effect::addToEngine(EngineEffectChain* pChain, int iIndex) {
+void Effect::addToEngine(EngineEffectChain* pChain, int iIndex,
+                         const QSet<QString>& groups) {
     if (m_pEngineEffect) {
         return;
     }
-    m_pEngineEffect = new EngineEffect(m_manifest,
-            m_pEffectsManager->registeredGroups(),
-            m_pInstantiator);
+    m_pEngineEffect = new EngineEffect(m_manifest, groups, m_pInstantiator);
+    m_engineGroups = groups;
     EffectsRequest* request = new EffectsRequest();
     request->type = EffectsRequest::ADD_EFFECT_TO_CHAIN;
     request->pTargetChain = pChain;
@@ -65,6 +65,15 @@ void Effect::removeFromEngine(EngineEffectChain* pChain, int iIndex) {
     request->RemoveEffectFromChain.iIndex = iIndex;
     m_pEffectsManager->writeRequest(request);
     m_pEngineEffect = NULL;
+    m_engineGroups.clear();
+}
+
+EffectGroupState* Effect::createEngineGroupState(const QString& group) {
+    if (!m_pEngineEffect || m_engineGroups.contains(group)) {
+        return NULL;
+    }
+    m_engineGroups.insert(group);
+    return m_pEngineEffect->createGroupState();
 }
 
 void Effect::updateEngineState() {
@@ -3,6 +3,7 @@
 
 #include <QSharedPointer>
 #include <QDomDocument>
+#include <QSet>
 
 #include "util.h"
 #include "effects/effectmanifest.h"
@@ -12,6 +13,7 @@
 class EffectProcessor;
 class EngineEffectChain;
 class EngineEffect;
+class EffectGroupState;
 class EffectsManager;
 
 class Effect;
@@ -51,10 +53,18 @@ class Effect : public QObject {
 
     EngineEffect* getEngineEffect();
 
-    void addToEngine(EngineEffectChain* pChain, int iIndex);
+    // groups are the groups that the processor of the effect allocates its
+    // state for before it is sent to the engine.
+    void addToEngine(EngineEffectChain* pChain, int iIndex,
+                     const QSet<QString>& groups);
     void removeFromEngine(EngineEffectChain* pChain, int iIndex);
     void updateEngineState();
 
+    // Creates the state of group for the engine effect if addToEngine() did
+    // not allocate it. Returns NULL if the engine effect already has it or
+    // keeps no state per group. The caller sends the state to the engine.
+    EffectGroupState* createEngineGroupState(const QString& group);
+
     QDomElement toXML(QDomDocument* doc) const;
     static EffectPointer fromXML(EffectsManager* pEffectsManager,
                                  const QDomElement& element);
@@ -73,6 +83,8 @@ class Effect : public QObject {
     EffectManifest m_manifest;
     EffectInstantiatorPointer m_pInstantiator;
     EngineEffect* m_pEngineEffect;
+    // The groups that the engine effect has state for.
+    QSet<QString> m_engineGroups;
     bool m_bAddedToEngine;
     bool m_bEnabled;
     QList<EffectParameter*> m_parameters;
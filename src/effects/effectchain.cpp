@@ -5,6 +5,7 @@
 #include "engine/effects/engineeffectrack.h"
 #include "engine/effects/engineeffectchain.h"
 #include "sampleutil.h"
+#include "util/defs.h"
 #include "xmlparse.h"
 
 EffectChain::EffectChain(EffectsManager* pEffectsManager, const QString& id,
@@ -30,6 +31,7 @@ EffectChain::~EffectChain() {
 
 void EffectChain::addToEngine(EngineEffectRack* pRack, int iIndex) {
     m_pEngineEffectChain = new EngineEffectChain(m_id);
+    m_engineGroups.clear();
     EffectsRequest* pRequest = new EffectsRequest();
     pRequest->type = EffectsRequest::ADD_CHAIN_TO_RACK;
     pRequest->pTargetRack = pRack;
@@ -43,7 +45,7 @@ void EffectChain::addToEngine(EngineEffectRack* pRack, int iIndex) {
         // Add the effect to the engine.
         EffectPointer pEffect = m_effects[i];
         if (pEffect) {
-            pEffect->addToEngine(m_pEngineEffectChain, i);
+            pEffect->addToEngine(m_pEngineEffectChain, i, effectGroups());
         }
     }
 }
@@ -66,6 +68,7 @@ void EffectChain::removeFromEngine(EngineEffectRack* pRack, int iIndex) {
     m_bAddedToEngine = false;
 
     m_pEngineEffectChain = NULL;
+    m_engineGroups.clear();
 }
 
 void EffectChain::updateEngineState() {
@@ -74,6 +77,10 @@ void EffectChain::updateEngineState() {
     }
     // Update chain parameters in the engine.
     sendParameterUpdate();
+    for (QMap<QString, double>::const_iterator it = m_groupSendLevels.begin();
+         it != m_groupSendLevels.end(); ++it) {
+        sendGroupSendLevelUpdate(it.key(), it.value());
+    }
     for (int i = 0; i < m_effects.size(); ++i) {
         EffectPointer pEffect = m_effects[i];
         if (pEffect) {
@@ -148,7 +155,7 @@ void EffectChain::enableForGroup(const QString& group) {
         EffectsRequest* request = new EffectsRequest();
         request->type = EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_GROUP;
         request->pTargetChain = m_pEngineEffectChain;
-        request->group = group;
+        setRequestGroup(request, group);
         m_pEffectsManager->writeRequest(request);
 
         emit(groupStatusChanged(group, true));
@@ -168,13 +175,25 @@ void EffectChain::disableForGroup(const QString& group) {
         EffectsRequest* request = new EffectsRequest();
         request->type = EffectsRequest::DISABLE_EFFECT_CHAIN_FOR_GROUP;
         request->pTargetChain = m_pEngineEffectChain;
-        request->group = group;
+        setRequestGroup(request, group);
         m_pEffectsManager->writeRequest(request);
 
         emit(groupStatusChanged(group, false));
     }
 }
 
+double EffectChain::sendLevelForGroup(const QString& group) const {
+    return m_groupSendLevels.value(group, 1.0);
+}
+
+void EffectChain::setSendLevelForGroup(const QString& group, double level) {
+    if (m_groupSendLevels.contains(group) && m_groupSendLevels[group] == level) {
+        return;
+    }
+    m_groupSendLevels[group] = level;
+    sendGroupSendLevelUpdate(group, level);
+}
+
 double EffectChain::mix() const {
     return m_dMix;
 }
@@ -209,7 +228,8 @@ void EffectChain::addEffect(EffectPointer pEffect) {
     }
     m_effects.append(pEffect);
     if (m_bAddedToEngine) {
-        pEffect->addToEngine(m_pEngineEffectChain, m_effects.size() - 1);
+        pEffect->addToEngine(m_pEngineEffectChain, m_effects.size() - 1,
+                             effectGroups());
     }
     emit(effectsChanged());
 }
@@ -235,7 +255,8 @@ void EffectChain::replaceEffect(unsigned int effectSlotNumber,
     m_effects.replace(effectSlotNumber, pEffect);
     if (!pEffect.isNull()) {
         if (m_bAddedToEngine) {
-            pEffect->addToEngine(m_pEngineEffectChain, effectSlotNumber);
+            pEffect->addToEngine(m_pEngineEffectChain, effectSlotNumber,
+                                 effectGroups());
         }
     }
 
@@ -268,9 +289,53 @@ void EffectChain::sendParameterUpdate() {
     pRequest->SetEffectChainParameters.enabled = m_bEnabled;
     pRequest->SetEffectChainParameters.insertion_type = m_insertionType;
     pRequest->SetEffectChainParameters.mix = m_dMix;
+    if (m_insertionType == BUS) {
+        // Effects added before the switch to BUS mode have no bus state yet.
+        // Create it here rather than in the callback.
+        foreach (EffectPointer pEffect, m_effects) {
+            if (!pEffect) {
+                continue;
+            }
+            EffectGroupState* pState = pEffect->createEngineGroupState(
+                    EngineEffectChain::busGroup());
+            if (pState) {
+                pRequest->busGroupStates.append(qMakePair(
+                        pEffect->getEngineEffect(), pState));
+            }
+        }
+    }
     m_pEffectsManager->writeRequest(pRequest);
 }
 
+void EffectChain::sendGroupSendLevelUpdate(const QString& group, double level) {
+    if (!m_bAddedToEngine) {
+        return;
+    }
+    EffectsRequest* pRequest = new EffectsRequest();
+    pRequest->type = EffectsRequest::SET_EFFECT_CHAIN_GROUP_SEND_LEVEL;
+    pRequest->pTargetChain = m_pEngineEffectChain;
+    setRequestGroup(pRequest, group);
+    pRequest->SetEffectChainGroupSendLevel.send_level = level;
+    m_pEffectsManager->writeRequest(pRequest);
+}
+
+QSet<QString> EffectChain::effectGroups() const {
+    QSet<QString> groups = m_pEffectsManager->registeredGroups();
+    if (m_insertionType == BUS) {
+        groups.insert(EngineEffectChain::busGroup());
+    }
+    return groups;
+}
+
+void EffectChain::setRequestGroup(EffectsRequest* pRequest,
+                                  const QString& group) {
+    pRequest->group = group;
+    if (m_bAddedToEngine && !m_engineGroups.contains(group)) {
+        m_engineGroups.insert(group);
+        pRequest->pGroupBuffer = SampleUtil::alloc(MAX_BUFFER_LEN);
+    }
+}
+
 QDomElement EffectChain::toXML(QDomDocument* doc) const {
     QDomElement element = doc->createElement("EffectChain");
 
@@ -42,6 +42,11 @@ class EffectChain : public QObject {
     const QSet<QString>& enabledGroups() const;
     void disableForGroup(const QString& group);
 
+    // The level at which group is sent to the chain in BUS mode. Defaults to
+    // 1.0.
+    double sendLevelForGroup(const QString& group) const;
+    void setSendLevelForGroup(const QString& group, double level);
+
     EffectChainPointer prototype() const;
 
     // Get the human-readable name of the EffectChain
@@ -58,6 +63,10 @@ class EffectChain : public QObject {
     enum InsertionType {
         INSERT = 0,
         SEND,
+        // The enabled channels are sent post-fader, scaled by their send
+        // level, into a bus of the chain. The bus is processed once per
+        // callback and its return is mixed into the master at the chain mix.
+        BUS,
         // The number of insertion types. Also used to represent "unknown".
         NUM_INSERTION_TYPES
     };
@@ -67,6 +76,8 @@ class EffectChain : public QObject {
                 return "INSERT";
             case SEND:
                 return "SEND";
+            case BUS:
+                return "BUS";
             default:
                 return "UNKNOWN";
         }
@@ -76,6 +87,8 @@ class EffectChain : public QObject {
             return INSERT;
         } else if (typeStr == "SEND") {
             return SEND;
+        } else if (typeStr == "BUS") {
+            return BUS;
         } else {
             return NUM_INSERTION_TYPES;
         }
@@ -113,6 +126,14 @@ class EffectChain : public QObject {
     }
 
     void sendParameterUpdate();
+    void sendGroupSendLevelUpdate(const QString& group, double level);
+    // The groups that effects added to the engine allocate their state for:
+    // the registered groups and, in BUS mode, the bus of the chain.
+    QSet<QString> effectGroups() const;
+    // Sets the group of a request for m_pEngineEffectChain. If the engine
+    // chain has not seen group yet, the request also carries the scratch
+    // buffer of the group so that the engine does not allocate it.
+    void setRequestGroup(EffectsRequest* pRequest, const QString& group);
 
     EffectsManager* m_pEffectsManager;
     EffectChainPointer m_pPrototype;
@@ -125,8 +146,11 @@ class EffectChain : public QObject {
     double m_dMix;
 
     QSet<QString> m_enabledGroups;
+    QMap<QString, double> m_groupSendLevels;
     QList<EffectPointer> m_effects;
     EngineEffectChain* m_pEngineEffectChain;
+    // Groups that m_pEngineEffectChain was sent a scratch buffer for.
+    QSet<QString> m_engineGroups;
     bool m_bAddedToEngine;
 
     DISALLOW_COPY_AND_ASSIGN(EffectChain);
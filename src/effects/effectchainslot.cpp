@@ -4,6 +4,8 @@
 #include "sampleutil.h"
 #include "controlpotmeter.h"
 #include "controlpushbutton.h"
+#include "controlobjectslave.h"
+#include "engine/effects/engineeffectchain.h"
 #include "util/math.h"
 
 EffectChainSlot::EffectChainSlot(EffectRack* pRack, const QString& group,
@@ -67,8 +69,17 @@ EffectChainSlot::EffectChainSlot(EffectRack* pRack, const QString& group,
     connect(m_pControlChainSelector, SIGNAL(valueChanged(double)),
             this, SLOT(slotControlChainSelector(double)));
 
+    m_pControlChainCpuUsage = new ControlObject(ConfigKey(m_group, "cpu_usage"));
+    m_pControlChainCpuUsage->connectValueChangeRequest(
+        this, SLOT(slotControlChainCpuUsage(double)));
+    // The engine measures continuously, the control is updated at GUI rate.
+    m_pGuiTick = new ControlObjectSlave("[Master]", "guiTick50ms", this);
+    m_pGuiTick->connectValueChanged(this, SLOT(slotGuiTick50ms(double)));
+
     connect(&m_groupStatusMapper, SIGNAL(mapped(const QString&)),
             this, SLOT(slotGroupStatusChanged(const QString&)));
+    connect(&m_groupSendMapper, SIGNAL(mapped(const QString&)),
+            this, SLOT(slotGroupSendLevelChanged(const QString&)));
 }
 
 EffectChainSlot::~EffectChainSlot() {
@@ -85,12 +96,18 @@ EffectChainSlot::~EffectChainSlot() {
     delete m_pControlChainPrevPreset;
     delete m_pControlChainNextPreset;
     delete m_pControlChainSelector;
+    delete m_pControlChainCpuUsage;
 
     for (QMap<QString, ControlObject*>::iterator it = m_groupEnableControls.begin();
          it != m_groupEnableControls.end();) {
         delete it.value();
         it = m_groupEnableControls.erase(it);
     }
+    for (QMap<QString, ControlObject*>::iterator it = m_groupSendControls.begin();
+         it != m_groupSendControls.end();) {
+        delete it.value();
+        it = m_groupSendControls.erase(it);
+    }
 
     m_slots.clear();
     m_pEffectChain.clear();
@@ -210,6 +227,10 @@ void EffectChainSlot::loadEffectChain(EffectChainPointer pEffectChain) {
                 m_pEffectChain->disableForGroup(it.key());
             }
         }
+        for (QMap<QString, ControlObject*>::iterator it = m_groupSendControls.begin();
+             it != m_groupSendControls.end(); ++it) {
+            m_pEffectChain->setSendLevelForGroup(it.key(), it.value()->get());
+        }
 
         // Don't emit because we will below.
         slotChainEffectsChanged(false);
@@ -280,6 +301,20 @@ void EffectChainSlot::registerGroup(const QString& group) {
     m_groupStatusMapper.setMapping(pEnableControl, group);
     connect(pEnableControl, SIGNAL(valueChanged(double)),
             &m_groupStatusMapper, SLOT(map()));
+
+    // Only channels are sent to the bus. The master and headphone outputs
+    // are not.
+    if (group == "[Master]" || group == "[Headphone]") {
+        return;
+    }
+    ControlPotmeter* pSendControl = new ControlPotmeter(
+        ConfigKey(m_group, QString("group_%1_send").arg(group)), 0.0, 1.0);
+    pSendControl->setDefaultValue(1.0);
+    pSendControl->set(1.0);
+    m_groupSendControls[group] = pSendControl;
+    m_groupSendMapper.setMapping(pSendControl, group);
+    connect(pSendControl, SIGNAL(valueChanged(double)),
+            &m_groupSendMapper, SLOT(map()));
 }
 
 void EffectChainSlot::slotEffectLoaded(EffectPointer pEffect, unsigned int slotNumber) {
@@ -329,6 +364,22 @@ void EffectChainSlot::slotControlChainLoaded(double v) {
     qWarning() << "WARNING: loaded is a read-only control.";
 }
 
+void EffectChainSlot::slotControlChainCpuUsage(double v) {
+    // Ignore sets to cpu_usage.
+    Q_UNUSED(v);
+    qWarning() << "WARNING: cpu_usage is a read-only control.";
+}
+
+void EffectChainSlot::slotGuiTick50ms(double v) {
+    Q_UNUSED(v);
+    EngineEffectChain* pEngineChain = m_pEffectChain ?
+            m_pEffectChain->getEngineEffectChain() : NULL;
+    double usage = pEngineChain ? pEngineChain->cpuUsage() : 0.0;
+    if (usage != m_pControlChainCpuUsage->get()) {
+        m_pControlChainCpuUsage->setAndConfirm(usage);
+    }
+}
+
 void EffectChainSlot::slotControlChainEnabled(double v) {
     //qDebug() << debugString() << "slotControlChainEnabled" << v;
     if (m_pEffectChain) {
@@ -397,6 +448,15 @@ void EffectChainSlot::slotControlChainPrevPreset(double v) {
     }
 }
 
+void EffectChainSlot::slotGroupSendLevelChanged(const QString& group) {
+    if (m_pEffectChain) {
+        ControlObject* pSendControl = m_groupSendControls.value(group, NULL);
+        if (pSendControl != NULL) {
+            m_pEffectChain->setSendLevelForGroup(group, pSendControl->get());
+        }
+    }
+}
+
 void EffectChainSlot::slotGroupStatusChanged(const QString& group) {
     if (m_pEffectChain) {
         ControlObject* pGroupControl = m_groupEnableControls.value(group, NULL);
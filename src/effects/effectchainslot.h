@@ -12,6 +12,7 @@
 #include "effects/effectchain.h"
 
 class ControlObject;
+class ControlObjectSlave;
 class ControlPushButton;
 class EffectChainSlot;
 class EffectRack;
@@ -108,6 +109,7 @@ class EffectChainSlot : public QObject {
     void slotControlNumEffects(double v);
     void slotControlNumEffectSlots(double v);
     void slotControlChainLoaded(double v);
+    void slotControlChainCpuUsage(double v);
     void slotControlChainEnabled(double v);
     void slotControlChainMix(double v);
     void slotControlChainSuperParameter(double v);
@@ -116,6 +118,8 @@ class EffectChainSlot : public QObject {
     void slotControlChainNextPreset(double v);
     void slotControlChainPrevPreset(double v);
     void slotGroupStatusChanged(const QString& group);
+    void slotGroupSendLevelChanged(const QString& group);
+    void slotGuiTick50ms(double v);
 
   private:
     QString debugString() const {
@@ -139,11 +143,17 @@ class EffectChainSlot : public QObject {
     ControlObject* m_pControlChainSelector;
     ControlPushButton* m_pControlChainNextPreset;
     ControlPushButton* m_pControlChainPrevPreset;
+    // The fraction of the audio callback spent in this chain.
+    ControlObject* m_pControlChainCpuUsage;
+    ControlObjectSlave* m_pGuiTick;
 
     QMap<QString, ControlObject*> m_groupEnableControls;
+    // The send levels of the groups for BUS mode.
+    QMap<QString, ControlObject*> m_groupSendControls;
 
     QList<EffectSlotPointer> m_slots;
     QSignalMapper m_groupStatusMapper;
+    QSignalMapper m_groupSendMapper;
 
     DISALLOW_COPY_AND_ASSIGN(EffectChainSlot);
 };
@@ -4,11 +4,21 @@
 #include <QString>
 #include <QHash>
 
+#include "sampleutil.h"
+#include "util/assert.h"
 #include "util/types.h"
 #include "engine/effects/groupfeaturestate.h"
 
 class EngineEffect;
 
+// The state an EffectProcessor keeps for one group. It is created on the main
+// thread by EffectProcessor::createGroupState() for groups that the engine
+// starts processing later, so that the engine does not allocate it.
+class EffectGroupState {
+  public:
+    virtual ~EffectGroupState() { }
+};
+
 class EffectProcessor {
   public:
     enum EnableState {
@@ -23,6 +33,37 @@ class EffectProcessor {
 
     virtual void initialize(const QSet<QString>& registeredGroups) = 0;
 
+    // Called from the engine thread before group is processed in a callback.
+    // Processors that keep per-group state must allocate it here, because
+    // process() may run concurrently for different groups.
+    virtual void prepareGroup(const QString& group) {
+        Q_UNUSED(group);
+    }
+
+    // Makes room for the state of group, which is handed over later with
+    // adoptGroupState(). Called from the main thread before the processor is
+    // sent to the engine.
+    virtual void reserveGroup(const QString& group) {
+        Q_UNUSED(group);
+    }
+
+    // Creates the state of a group for adoptGroupState(). Called from the
+    // main thread while the engine may be using the processor, so it must
+    // not modify the processor. Returns NULL if the processor keeps no state
+    // per group.
+    virtual EffectGroupState* createGroupState() const {
+        return NULL;
+    }
+
+    // Takes ownership of pState, which createGroupState() created, as the
+    // state of the reserved group. Called from the engine thread, so it must
+    // not allocate.
+    virtual void adoptGroupState(const QString& group,
+                                 EffectGroupState* pState) {
+        Q_UNUSED(group);
+        DEBUG_ASSERT(pState == NULL);
+    }
+
     // Take a buffer of numSamples samples of audio from group, provided as
     // pInput, process the buffer according to Effect-specific logic, and output
     // it to the buffer pOutput. If pInput is equal to pOutput, then the
@@ -44,9 +85,12 @@ class EffectProcessor {
 // of a group-specific process call.
 template <typename T>
 class GroupEffectProcessor : public EffectProcessor {
+    struct GroupStateBox : public EffectGroupState {
+        T state;
+    };
     struct GroupStateHolder {
-        GroupStateHolder() : state(NULL) { }
-        T* state;
+        GroupStateHolder() : pBox(NULL) { }
+        GroupStateBox* pBox;
     };
   public:
     GroupEffectProcessor() {
@@ -54,26 +98,62 @@ class GroupEffectProcessor : public EffectProcessor {
     virtual ~GroupEffectProcessor() {
         for (typename QHash<QString, GroupStateHolder>::iterator it =
                      m_groupState.begin(); it != m_groupState.end();) {
-            T* pState = it->state;
+            GroupStateBox* pBox = it->pBox;
             it = m_groupState.erase(it);
-            delete pState;
+            delete pBox;
         }
     }
 
     virtual void initialize(const QSet<QString>& registeredGroups) {
         foreach (const QString& group, registeredGroups) {
-            getOrCreateGroupState(group);
+            ensureGroupState(group);
         }
     }
 
+    virtual void prepareGroup(const QString& group) {
+        ensureGroupState(group);
+    }
+
+    virtual void reserveGroup(const QString& group) {
+        if (!m_groupState.contains(group)) {
+            m_groupState.insert(group, GroupStateHolder());
+        }
+    }
+
+    virtual EffectGroupState* createGroupState() const {
+        return new GroupStateBox();
+    }
+
+    virtual void adoptGroupState(const QString& group,
+                                 EffectGroupState* pState) {
+        // The group was reserved, so this does not insert into the hash.
+        typename QHash<QString, GroupStateHolder>::iterator it =
+                m_groupState.find(group);
+        DEBUG_ASSERT_AND_HANDLE(it != m_groupState.end() && it->pBox == NULL) {
+            delete pState;
+            return;
+        }
+        it->pBox = static_cast<GroupStateBox*>(pState);
+    }
+
     virtual void process(const QString& group,
                          const CSAMPLE* pInput, CSAMPLE* pOutput,
                          const unsigned int numSamples,
                          const unsigned int sampleRate,
                          const EffectProcessor::EnableState enableState,
                          const GroupFeatureState& groupFeatures) {
-        T* pState = getOrCreateGroupState(group);
-        processGroup(group, pState, pInput, pOutput, numSamples, sampleRate,
+        // Only looks up the state so that groups can be processed in
+        // parallel. It is created by initialize() or prepareGroup(), or
+        // handed over with adoptGroupState().
+        GroupStateBox* pBox = m_groupState.value(group).pBox;
+        DEBUG_ASSERT_AND_HANDLE(pBox != NULL) {
+            // Pass the audio through rather than modify m_groupState here.
+            if (pInput != pOutput) {
+                SampleUtil::copy(pOutput, pInput, numSamples);
+            }
+            return;
+        }
+        processGroup(group, &pBox->state, pInput, pOutput, numSamples, sampleRate,
                      enableState, groupFeatures);
     }
 
@@ -86,12 +166,11 @@ class GroupEffectProcessor : public EffectProcessor {
                               const GroupFeatureState& groupFeatures) = 0;
 
   private:
-    inline T* getOrCreateGroupState(const QString& group) {
+    inline void ensureGroupState(const QString& group) {
         GroupStateHolder& holder = m_groupState[group];
-        if (holder.state == NULL) {
-            holder.state = new T();
+        if (holder.pBox == NULL) {
+            holder.pBox = new GroupStateBox();
         }
-        return holder.state;
     }
 
     QHash<QString, GroupStateHolder> m_groupState;
@@ -7,11 +7,27 @@
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectrack.h"
 #include "engine/effects/engineeffectchain.h"
+#include "effects/effectprocessor.h"
+#include "sampleutil.h"
 #include "util/assert.h"
 
 const char* kEqualizerRackName = "[EqualizerChain]";
 const char* kQuickEffectRackName = "[QuickEffectChain]";
 
+namespace {
+
+// Frees what the main thread allocated for a request that never reached the
+// engine.
+void deleteUnsentRequest(EffectsRequest* request) {
+    SampleUtil::free(request->pGroupBuffer);
+    for (int i = 0; i < request->busGroupStates.size(); ++i) {
+        delete request->busGroupStates.at(i).second;
+    }
+    delete request;
+}
+
+}  // anonymous namespace
+
 EffectsManager::EffectsManager(QObject* pParent, ConfigObject<ConfigValue>* pConfig)
         : QObject(pParent),
           m_pEffectChainManager(new EffectChainManager(pConfig, this)),
@@ -278,12 +294,12 @@ bool EffectsManager::writeRequest(EffectsRequest* request) {
             //qDebug() << debugString() << "delete" << request->RemoveEffectRack.pRack;
             delete request->RemoveEffectRack.pRack;
         }
-        delete request;
+        deleteUnsentRequest(request);
         return false;
     }
 
     if (m_pRequestPipe.isNull()) {
-        delete request;
+        deleteUnsentRequest(request);
         return false;
     }
 
@@ -297,7 +313,7 @@ bool EffectsManager::writeRequest(EffectsRequest* request) {
         m_activeRequests[request->request_id] = request;
         return true;
     }
-    delete request;
+    deleteUnsentRequest(request);
     return false;
 }
 
@@ -324,21 +340,10 @@ void EffectsManager::processEffectsResponses() {
             if (!response.success) {
                 qWarning() << debugString() << "WARNING: Failed EffectsRequest"
                            << "type" << pRequest->type;
-            } else {
-                //qDebug() << debugString() << "EffectsRequest Success"
-                //           << "type" << pRequest->type;
-
-                if (pRequest->type == EffectsRequest::REMOVE_EFFECT_FROM_CHAIN) {
-                    //qDebug() << debugString() << "delete" << pRequest->RemoveEffectFromChain.pEffect;
-                    delete pRequest->RemoveEffectFromChain.pEffect;
-                } else if (pRequest->type == EffectsRequest::REMOVE_CHAIN_FROM_RACK) {
-                    //qDebug() << debugString() << "delete" << request->RemoveEffectFromChain.pEffect;
-                    delete pRequest->RemoveChainFromRack.pChain;
-                } else if (pRequest->type == EffectsRequest::REMOVE_EFFECT_RACK) {
-                    qDebug() << debugString() << "delete" << pRequest->RemoveEffectRack.pRack;
-                    delete pRequest->RemoveEffectRack.pRack;
-                }
             }
+            // Removed racks, chains and effects are not deleted here. The
+            // engine retires them to its EngineGarbageCollector, which frees
+            // them once no callback can use them anymore.
 
             delete pRequest;
             it = m_activeRequests.erase(it);
@@ -0,0 +1,282 @@
+#include <QDir>
+#include <QtDebug>
+
+#include <lv2/lv2plug.in/ns/ext/port-props/port-props.h>
+#include <lv2/lv2plug.in/ns/ext/worker/worker.h>
+
+#include "effects/lv2/lv2backend.h"
+#include "effects/lv2/lv2effectprocessor.h"
+#include "effects/lv2/lv2worker.h"
+#include "util/timer.h"
+
+namespace {
+
+// Creates the LV2EffectProcessor of one plugin.
+class LV2EffectInstantiator : public EffectInstantiator {
+  public:
+    LV2EffectInstantiator(const LV2Manifest& manifest, LV2Backend* pBackend)
+            : m_manifest(manifest),
+              m_pBackend(pBackend) {
+    }
+
+    EffectProcessor* instantiate(EngineEffect* pEngineEffect,
+                                 const EffectManifest& manifest) {
+        Q_UNUSED(manifest);
+        return new LV2EffectProcessor(pEngineEffect, m_manifest, m_pBackend);
+    }
+
+  private:
+    LV2Manifest m_manifest;
+    LV2Backend* m_pBackend;
+};
+
+// The host features we provide. Plugins that require others are not offered.
+bool isSupportedFeature(const QString& feature) {
+    return feature == LV2_URID__map ||
+            feature == LV2_URID__unmap ||
+            feature == LV2_WORKER__schedule ||
+            feature == LV2_CORE__hardRTCapable ||
+            feature == LV2_CORE__inPlaceBroken ||
+            feature == LV2_CORE__isLive;
+}
+
+QString nodeToString(LilvNode* pNode) {
+    QString string;
+    if (pNode != NULL) {
+        string = QString::fromUtf8(lilv_node_as_string(pNode));
+        lilv_node_free(pNode);
+    }
+    return string;
+}
+
+}  // anonymous namespace
+
+LV2Backend::LV2Backend(QObject* pParent, ConfigObject<ConfigValue>* pConfig)
+        : EffectsBackend(pParent, tr("LV2")),
+          m_indexPath(QDir(pConfig->getSettingsPath()).filePath("lv2_index.dat")),
+          m_pWorld(lilv_world_new()),
+          m_bWorldLoaded(false),
+          m_pWorkerThread(new LV2WorkerThread()) {
+    m_pAudioPort = lilv_new_uri(m_pWorld, LV2_CORE__AudioPort);
+    m_pControlPort = lilv_new_uri(m_pWorld, LV2_CORE__ControlPort);
+    m_pInputPort = lilv_new_uri(m_pWorld, LV2_CORE__InputPort);
+    m_pOutputPort = lilv_new_uri(m_pWorld, LV2_CORE__OutputPort);
+    m_pConnectionOptional = lilv_new_uri(m_pWorld, LV2_CORE__connectionOptional);
+    m_pToggled = lilv_new_uri(m_pWorld, LV2_CORE__toggled);
+    m_pInteger = lilv_new_uri(m_pWorld, LV2_CORE__integer);
+    m_pLogarithmic = lilv_new_uri(m_pWorld, LV2_PORT_PROPS__logarithmic);
+    m_pWorkerInterface = lilv_new_uri(m_pWorld, LV2_WORKER__interface);
+
+    m_uridMap.handle = this;
+    m_uridMap.map = &LV2Backend::mapUri;
+    m_uridMapFeature.URI = LV2_URID__map;
+    m_uridMapFeature.data = &m_uridMap;
+    m_uridUnmap.handle = this;
+    m_uridUnmap.unmap = &LV2Backend::unmapUri;
+    m_uridUnmapFeature.URI = LV2_URID__unmap;
+    m_uridUnmapFeature.data = &m_uridUnmap;
+
+    m_pWorkerThread->start(QThread::LowPriority);
+
+    ScopedTimer t("LV2Backend::LV2Backend");
+    const LV2ManifestIndex::Fingerprint fingerprint =
+            LV2ManifestIndex::scanBundles(LV2ManifestIndex::searchPaths());
+    if (!m_index.load(m_indexPath) || m_index.fingerprint() != fingerprint) {
+        rebuildIndex(fingerprint);
+    }
+    registerManifests();
+}
+
+LV2Backend::~LV2Backend() {
+    delete m_pWorkerThread;
+    lilv_node_free(m_pAudioPort);
+    lilv_node_free(m_pControlPort);
+    lilv_node_free(m_pInputPort);
+    lilv_node_free(m_pOutputPort);
+    lilv_node_free(m_pConnectionOptional);
+    lilv_node_free(m_pToggled);
+    lilv_node_free(m_pInteger);
+    lilv_node_free(m_pLogarithmic);
+    lilv_node_free(m_pWorkerInterface);
+    lilv_world_free(m_pWorld);
+}
+
+void LV2Backend::rebuildIndex(const LV2ManifestIndex::Fingerprint& fingerprint) {
+    qDebug() << debugString() << "LV2 bundles changed, rebuilding the index";
+    lilv_world_load_all(m_pWorld);
+    m_bWorldLoaded = true;
+
+    m_index.clear();
+    m_index.setFingerprint(fingerprint);
+    const LilvPlugins* pPlugins = lilv_world_get_all_plugins(m_pWorld);
+    LILV_FOREACH(plugins, it, pPlugins) {
+        m_index.addManifest(buildManifest(lilv_plugins_get(pPlugins, it)));
+    }
+    if (!m_index.save(m_indexPath)) {
+        qWarning() << debugString() << "could not save the index to"
+                   << m_indexPath;
+    }
+}
+
+LV2Manifest LV2Backend::buildManifest(const LilvPlugin* pPlugin) {
+    LV2Manifest manifest;
+    manifest.setUri(QString::fromUtf8(
+            lilv_node_as_uri(lilv_plugin_get_uri(pPlugin))));
+    manifest.setBundleUri(QString::fromUtf8(
+            lilv_node_as_uri(lilv_plugin_get_bundle_uri(pPlugin))));
+    manifest.setStatus(LV2Manifest::AVAILABLE);
+
+    EffectManifest* pEffectManifest = manifest.effectManifestPointer();
+    pEffectManifest->setId(manifest.uri());
+    pEffectManifest->setName(nodeToString(lilv_plugin_get_name(pPlugin)));
+    pEffectManifest->setAuthor(nodeToString(lilv_plugin_get_author_name(pPlugin)));
+    pEffectManifest->setDescription(manifest.uri());
+
+    LilvNodes* pRequiredFeatures = lilv_plugin_get_required_features(pPlugin);
+    LILV_FOREACH(nodes, it, pRequiredFeatures) {
+        const QString feature = QString::fromUtf8(
+                lilv_node_as_uri(lilv_nodes_get(pRequiredFeatures, it)));
+        if (!isSupportedFeature(feature)) {
+            manifest.setStatus(LV2Manifest::HAS_REQUIRED_FEATURES);
+        }
+    }
+    lilv_nodes_free(pRequiredFeatures);
+
+    manifest.setUsesWorker(
+            lilv_plugin_has_extension_data(pPlugin, m_pWorkerInterface));
+
+    const uint32_t numPorts = lilv_plugin_get_num_ports(pPlugin);
+    QVector<float> minimums(numPorts);
+    QVector<float> maximums(numPorts);
+    QVector<float> defaults(numPorts);
+    lilv_plugin_get_port_ranges_float(pPlugin, minimums.data(),
+                                      maximums.data(), defaults.data());
+
+    for (uint32_t i = 0; i < numPorts; ++i) {
+        const LilvPort* pPort = lilv_plugin_get_port_by_index(pPlugin, i);
+        const bool isInput = lilv_port_is_a(pPlugin, pPort, m_pInputPort);
+        const bool isOutput = lilv_port_is_a(pPlugin, pPort, m_pOutputPort);
+
+        if (lilv_port_is_a(pPlugin, pPort, m_pAudioPort) && (isInput || isOutput)) {
+            manifest.addPort(isInput ? LV2Manifest::PORT_AUDIO_INPUT
+                                     : LV2Manifest::PORT_AUDIO_OUTPUT);
+        } else if (lilv_port_is_a(pPlugin, pPort, m_pControlPort) && isOutput) {
+            manifest.addPort(LV2Manifest::PORT_CONTROL_OUTPUT);
+        } else if (lilv_port_is_a(pPlugin, pPort, m_pControlPort) && isInput) {
+            manifest.addPort(LV2Manifest::PORT_CONTROL_INPUT);
+
+            // Ports without a range get a 0 to 1 knob.
+            double minimum = minimums[i] == minimums[i] ? minimums[i] : 0.0;
+            double maximum = maximums[i] == maximums[i] ? maximums[i] : 1.0;
+            if (maximum <= minimum) {
+                maximum = minimum + 1.0;
+            }
+            double defaultValue = defaults[i] == defaults[i] ? defaults[i] : minimum;
+
+            EffectManifestParameter* pParameter = pEffectManifest->addParameter();
+            pParameter->setId(nodeToString(lilv_node_duplicate(
+                    lilv_port_get_symbol(pPlugin, pPort))));
+            pParameter->setName(nodeToString(lilv_port_get_name(pPlugin, pPort)));
+            pParameter->setDescription(pParameter->name());
+            pParameter->setUnitsHint(EffectManifestParameter::UNITS_UNKNOWN);
+            if (lilv_port_has_property(pPlugin, pPort, m_pToggled)) {
+                pParameter->setControlHint(
+                        EffectManifestParameter::CONTROL_TOGGLE_STEPPING);
+                pParameter->appendStep(qMakePair(QString("Off"), minimum));
+                pParameter->appendStep(qMakePair(QString("On"), maximum));
+            } else if (lilv_port_has_property(pPlugin, pPort, m_pInteger) &&
+                       maximum - minimum <= 32) {
+                pParameter->setControlHint(
+                        EffectManifestParameter::CONTROL_KNOB_STEPPING);
+                for (int step = static_cast<int>(minimum);
+                        step <= static_cast<int>(maximum); ++step) {
+                    pParameter->appendStep(
+                            qMakePair(QString::number(step), static_cast<double>(step)));
+                }
+            } else if (lilv_port_has_property(pPlugin, pPort, m_pLogarithmic) &&
+                       minimum > 0) {
+                pParameter->setControlHint(
+                        EffectManifestParameter::CONTROL_KNOB_LOGARITHMIC);
+            } else {
+                pParameter->setControlHint(
+                        EffectManifestParameter::CONTROL_KNOB_LINEAR);
+            }
+            pParameter->setMinimum(minimum);
+            pParameter->setMaximum(maximum);
+            pParameter->setDefault(defaultValue);
+        } else if (lilv_port_has_property(pPlugin, pPort, m_pConnectionOptional)) {
+            manifest.addPort(LV2Manifest::PORT_OPTIONAL);
+        } else {
+            // Atom and CV ports are not supported yet.
+            manifest.addPort(LV2Manifest::PORT_OPTIONAL);
+            if (manifest.status() == LV2Manifest::AVAILABLE) {
+                manifest.setStatus(LV2Manifest::HAS_UNSUPPORTED_PORTS);
+            }
+        }
+    }
+
+    if (manifest.status() == LV2Manifest::AVAILABLE &&
+            (manifest.audioInputPorts().size() != 2 ||
+             manifest.audioOutputPorts().size() != 2)) {
+        manifest.setStatus(LV2Manifest::IO_NOT_STEREO);
+    }
+    return manifest;
+}
+
+void LV2Backend::registerManifests() {
+    int numAvailable = 0;
+    foreach (const LV2Manifest& manifest, m_index.manifests()) {
+        if (!manifest.isAvailable()) {
+            continue;
+        }
+        registerEffect(manifest.uri(), manifest.effectManifest(),
+                       EffectInstantiatorPointer(
+                               new LV2EffectInstantiator(manifest, this)));
+        ++numAvailable;
+    }
+    qDebug() << debugString() << numAvailable << "of"
+             << m_index.manifests().size() << "LV2 plugins available";
+}
+
+const LilvPlugin* LV2Backend::getPlugin(const LV2Manifest& manifest) {
+    if (!m_bWorldLoaded && !m_loadedBundles.contains(manifest.bundleUri())) {
+        LilvNode* pBundle = lilv_new_uri(
+                m_pWorld, manifest.bundleUri().toUtf8().constData());
+        lilv_world_load_bundle(m_pWorld, pBundle);
+        lilv_node_free(pBundle);
+        m_loadedBundles.insert(manifest.bundleUri());
+    }
+
+    LilvNode* pUri = lilv_new_uri(m_pWorld, manifest.uri().toUtf8().constData());
+    const LilvPlugin* pPlugin = lilv_plugins_get_by_uri(
+            lilv_world_get_all_plugins(m_pWorld), pUri);
+    lilv_node_free(pUri);
+    return pPlugin;
+}
+
+// static
+LV2_URID LV2Backend::mapUri(LV2_URID_Map_Handle handle, const char* uri) {
+    LV2Backend* pBackend = static_cast<LV2Backend*>(handle);
+    QMutexLocker locker(&pBackend->m_uridMutex);
+    const QByteArray key(uri);
+    LV2_URID urid = pBackend->m_urids.value(key, 0);
+    if (urid == 0) {
+        // URIDs start at 1, 0 is reserved.
+        pBackend->m_uris.append(key);
+        urid = pBackend->m_uris.size();
+        pBackend->m_urids.insert(key, urid);
+    }
+    return urid;
+}
+
+// static
+const char* LV2Backend::unmapUri(LV2_URID_Unmap_Handle handle, LV2_URID urid) {
+    LV2Backend* pBackend = static_cast<LV2Backend*>(handle);
+    QMutexLocker locker(&pBackend->m_uridMutex);
+    if (urid == 0 || urid > static_cast<LV2_URID>(pBackend->m_uris.size())) {
+        return NULL;
+    }
+    // QList does not move its elements' data when it grows, so the pointer
+    // stays valid.
+    return pBackend->m_uris.at(urid - 1).constData();
+}
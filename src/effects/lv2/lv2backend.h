@@ -0,0 +1,99 @@
+#ifndef LV2BACKEND_H
+#define LV2BACKEND_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+#include <lilv/lilv.h>
+#include <lv2/lv2plug.in/ns/ext/urid/urid.h>
+
+#include "configobject.h"
+#include "effects/effectsbackend.h"
+#include "effects/lv2/lv2manifest.h"
+#include "effects/lv2/lv2manifestindex.h"
+
+class LV2WorkerThread;
+
+// LV2Backend offers the installed LV2 plugins as effects.
+//
+// Loading the Turtle files of all plugins with lilv is slow, so the manifests
+// are kept in an LV2ManifestIndex in the settings directory. At startup only
+// the bundle directories are listed, and lilv is only asked to load everything
+// if they changed. The bundle of a plugin is loaded when it is first
+// instantiated.
+class LV2Backend : public EffectsBackend {
+    Q_OBJECT
+  public:
+    LV2Backend(QObject* pParent, ConfigObject<ConfigValue>* pConfig);
+    virtual ~LV2Backend();
+
+    // Returns the lilv plugin of manifest, loading its bundle if necessary.
+    // Returns NULL if it is not installed anymore. Must be called from the
+    // main thread.
+    const LilvPlugin* getPlugin(const LV2Manifest& manifest);
+
+    // The manifests of all installed plugins, including the ones that are not
+    // offered as effects.
+    const QList<LV2Manifest>& manifests() const {
+        return m_index.manifests();
+    }
+
+    LV2WorkerThread* workerThread() const {
+        return m_pWorkerThread;
+    }
+    const LV2_Feature* uridMapFeature() const {
+        return &m_uridMapFeature;
+    }
+    const LV2_Feature* uridUnmapFeature() const {
+        return &m_uridUnmapFeature;
+    }
+
+  private:
+    QString debugString() const {
+        return "LV2Backend";
+    }
+
+    // Loads all plugins with lilv and replaces the index with their
+    // manifests.
+    void rebuildIndex(const LV2ManifestIndex::Fingerprint& fingerprint);
+    LV2Manifest buildManifest(const LilvPlugin* pPlugin);
+    void registerManifests();
+
+    static LV2_URID mapUri(LV2_URID_Map_Handle handle, const char* uri);
+    static const char* unmapUri(LV2_URID_Unmap_Handle handle, LV2_URID urid);
+
+    QString m_indexPath;
+    LV2ManifestIndex m_index;
+
+    LilvWorld* m_pWorld;
+    bool m_bWorldLoaded;
+    QSet<QString> m_loadedBundles;
+
+    // Nodes used to classify ports.
+    LilvNode* m_pAudioPort;
+    LilvNode* m_pControlPort;
+    LilvNode* m_pInputPort;
+    LilvNode* m_pOutputPort;
+    LilvNode* m_pConnectionOptional;
+    LilvNode* m_pToggled;
+    LilvNode* m_pInteger;
+    LilvNode* m_pLogarithmic;
+    LilvNode* m_pWorkerInterface;
+
+    LV2WorkerThread* m_pWorkerThread;
+
+    // The URID map is shared by all plugins. Plugins may map URIs from any
+    // thread, so it is locked.
+    QMutex m_uridMutex;
+    QHash<QByteArray, LV2_URID> m_urids;
+    QList<QByteArray> m_uris;
+    LV2_URID_Map m_uridMap;
+    LV2_URID_Unmap m_uridUnmap;
+    LV2_Feature m_uridMapFeature;
+    LV2_Feature m_uridUnmapFeature;
+};
+
+#endif /* LV2BACKEND_H */
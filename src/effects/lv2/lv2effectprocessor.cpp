@@ -0,0 +1,221 @@
+#include <QtDebug>
+
+#include "effects/lv2/lv2effectprocessor.h"
+#include "effects/lv2/lv2backend.h"
+#include "effects/lv2/lv2worker.h"
+#include "controlobject.h"
+#include "sampleutil.h"
+#include "util/assert.h"
+#include "util/defs.h"
+
+namespace {
+
+unsigned int currentSampleRate() {
+    unsigned int sampleRate = static_cast<unsigned int>(
+            ControlObject::get(ConfigKey("[Master]", "samplerate")));
+    return sampleRate != 0 ? sampleRate : 44100;
+}
+
+}  // anonymous namespace
+
+LV2EffectGroupState::LV2EffectGroupState()
+        : pInstance(NULL),
+          pWorker(NULL),
+          sampleRate(0) {
+    for (int i = 0; i < 2; ++i) {
+        pInput[i] = SampleUtil::alloc(MAX_BUFFER_LEN / 2);
+        pOutput[i] = SampleUtil::alloc(MAX_BUFFER_LEN / 2);
+        SampleUtil::clear(pInput[i], MAX_BUFFER_LEN / 2);
+        SampleUtil::clear(pOutput[i], MAX_BUFFER_LEN / 2);
+    }
+}
+
+LV2EffectGroupState::~LV2EffectGroupState() {
+    if (pInstance != NULL) {
+        lilv_instance_deactivate(pInstance);
+    }
+    // Stop the worker before the instance it calls into goes away.
+    delete pWorker;
+    if (pInstance != NULL) {
+        lilv_instance_free(pInstance);
+    }
+    for (int i = 0; i < 2; ++i) {
+        SampleUtil::free(pInput[i]);
+        SampleUtil::free(pOutput[i]);
+    }
+}
+
+LV2EffectProcessor::LV2EffectProcessor(EngineEffect* pEngineEffect,
+                                       const LV2Manifest& manifest,
+                                       LV2Backend* pBackend)
+        : m_manifest(manifest),
+          m_pBackend(pBackend),
+          m_pPlugin(NULL) {
+    const QList<EffectManifestParameter>& parameters =
+            m_manifest.effectManifest().parameters();
+    foreach (const EffectManifestParameter& parameter, parameters) {
+        m_parameters.append(pEngineEffect->getParameterById(parameter.id()));
+    }
+}
+
+LV2EffectProcessor::~LV2EffectProcessor() {
+    qDeleteAll(m_groupState);
+    m_groupState.clear();
+}
+
+void LV2EffectProcessor::initialize(const QSet<QString>& registeredGroups) {
+    m_pPlugin = m_pBackend->getPlugin(m_manifest);
+    if (m_pPlugin == NULL) {
+        qWarning() << debugString() << "could not load plugin";
+        return;
+    }
+
+    const unsigned int sampleRate = currentSampleRate();
+    foreach (const QString& group, registeredGroups) {
+        if (m_groupState.value(group, NULL) != NULL) {
+            continue;
+        }
+        LV2EffectGroupState* pState = instantiateGroupState(sampleRate);
+        if (pState == NULL) {
+            qWarning() << debugString() << "could not instantiate for" << group;
+            return;
+        }
+        m_groupState.insert(group, pState);
+    }
+}
+
+void LV2EffectProcessor::reserveGroup(const QString& group) {
+    if (!m_groupState.contains(group)) {
+        m_groupState.insert(group, NULL);
+    }
+}
+
+EffectGroupState* LV2EffectProcessor::createGroupState() const {
+    if (m_pPlugin == NULL) {
+        return NULL;
+    }
+    LV2EffectGroupState* pState = instantiateGroupState(currentSampleRate());
+    if (pState == NULL) {
+        qWarning() << debugString() << "could not instantiate for the bus";
+    }
+    return pState;
+}
+
+void LV2EffectProcessor::adoptGroupState(const QString& group,
+                                         EffectGroupState* pState) {
+    // The group was reserved, so this does not insert into the hash.
+    QHash<QString, LV2EffectGroupState*>::iterator it =
+            m_groupState.find(group);
+    DEBUG_ASSERT_AND_HANDLE(it != m_groupState.end() && it.value() == NULL) {
+        delete pState;
+        return;
+    }
+    it.value() = static_cast<LV2EffectGroupState*>(pState);
+}
+
+LV2EffectGroupState* LV2EffectProcessor::instantiateGroupState(
+        unsigned int sampleRate) const {
+    LV2EffectGroupState* pState = new LV2EffectGroupState();
+    pState->sampleRate = sampleRate;
+    pState->pWorker = new LV2Worker(m_pBackend->workerThread());
+
+    const LV2_Feature* features[] = {
+        m_pBackend->uridMapFeature(),
+        m_pBackend->uridUnmapFeature(),
+        pState->pWorker->scheduleFeature(),
+        NULL
+    };
+    pState->pInstance = lilv_plugin_instantiate(m_pPlugin, sampleRate, features);
+    if (pState->pInstance == NULL) {
+        delete pState;
+        return NULL;
+    }
+
+    // Connect every port now. Connecting is not realtime-safe for all
+    // plugins, and the buffers never move.
+    pState->controls.fill(0, m_manifest.numPorts());
+    pState->controlOutputs.fill(0, m_manifest.numPorts());
+    const QList<int>& controlInputs = m_manifest.controlInputPorts();
+    for (int i = 0; i < controlInputs.size(); ++i) {
+        EngineEffectParameter* pParameter = m_parameters.at(i);
+        pState->controls[controlInputs[i]] = pParameter != NULL ?
+                static_cast<float>(pParameter->value()) : 0;
+    }
+    int audioInput = 0;
+    int audioOutput = 0;
+    for (int port = 0; port < m_manifest.numPorts(); ++port) {
+        void* pLocation = NULL;
+        switch (m_manifest.portType(port)) {
+            case LV2Manifest::PORT_AUDIO_INPUT:
+                pLocation = pState->pInput[audioInput++];
+                break;
+            case LV2Manifest::PORT_AUDIO_OUTPUT:
+                pLocation = pState->pOutput[audioOutput++];
+                break;
+            case LV2Manifest::PORT_CONTROL_INPUT:
+                pLocation = &pState->controls[port];
+                break;
+            case LV2Manifest::PORT_CONTROL_OUTPUT:
+                pLocation = &pState->controlOutputs[port];
+                break;
+            case LV2Manifest::PORT_OPTIONAL:
+                break;
+        }
+        lilv_instance_connect_port(pState->pInstance, port, pLocation);
+    }
+
+    if (m_manifest.usesWorker()) {
+        const LV2_Worker_Interface* pInterface =
+                static_cast<const LV2_Worker_Interface*>(
+                        lilv_instance_get_extension_data(
+                                pState->pInstance, LV2_WORKER__interface));
+        pState->pWorker->setInterface(
+                pInterface, lilv_instance_get_handle(pState->pInstance));
+    }
+
+    lilv_instance_activate(pState->pInstance);
+    return pState;
+}
+
+void LV2EffectProcessor::process(const QString& group,
+                                 const CSAMPLE* pInput, CSAMPLE* pOutput,
+                                 const unsigned int numSamples,
+                                 const unsigned int sampleRate,
+                                 const EffectProcessor::EnableState enableState,
+                                 const GroupFeatureState& groupFeatures) {
+    Q_UNUSED(enableState);
+    Q_UNUSED(groupFeatures);
+
+    LV2EffectGroupState* pState = m_groupState.value(group, NULL);
+    // Instantiating for another sample rate is not realtime-safe. Pass the
+    // audio through until the effect is reloaded.
+    if (pState == NULL || pState->sampleRate != sampleRate) {
+        if (pInput != pOutput) {
+            SampleUtil::copy(pOutput, pInput, numSamples);
+        }
+        return;
+    }
+
+    const QList<int>& controlInputs = m_manifest.controlInputPorts();
+    for (int i = 0; i < controlInputs.size(); ++i) {
+        EngineEffectParameter* pParameter = m_parameters.at(i);
+        if (pParameter != NULL) {
+            pState->controls[controlInputs[i]] =
+                    static_cast<float>(pParameter->value());
+        }
+    }
+
+    const unsigned int numFrames = numSamples / 2;
+    for (unsigned int i = 0; i < numFrames; ++i) {
+        pState->pInput[0][i] = pInput[i * 2];
+        pState->pInput[1][i] = pInput[i * 2 + 1];
+    }
+
+    lilv_instance_run(pState->pInstance, numFrames);
+    pState->pWorker->deliverResponses();
+
+    for (unsigned int i = 0; i < numFrames; ++i) {
+        pOutput[i * 2] = pState->pOutput[0][i];
+        pOutput[i * 2 + 1] = pState->pOutput[1][i];
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef LV2EFFECTPROCESSOR_H
+#define LV2EFFECTPROCESSOR_H
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include <lilv/lilv.h>
+
+#include "effects/effectprocessor.h"
+#include "effects/lv2/lv2manifest.h"
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectparameter.h"
+#include "util.h"
+#include "util/types.h"
+
+class LV2Worker;
+class LV2WorkerThread;
+class LV2Backend;
+
+// One instance of the plugin with all of its ports connected. The buffers
+// never move, so the ports are connected once, at instantiation.
+struct LV2EffectGroupState : public EffectGroupState {
+    LV2EffectGroupState();
+    virtual ~LV2EffectGroupState();
+
+    LilvInstance* pInstance;
+    LV2Worker* pWorker;
+    unsigned int sampleRate;
+    // Non-interleaved audio buffers of MAX_BUFFER_LEN / 2 frames.
+    float* pInput[2];
+    float* pOutput[2];
+    // The values of the control input ports, indexed by port.
+    QVector<float> controls;
+    // Written by the control output ports, indexed by port. Each instance
+    // has its own since groups are processed in parallel.
+    QVector<float> controlOutputs;
+};
+
+// LV2EffectProcessor runs an LV2 plugin as an EffectProcessor. Each group gets
+// its own instance of the plugin since plugins keep state across run() calls.
+//
+// Instantiating a plugin may allocate and do I/O, so all instances are created
+// by initialize(), which runs in the main thread when the effect is loaded,
+// and deleted with the processor, which happens on the garbage collector
+// thread. The instance for the bus of a chain switched to BUS mode is created
+// by createGroupState() in the main thread as well. Groups without an
+// instance, e.g. ones registered after the effect was loaded, pass through
+// unprocessed.
+class LV2EffectProcessor : public EffectProcessor {
+  public:
+    LV2EffectProcessor(EngineEffect* pEngineEffect,
+                       const LV2Manifest& manifest,
+                       LV2Backend* pBackend);
+    virtual ~LV2EffectProcessor();
+
+    virtual void initialize(const QSet<QString>& registeredGroups);
+
+    virtual void reserveGroup(const QString& group);
+    virtual EffectGroupState* createGroupState() const;
+    virtual void adoptGroupState(const QString& group,
+                                 EffectGroupState* pState);
+
+    virtual void process(const QString& group,
+                         const CSAMPLE* pInput, CSAMPLE* pOutput,
+                         const unsigned int numSamples,
+                         const unsigned int sampleRate,
+                         const EffectProcessor::EnableState enableState,
+                         const GroupFeatureState& groupFeatures);
+
+  private:
+    QString debugString() const {
+        return QString("LV2EffectProcessor(%1)").arg(m_manifest.uri());
+    }
+
+    LV2EffectGroupState* instantiateGroupState(unsigned int sampleRate) const;
+
+    LV2Manifest m_manifest;
+    LV2Backend* m_pBackend;
+    const LilvPlugin* m_pPlugin;
+    // Indexed like m_manifest.controlInputPorts().
+    QList<EngineEffectParameter*> m_parameters;
+    QHash<QString, LV2EffectGroupState*> m_groupState;
+
+    DISALLOW_COPY_AND_ASSIGN(LV2EffectProcessor);
+};
+
+#endif /* LV2EFFECTPROCESSOR_H */
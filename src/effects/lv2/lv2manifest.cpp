@@ -0,0 +1,119 @@
+#include "effects/lv2/lv2manifest.h"
+
+void LV2Manifest::addPort(PortType type) {
+    const int port = m_iNumPorts++;
+    m_portTypes.append(type);
+    switch (type) {
+        case PORT_AUDIO_INPUT:
+            m_audioInputPorts.append(port);
+            break;
+        case PORT_AUDIO_OUTPUT:
+            m_audioOutputPorts.append(port);
+            break;
+        case PORT_CONTROL_INPUT:
+            m_controlInputPorts.append(port);
+            break;
+        default:
+            break;
+    }
+}
+
+void LV2Manifest::write(QDataStream* pStream) const {
+    QDataStream& out = *pStream;
+    out << m_uri << m_bundleUri << static_cast<qint32>(m_status)
+        << m_bUsesWorker;
+
+    out << m_effectManifest.id() << m_effectManifest.name()
+        << m_effectManifest.author() << m_effectManifest.version()
+        << m_effectManifest.description();
+
+    out << static_cast<qint32>(m_portTypes.size());
+    foreach (PortType type, m_portTypes) {
+        out << static_cast<qint32>(type);
+    }
+
+    const QList<EffectManifestParameter>& parameters =
+            m_effectManifest.parameters();
+    out << static_cast<qint32>(parameters.size());
+    foreach (const EffectManifestParameter& parameter, parameters) {
+        out << parameter.id() << parameter.name() << parameter.description()
+            << static_cast<qint32>(parameter.controlHint())
+            << static_cast<qint32>(parameter.unitsHint())
+            << parameter.getDefault() << parameter.getMinimum()
+            << parameter.getMaximum();
+        const QList<QPair<QString, double> >& steps = parameter.getSteps();
+        out << static_cast<qint32>(steps.size());
+        for (int i = 0; i < steps.size(); ++i) {
+            out << steps[i].first << steps[i].second;
+        }
+    }
+}
+
+bool LV2Manifest::read(QDataStream* pStream) {
+    QDataStream& in = *pStream;
+    qint32 status;
+    in >> m_uri >> m_bundleUri >> status >> m_bUsesWorker;
+    if (status < 0 || status >= NUM_STATUS) {
+        return false;
+    }
+    m_status = static_cast<Status>(status);
+
+    QString id, name, author, version, description;
+    in >> id >> name >> author >> version >> description;
+    m_effectManifest = EffectManifest();
+    m_effectManifest.setId(id);
+    m_effectManifest.setName(name);
+    m_effectManifest.setAuthor(author);
+    m_effectManifest.setVersion(version);
+    m_effectManifest.setDescription(description);
+
+    m_iNumPorts = 0;
+    m_portTypes.clear();
+    m_audioInputPorts.clear();
+    m_audioOutputPorts.clear();
+    m_controlInputPorts.clear();
+    qint32 numPorts;
+    in >> numPorts;
+    for (qint32 i = 0; i < numPorts && in.status() == QDataStream::Ok; ++i) {
+        qint32 type;
+        in >> type;
+        if (type < PORT_AUDIO_INPUT || type > PORT_OPTIONAL) {
+            return false;
+        }
+        addPort(static_cast<PortType>(type));
+    }
+
+    qint32 numParameters;
+    in >> numParameters;
+    for (qint32 i = 0; i < numParameters && in.status() == QDataStream::Ok; ++i) {
+        QString parameterId, parameterName, parameterDescription;
+        qint32 controlHint, unitsHint;
+        double defaultValue, minimum, maximum;
+        in >> parameterId >> parameterName >> parameterDescription
+           >> controlHint >> unitsHint >> defaultValue >> minimum >> maximum;
+
+        EffectManifestParameter* pParameter = m_effectManifest.addParameter();
+        pParameter->setId(parameterId);
+        pParameter->setName(parameterName);
+        pParameter->setDescription(parameterDescription);
+        pParameter->setControlHint(
+                static_cast<EffectManifestParameter::ControlHint>(controlHint));
+        pParameter->setUnitsHint(
+                static_cast<EffectManifestParameter::UnitsHint>(unitsHint));
+        pParameter->setDefault(defaultValue);
+        pParameter->setMinimum(minimum);
+        pParameter->setMaximum(maximum);
+
+        qint32 numSteps;
+        in >> numSteps;
+        for (qint32 j = 0; j < numSteps && in.status() == QDataStream::Ok; ++j) {
+            QString stepName;
+            double stepValue;
+            in >> stepName >> stepValue;
+            pParameter->appendStep(qMakePair(stepName, stepValue));
+        }
+    }
+
+    return in.status() == QDataStream::Ok &&
+            m_controlInputPorts.size() == m_effectManifest.parameters().size();
+}
@@ -0,0 +1,127 @@
+#ifndef LV2MANIFEST_H
+#define LV2MANIFEST_H
+
+#include <QDataStream>
+#include <QList>
+#include <QString>
+
+#include "effects/effectmanifest.h"
+
+// LV2Manifest describes an LV2 plugin as far as the LV2Backend needs to know
+// it: the EffectManifest shown to the rest of Mixxx and the ports that have to
+// be connected when the plugin is instantiated.
+//
+// It is plain data so that it can be stored in the LV2ManifestIndex. Reading
+// the manifests from the index at startup is much faster than loading the
+// Turtle files of every installed plugin with lilv.
+class LV2Manifest {
+  public:
+    enum Status {
+        AVAILABLE = 0,
+        // We only process stereo. Plugins with a different number of audio
+        // ports are not offered.
+        IO_NOT_STEREO,
+        // The plugin requires a host feature we do not provide.
+        HAS_REQUIRED_FEATURES,
+        // The plugin has a port that we do not know how to connect.
+        HAS_UNSUPPORTED_PORTS,
+        NUM_STATUS
+    };
+
+    enum PortType {
+        PORT_AUDIO_INPUT = 0,
+        PORT_AUDIO_OUTPUT,
+        PORT_CONTROL_INPUT,
+        PORT_CONTROL_OUTPUT,
+        // Ports of other types that are lv2:connectionOptional are connected
+        // to NULL.
+        PORT_OPTIONAL,
+    };
+
+    LV2Manifest()
+            : m_status(NUM_STATUS),
+              m_iNumPorts(0),
+              m_bUsesWorker(false) {
+    }
+
+    const QString& uri() const {
+        return m_uri;
+    }
+    void setUri(const QString& uri) {
+        m_uri = uri;
+    }
+
+    // The URI of the bundle that contains the plugin. Only this bundle needs
+    // to be loaded to instantiate the plugin.
+    const QString& bundleUri() const {
+        return m_bundleUri;
+    }
+    void setBundleUri(const QString& bundleUri) {
+        m_bundleUri = bundleUri;
+    }
+
+    Status status() const {
+        return m_status;
+    }
+    void setStatus(Status status) {
+        m_status = status;
+    }
+    bool isAvailable() const {
+        return m_status == AVAILABLE;
+    }
+
+    const EffectManifest& effectManifest() const {
+        return m_effectManifest;
+    }
+    EffectManifest* effectManifestPointer() {
+        return &m_effectManifest;
+    }
+
+    int numPorts() const {
+        return m_iNumPorts;
+    }
+    PortType portType(int port) const {
+        return m_portTypes.at(port);
+    }
+    void addPort(PortType type);
+
+    // The audio ports, left first.
+    const QList<int>& audioInputPorts() const {
+        return m_audioInputPorts;
+    }
+    const QList<int>& audioOutputPorts() const {
+        return m_audioOutputPorts;
+    }
+
+    // The control input ports, in the order of the parameters of the
+    // EffectManifest.
+    const QList<int>& controlInputPorts() const {
+        return m_controlInputPorts;
+    }
+
+    // True if the plugin provides the LV2 worker interface.
+    bool usesWorker() const {
+        return m_bUsesWorker;
+    }
+    void setUsesWorker(bool usesWorker) {
+        m_bUsesWorker = usesWorker;
+    }
+
+    void write(QDataStream* pStream) const;
+    // Returns false if the stream ended early or is corrupt.
+    bool read(QDataStream* pStream);
+
+  private:
+    QString m_uri;
+    QString m_bundleUri;
+    Status m_status;
+    EffectManifest m_effectManifest;
+    int m_iNumPorts;
+    QList<PortType> m_portTypes;
+    QList<int> m_audioInputPorts;
+    QList<int> m_audioOutputPorts;
+    QList<int> m_controlInputPorts;
+    bool m_bUsesWorker;
+};
+
+#endif /* LV2MANIFEST_H */
@@ -0,0 +1,151 @@
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtDebug>
+
+#include "effects/lv2/lv2manifestindex.h"
+
+namespace {
+
+const quint32 kIndexMagic = 0x4c56324d; // "LV2M"
+// Increase when the format of LV2Manifest::write() changes.
+const quint32 kIndexVersion = 1;
+
+}  // anonymous namespace
+
+// static
+QStringList LV2ManifestIndex::searchPaths() {
+    QString lv2Path = QString::fromLocal8Bit(qgetenv("LV2_PATH"));
+    if (!lv2Path.isEmpty()) {
+#ifdef __WINDOWS__
+        return lv2Path.split(';', QString::SkipEmptyParts);
+#else
+        return lv2Path.split(':', QString::SkipEmptyParts);
+#endif
+    }
+
+    // The default search path of lilv.
+    QStringList paths;
+#if defined(__APPLE__)
+    paths << QDir::homePath() + "/Library/Audio/Plug-Ins/LV2"
+          << QDir::homePath() + "/.lv2"
+          << "/usr/local/lib/lv2"
+          << "/usr/lib/lv2"
+          << "/Library/Audio/Plug-Ins/LV2";
+#elif defined(__WINDOWS__)
+    paths << QString::fromLocal8Bit(qgetenv("APPDATA")) + "/LV2"
+          << QString::fromLocal8Bit(qgetenv("COMMONPROGRAMFILES")) + "/LV2";
+#else
+    paths << QDir::homePath() + "/.lv2"
+          << "/usr/local/lib/lv2"
+          << "/usr/lib/lv2";
+#endif
+    return paths;
+}
+
+// static
+LV2ManifestIndex::Fingerprint LV2ManifestIndex::scanBundles(
+        const QStringList& searchPaths) {
+    QList<QPair<QString, qint64> > bundles;
+    foreach (const QString& searchPath, searchPaths) {
+        QDir dir(searchPath);
+        if (!dir.exists()) {
+            continue;
+        }
+        QStringList bundleDirs = dir.entryList(
+                QStringList() << "*.lv2", QDir::Dirs | QDir::NoDotAndDotDot);
+        foreach (const QString& bundleDir, bundleDirs) {
+            // Installing or updating a bundle rewrites manifest.ttl.
+            QFileInfo manifest(dir.filePath(bundleDir) + "/manifest.ttl");
+            if (!manifest.exists()) {
+                continue;
+            }
+            bundles.append(qMakePair(manifest.canonicalFilePath(),
+                                     static_cast<qint64>(
+                                         manifest.lastModified().toTime_t())));
+        }
+    }
+    qSort(bundles);
+    return bundles;
+}
+
+void LV2ManifestIndex::clear() {
+    m_fingerprint.clear();
+    m_manifests.clear();
+}
+
+bool LV2ManifestIndex::load(const QString& path) {
+    clear();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != kIndexMagic || version != kIndexVersion) {
+        return false;
+    }
+
+    qint32 numBundles;
+    in >> numBundles;
+    for (qint32 i = 0; i < numBundles && in.status() == QDataStream::Ok; ++i) {
+        QString bundle;
+        qint64 modified;
+        in >> bundle >> modified;
+        m_fingerprint.append(qMakePair(bundle, modified));
+    }
+
+    qint32 numManifests;
+    in >> numManifests;
+    for (qint32 i = 0; i < numManifests && in.status() == QDataStream::Ok; ++i) {
+        LV2Manifest manifest;
+        if (!manifest.read(&in)) {
+            qWarning() << "LV2ManifestIndex: corrupt index" << path;
+            clear();
+            return false;
+        }
+        m_manifests.append(manifest);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool LV2ManifestIndex::save(const QString& path) const {
+    // Write to a temporary file first so that a crash does not leave a
+    // truncated index behind.
+    const QString tempPath = path + ".tmp";
+    QFile file(tempPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "LV2ManifestIndex: could not write" << tempPath;
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+
+    out << kIndexMagic << kIndexVersion;
+    out << static_cast<qint32>(m_fingerprint.size());
+    for (int i = 0; i < m_fingerprint.size(); ++i) {
+        out << m_fingerprint[i].first << m_fingerprint[i].second;
+    }
+    out << static_cast<qint32>(m_manifests.size());
+    foreach (const LV2Manifest& manifest, m_manifests) {
+        manifest.write(&out);
+    }
+    file.close();
+    if (out.status() != QDataStream::Ok) {
+        QFile::remove(tempPath);
+        return false;
+    }
+
+    QFile::remove(path);
+    return QFile::rename(tempPath, path);
+}
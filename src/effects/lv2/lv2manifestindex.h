@@ -0,0 +1,57 @@
+#ifndef LV2MANIFESTINDEX_H
+#define LV2MANIFESTINDEX_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+#include "effects/lv2/lv2manifest.h"
+
+// LV2ManifestIndex caches the LV2Manifests of all installed LV2 plugins on
+// disk.
+//
+// The index is only valid for the set of bundles it was built from. A
+// fingerprint lists every bundle directory found in the LV2 search path with
+// the modification time of its manifest.ttl. It is cheap to compute, so at
+// startup the fingerprint is compared to the stored one. Only if a bundle was
+// added, removed or updated does the LV2Backend have to load all plugins with
+// lilv and rebuild the index.
+class LV2ManifestIndex {
+  public:
+    typedef QList<QPair<QString, qint64> > Fingerprint;
+
+    // The directories that are searched for LV2 bundles. Honors LV2_PATH.
+    static QStringList searchPaths();
+
+    // Returns the bundles found in searchPaths, sorted by path.
+    static Fingerprint scanBundles(const QStringList& searchPaths);
+
+    LV2ManifestIndex() { }
+
+    const Fingerprint& fingerprint() const {
+        return m_fingerprint;
+    }
+    void setFingerprint(const Fingerprint& fingerprint) {
+        m_fingerprint = fingerprint;
+    }
+
+    const QList<LV2Manifest>& manifests() const {
+        return m_manifests;
+    }
+    void addManifest(const LV2Manifest& manifest) {
+        m_manifests.append(manifest);
+    }
+    void clear();
+
+    // Returns false if there is no index at path or it is corrupt or of
+    // another format version. The index is empty then.
+    bool load(const QString& path);
+    bool save(const QString& path) const;
+
+  private:
+    Fingerprint m_fingerprint;
+    QList<LV2Manifest> m_manifests;
+};
+
+#endif /* LV2MANIFESTINDEX_H */
@@ -0,0 +1,181 @@
+#include <string.h>
+
+#include "effects/lv2/lv2worker.h"
+
+namespace {
+
+// Requests and responses are usually small (a path, a pointer to a loaded
+// buffer). Larger ones are refused with LV2_WORKER_ERR_NO_SPACE.
+const uint32_t kMaxMessageSize = 4096;
+const int kFifoSize = 16 * kMaxMessageSize;
+
+// How often the worker thread looks for new requests. Plugins schedule work
+// like loading a file, which takes much longer than this anyway.
+const unsigned long kPollMillis = 5;
+
+// Copies size bytes of data into the one or two regions of a ring buffer
+// write, starting at offset.
+void copyToRegions(char* pRegion1, ring_buffer_size_t size1,
+                   char* pRegion2, int offset,
+                   const char* data, int size) {
+    for (int i = 0; i < size; ++i, ++offset) {
+        if (offset < size1) {
+            pRegion1[offset] = data[i];
+        } else {
+            pRegion2[offset - size1] = data[i];
+        }
+    }
+}
+
+}  // anonymous namespace
+
+LV2Worker::LV2Worker(LV2WorkerThread* pThread)
+        : m_pThread(pThread),
+          m_pInterface(NULL),
+          m_instance(NULL),
+          m_requests(kFifoSize),
+          m_responses(kFifoSize),
+          m_pRequestBuffer(new char[kMaxMessageSize]),
+          m_pResponseBuffer(new char[kMaxMessageSize]) {
+    m_schedule.handle = this;
+    m_schedule.schedule_work = &LV2Worker::scheduleWork;
+    m_scheduleFeature.URI = LV2_WORKER__schedule;
+    m_scheduleFeature.data = &m_schedule;
+}
+
+LV2Worker::~LV2Worker() {
+    if (m_pInterface != NULL) {
+        // Waits for a running work() of this worker to finish.
+        m_pThread->removeWorker(this);
+    }
+    delete [] m_pRequestBuffer;
+    delete [] m_pResponseBuffer;
+}
+
+void LV2Worker::setInterface(const LV2_Worker_Interface* pInterface,
+                             LV2_Handle instance) {
+    if (pInterface == NULL || pInterface->work == NULL) {
+        return;
+    }
+    m_pInterface = pInterface;
+    m_instance = instance;
+    m_pThread->addWorker(this);
+}
+
+// static
+bool LV2Worker::writeMessage(FIFO<char>* pFifo, uint32_t size, const void* data) {
+    const int total = sizeof(size) + size;
+    if (size > kMaxMessageSize || pFifo->writeAvailable() < total) {
+        return false;
+    }
+    // Both parts are published at once, so the reader never sees a header
+    // without its data.
+    char* pRegion1;
+    char* pRegion2;
+    ring_buffer_size_t size1, size2;
+    pFifo->aquireWriteRegions(total, &pRegion1, &size1, &pRegion2, &size2);
+    copyToRegions(pRegion1, size1, pRegion2, 0,
+                  reinterpret_cast<const char*>(&size), sizeof(size));
+    copyToRegions(pRegion1, size1, pRegion2, sizeof(size),
+                  static_cast<const char*>(data), size);
+    pFifo->releaseWriteRegions(total);
+    return true;
+}
+
+// static
+bool LV2Worker::readMessage(FIFO<char>* pFifo, char* pBuffer, uint32_t* pSize) {
+    if (pFifo->readAvailable() < static_cast<int>(sizeof(*pSize))) {
+        return false;
+    }
+    pFifo->read(reinterpret_cast<char*>(pSize), sizeof(*pSize));
+    pFifo->read(pBuffer, *pSize);
+    return true;
+}
+
+// static
+LV2_Worker_Status LV2Worker::scheduleWork(LV2_Worker_Schedule_Handle handle,
+                                          uint32_t size, const void* data) {
+    LV2Worker* pWorker = static_cast<LV2Worker*>(handle);
+    if (pWorker->m_pInterface == NULL) {
+        return LV2_WORKER_ERR_UNKNOWN;
+    }
+    if (!writeMessage(&pWorker->m_requests, size, data)) {
+        return LV2_WORKER_ERR_NO_SPACE;
+    }
+    pWorker->m_pThread->wake();
+    return LV2_WORKER_SUCCESS;
+}
+
+// static
+LV2_Worker_Status LV2Worker::respond(LV2_Worker_Respond_Handle handle,
+                                     uint32_t size, const void* data) {
+    LV2Worker* pWorker = static_cast<LV2Worker*>(handle);
+    if (!writeMessage(&pWorker->m_responses, size, data)) {
+        return LV2_WORKER_ERR_NO_SPACE;
+    }
+    return LV2_WORKER_SUCCESS;
+}
+
+void LV2Worker::runRequests() {
+    uint32_t size;
+    while (readMessage(&m_requests, m_pRequestBuffer, &size)) {
+        m_pInterface->work(m_instance, &LV2Worker::respond, this,
+                           size, m_pRequestBuffer);
+    }
+}
+
+void LV2Worker::deliverResponses() {
+    if (m_pInterface == NULL) {
+        return;
+    }
+    uint32_t size;
+    while (readMessage(&m_responses, m_pResponseBuffer, &size)) {
+        if (m_pInterface->work_response != NULL) {
+            m_pInterface->work_response(m_instance, size, m_pResponseBuffer);
+        }
+    }
+    if (m_pInterface->end_run != NULL) {
+        m_pInterface->end_run(m_instance);
+    }
+}
+
+LV2WorkerThread::LV2WorkerThread(QObject* pParent)
+        : QThread(pParent),
+          m_pending(0),
+          m_bStop(false) {
+    setObjectName("LV2Worker");
+}
+
+LV2WorkerThread::~LV2WorkerThread() {
+    stop();
+}
+
+void LV2WorkerThread::addWorker(LV2Worker* pWorker) {
+    QMutexLocker locker(&m_workersMutex);
+    m_workers.append(pWorker);
+}
+
+void LV2WorkerThread::removeWorker(LV2Worker* pWorker) {
+    QMutexLocker locker(&m_workersMutex);
+    m_workers.removeAll(pWorker);
+}
+
+void LV2WorkerThread::stop() {
+    m_bStop = true;
+    wait();
+}
+
+void LV2WorkerThread::run() {
+    while (!m_bStop) {
+        // Wakeups that piled up since the last poll are served by one pass.
+        if (m_pending.fetchAndStoreAcquire(0) == 0) {
+            msleep(kPollMillis);
+            continue;
+        }
+
+        QMutexLocker locker(&m_workersMutex);
+        foreach (LV2Worker* pWorker, m_workers) {
+            pWorker->runRequests();
+        }
+    }
+}
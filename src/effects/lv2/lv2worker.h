@@ -0,0 +1,105 @@
+#ifndef LV2WORKER_H
+#define LV2WORKER_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+
+#include <lv2/lv2plug.in/ns/ext/worker/worker.h>
+
+#include "util/fifo.h"
+
+class LV2WorkerThread;
+
+// LV2Worker implements the LV2 worker extension for one plugin instance.
+//
+// A plugin calls schedule_work() from run() to have slow work, like loading an
+// impulse response or a sample, done outside of the audio thread. The request
+// is copied into a lock-free FIFO, where the LV2WorkerThread picks it up on
+// its next poll and calls the work() method of the plugin with it. The plugin answers through respond(), which
+// goes into a second FIFO that deliverResponses() passes back to the plugin in
+// the audio thread after the next run().
+class LV2Worker {
+  public:
+    explicit LV2Worker(LV2WorkerThread* pThread);
+    virtual ~LV2Worker();
+
+    // The LV2_WORKER__schedule feature to pass to lilv_plugin_instantiate().
+    const LV2_Feature* scheduleFeature() const {
+        return &m_scheduleFeature;
+    }
+
+    // Sets the worker interface of the instantiated plugin and registers with
+    // the LV2WorkerThread. Does nothing if pInterface is NULL.
+    void setInterface(const LV2_Worker_Interface* pInterface,
+                      LV2_Handle instance);
+
+    // Called from the audio thread after run(). Delivers the responses of the
+    // plugin's work to it and signals the end of the run cycle.
+    void deliverResponses();
+
+    // Called from the LV2WorkerThread. Runs all pending requests.
+    void runRequests();
+
+  private:
+    static LV2_Worker_Status scheduleWork(LV2_Worker_Schedule_Handle handle,
+                                          uint32_t size, const void* data);
+    static LV2_Worker_Status respond(LV2_Worker_Respond_Handle handle,
+                                     uint32_t size, const void* data);
+
+    // Writes size and data as one message. Returns false if it does not fit.
+    static bool writeMessage(FIFO<char>* pFifo, uint32_t size, const void* data);
+    // Reads the next message into pBuffer, which must hold kMaxMessageSize
+    // bytes. Returns false if there is none.
+    static bool readMessage(FIFO<char>* pFifo, char* pBuffer, uint32_t* pSize);
+
+    LV2WorkerThread* m_pThread;
+    const LV2_Worker_Interface* m_pInterface;
+    LV2_Handle m_instance;
+
+    LV2_Worker_Schedule m_schedule;
+    LV2_Feature m_scheduleFeature;
+
+    // Audio thread -> worker thread.
+    FIFO<char> m_requests;
+    // Worker thread -> audio thread.
+    FIFO<char> m_responses;
+    // Scratch space for reading messages. Requests are read by the worker
+    // thread and responses by the audio thread, so each has its own.
+    char* m_pRequestBuffer;
+    char* m_pResponseBuffer;
+};
+
+// LV2WorkerThread runs the work() of all LV2Workers. The LV2 worker extension
+// requires that the work of an instance is not run concurrently, which a
+// single thread guarantees. The audio thread must not touch a semaphore or a
+// wait condition, so the thread polls a flag that wake() sets instead.
+class LV2WorkerThread : public QThread {
+    Q_OBJECT
+  public:
+    LV2WorkerThread(QObject* pParent = NULL);
+    virtual ~LV2WorkerThread();
+
+    void addWorker(LV2Worker* pWorker);
+    void removeWorker(LV2Worker* pWorker);
+
+    // Has the thread run the requests on its next poll. Lock-free, so it is
+    // safe to call from the audio thread.
+    void wake() {
+        m_pending.fetchAndStoreRelease(1);
+    }
+
+    void stop();
+
+  protected:
+    void run();
+
+  private:
+    QMutex m_workersMutex;
+    QList<LV2Worker*> m_workers;
+    QAtomicInt m_pending;
+    volatile bool m_bStop;
+};
+
+#endif /* LV2WORKER_H */
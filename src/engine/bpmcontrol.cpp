@@ -35,7 +35,6 @@ BpmControl::BpmControl(QString group,
         m_sGroup(group) {
     m_pPlayButton = new ControlObjectSlave(group, "play", this);
     m_pPlayButton->connectValueChanged(SLOT(slotControlPlay(double)), Qt::DirectConnection);
-    m_pReverseButton = new ControlObjectSlave(group, "reverse", this);
     m_pRateSlider = new ControlObjectSlave(group, "rate", this);
     m_pRateSlider->connectValueChanged(SLOT(slotAdjustRateSlider()), Qt::DirectConnection);
     m_pQuantize = ControlObject::getControl(group, "quantize");
@@ -389,7 +388,7 @@ double BpmControl::shortestPercentageChange(const double& current_percentage,
     }
 }
 
-double BpmControl::calcSyncedRate(double userTweak) {
+double BpmControl::calcSyncedRate(const DeckParams& params, double userTweak) {
     double rate = 1.0;
     // Don't know what to do if there's no bpm.
     if (m_pLocalBpm->get() != 0.0) {
@@ -398,8 +397,8 @@ double BpmControl::calcSyncedRate(double userTweak) {
 
     // If we are not quantized, or there are no beats, or we're master,
     // or we're in reverse, just return the rate as-is.
-    if (!m_pQuantize->get() || getSyncMode() == SYNC_MASTER ||
-            m_pBeats == NULL || m_pReverseButton->get()) {
+    if (!params.quantize || getSyncMode() == SYNC_MASTER ||
+            m_pBeats == NULL || params.reverse) {
         m_resetSyncAdjustment = true;
         return rate + userTweak;
     }
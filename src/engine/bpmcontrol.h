@@ -7,6 +7,7 @@
 #include <gtest/gtest_prod.h>
 
 #include "controlobject.h"
+#include "engine/deckparams.h"
 #include "engine/enginecontrol.h"
 #include "engine/sync/syncable.h"
 #include "tapfilter.h"
@@ -34,7 +35,7 @@ class BpmControl : public EngineControl {
     // that value is added to the rate by bpmcontrol.  The rate may be
     // further adjusted if bpmcontrol discovers that the tracks have fallen
     // out of sync.
-    double calcSyncedRate(double userTweak);
+    double calcSyncedRate(const DeckParams& params, double userTweak);
     // Get the phase offset from the specified position.
     double getPhaseOffset(double reference_position);
     double getBeatDistance(double dThisPosition) const;
@@ -104,7 +105,6 @@ class BpmControl : public EngineControl {
 
     // ControlObjects that come from EngineBuffer
     ControlObjectSlave* m_pPlayButton;
-    ControlObjectSlave* m_pReverseButton;
     ControlObjectSlave* m_pRateSlider;
     ControlObject* m_pQuantize;
     ControlObjectSlave* m_pRateRange;
@@ -0,0 +1,83 @@
+#include "engine/deckparams.h"
+
+#include "controlobjectslave.h"
+
+DeckParams::DeckParams()
+        : sampleRate(0.0),
+          rateSearch(0.0),
+          scratch2(0.0),
+          vinylControlMode(0),
+          play(false),
+          fwd(false),
+          back(false),
+          reverse(false),
+          repeat(false),
+          quantize(false),
+          scratch2Enable(false),
+          scratch2Scratching(false),
+          vinylControlEnabled(false),
+          vinylControlScratching(false) {
+}
+
+DeckParamsJournal::DeckParamsJournal(const QString& group, QObject* pParent)
+        : QObject(pParent),
+          m_changed(0) {
+    m_pSampleRate = watch("[Master]", "samplerate");
+    m_pRateSearch = watch(group, "rateSearch");
+    m_pScratch2 = watch(group, "scratch2");
+    m_pVinylControlMode = watch(group, "vinylcontrol_mode");
+    m_pPlay = watch(group, "play");
+    m_pFwd = watch(group, "fwd");
+    m_pBack = watch(group, "back");
+    m_pReverse = watch(group, "reverse");
+    m_pRepeat = watch(group, "repeat");
+    m_pQuantize = watch(group, "quantize");
+    m_pScratch2Enable = watch(group, "scratch2_enable");
+    m_pScratch2Scratching = watch(group, "scratch2_indicates_scratching");
+    m_pVinylControlEnabled = watch(group, "vinylcontrol_enabled");
+    m_pVinylControlScratching = watch(group, "vinylcontrol_scratching");
+    readControls();
+}
+
+DeckParamsJournal::~DeckParamsJournal() {
+}
+
+ControlObjectSlave* DeckParamsJournal::watch(const QString& group,
+                                             const QString& item) {
+    ControlObjectSlave* pControl = new ControlObjectSlave(group, item, this);
+    // Noted in the thread that changes the control.
+    pControl->connectValueChanged(this, SLOT(slotControlChanged(double)),
+                                  Qt::DirectConnection);
+    return pControl;
+}
+
+void DeckParamsJournal::slotControlChanged(double value) {
+    Q_UNUSED(value);
+    m_changed.fetchAndStoreRelease(1);
+}
+
+const DeckParams& DeckParamsJournal::update() {
+    // The flag is cleared before reading, so a change that races with the
+    // reads is picked up by the next update().
+    if (m_changed.fetchAndStoreAcquire(0)) {
+        readControls();
+    }
+    return m_params;
+}
+
+void DeckParamsJournal::readControls() {
+    m_params.sampleRate = m_pSampleRate->get();
+    m_params.rateSearch = m_pRateSearch->get();
+    m_params.scratch2 = m_pScratch2->get();
+    m_params.vinylControlMode = static_cast<int>(m_pVinylControlMode->get());
+    m_params.play = m_pPlay->get() != 0.0;
+    m_params.fwd = m_pFwd->get() != 0.0;
+    m_params.back = m_pBack->get() != 0.0;
+    m_params.reverse = m_pReverse->get() != 0.0;
+    m_params.repeat = m_pRepeat->get() != 0.0;
+    m_params.quantize = m_pQuantize->get() > 0.0;
+    m_params.scratch2Enable = m_pScratch2Enable->get() != 0.0;
+    m_params.scratch2Scratching = m_pScratch2Scratching->get() != 0.0;
+    m_params.vinylControlEnabled = m_pVinylControlEnabled->toBool();
+    m_params.vinylControlScratching = m_pVinylControlScratching->toBool();
+}
@@ -0,0 +1,86 @@
+#ifndef DECKPARAMS_H
+#define DECKPARAMS_H
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QString>
+
+class ControlObjectSlave;
+
+// The values of the controls of a deck that EngineBuffer::process and its
+// EngineControls read every callback. They are packed into a single cache line
+// instead of being scattered over dozens of ControlObjects on the heap.
+struct DeckParams {
+    DeckParams();
+
+    double sampleRate;
+    double rateSearch;
+    double scratch2;
+    int vinylControlMode;
+    bool play;
+    bool fwd;
+    bool back;
+    bool reverse;
+    bool repeat;
+    bool quantize;
+    bool scratch2Enable;
+    bool scratch2Scratching;
+    bool vinylControlEnabled;
+    bool vinylControlScratching;
+};
+
+// DeckParamsJournal keeps the DeckParams of a deck up to date. Whenever one of
+// the controls changes, in whatever thread, it is noted in the journal. The
+// engine reads all controls into the snapshot at the start of the next
+// callback. While nothing changes, which is the case for most callbacks, the
+// engine does not read any control at all.
+//
+// A change shows up in the DeckParams only after the next update(), even if
+// the engine made it itself during the callback. Callers that need to see
+// their own changes must call update() again after making them.
+//
+// All controls must exist when the journal is created. Controls that never do,
+// like the vinyl controls when vinyl control is not available, read as 0.
+class DeckParamsJournal : public QObject {
+    Q_OBJECT
+  public:
+    explicit DeckParamsJournal(const QString& group, QObject* pParent = NULL);
+    virtual ~DeckParamsJournal();
+
+    // Refreshes the snapshot if a control changed and returns it. The
+    // returned reference stays valid and reflects later updates. Must only be
+    // called from the engine callback.
+    const DeckParams& update();
+
+    // Returns the DeckParams of the last update().
+    inline const DeckParams& params() const {
+        return m_params;
+    }
+
+  private slots:
+    void slotControlChanged(double value);
+
+  private:
+    ControlObjectSlave* watch(const QString& group, const QString& item);
+    void readControls();
+
+    DeckParams m_params;
+    QAtomicInt m_changed;
+
+    ControlObjectSlave* m_pSampleRate;
+    ControlObjectSlave* m_pRateSearch;
+    ControlObjectSlave* m_pScratch2;
+    ControlObjectSlave* m_pVinylControlMode;
+    ControlObjectSlave* m_pPlay;
+    ControlObjectSlave* m_pFwd;
+    ControlObjectSlave* m_pBack;
+    ControlObjectSlave* m_pReverse;
+    ControlObjectSlave* m_pRepeat;
+    ControlObjectSlave* m_pQuantize;
+    ControlObjectSlave* m_pScratch2Enable;
+    ControlObjectSlave* m_pScratch2Scratching;
+    ControlObjectSlave* m_pVinylControlEnabled;
+    ControlObjectSlave* m_pVinylControlScratching;
+};
+
+#endif /* DECKPARAMS_H */
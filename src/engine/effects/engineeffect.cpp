@@ -1,4 +1,5 @@
 #include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectchain.h"
 #include "sampleutil.h"
 
 
@@ -20,6 +21,9 @@ EngineEffect::EngineEffect(const EffectManifest& manifest,
     // Creating the processor must come last.
     m_pProcessor = pInstantiator->instantiate(this, manifest);
     m_pProcessor->initialize(registeredGroups);
+    // The chain may be switched to BUS mode later. Its state is sent by the
+    // main thread then, and the engine must not grow the processor's hash.
+    m_pProcessor->reserveGroup(EngineEffectChain::busGroup());
     m_effectRampsFromDry = manifest.effectRampsFromDry();
 }
 
@@ -118,7 +122,9 @@ void EngineEffect::process(const QString& group,
                     numSamples);
         }
     }
+}
 
+void EngineEffect::onCallbackEnd() {
     if (m_enableState == EffectProcessor::DISABLING) {
         m_enableState = EffectProcessor::DISABLED;
     } else if (m_enableState == EffectProcessor::ENABLING) {
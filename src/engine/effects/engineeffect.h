@@ -41,6 +41,29 @@ class EngineEffect : public EffectsRequestHandler {
                  const EffectProcessor::EnableState enableState,
                  const GroupFeatureState& groupFeatures);
 
+    // Allocates the processor state for group. Called from the engine thread
+    // before group may be processed in parallel with other groups.
+    void prepareGroup(const QString& group) {
+        m_pProcessor->prepareGroup(group);
+    }
+
+    // Creates the processor state for a group on the main thread. Returns NULL
+    // if the processor keeps no state per group.
+    EffectGroupState* createGroupState() const {
+        return m_pProcessor->createGroupState();
+    }
+
+    // Hands the state from createGroupState() to the processor as the state
+    // of the bus group, which is reserved on construction. Called from the
+    // engine thread.
+    void adoptGroupState(const QString& group, EffectGroupState* pState) {
+        m_pProcessor->adoptGroupState(group, pState);
+    }
+
+    // Finishes enabling or disabling the effect once every group has been
+    // processed in this callback.
+    void onCallbackEnd();
+
     bool enabled() const {
         return m_enableState != EffectProcessor::DISABLED;
     }
@@ -2,20 +2,47 @@
 
 #include "engine/effects/engineeffect.h"
 #include "sampleutil.h"
+#include "util/assert.h"
+#include "util/compatibility.h"
 #include "util/defs.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+// Weight of the latest callback in the smoothed CPU usage.
+const double kCpuUsageSmoothing = 0.05;
+
+}  // anonymous namespace
+
+// static
+const QString& EngineEffectChain::busGroup() {
+    static const QString group = "[EffectBus]";
+    return group;
+}
 
 EngineEffectChain::EngineEffectChain(const QString& id)
         : m_id(id),
           m_enableState(EffectProcessor::ENABLED),
           m_insertionType(EffectChain::INSERT),
+          m_groupInsertionType(EffectChain::INSERT),
           m_dMix(0),
-          m_pBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)) {
+          m_pBusBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
+          m_bBusHasInput(false),
+          m_oldReturnGain(0),
+          m_callbackNanos(0),
+          m_dCpuUsage(0),
+          m_cpuUsagePpm(0) {
     // Try to prevent memory allocation.
     m_effects.reserve(256);
 }
 
 EngineEffectChain::~EngineEffectChain() {
-    SampleUtil::free(m_pBuffer);
+    SampleUtil::free(m_pBusBuffer);
+    for (QLinkedList<GroupStatus>::iterator it = m_groupStatus.begin(),
+                 end = m_groupStatus.end(); it != end; ++it) {
+        SampleUtil::free(it->pBuffer);
+    }
 }
 
 bool EngineEffectChain::addEffect(EngineEffect* pEffect, int iIndex) {
@@ -67,7 +94,16 @@ bool EngineEffectChain::removeEffect(EngineEffect* pEffect, int iIndex) {
 bool EngineEffectChain::updateParameters(const EffectsRequest& message) {
     // TODO(rryan): Parameter interpolation.
     m_insertionType = message.SetEffectChainParameters.insertion_type;
+    if (m_insertionType != EffectChain::BUS) {
+        m_groupInsertionType = m_insertionType;
+    }
     m_dMix = message.SetEffectChainParameters.mix;
+    for (int i = 0; i < message.busGroupStates.size(); ++i) {
+        const QPair<EngineEffect*, EffectGroupState*>& busGroupState =
+                message.busGroupStates.at(i);
+        busGroupState.first->adoptGroupState(busGroup(),
+                                             busGroupState.second);
+    }
 
     if (m_enableState != EffectProcessor::DISABLED && !message.SetEffectParameters.enabled) {
         m_enableState = EffectProcessor::DISABLING;
@@ -112,14 +148,26 @@ bool EngineEffectChain::processEffectsRequest(const EffectsRequest& message,
                 qDebug() << debugString() << "ENABLE_EFFECT_CHAIN_FOR_GROUP"
                          << message.group;
             }
-            response.success = enableForGroup(message.group);
+            response.success = enableForGroup(message.group,
+                                              message.pGroupBuffer);
             break;
         case EffectsRequest::DISABLE_EFFECT_CHAIN_FOR_GROUP:
             if (kEffectDebugOutput) {
                 qDebug() << debugString() << "DISABLE_EFFECT_CHAIN_FOR_GROUP"
                          << message.group;
             }
-            response.success = disableForGroup(message.group);
+            response.success = disableForGroup(message.group,
+                                               message.pGroupBuffer);
+            break;
+        case EffectsRequest::SET_EFFECT_CHAIN_GROUP_SEND_LEVEL:
+            if (kEffectDebugOutput) {
+                qDebug() << debugString() << "SET_EFFECT_CHAIN_GROUP_SEND_LEVEL"
+                         << message.group
+                         << message.SetEffectChainGroupSendLevel.send_level;
+            }
+            response.success = setGroupSendLevel(
+                message.group, message.pGroupBuffer,
+                message.SetEffectChainGroupSendLevel.send_level);
             break;
         default:
             return false;
@@ -128,33 +176,204 @@ bool EngineEffectChain::processEffectsRequest(const EffectsRequest& message,
     return true;
 }
 
-bool EngineEffectChain::enableForGroup(const QString& group) {
-    GroupStatus& status = getGroupStatus(group);
-    if (status.enable_state != EffectProcessor::ENABLED) {
-        status.enable_state = EffectProcessor::ENABLING;
+bool EngineEffectChain::enableForGroup(const QString& group,
+                                       CSAMPLE* pGroupBuffer) {
+    GroupStatus* pStatus = getGroupStatus(group, pGroupBuffer);
+    if (pStatus == NULL) {
+        return false;
+    }
+    if (pStatus->enable_state != EffectProcessor::ENABLED) {
+        pStatus->enable_state = EffectProcessor::ENABLING;
     }
     return true;
 }
 
-bool EngineEffectChain::disableForGroup(const QString& group) {
-    GroupStatus& status = getGroupStatus(group);
-    if (status.enable_state != EffectProcessor::DISABLED) {
-        status.enable_state = EffectProcessor::DISABLING;
+bool EngineEffectChain::disableForGroup(const QString& group,
+                                        CSAMPLE* pGroupBuffer) {
+    GroupStatus* pStatus = getGroupStatus(group, pGroupBuffer);
+    if (pStatus == NULL) {
+        return false;
+    }
+    if (pStatus->enable_state != EffectProcessor::DISABLED) {
+        pStatus->enable_state = EffectProcessor::DISABLING;
     }
     return true;
 }
 
-EngineEffectChain::GroupStatus& EngineEffectChain::getGroupStatus(const QString& group) {
+bool EngineEffectChain::setGroupSendLevel(const QString& group,
+                                          CSAMPLE* pGroupBuffer,
+                                          double level) {
+    GroupStatus* pStatus = getGroupStatus(group, pGroupBuffer);
+    if (pStatus == NULL) {
+        return false;
+    }
+    pStatus->send_level = level;
+    return true;
+}
+
+EngineEffectChain::GroupStatus* EngineEffectChain::getGroupStatus(
+        const QString& group, CSAMPLE* pGroupBuffer) {
+    GroupStatus* pStatus = findGroupStatus(group);
+    if (pStatus != NULL) {
+        // The main thread only sends a buffer with the first request for a
+        // group.
+        DEBUG_ASSERT(pGroupBuffer == NULL);
+        return pStatus;
+    }
+    DEBUG_ASSERT_AND_HANDLE(pGroupBuffer != NULL) {
+        return NULL;
+    }
+    GroupStatus status(group);
+    status.pBuffer = pGroupBuffer;
+    m_groupStatus.append(status);
+    return &m_groupStatus.last();
+}
+
+EngineEffectChain::GroupStatus* EngineEffectChain::findGroupStatus(const QString& group) {
     for (QLinkedList<GroupStatus>::iterator it = m_groupStatus.begin(),
                  end = m_groupStatus.end(); it != end; ++it) {
-        GroupStatus& status = *it;
-        if (status.group == group) {
-            return status;
+        if (it->group == group) {
+            return &(*it);
+        }
+    }
+    return NULL;
+}
+
+void EngineEffectChain::prepareGroup(const QString& group) {
+    GroupStatus* pGroupInfo = findGroupStatus(group);
+    if (m_enableState == EffectProcessor::DISABLED || pGroupInfo == NULL ||
+            pGroupInfo->enable_state == EffectProcessor::DISABLED) {
+        return;
+    }
+    for (int i = 0; i < m_effects.size(); ++i) {
+        EngineEffect* pEffect = m_effects[i];
+        if (pEffect != NULL) {
+            pEffect->prepareGroup(group);
         }
     }
-    GroupStatus status(group);
-    m_groupStatus.append(status);
-    return m_groupStatus.last();
+}
+
+void EngineEffectChain::onCallbackEnd(const unsigned int numSamples,
+                                      const unsigned int sampleRate) {
+    if (m_enableState == EffectProcessor::DISABLING) {
+        m_enableState = EffectProcessor::DISABLED;
+    } else if (m_enableState == EffectProcessor::ENABLING) {
+        m_enableState = EffectProcessor::ENABLED;
+    }
+
+    for (int i = 0; i < m_effects.size(); ++i) {
+        EngineEffect* pEffect = m_effects[i];
+        if (pEffect != NULL) {
+            pEffect->onCallbackEnd();
+        }
+    }
+
+    if (numSamples == 0 || sampleRate == 0) {
+        return;
+    }
+    // numSamples are stereo interleaved.
+    const double periodNanos = 1e9 * numSamples / 2 / sampleRate;
+    const double usage = m_callbackNanos.fetchAndStoreRelaxed(0) / periodNanos;
+    m_dCpuUsage += kCpuUsageSmoothing * (usage - m_dCpuUsage);
+    m_cpuUsagePpm = static_cast<int>(math_min(m_dCpuUsage, 1.0) * 1000000);
+}
+
+double EngineEffectChain::cpuUsage() const {
+    return load_atomic(m_cpuUsagePpm) / 1000000.0;
+}
+
+void EngineEffectChain::sendToBus(const QString& group,
+                                  const CSAMPLE* pInput,
+                                  const CSAMPLE gain,
+                                  const unsigned int numSamples) {
+    const bool busMode = m_insertionType == EffectChain::BUS &&
+            m_enableState != EffectProcessor::DISABLED;
+    // Keep sending while processBus() ramps out the return.
+    if (!busMode && m_oldReturnGain == 0) {
+        return;
+    }
+    GroupStatus* pGroupInfo = findGroupStatus(group);
+    if (pGroupInfo == NULL ||
+            pGroupInfo->enable_state == EffectProcessor::DISABLED) {
+        return;
+    }
+    GroupStatus& group_info = *pGroupInfo;
+
+    // Ramp the send in and out when the group is enabled or disabled.
+    CSAMPLE send_gain = group_info.enable_state == EffectProcessor::DISABLING ?
+            0 : group_info.send_level * gain;
+    if (!m_bBusHasInput) {
+        SampleUtil::copyWithRampingGain(m_pBusBuffer, pInput,
+                                        group_info.old_send_gain, send_gain,
+                                        numSamples);
+        m_bBusHasInput = true;
+    } else {
+        SampleUtil::addWithRampingGain(m_pBusBuffer, pInput,
+                                       group_info.old_send_gain, send_gain,
+                                       numSamples);
+    }
+    group_info.old_send_gain = send_gain;
+
+    // process() does not touch the group in BUS mode, so the group ramp
+    // ends here.
+    if (busMode) {
+        if (group_info.enable_state == EffectProcessor::DISABLING) {
+            group_info.enable_state = EffectProcessor::DISABLED;
+        } else if (group_info.enable_state == EffectProcessor::ENABLING) {
+            group_info.enable_state = EffectProcessor::ENABLED;
+        }
+    }
+}
+
+void EngineEffectChain::processBus(CSAMPLE* pOutput,
+                                   const unsigned int numSamples,
+                                   const unsigned int sampleRate) {
+    const bool busMode = m_insertionType == EffectChain::BUS &&
+            m_enableState != EffectProcessor::DISABLED;
+    if (!busMode && m_oldReturnGain == 0) {
+        m_bBusHasInput = false;
+        return;
+    }
+
+    PerformanceTimer timer;
+    timer.start();
+    if (!m_bBusHasInput) {
+        // Nothing was sent, but the effects may still have a tail.
+        SampleUtil::clear(m_pBusBuffer, numSamples);
+    }
+    m_bBusHasInput = false;
+
+    // When the chain is disabled or leaves BUS mode, the return ramps out
+    // over one more buffer of the bus.
+    const bool rampOut = !busMode ||
+            m_enableState == EffectProcessor::DISABLING;
+    const EffectProcessor::EnableState busEnableState = rampOut ?
+            EffectProcessor::DISABLING : m_enableState;
+    GroupFeatureState busFeatures;
+    for (int i = 0; i < m_effects.size(); ++i) {
+        EngineEffect* pEffect = m_effects[i];
+        if (pEffect == NULL || !pEffect->enabled()) {
+            continue;
+        }
+        pEffect->process(busGroup(), m_pBusBuffer, m_pBusBuffer,
+                         numSamples, sampleRate, busEnableState, busFeatures);
+    }
+
+    CSAMPLE return_gain = rampOut ? 0 : m_dMix;
+    SampleUtil::addWithRampingGain(pOutput, m_pBusBuffer,
+                                   m_oldReturnGain, return_gain, numSamples);
+    m_oldReturnGain = return_gain;
+
+    if (!busMode) {
+        // The sends stopped with the switch. Ramp them in again if the chain
+        // returns to BUS mode.
+        for (QLinkedList<GroupStatus>::iterator it = m_groupStatus.begin(),
+                     end = m_groupStatus.end(); it != end; ++it) {
+            it->old_send_gain = 0;
+        }
+    }
+
+    m_callbackNanos.fetchAndAddRelaxed(static_cast<int>(timer.elapsed()));
 }
 
 void EngineEffectChain::process(const QString& group,
@@ -162,7 +381,12 @@ void EngineEffectChain::process(const QString& group,
                                 const unsigned int numSamples,
                                 const unsigned int sampleRate,
                                 const GroupFeatureState& groupFeatures) {
-    GroupStatus& group_info = getGroupStatus(group);
+    GroupStatus* pGroupInfo = findGroupStatus(group);
+    if (pGroupInfo == NULL) {
+        // The chain was never enabled for this group.
+        return;
+    }
+    GroupStatus& group_info = *pGroupInfo;
 
     if (m_enableState == EffectProcessor::DISABLED
             || group_info.enable_state == EffectProcessor::DISABLED) {
@@ -171,9 +395,21 @@ void EngineEffectChain::process(const QString& group,
         return;
     }
 
+    // In BUS mode the group is sent to the bus by sendToBus() instead. Right
+    // after a switch to BUS the wet signal that the chain mixed into the
+    // group is ramped out over one more buffer.
+    const bool rampOutForBus = m_insertionType == EffectChain::BUS;
+    if (rampOutForBus && group_info.old_gain == 0) {
+        return;
+    }
+
+    PerformanceTimer timer;
+    timer.start();
+    CSAMPLE* pBuffer = group_info.pBuffer;
+
     EffectProcessor::EnableState effectiveEnableState = group_info.enable_state;
 
-    if (m_enableState == EffectProcessor::DISABLING) {
+    if (m_enableState == EffectProcessor::DISABLING || rampOutForBus) {
         effectiveEnableState = EffectProcessor::DISABLING;
     } else if (m_enableState == EffectProcessor::ENABLING) {
         effectiveEnableState = EffectProcessor::ENABLING;
@@ -181,11 +417,14 @@ void EngineEffectChain::process(const QString& group,
 
     // At this point either the chain and group are enabled or we are ramping
     // out. If we are ramping out then ramp to 0 instead of m_dMix.
-    CSAMPLE wet_gain = m_dMix;
+    CSAMPLE wet_gain = rampOutForBus ? 0 : m_dMix;
     CSAMPLE wet_gain_old = group_info.old_gain;
+    // The group is ramped out in the mode it was processed in before.
+    const EffectChain::InsertionType insertionType = rampOutForBus ?
+            m_groupInsertionType : m_insertionType;
 
     // INSERT mode: output = input * (1-wet) + effect(input) * wet
-    if (m_insertionType == EffectChain::INSERT) {
+    if (insertionType == EffectChain::INSERT) {
         if (wet_gain_old == 1.0 && wet_gain == 1.0) {
             // Fully wet, no ramp, insert optimization. No temporary buffer needed.
             for (int i = 0; i < m_effects.size(); ++i) {
@@ -201,7 +440,7 @@ void EngineEffectChain::process(const QString& group,
             // Fully dry, no ramp, insert optimization. No action is needed
         } else {
             // Clear scratch buffer.
-            SampleUtil::clear(m_pBuffer, numSamples);
+            SampleUtil::clear(pBuffer, numSamples);
 
             // Chain each effect
             bool anyProcessed = false;
@@ -210,8 +449,8 @@ void EngineEffectChain::process(const QString& group,
                 if (pEffect == NULL || !pEffect->enabled()) {
                     continue;
                 }
-                const CSAMPLE* pIntermediateInput = (i == 0) ? pInOut : m_pBuffer;
-                CSAMPLE* pIntermediateOutput = m_pBuffer;
+                const CSAMPLE* pIntermediateInput = (i == 0) ? pInOut : pBuffer;
+                CSAMPLE* pIntermediateOutput = pBuffer;
                 pEffect->process(group, pIntermediateInput, pIntermediateOutput,
                                  numSamples, sampleRate,
                                  effectiveEnableState, groupFeatures);
@@ -219,17 +458,17 @@ void EngineEffectChain::process(const QString& group,
             }
 
             if (anyProcessed) {
-                // m_pBuffer now contains the fully wet output.
+                // pBuffer now contains the fully wet output.
                 // TODO(rryan): benchmark applyGain followed by addWithGain versus
                 // copy2WithGain.
                 SampleUtil::copy2WithRampingGain(
                     pInOut, pInOut, 1.0 - wet_gain_old, 1.0 - wet_gain,
-                    m_pBuffer, wet_gain_old, wet_gain, numSamples);
+                    pBuffer, wet_gain_old, wet_gain, numSamples);
             }
         }
     } else { // SEND mode: output = input + effect(input) * wet
         // Clear scratch buffer.
-        SampleUtil::applyGain(m_pBuffer, 0.0, numSamples);
+        SampleUtil::applyGain(pBuffer, 0.0, numSamples);
 
         // Chain each effect
         bool anyProcessed = false;
@@ -238,8 +477,8 @@ void EngineEffectChain::process(const QString& group,
             if (pEffect == NULL || !pEffect->enabled()) {
                 continue;
             }
-            const CSAMPLE* pIntermediateInput = (i == 0) ? pInOut : m_pBuffer;
-            CSAMPLE* pIntermediateOutput = m_pBuffer;
+            const CSAMPLE* pIntermediateInput = (i == 0) ? pInOut : pBuffer;
+            CSAMPLE* pIntermediateOutput = pBuffer;
             pEffect->process(group, pIntermediateInput,
                              pIntermediateOutput, numSamples, sampleRate,
                              effectiveEnableState, groupFeatures);
@@ -247,8 +486,8 @@ void EngineEffectChain::process(const QString& group,
         }
 
         if (anyProcessed) {
-            // m_pBuffer now contains the fully wet output.
-            SampleUtil::addWithRampingGain(pInOut, m_pBuffer,
+            // pBuffer now contains the fully wet output.
+            SampleUtil::addWithRampingGain(pInOut, pBuffer,
                                            wet_gain_old, wet_gain, numSamples);
         }
     }
@@ -256,15 +495,16 @@ void EngineEffectChain::process(const QString& group,
     // Update GroupStatus with the latest values.
     group_info.old_gain = wet_gain;
 
-    if (m_enableState == EffectProcessor::DISABLING) {
-        m_enableState = EffectProcessor::DISABLED;
-    } else if (m_enableState == EffectProcessor::ENABLING) {
-        m_enableState = EffectProcessor::ENABLED;
+    // The chain and effect enable states are advanced in onCallbackEnd()
+    // since other groups may still be processed in this callback. In BUS
+    // mode sendToBus() advances the state of the group.
+    if (!rampOutForBus) {
+        if (group_info.enable_state == EffectProcessor::DISABLING) {
+            group_info.enable_state = EffectProcessor::DISABLED;
+        } else if (group_info.enable_state == EffectProcessor::ENABLING) {
+            group_info.enable_state = EffectProcessor::ENABLED;
+        }
     }
 
-    if (group_info.enable_state == EffectProcessor::DISABLING) {
-        group_info.enable_state = EffectProcessor::DISABLED;
-    } else if (group_info.enable_state == EffectProcessor::ENABLING) {
-        group_info.enable_state = EffectProcessor::ENABLED;
-    }
+    m_callbackNanos.fetchAndAddRelaxed(static_cast<int>(timer.elapsed()));
 }
@@ -4,6 +4,7 @@
 #include <QString>
 #include <QList>
 #include <QLinkedList>
+#include <QAtomicInt>
 
 #include "util.h"
 #include "util/types.h"
@@ -32,18 +33,64 @@ class EngineEffectChain : public EffectsRequestHandler {
         return m_id;
     }
 
+    // The group under which the effects of a chain in BUS mode keep the
+    // state of the bus. An effect is only ever part of one chain, so it is
+    // unique.
+    static const QString& busGroup();
+
     bool enabledForGroup(const QString& group) const;
 
+    // Adds pInput of group, scaled by gain and the send level of the group,
+    // to the bus of the chain. Only has an effect in BUS mode, where
+    // process() leaves the channels alone. Must be called from the engine
+    // thread, serially.
+    void sendToBus(const QString& group,
+                   const CSAMPLE* pInput,
+                   const CSAMPLE gain,
+                   const unsigned int numSamples);
+
+    // In BUS mode, processes the bus once and mixes the wet return into
+    // pOutput at the chain mix. The bus keeps being processed while the
+    // chain is enabled so that tails of e.g. a reverb can decay. Once the
+    // chain is disabled or leaves BUS mode the return ramps out over one
+    // more buffer.
+    void processBus(CSAMPLE* pOutput,
+                    const unsigned int numSamples,
+                    const unsigned int sampleRate);
+
+    // Allocates the state of all effects in the chain for group. Called from
+    // the engine thread before the groups of a callback are processed in
+    // parallel.
+    void prepareGroup(const QString& group);
+
+    // Called from the engine thread once every group has been processed in
+    // this callback. Finishes enable state ramps and updates cpuUsage().
+    void onCallbackEnd(const unsigned int numSamples,
+                       const unsigned int sampleRate);
+
+    // The smoothed fraction of the audio callback period spent processing
+    // this chain, summed over all groups. Safe to call from any thread.
+    double cpuUsage() const;
+
   private:
     struct GroupStatus {
         GroupStatus(const QString& group)
                 : group(group),
                   old_gain(0),
-                  enable_state(EffectProcessor::DISABLED) {
+                  enable_state(EffectProcessor::DISABLED),
+                  send_level(1.0),
+                  old_send_gain(0),
+                  pBuffer(NULL) {
         }
         QString group;
         CSAMPLE old_gain;
         EffectProcessor::EnableState enable_state;
+        // Only used in BUS mode.
+        CSAMPLE send_level;
+        CSAMPLE old_send_gain;
+        // Scratch buffer of this group so that groups can be processed in
+        // parallel.
+        CSAMPLE* pBuffer;
     };
 
     QString debugString() const {
@@ -53,20 +100,39 @@ class EngineEffectChain : public EffectsRequestHandler {
     bool updateParameters(const EffectsRequest& message);
     bool addEffect(EngineEffect* pEffect, int iIndex);
     bool removeEffect(EngineEffect* pEffect, int iIndex);
-    bool enableForGroup(const QString& group);
-    bool disableForGroup(const QString& group);
+    bool enableForGroup(const QString& group, CSAMPLE* pGroupBuffer);
+    bool disableForGroup(const QString& group, CSAMPLE* pGroupBuffer);
+    bool setGroupSendLevel(const QString& group, CSAMPLE* pGroupBuffer,
+                           double level);
 
     // Gets or creates a GroupStatus entry in m_groupStatus for the provided
-    // group.
-    GroupStatus& getGroupStatus(const QString& group);
+    // group. A new entry uses pGroupBuffer, which the main thread allocated
+    // for it. Returns NULL if there is no entry and pGroupBuffer is NULL.
+    GroupStatus* getGroupStatus(const QString& group, CSAMPLE* pGroupBuffer);
+    // Returns the GroupStatus entry for group or NULL if there is none. Does
+    // not modify m_groupStatus so it may be called from parallel process()
+    // calls.
+    GroupStatus* findGroupStatus(const QString& group);
 
     QString m_id;
     EffectProcessor::EnableState m_enableState;
     EffectChain::InsertionType m_insertionType;
+    // The last insertion type other than BUS, which the groups are ramped
+    // out with after a switch to BUS.
+    EffectChain::InsertionType m_groupInsertionType;
     CSAMPLE m_dMix;
     QList<EngineEffect*> m_effects;
-    CSAMPLE* m_pBuffer;
     QLinkedList<GroupStatus> m_groupStatus;
+    // The bus that the groups are sent to in BUS mode.
+    CSAMPLE* m_pBusBuffer;
+    bool m_bBusHasInput;
+    CSAMPLE m_oldReturnGain;
+    // Nanoseconds spent in process() during the current callback, summed
+    // over all groups.
+    QAtomicInt m_callbackNanos;
+    double m_dCpuUsage;
+    // m_dCpuUsage in millionths, for reading from other threads.
+    QAtomicInt m_cpuUsagePpm;
 
     DISALLOW_COPY_AND_ASSIGN(EngineEffectChain);
 };
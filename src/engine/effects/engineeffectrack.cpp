@@ -54,6 +54,35 @@ void EngineEffectRack::process(const QString& group,
     }
 }
 
+void EngineEffectRack::sendToBuses(const QString& group,
+                                   const CSAMPLE* pInput,
+                                   const CSAMPLE gain,
+                                   const unsigned int numSamples) {
+    foreach (EngineEffectChain* pChain, m_chains) {
+        if (pChain != NULL) {
+            pChain->sendToBus(group, pInput, gain, numSamples);
+        }
+    }
+}
+
+void EngineEffectRack::processBuses(CSAMPLE* pOutput,
+                                    const unsigned int numSamples,
+                                    const unsigned int sampleRate) {
+    foreach (EngineEffectChain* pChain, m_chains) {
+        if (pChain != NULL) {
+            pChain->processBus(pOutput, numSamples, sampleRate);
+        }
+    }
+}
+
+void EngineEffectRack::prepareGroup(const QString& group) {
+    foreach (EngineEffectChain* pChain, m_chains) {
+        if (pChain != NULL) {
+            pChain->prepareGroup(group);
+        }
+    }
+}
+
 bool EngineEffectRack::addEffectChain(EngineEffectChain* pChain, int iIndex) {
     if (iIndex < 0) {
         if (kEffectDebugOutput) {
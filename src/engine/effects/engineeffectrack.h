@@ -23,6 +23,16 @@ class EngineEffectRack : public EffectsRequestHandler {
                  const unsigned int sampleRate,
                  const GroupFeatureState& groupFeatures);
 
+    void sendToBuses(const QString& group,
+                     const CSAMPLE* pInput,
+                     const CSAMPLE gain,
+                     const unsigned int numSamples);
+    void processBuses(CSAMPLE* pOutput,
+                      const unsigned int numSamples,
+                      const unsigned int sampleRate);
+
+    void prepareGroup(const QString& group);
+
     int number() const {
         return m_iRackNumber;
     }
@@ -3,9 +3,11 @@
 #include "engine/effects/engineeffectrack.h"
 #include "engine/effects/engineeffectchain.h"
 #include "engine/effects/engineeffect.h"
+#include "engine/enginegarbagecollector.h"
 
 EngineEffectsManager::EngineEffectsManager(EffectsResponsePipe* pResponsePipe)
-        : m_pResponsePipe(pResponsePipe) {
+        : m_pResponsePipe(pResponsePipe),
+          m_pGarbageCollector(NULL) {
     // Try to prevent memory allocation.
     m_racks.reserve(256);
     m_chains.reserve(256);
@@ -15,6 +17,18 @@ EngineEffectsManager::EngineEffectsManager(EffectsResponsePipe* pResponsePipe)
 EngineEffectsManager::~EngineEffectsManager() {
 }
 
+template <typename T>
+void EngineEffectsManager::retire(T* pObject) {
+    // The object is no longer reachable from the callback. It is deleted by
+    // the garbage collector once this callback has completed.
+    if (m_pGarbageCollector) {
+        m_pGarbageCollector->retireFromEngine(pObject);
+    } else if (kEffectDebugOutput) {
+        qDebug() << debugString()
+                 << "WARNING: no garbage collector, leaking" << pObject;
+    }
+}
+
 void EngineEffectsManager::onCallbackStart() {
     EffectsRequest* request = NULL;
     while (m_pResponsePipe->readMessages(&request, 1) > 0) {
@@ -25,6 +39,9 @@ void EngineEffectsManager::onCallbackStart() {
             case EffectsRequest::REMOVE_EFFECT_RACK:
                 if (processEffectsRequest(*request, m_pResponsePipe.data())) {
                     processed = true;
+                    if (request->type == EffectsRequest::REMOVE_EFFECT_RACK) {
+                        retire(request->RemoveEffectRack.pRack);
+                    }
                 }
                 break;
             case EffectsRequest::ADD_CHAIN_TO_RACK:
@@ -49,6 +66,7 @@ void EngineEffectsManager::onCallbackStart() {
                             m_chains.append(request->AddChainToRack.pChain);
                         } else if (request->type == EffectsRequest::REMOVE_CHAIN_FROM_RACK) {
                             m_chains.removeAll(request->RemoveChainFromRack.pChain);
+                            retire(request->RemoveChainFromRack.pChain);
                         }
                     } else {
                         if (!processed) {
@@ -65,6 +83,7 @@ void EngineEffectsManager::onCallbackStart() {
             case EffectsRequest::SET_EFFECT_CHAIN_PARAMETERS:
             case EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_GROUP:
             case EffectsRequest::DISABLE_EFFECT_CHAIN_FOR_GROUP:
+            case EffectsRequest::SET_EFFECT_CHAIN_GROUP_SEND_LEVEL:
                 if (!m_chains.contains(request->pTargetChain)) {
                     if (kEffectDebugOutput) {
                         qDebug() << debugString()
@@ -85,6 +104,7 @@ void EngineEffectsManager::onCallbackStart() {
                             m_effects.append(request->AddEffectToChain.pEffect);
                         } else if (request->type == EffectsRequest::REMOVE_EFFECT_FROM_CHAIN) {
                             m_effects.removeAll(request->RemoveEffectFromChain.pEffect);
+                            retire(request->RemoveEffectFromChain.pEffect);
                         }
                     } else {
                         if (!processed) {
@@ -140,6 +160,36 @@ void EngineEffectsManager::process(const QString& group,
     }
 }
 
+void EngineEffectsManager::sendToBuses(const QString& group,
+                                       const CSAMPLE* pInput,
+                                       const CSAMPLE gain,
+                                       const unsigned int numSamples) {
+    foreach (EngineEffectRack* pRack, m_racks) {
+        pRack->sendToBuses(group, pInput, gain, numSamples);
+    }
+}
+
+void EngineEffectsManager::processBuses(CSAMPLE* pOutput,
+                                        const unsigned int numSamples,
+                                        const unsigned int sampleRate) {
+    foreach (EngineEffectRack* pRack, m_racks) {
+        pRack->processBuses(pOutput, numSamples, sampleRate);
+    }
+}
+
+void EngineEffectsManager::prepareGroup(const QString& group) {
+    foreach (EngineEffectRack* pRack, m_racks) {
+        pRack->prepareGroup(group);
+    }
+}
+
+void EngineEffectsManager::onCallbackEnd(const unsigned int numSamples,
+                                         const unsigned int sampleRate) {
+    foreach (EngineEffectChain* pChain, m_chains) {
+        pChain->onCallbackEnd(numSamples, sampleRate);
+    }
+}
+
 bool EngineEffectsManager::addEffectRack(EngineEffectRack* pRack) {
     if (m_racks.contains(pRack)) {
         if (kEffectDebugOutput) {
@@ -11,14 +11,33 @@
 class EngineEffectRack;
 class EngineEffectChain;
 class EngineEffect;
+class EngineGarbageCollector;
 
 class EngineEffectsManager : public EffectsRequestHandler {
   public:
     EngineEffectsManager(EffectsResponsePipe* pResponsePipe);
     virtual ~EngineEffectsManager();
 
+    // Removed racks, chains and effects are retired to pGarbageCollector once
+    // the engine no longer uses them.
+    void setGarbageCollector(EngineGarbageCollector* pGarbageCollector) {
+        m_pGarbageCollector = pGarbageCollector;
+    }
+
     void onCallbackStart();
 
+    // Called at the end of the callback, after all groups have been
+    // processed. Finishes the enable and disable ramps of chains and effects
+    // and updates the CPU usage of each chain.
+    void onCallbackEnd(const unsigned int numSamples,
+                       const unsigned int sampleRate);
+
+    // Prepares every chain enabled for group to process it. Must be called
+    // from the engine thread for each group that is processed in parallel
+    // with other groups during this callback. Allocates on the first call
+    // for a group.
+    void prepareGroup(const QString& group);
+
     // Take a buffer of numSamples samples of audio from group, provided as
     // pInput, and apply each EffectChain enabled for this group to it,
     // putting the resulting output in pOutput. If pInput is equal to pOutput,
@@ -26,12 +45,28 @@ class EngineEffectsManager : public EffectsRequestHandler {
     // represented as stereo interleaved samples. There are numSamples total
     // samples, so numSamples/2 left channel samples and numSamples/2 right
     // channel samples.
+    //
+    // Different groups may be processed concurrently once prepareGroup() was
+    // called for them. A single group must not.
     virtual void process(const QString& group,
                          CSAMPLE* pInOut,
                          const unsigned int numSamples,
                          const unsigned int sampleRate,
                          const GroupFeatureState& groupFeatures);
 
+    // Sends pInput of group, scaled by gain, to every chain in BUS mode that
+    // is enabled for group. Call for each channel before processBuses().
+    void sendToBuses(const QString& group,
+                     const CSAMPLE* pInput,
+                     const CSAMPLE gain,
+                     const unsigned int numSamples);
+
+    // Processes the bus of every chain in BUS mode once and mixes the returns
+    // into pOutput.
+    void processBuses(CSAMPLE* pOutput,
+                      const unsigned int numSamples,
+                      const unsigned int sampleRate);
+
     bool processEffectsRequest(
         const EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
@@ -44,7 +79,11 @@ class EngineEffectsManager : public EffectsRequestHandler {
     bool addEffectRack(EngineEffectRack* pRack);
     bool removeEffectRack(EngineEffectRack* pRack);
 
+    template <typename T>
+    void retire(T* pObject);
+
     QScopedPointer<EffectsResponsePipe> m_pResponsePipe;
+    EngineGarbageCollector* m_pGarbageCollector;
     QList<EngineEffectRack*> m_racks;
     QList<EngineEffectChain*> m_chains;
     QList<EngineEffect*> m_effects;
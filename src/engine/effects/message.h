@@ -3,9 +3,12 @@
 
 #include <QVariant>
 #include <QString>
+#include <QList>
+#include <QPair>
 #include <QtGlobal>
 
 #include "util/fifo.h"
+#include "util/types.h"
 #include "effects/effectchain.h"
 
 const bool kEffectDebugOutput = false;
@@ -13,6 +16,7 @@ const bool kEffectDebugOutput = false;
 class EngineEffectRack;
 class EngineEffectChain;
 class EngineEffect;
+class EffectGroupState;
 
 struct EffectsRequest {
     enum MessageType {
@@ -30,6 +34,7 @@ struct EffectsRequest {
         REMOVE_EFFECT_FROM_CHAIN,
         ENABLE_EFFECT_CHAIN_FOR_GROUP,
         DISABLE_EFFECT_CHAIN_FOR_GROUP,
+        SET_EFFECT_CHAIN_GROUP_SEND_LEVEL,
 
         // Messages for EngineEffect
         SET_EFFECT_PARAMETERS,
@@ -45,7 +50,8 @@ struct EffectsRequest {
               minimum(0.0),
               maximum(0.0),
               default_value(0.0),
-              value(0.0) {
+              value(0.0),
+              pGroupBuffer(NULL) {
         pTargetRack = NULL;
         pTargetChain = NULL;
         pTargetEffect = NULL;
@@ -57,6 +63,7 @@ struct EffectsRequest {
         CLEAR_STRUCT(AddEffectToChain);
         CLEAR_STRUCT(RemoveEffectFromChain);
         CLEAR_STRUCT(SetEffectChainParameters);
+        CLEAR_STRUCT(SetEffectChainGroupSendLevel);
         CLEAR_STRUCT(SetEffectParameters);
         CLEAR_STRUCT(SetParameterParameters);
 #undef CLEAR_STRUCT
@@ -77,6 +84,7 @@ struct EffectsRequest {
         // - SET_EFFECT_CHAIN_PARAMETERS
         // - ENABLE_EFFECT_CHAIN_FOR_GROUP
         // - DISABLE_EFFECT_CHAIN_FOR_GROUP
+        // - SET_EFFECT_CHAIN_GROUP_SEND_LEVEL
         EngineEffectChain* pTargetChain;
         // Used by:
         // - SET_EFFECT_PARAMETER
@@ -112,6 +120,9 @@ struct EffectsRequest {
             EffectChain::InsertionType insertion_type;
             double mix;
         } SetEffectChainParameters;
+        struct {
+            double send_level;
+        } SetEffectChainGroupSendLevel;
         struct {
             bool enabled;
         } SetEffectParameters;
@@ -124,7 +135,8 @@ struct EffectsRequest {
     // Message-specific, non-POD values that can't be part of the above union.
     ////////////////////////////////////////////////////////////////////////////
 
-    // Used by ENABLE_EFFECT_CHAIN_FOR_GROUP and DISABLE_EFFECT_CHAIN_FOR_GROUP.
+    // Used by ENABLE_EFFECT_CHAIN_FOR_GROUP, DISABLE_EFFECT_CHAIN_FOR_GROUP and
+    // SET_EFFECT_CHAIN_GROUP_SEND_LEVEL.
     QString group;
 
     // Used by SET_EFFECT_PARAMETER.
@@ -132,6 +144,17 @@ struct EffectsRequest {
     double maximum;
     double default_value;
     double value;
+
+    // Used by ENABLE_EFFECT_CHAIN_FOR_GROUP, DISABLE_EFFECT_CHAIN_FOR_GROUP and
+    // SET_EFFECT_CHAIN_GROUP_SEND_LEVEL. Allocated by the main thread for the
+    // first request that names group so that the engine does not have to. The
+    // EngineEffectChain takes ownership of it.
+    CSAMPLE* pGroupBuffer;
+
+    // Used by SET_EFFECT_CHAIN_PARAMETERS. The bus state of each effect that
+    // was added to the chain before it was switched to BUS mode, created by
+    // the main thread. The EngineEffects take ownership of them.
+    QList<QPair<EngineEffect*, EffectGroupState*> > busGroupStates;
 };
 
 struct EffectsResponse {
@@ -35,6 +35,7 @@
 #include "engine/engineworkerscheduler.h"
 #include "engine/readaheadmanager.h"
 #include "engine/enginecontrol.h"
+#include "engine/deckparams.h"
 #include "engine/loopingcontrol.h"
 #include "engine/ratecontrol.h"
 #include "engine/bpmcontrol.h"
@@ -227,7 +228,6 @@ EngineBuffer::EngineBuffer(QString group, ConfigObject<ConfigValue>* _config,
     // quantization (alignment) of loop in/out positions and (hot)cues with
     // beats.
     addControl(new QuantizeControl(group, _config));
-    m_pQuantize = ControlObject::getControl(ConfigKey(group, "quantize"));
 
     // Create the Loop Controller
     m_pLoopingControl = new LoopingControl(group, _config);
@@ -256,9 +256,6 @@ EngineBuffer::EngineBuffer(QString group, ConfigObject<ConfigValue>* _config,
     m_pSyncControl->setEngineControls(m_pRateControl, m_pBpmControl);
     pMixingEngine->getEngineSync()->addSyncableDeck(m_pSyncControl);
 
-    m_fwdButton = ControlObject::getControl(ConfigKey(group, "fwd"));
-    m_backButton = ControlObject::getControl(ConfigKey(group, "back"));
-
     m_pKeyControl = new KeyControl(group, _config);
     addControl(m_pKeyControl);
 
@@ -286,6 +283,9 @@ EngineBuffer::EngineBuffer(QString group, ConfigObject<ConfigValue>* _config,
     }
     enableIndependentPitchTempoScaling(false);
 
+    // All controls of the deck exist now.
+    m_pDeckParamsJournal = new DeckParamsJournal(group, this);
+
     m_pPassthroughEnabled.reset(new ControlObjectSlave(group, "passthrough", this));
     m_pPassthroughEnabled->connectValueChanged(this, SLOT(slotPassthroughChanged(double)),
                                                Qt::DirectConnection);
@@ -721,6 +721,8 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
         return;
     }
     m_pReader->process();
+    // Read the controls of the deck at most once per callback.
+    const DeckParams& params = m_pDeckParamsJournal->update();
     // Steps:
     // - Lookup new reader information
     // - Calculate current rate
@@ -737,14 +739,14 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     bool bTrackLoading = load_atomic(m_iTrackLoading) != 0;
     if (!bTrackLoading && m_pause.tryLock()) {
         ScopedTimer t("EngineBuffer::process_pauselock");
-        float sr = m_pSampleRate->get();
+        float sr = params.sampleRate;
 
         double baserate = 0.0;
         if (sr > 0) {
             baserate = ((double)m_file_srate_old / sr);
         }
 
-        bool paused = m_playButton->get() == 0.0;
+        bool paused = !params.play;
         KeyControl::PitchTempoRatio pitchTempoRatio = m_pKeyControl->getPitchTempoRatio();
 
         // The pitch adjustment in Ratio (1.0 being normal
@@ -760,7 +762,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
         // pass for every 1 real second). Depending on whether
         // keylock is enabled, this is applied to either the rate or the tempo.
         double speed = m_pRateControl->calculateSpeed(
-                baserate, tempoRatio, paused, iBufferSize, &is_scratching);
+                params, baserate, tempoRatio, iBufferSize, &is_scratching);
 
         if (is_scratching || fabs(speed) > 1.9) {
             // Scratching always disables keylock because keylock sounds
@@ -842,7 +844,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
         // we need to sync phase or we'll be totally out of whack and the sync
         // adjuster will kick in and push the track back in to sync with the
         // master.
-        if (m_scratching_old && !is_scratching && m_pQuantize->get() > 0.0
+        if (m_scratching_old && !is_scratching && params.quantize
                 && m_pSyncControl->getSyncMode() == SYNC_FOLLOWER && !paused) {
             requestSyncPhase();
         }
@@ -851,7 +853,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
         processSlip(iBufferSize);
 
         processSyncRequests();
-        processSeek();
+        processSeek(params);
 
         // If the baserate, speed, or pitch has changed, we need to update the
         // scaler. Also, if we have changed scalers then we need to update the
@@ -882,7 +884,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             // master samplerate), the deck speed, the pitch shift, and whether
             // the deck speed should affect the pitch.
 
-            m_pScale->setScaleParameters(m_pSampleRate->get(),
+            m_pScale->setScaleParameters(params.sampleRate,
                                          baserate,
                                          &speed,
                                          &pitchRatio);
@@ -982,20 +984,24 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
         }
         m_engineLock.unlock();
 
+        // Controls of the deck changed by the engine in this callback, e.g.
+        // by an EngineControl, are picked up here rather than in the next
+        // callback. This is free if nothing changed.
+        m_pDeckParamsJournal->update();
+
         m_scratching_old = is_scratching;
 
         // Handle repeat mode
         at_start = m_filepos_play <= 0;
         at_end = m_filepos_play >= m_file_length_old;
 
-        bool repeat_enabled = m_pRepeat->get() != 0.0;
+        bool repeat_enabled = params.repeat;
 
         bool end_of_track = //(at_start && backwards) ||
             (at_end && !backwards);
 
         // If playbutton is pressed, check if we are at start or end of track
-        if ((m_playButton->get() || (m_fwdButton->get() || m_backButton->get()))
-                && end_of_track) {
+        if ((params.play || params.fwd || params.back) && end_of_track) {
             if (repeat_enabled) {
                 double seekPosition = at_start ? m_file_length_old : 0;
                 doSeek(seekPosition, SEEK_STANDARD);
@@ -1051,7 +1057,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     if (m_iRampState == ENGINE_RAMP_UP ||
         m_iRampState == ENGINE_RAMP_DOWN) {
         // Ramp of 3.33 ms
-        ramp_inc = m_iRampState * 300 / m_pSampleRate->get();
+        ramp_inc = m_iRampState * 300 / params.sampleRate;
 
         for (int i=0; i < iBufferSize; i += 2) {
             if (bCurBufferPaused) {
@@ -1146,7 +1152,7 @@ void EngineBuffer::processSyncRequests() {
     }
 }
 
-void EngineBuffer::processSeek() {
+void EngineBuffer::processSeek(const DeckParams& params) {
     // We need to read position just after reading seekType, to ensure that we read
     // the matching poition to seek_typ or a position from a new seek just queued from an other thread
     // the later case is ok, because we will process the new seek in the next call anyway.
@@ -1160,9 +1166,8 @@ void EngineBuffer::processSeek() {
             setNewPlaypos(position);
             break;
         case SEEK_STANDARD: {
-            bool paused = m_playButton->get() == 0.0;
             // If we are playing and quantize is on, match phase when seeking.
-            if (!paused && m_pQuantize->get() > 0.0) {
+            if (params.play && params.quantize) {
                 int offset = static_cast<int>(round(m_pBpmControl->getPhaseOffset(position)));
                 if (!even(offset)) {
                     offset--;
@@ -1308,6 +1313,10 @@ void EngineBuffer::bindWorkers(EngineWorkerScheduler* pWorkerScheduler) {
     m_pReader->setScheduler(pWorkerScheduler);
 }
 
+void EngineBuffer::unbindFromEngine() {
+    m_pEngineSync->removeSyncableDeck(m_pSyncControl);
+}
+
 bool EngineBuffer::isTrackLoaded() {
     if (m_pCurrentTrack) {
         return true;
@@ -64,6 +64,8 @@ class EngineBufferScaleST;
 class EngineBufferScaleRubberBand;
 class EngineSync;
 class EngineWorkerScheduler;
+class DeckParamsJournal;
+struct DeckParams;
 class VisualPlayPosition;
 class EngineMaster;
 
@@ -122,6 +124,9 @@ class EngineBuffer : public EngineObject {
     virtual ~EngineBuffer();
 
     void bindWorkers(EngineWorkerScheduler* pWorkerScheduler);
+    // Unregisters the deck from the EngineSync it registered with on
+    // construction. Called when the channel is removed from the engine.
+    void unbindFromEngine();
 
     // Add an engine control to the EngineBuffer
     void addControl(EngineControl* pControl);
@@ -227,7 +232,7 @@ class EngineBuffer : public EngineObject {
     void setNewPlaypos(double playpos);
 
     void processSyncRequests();
-    void processSeek();
+    void processSeek(const DeckParams& params);
 
     double updateIndicatorsAndModifyPlay(double v);
     void verifyPlay();
@@ -318,18 +323,17 @@ class EngineBuffer : public EngineObject {
     ControlPushButton* m_stopStartButton;
     ControlPushButton* m_stopButton;
 
-    ControlObject* m_fwdButton;
-    ControlObject* m_backButton;
     ControlPushButton* m_pSlipButton;
 
     ControlObject* m_rateEngine;
     ControlObject* m_visualBpm;
     ControlObject* m_visualKey;
-    ControlObject* m_pQuantize;
     ControlObject* m_pMasterRate;
     ControlPotmeter* m_playposSlider;
     ControlObjectSlave* m_pSampleRate;
     ControlObjectSlave* m_pKeylockEngine;
+    // The controls process() reads every callback.
+    DeckParamsJournal* m_pDeckParamsJournal;
     ControlPushButton* m_pKeylock;
     QScopedPointer<ControlObjectSlave> m_pPassthroughEnabled;
 
@@ -52,6 +52,14 @@ class EngineChannel : public EngineObject {
     virtual bool isTalkover() const;
 
     virtual void process(CSAMPLE* pOut, const int iBufferSize) = 0;
+    // Applies the effects enabled for this channel to the output of process()
+    // and updates the channel's meters. EngineMaster calls this after all
+    // channels have been processed. It may run on an EngineTaskPool thread,
+    // in parallel with processEffects() of other channels.
+    virtual void processEffects(CSAMPLE* pInOut, const int iBufferSize) {
+        Q_UNUSED(pInOut);
+        Q_UNUSED(iBufferSize);
+    }
     virtual void postProcess(const int iBuffersize) = 0;
 
     // TODO(XXX) This hack needs to be removed.
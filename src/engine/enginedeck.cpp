@@ -46,6 +46,7 @@ EngineDeck::EngineDeck(QString group,
     m_pPassing->setButtonMode(ControlPushButton::POWERWINDOW);
     m_bPassthroughIsActive = false;
     m_bPassthroughWasActive = false;
+    m_bProcessEffects = false;
 
     // Set up passthrough toggle button
     connect(m_pPassing, SIGNAL(valueChanged(double)),
@@ -71,6 +72,7 @@ EngineDeck::~EngineDeck() {
 
 void EngineDeck::process(CSAMPLE* pOut, const int iBufferSize) {
     GroupFeatureState features;
+    m_bProcessEffects = false;
     // Feed the incoming audio through if passthrough is active
     const CSAMPLE* sampleBuffer = m_sampleBuffer; // save pointer on stack
     if (isPassthroughActive() && sampleBuffer) {
@@ -95,17 +97,26 @@ void EngineDeck::process(CSAMPLE* pOut, const int iBufferSize) {
 
     // Apply pregain
     m_pPregain->process(pOut, iBufferSize);
+    m_features = features;
+    m_bProcessEffects = true;
+}
+
+void EngineDeck::processEffects(CSAMPLE* pInOut, const int iBufferSize) {
+    if (!m_bProcessEffects) {
+        // The buffer was silenced because passthrough was switched off.
+        return;
+    }
     // Process effects enabled for this channel
     if (m_pEngineEffectsManager != NULL) {
         // This is out of date by a callback but some effects will want the RMS
         // volume.
-        m_pVUMeter->collectFeatures(&features);
+        m_pVUMeter->collectFeatures(&m_features);
         m_pEngineEffectsManager->process(
-                getGroup(), pOut, iBufferSize,
-                static_cast<unsigned int>(m_pSampleRate->get()), features);
+                getGroup(), pInOut, iBufferSize,
+                static_cast<unsigned int>(m_pSampleRate->get()), m_features);
     }
     // Update VU meter
-    m_pVUMeter->process(pOut, iBufferSize);
+    m_pVUMeter->process(pInOut, iBufferSize);
 }
 
 void EngineDeck::postProcess(const int iBufferSize) {
@@ -23,6 +23,7 @@
 #include "controlpushbutton.h"
 #include "engine/engineobject.h"
 #include "engine/enginechannel.h"
+#include "engine/effects/groupfeaturestate.h"
 #include "util/circularbuffer.h"
 
 #include "soundmanagerutil.h"
@@ -45,6 +46,7 @@ class EngineDeck : public EngineChannel, public AudioDestination {
     virtual ~EngineDeck();
 
     virtual void process(CSAMPLE* pOutput, const int iBufferSize);
+    virtual void processEffects(CSAMPLE* pInOut, const int iBufferSize);
     virtual void postProcess(const int iBufferSize);
 
     // TODO(XXX) This hack needs to be removed.
@@ -81,6 +83,9 @@ class EngineDeck : public EngineChannel, public AudioDestination {
     EngineVuMeter* m_pVUMeter;
     EngineEffectsManager* m_pEngineEffectsManager;
     ControlObjectSlave* m_pSampleRate;
+    // The features of the last process() call for processEffects().
+    GroupFeatureState m_features;
+    bool m_bProcessEffects;
 
     // Begin vinyl passthrough fields
     ControlPushButton* m_pPassing;
@@ -0,0 +1,143 @@
+#include <QMutexLocker>
+#include <QtDebug>
+
+#include "engine/enginegarbagecollector.h"
+
+#include "util/assert.h"
+#include "util/compatibility.h"
+#include "util/counter.h"
+#include "util/event.h"
+
+namespace {
+
+// The maximum number of objects the engine can retire between two
+// collections. Must be a power of 2.
+const int kEngineRetiredFifoSize = 4096;
+
+// Objects retired from other threads are collected at least this often.
+const unsigned long kCollectIntervalMillis = 100;
+
+}  // anonymous namespace
+
+EngineGarbageCollector::EngineGarbageCollector(QObject* pParent)
+        : QThread(pParent),
+          m_startedEpoch(0),
+          m_completedEpoch(0),
+          m_engineRetired(kEngineRetiredFifoSize),
+          m_bWakeCollector(false),
+          m_bQuit(false) {
+}
+
+EngineGarbageCollector::~EngineGarbageCollector() {
+    m_bQuit = true;
+    wake();
+    wait();
+
+    // The engine is stopped, so everything can go.
+    m_completedEpoch = load_atomic(m_startedEpoch);
+    collect();
+    DEBUG_ASSERT(m_pending.isEmpty());
+}
+
+void EngineGarbageCollector::onCallbackStart() {
+    m_startedEpoch.fetchAndAddOrdered(1);
+}
+
+void EngineGarbageCollector::onCallbackEnd() {
+    m_completedEpoch.fetchAndStoreOrdered(load_atomic(m_startedEpoch));
+    // Wake the collector if the callback has retired objects. There is no
+    // race condition in accessing this boolean because it is only touched
+    // from the callback thread. A missed wake-up only delays the collection
+    // until the next interval.
+    if (m_bWakeCollector) {
+        m_bWakeCollector = false;
+        m_waitCondition.wakeAll();
+    }
+}
+
+void EngineGarbageCollector::retireFromEngine(void* pObject, Deleter deleter) {
+    if (pObject == NULL) {
+        return;
+    }
+    RetiredObject retired;
+    retired.pObject = pObject;
+    retired.deleter = deleter;
+    retired.epoch = load_atomic(m_startedEpoch);
+    if (m_engineRetired.write(&retired, 1) != 1) {
+        // We must not block or free in the callback, so the object leaks.
+        Counter overflow("EngineGarbageCollector retire overflow");
+        overflow.increment();
+        return;
+    }
+    m_bWakeCollector = true;
+}
+
+void EngineGarbageCollector::retire(void* pObject, Deleter deleter) {
+    if (pObject == NULL) {
+        return;
+    }
+    RetiredObject retired;
+    retired.pObject = pObject;
+    retired.deleter = deleter;
+    // The caller has already unlinked the object, so only a callback that was
+    // started before this point may still use it. The ordered read makes sure
+    // the unlinking is visible to every later callback.
+    retired.epoch = m_startedEpoch.fetchAndAddOrdered(0);
+    {
+        QMutexLocker locker(&m_retiredMutex);
+        m_retired.append(retired);
+    }
+    wake();
+}
+
+bool EngineGarbageCollector::isReclaimable(const RetiredObject& retired) const {
+    // Wrap-around safe comparison of completed >= retired.epoch.
+    const quint32 completed = static_cast<quint32>(load_atomic(m_completedEpoch));
+    return static_cast<qint32>(
+            completed - static_cast<quint32>(retired.epoch)) >= 0;
+}
+
+int EngineGarbageCollector::collect() {
+    QMutexLocker locker(&m_collectMutex);
+
+    RetiredObject retired;
+    while (m_engineRetired.read(&retired, 1) == 1) {
+        m_pending.append(retired);
+    }
+    {
+        QMutexLocker retiredLocker(&m_retiredMutex);
+        m_pending.append(m_retired);
+        m_retired.clear();
+    }
+
+    int collected = 0;
+    QMutableListIterator<RetiredObject> it(m_pending);
+    while (it.hasNext()) {
+        const RetiredObject& pending = it.next();
+        if (isReclaimable(pending)) {
+            pending.deleter(pending.pObject);
+            it.remove();
+            ++collected;
+        }
+    }
+    return collected;
+}
+
+void EngineGarbageCollector::wake() {
+    QMutexLocker locker(&m_waitMutex);
+    m_waitCondition.wakeAll();
+}
+
+void EngineGarbageCollector::run() {
+    QThread::currentThread()->setObjectName("EngineGarbageCollector");
+    while (!m_bQuit) {
+        Event::start("EngineGarbageCollector");
+        collect();
+        Event::end("EngineGarbageCollector");
+        m_waitMutex.lock();
+        if (!m_bQuit) {
+            m_waitCondition.wait(&m_waitMutex, kCollectIntervalMillis);
+        }
+        m_waitMutex.unlock();
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef ENGINEGARBAGECOLLECTOR_H
+#define ENGINEGARBAGECOLLECTOR_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "util/fifo.h"
+
+// EngineGarbageCollector frees objects that were removed from the engine
+// without ever freeing memory in the engine callback.
+//
+// Reclamation is epoch based: the engine callback advances an epoch counter
+// when it starts (onCallbackStart) and marks the epoch as completed when it
+// ends (onCallbackEnd). An object is retired after it has been unlinked from
+// everything the callback can reach. It may still be in use by the callback
+// that is running at that moment, so it is tagged with the current epoch and
+// only deleted by the collector thread once that epoch has completed. If the
+// engine is idle when an object is retired, it is freed on the next collection.
+//
+// retireFromEngine() is real-time safe and must only be called from the engine
+// callback. retire() may be called from any other thread.
+class EngineGarbageCollector : public QThread {
+    Q_OBJECT
+  public:
+    typedef void (*Deleter)(void* pObject);
+
+    EngineGarbageCollector(QObject* pParent = NULL);
+    // Frees all objects that are still pending. The engine callback must not
+    // run anymore at this point.
+    virtual ~EngineGarbageCollector();
+
+    // Called by EngineMaster at the start and the end of each callback.
+    void onCallbackStart();
+    void onCallbackEnd();
+
+    template <typename T>
+    void retireFromEngine(T* pObject) {
+        retireFromEngine(pObject, &deleteObject<T>);
+    }
+    void retireFromEngine(void* pObject, Deleter deleter);
+
+    template <typename T>
+    void retire(T* pObject) {
+        retire(pObject, &deleteObject<T>);
+    }
+    void retire(void* pObject, Deleter deleter);
+
+    // Deletes all retired objects whose epoch has completed and returns how
+    // many were deleted. Called periodically by the collector thread.
+    int collect();
+
+  protected:
+    void run();
+
+  private:
+    struct RetiredObject {
+        void* pObject;
+        Deleter deleter;
+        int epoch;
+    };
+
+    template <typename T>
+    static void deleteObject(void* pObject) {
+        delete static_cast<T*>(pObject);
+    }
+
+    bool isReclaimable(const RetiredObject& retired) const;
+    void wake();
+
+    QAtomicInt m_startedEpoch;
+    QAtomicInt m_completedEpoch;
+
+    // Written by the engine callback, read by collect().
+    FIFO<RetiredObject> m_engineRetired;
+    // Indicates whether objects were retired in the current callback. This
+    // should only be touched from the engine callback.
+    bool m_bWakeCollector;
+
+    // Objects retired from other threads.
+    QMutex m_retiredMutex;
+    QList<RetiredObject> m_retired;
+
+    // Objects waiting for their epoch to complete. Guarded by
+    // m_collectMutex.
+    QMutex m_collectMutex;
+    QList<RetiredObject> m_pending;
+
+    QMutex m_waitMutex;
+    QWaitCondition m_waitCondition;
+    volatile bool m_bQuit;
+};
+
+#endif /* ENGINEGARBAGECOLLECTOR_H */
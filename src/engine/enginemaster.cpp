@@ -27,11 +27,14 @@
 #include "engine/enginebuffer.h"
 #include "engine/enginemaster.h"
 #include "engine/engineworkerscheduler.h"
+#include "engine/enginegarbagecollector.h"
 #include "engine/enginedeck.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginechannel.h"
 #include "engine/enginetalkoverducking.h"
 #include "engine/enginevumeter.h"
+#include "engine/metering/enginemetering.h"
+#include "engine/metering/meteringtap.h"
 #include "engine/enginexfader.h"
 #include "engine/enginedelay.h"
 #include "engine/sidechain/enginesidechain.h"
@@ -39,11 +42,20 @@
 #include "sampleutil.h"
 #include "engine/effects/engineeffectsmanager.h"
 #include "effects/effectsmanager.h"
+#include "util/compatibility.h"
 #include "util/timer.h"
 #include "util/trace.h"
 #include "util/defs.h"
 #include "playermanager.h"
 #include "engine/channelmixer.h"
+#include "util/math.h"
+
+namespace {
+
+// More threads than this do not pay off for the few channels we mix.
+const int kMaxEffectsThreads = 3;
+
+}  // anonymous namespace
 
 EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
                            const char* group,
@@ -52,6 +64,8 @@ EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
                            bool bRampingGain)
         : m_pEngineEffectsManager(pEffectsManager ? pEffectsManager->getEngineEffectsManager() : NULL),
           m_bRampingGain(bRampingGain),
+          m_pChannels(new ChannelArray()),
+          m_pTaskPool(NULL),
           m_masterVolumeOld(0.0),
           m_headphoneMasterGainOld(0.0),
           m_headphoneVolumeOld(1.0),
@@ -65,6 +79,24 @@ EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
     m_bBusOutputConnected[2] = false;
     m_pWorkerScheduler = new EngineWorkerScheduler(this);
     m_pWorkerScheduler->start(QThread::HighPriority);
+    m_pGarbageCollector = new EngineGarbageCollector(this);
+    m_pGarbageCollector->start(QThread::LowPriority);
+    if (m_pEngineEffectsManager) {
+        m_pEngineEffectsManager->setGarbageCollector(m_pGarbageCollector);
+
+        // The effects of the channels are processed in parallel with one
+        // thread less than there are cores, since the callback thread works
+        // on them too. Can be overridden with [Soundcard],EffectsThreads.
+        int effectsThreads = _config->getValueString(
+                ConfigKey("[Soundcard]", "EffectsThreads"), "-1").toInt();
+        if (effectsThreads < 0) {
+            effectsThreads = math_min(QThread::idealThreadCount() - 1,
+                                      kMaxEffectsThreads);
+        }
+        if (effectsThreads > 0) {
+            m_pTaskPool = new EngineTaskPool(effectsThreads);
+        }
+    }
 
     if (pEffectsManager) {
         pEffectsManager->registerGroup(getMasterGroup());
@@ -89,7 +121,7 @@ EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
     m_pMasterRate = new ControlPotmeter(ConfigKey(group, "rate"), -1.0, 1.0);
 
     // Master sync controller
-    m_pMasterSync = new EngineSync(_config);
+    m_pMasterSync = new EngineSync(_config, m_pGarbageCollector);
 
     // The last-used bpm value is saved in the destructor of EngineSync.
     double default_bpm = _config->getValueString(ConfigKey("[InternalClock]", "bpm"),
@@ -151,6 +183,10 @@ EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
     // Starts a thread for recording and shoutcast
     m_pSideChain = bEnableSidechain ? new EngineSideChain(_config) : NULL;
 
+    // Starts the low priority thread for the spectrum and loudness meters
+    m_pMetering = new EngineMetering();
+    m_pMasterMeteringTap = m_pMetering->addTap(group);
+
     // X-Fader Setup
     m_pXFaderMode = new ControlPushButton(
             ConfigKey("[Mixer Profile]", "xFaderMode"));
@@ -180,6 +216,10 @@ EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
 
 EngineMaster::~EngineMaster() {
     qDebug() << "in ~EngineMaster()";
+    if (m_pEngineEffectsManager) {
+        m_pEngineEffectsManager->setGarbageCollector(NULL);
+    }
+    delete m_pTaskPool;
     delete m_pKeylockEngine;
     delete m_pCrossfader;
     delete m_pBalance;
@@ -217,18 +257,25 @@ EngineMaster::~EngineMaster() {
         SampleUtil::free(m_pOutputBusBuffers[o]);
     }
 
-    delete m_pWorkerScheduler;
-
-    QMutableListIterator<ChannelInfo*> channel_it(m_channels);
-    while (channel_it.hasNext()) {
-        ChannelInfo* pChannelInfo = channel_it.next();
-        channel_it.remove();
+    ChannelArray* pChannels = m_pChannels.fetchAndStoreOrdered(NULL);
+    foreach (ChannelInfo* pChannelInfo, pChannels->channels) {
         SampleUtil::free(pChannelInfo->m_pBuffer);
         delete pChannelInfo->m_pChannel;
         delete pChannelInfo->m_pVolumeControl;
         delete pChannelInfo->m_pMuteControl;
         delete pChannelInfo;
     }
+    delete pChannels;
+
+    // Frees everything that was retired by the last callbacks.
+    delete m_pGarbageCollector;
+
+    // The workers of the channels drop out of the scheduler when they are
+    // unbound or deleted, so it goes last.
+    delete m_pWorkerScheduler;
+
+    // Removed channels retire their metering taps when they are freed.
+    delete m_pMetering;
 }
 
 const CSAMPLE* EngineMaster::getMasterBuffer() const {
@@ -239,7 +286,8 @@ const CSAMPLE* EngineMaster::getHeadphoneBuffer() const {
     return m_pHead;
 }
 
-void EngineMaster::processChannels(unsigned int* busChannelConnectionFlags,
+void EngineMaster::processChannels(const ChannelArray& channels,
+                                   unsigned int* busChannelConnectionFlags,
                                    unsigned int* headphoneOutput,
                                    int iBufferSize) {
     ScopedTimer timer("EngineMaster::processChannels");
@@ -249,8 +297,8 @@ void EngineMaster::processChannels(unsigned int* busChannelConnectionFlags,
 
     EngineChannel* pMasterChannel = m_pMasterSync->getMaster();
     m_activeChannels.clear();
-    QList<ChannelInfo*>::const_iterator it = m_channels.constBegin();
-    QList<ChannelInfo*>::const_iterator end = m_channels.constEnd();
+    QList<ChannelInfo*>::const_iterator it = channels.channels.constBegin();
+    QList<ChannelInfo*>::const_iterator end = channels.channels.constEnd();
     for (unsigned int channel_number = 0; it != end; ++it, ++channel_number) {
         ChannelInfo* pChannelInfo = *it;
         EngineChannel* pChannel = pChannelInfo->m_pChannel;
@@ -286,12 +334,48 @@ void EngineMaster::processChannels(unsigned int* busChannelConnectionFlags,
 
     // Now that the list is built and ordered, do the processing.
     foreach (ChannelInfo* pChannelInfo, m_activeChannels) {
-        EngineChannel* pChannel = pChannelInfo->m_pChannel;
-        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+        pChannelInfo->m_pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+    }
 
-        if (m_pTalkoverDucking->getMode() != EngineTalkoverDucking::OFF &&
-                pChannel->isTalkover()) {
-            m_pTalkoverDucking->processKey(pChannelInfo->m_pBuffer, iBufferSize);
+    // The effect state of channels added after an effect was loaded is
+    // created here, serially, before any effect of the channel is processed.
+    // This is needed whether or not the effects run on the task pool.
+    if (m_pEngineEffectsManager) {
+        foreach (ChannelInfo* pChannelInfo, m_activeChannels) {
+            m_pEngineEffectsManager->prepareGroup(
+                    pChannelInfo->m_pChannel->getGroup());
+        }
+    }
+
+    // The effects of a channel only touch its own buffer and effect state,
+    // so the channels can be processed in parallel.
+    if (m_pTaskPool) {
+        ScopedTimer timer("EngineMaster::processChannels effects");
+        m_effectsTasks.clear();
+        m_effectsTaskPointers.clear();
+        foreach (ChannelInfo* pChannelInfo, m_activeChannels) {
+            m_effectsTasks.append(ChannelEffectsTask(
+                    pChannelInfo->m_pChannel, pChannelInfo->m_pBuffer, iBufferSize));
+        }
+        // Take the pointers only after m_effectsTasks is complete since
+        // append() may move its elements.
+        for (int i = 0; i < m_effectsTasks.size(); ++i) {
+            m_effectsTaskPointers.append(&m_effectsTasks[i]);
+        }
+        m_pTaskPool->run(m_effectsTaskPointers.constData(),
+                         m_effectsTaskPointers.size());
+    } else {
+        foreach (ChannelInfo* pChannelInfo, m_activeChannels) {
+            pChannelInfo->m_pChannel->processEffects(pChannelInfo->m_pBuffer,
+                                                     iBufferSize);
+        }
+    }
+
+    if (m_pTalkoverDucking->getMode() != EngineTalkoverDucking::OFF) {
+        foreach (ChannelInfo* pChannelInfo, m_activeChannels) {
+            if (pChannelInfo->m_pChannel->isTalkover()) {
+                m_pTalkoverDucking->processKey(pChannelInfo->m_pBuffer, iBufferSize);
+            }
         }
     }
 
@@ -304,6 +388,45 @@ void EngineMaster::processChannels(unsigned int* busChannelConnectionFlags,
     }
 }
 
+void EngineMaster::processEffectBuses(const ChannelArray& channels,
+                                      const unsigned int* busChannelConnectionFlags,
+                                      int iBufferSize, unsigned int iSampleRate) {
+    ScopedTimer timer("EngineMaster::processEffectBuses");
+    const unsigned int masterChannels = busChannelConnectionFlags[0] |
+            busChannelConnectionFlags[1] | busChannelConnectionFlags[2];
+    for (int i = 0; i < channels.channels.size(); ++i) {
+        if ((masterChannels & (1 << i)) == 0) {
+            continue;
+        }
+        // The gain the channel was just mixed into the master with, so that
+        // the channel fader and the crossfader apply to the send.
+        const ChannelInfo* pChannelInfo = channels.channels[i];
+        m_pEngineEffectsManager->sendToBuses(pChannelInfo->m_pChannel->getGroup(),
+                                             pChannelInfo->m_pBuffer,
+                                             channels.masterGainCache[i],
+                                             iBufferSize);
+    }
+    m_pEngineEffectsManager->processBuses(m_pMaster, iBufferSize, iSampleRate);
+}
+
+void EngineMaster::processMeteringTaps(const ChannelArray& channels,
+                                       const unsigned int* busChannelConnectionFlags,
+                                       int iBufferSize) {
+    ScopedTimer timer("EngineMaster::processMeteringTaps");
+    const unsigned int masterChannels = busChannelConnectionFlags[0] |
+            busChannelConnectionFlags[1] | busChannelConnectionFlags[2];
+    for (int i = 0; i < channels.channels.size(); ++i) {
+        if ((masterChannels & (1 << i)) == 0) {
+            continue;
+        }
+        // The gain the channel was just mixed into the master with.
+        const ChannelInfo* pChannelInfo = channels.channels[i];
+        pChannelInfo->m_pMeteringTap->write(pChannelInfo->m_pBuffer,
+                                            channels.masterGainCache[i],
+                                            iBufferSize);
+    }
+}
+
 void EngineMaster::process(const int iBufferSize) {
     static bool haveSetName = false;
     if (!haveSetName) {
@@ -311,10 +434,21 @@ void EngineMaster::process(const int iBufferSize) {
         haveSetName = true;
     }
     Trace t("EngineMaster::process");
+    m_pGarbageCollector->onCallbackStart();
 
     bool masterEnabled = m_pMasterEnabled->get();
     bool headphoneEnabled = m_pHeadphoneEnabled->get();
 
+    // The channels may be swapped by the main thread at any time. Stick to the
+    // array we got for the whole callback; it is not freed before the callback
+    // has completed.
+    ChannelArray* pChannels = load_atomic_pointer(m_pChannels);
+    for (int i = 0; i < pChannels->channels.size(); ++i) {
+        const ChannelInfo* pChannelInfo = pChannels->channels[i];
+        pChannels->masterGainCache[i] = pChannelInfo->m_lastMasterGain;
+        pChannels->headphoneGainCache[i] = pChannelInfo->m_lastHeadphoneGain;
+    }
+
     unsigned int iSampleRate = static_cast<int>(m_pMasterSampleRate->get());
     if (m_pEngineEffectsManager) {
         m_pEngineEffectsManager->onCallbackStart();
@@ -328,7 +462,8 @@ void EngineMaster::process(const int iBufferSize) {
     // Update internal master sync rate.
     m_pMasterSync->onCallbackStart(iSampleRate, iBufferSize);
     // Prepare each channel for output
-    processChannels(busChannelConnectionFlags, &headphoneOutput, iBufferSize);
+    processChannels(*pChannels, busChannelConnectionFlags, &headphoneOutput,
+                    iBufferSize);
     // Do internal master sync post-processing
     m_pMasterSync->onCallbackEnd(iSampleRate, iBufferSize);
 
@@ -349,13 +484,13 @@ void EngineMaster::process(const int iBufferSize) {
 
     if (m_bRampingGain) {
         ChannelMixer::mixChannelsRamping(
-            m_channels, m_headphoneGain, headphoneOutput,
-            maxChannels, &m_channelHeadphoneGainCache,
+            pChannels->channels, m_headphoneGain, headphoneOutput,
+            maxChannels, &pChannels->headphoneGainCache,
             m_pHead, iBufferSize);
     } else {
         ChannelMixer::mixChannels(
-            m_channels, m_headphoneGain, headphoneOutput,
-            maxChannels, &m_channelHeadphoneGainCache,
+            pChannels->channels, m_headphoneGain, headphoneOutput,
+            maxChannels, &pChannels->headphoneGainCache,
             m_pHead, iBufferSize);
     }
 
@@ -377,19 +512,27 @@ void EngineMaster::process(const int iBufferSize) {
     for (int o = EngineChannel::LEFT; o <= EngineChannel::RIGHT; o++) {
         if (m_bRampingGain) {
             ChannelMixer::mixChannelsRamping(
-                m_channels, m_masterGain,
+                pChannels->channels, m_masterGain,
                 busChannelConnectionFlags[o], maxChannels,
-                &m_channelMasterGainCache,
+                &pChannels->masterGainCache,
                 m_pOutputBusBuffers[o], iBufferSize);
         } else {
             ChannelMixer::mixChannels(
-                m_channels, m_masterGain,
+                pChannels->channels, m_masterGain,
                 busChannelConnectionFlags[o], maxChannels,
-                &m_channelMasterGainCache,
+                &pChannels->masterGainCache,
                 m_pOutputBusBuffers[o], iBufferSize);
         }
     }
 
+    for (int i = 0; i < pChannels->channels.size(); ++i) {
+        ChannelInfo* pChannelInfo = pChannels->channels[i];
+        pChannelInfo->m_lastMasterGain = pChannels->masterGainCache[i];
+        pChannelInfo->m_lastHeadphoneGain = pChannels->headphoneGainCache[i];
+    }
+
+    processMeteringTaps(*pChannels, busChannelConnectionFlags, iBufferSize);
+
     // Process master channel effects
     if (m_pEngineEffectsManager) {
         GroupFeatureState busFeatures;
@@ -410,6 +553,13 @@ void EngineMaster::process(const int iBufferSize) {
                                   m_pOutputBusBuffers[EngineChannel::RIGHT], 1.0,
                                   iBufferSize);
 
+        // Mix in the returns of the effect buses. Like the returns of a
+        // hardware mixer they pass the master effects and volume.
+        if (m_pEngineEffectsManager) {
+            processEffectBuses(*pChannels, busChannelConnectionFlags,
+                               iBufferSize, iSampleRate);
+        }
+
         // Process master channel effects
         if (m_pEngineEffectsManager) {
             GroupFeatureState masterFeatures;
@@ -451,6 +601,7 @@ void EngineMaster::process(const int iBufferSize) {
         if (m_pVumeter != NULL) {
             m_pVumeter->process(m_pMaster, iBufferSize);
         }
+        m_pMasterMeteringTap->write(m_pMaster, CSAMPLE_GAIN_ONE, iBufferSize);
         // Submit master samples to the side chain to do shoutcasting, recording,
         // etc. (cpu intensive non-realtime tasks)
         if (m_pSideChain != NULL) {
@@ -516,7 +667,12 @@ void EngineMaster::process(const int iBufferSize) {
 
     // We're close to the end of the callback. Wake up the engine worker
     // scheduler so that it runs the workers.
+    if (m_pEngineEffectsManager) {
+        m_pEngineEffectsManager->onCallbackEnd(iBufferSize, iSampleRate);
+    }
+
     m_pWorkerScheduler->runWorkers();
+    m_pGarbageCollector->onCallbackEnd();
 }
 
 void EngineMaster::addChannel(EngineChannel* pChannel) {
@@ -531,22 +687,91 @@ void EngineMaster::addChannel(EngineChannel* pChannel) {
     pChannelInfo->m_pMuteControl->setButtonMode(ControlPushButton::POWERWINDOW);
     pChannelInfo->m_pBuffer = SampleUtil::alloc(MAX_BUFFER_LEN);
     SampleUtil::clear(pChannelInfo->m_pBuffer, MAX_BUFFER_LEN);
-    m_channels.push_back(pChannelInfo);
-    m_channelHeadphoneGainCache.push_back(0);
-    for (int o = EngineChannel::LEFT; o <= EngineChannel::RIGHT; o++) {
-        m_channelMasterGainCache.push_back(0);
-    }
+    pChannelInfo->m_pMeteringTap = m_pMetering->addTap(pChannel->getGroup());
 
     EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
     if (pBuffer != NULL) {
         pBuffer->bindWorkers(m_pWorkerScheduler);
         pBuffer->setEngineMaster(this);
     }
+
+    // The channel is completely set up before the callback can see it.
+    const ChannelArray* pOld = load_atomic_pointer(m_pChannels);
+    QList<ChannelInfo*> channels = pOld->channels;
+    channels.append(pChannelInfo);
+    swapChannelArray(createChannelArray(channels));
+}
+
+bool EngineMaster::removeChannel(const QString& group) {
+    const ChannelArray* pOld = load_atomic_pointer(m_pChannels);
+    QList<ChannelInfo*> channels = pOld->channels;
+    ChannelInfo* pRemoved = NULL;
+    QMutableListIterator<ChannelInfo*> it(channels);
+    while (it.hasNext()) {
+        ChannelInfo* pChannelInfo = it.next();
+        if (pChannelInfo->m_pChannel->getGroup() == group) {
+            pRemoved = pChannelInfo;
+            it.remove();
+            break;
+        }
+    }
+    if (pRemoved == NULL) {
+        return false;
+    }
+    swapChannelArray(createChannelArray(channels));
+    EngineBuffer* pBuffer = pRemoved->m_pChannel->getEngineBuffer();
+    if (pBuffer != NULL) {
+        pBuffer->unbindFromEngine();
+    }
+    // Retired after the array swap, so that every callback which still has
+    // the old array completes before the channel is deleted.
+    m_pGarbageCollector->retire(pRemoved, &EngineMaster::deleteRemovedChannel);
+    return true;
+}
+
+// static
+EngineMaster::ChannelArray* EngineMaster::createChannelArray(
+        const QList<ChannelInfo*>& channels) {
+    ChannelArray* pChannels = new ChannelArray();
+    // Append the elements instead of copying the lists. This keeps the caches
+    // unshared. The callback fills them from the ChannelInfos.
+    foreach (ChannelInfo* pChannelInfo, channels) {
+        pChannels->channels.append(pChannelInfo);
+        pChannels->headphoneGainCache.append(0);
+        pChannels->masterGainCache.append(0);
+    }
+    return pChannels;
+}
+
+void EngineMaster::swapChannelArray(ChannelArray* pChannels) {
+    ChannelArray* pOld = m_pChannels.fetchAndStoreOrdered(pChannels);
+    m_pGarbageCollector->retire(pOld);
+}
+
+// static
+void EngineMaster::deleteRemovedChannel(void* pObject) {
+    // Called from the garbage collector thread. The channel and its controls
+    // belong to the main thread, so they are deleted there.
+    ChannelInfo* pChannelInfo = static_cast<ChannelInfo*>(pObject);
+    // No callback can schedule the reader of the channel anymore, so it is
+    // safe to take it out of the EngineWorkerScheduler now.
+    EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
+    if (pBuffer != NULL) {
+        pBuffer->bindWorkers(NULL);
+    }
+    SampleUtil::free(pChannelInfo->m_pBuffer);
+    pChannelInfo->m_pChannel->deleteLater();
+    pChannelInfo->m_pVolumeControl->deleteLater();
+    pChannelInfo->m_pMuteControl->deleteLater();
+    // The metering thread deletes the tap.
+    pChannelInfo->m_pMeteringTap->retire();
+    delete pChannelInfo;
 }
 
 EngineChannel* EngineMaster::getChannel(QString group) {
-    for (QList<ChannelInfo*>::const_iterator i = m_channels.constBegin();
-         i != m_channels.constEnd(); ++i) {
+    const ChannelArray* pChannels = load_atomic_pointer(m_pChannels);
+    for (QList<ChannelInfo*>::const_iterator i = pChannels->channels.constBegin();
+         i != pChannels->channels.constEnd(); ++i) {
         ChannelInfo* pChannelInfo = *i;
         if (pChannelInfo->m_pChannel->getGroup() == group) {
             return pChannelInfo->m_pChannel;
@@ -566,8 +791,9 @@ const CSAMPLE* EngineMaster::getOutputBusBuffer(unsigned int i) const {
 }
 
 const CSAMPLE* EngineMaster::getChannelBuffer(QString group) const {
-    for (QList<ChannelInfo*>::const_iterator i = m_channels.constBegin();
-         i != m_channels.constEnd(); ++i) {
+    const ChannelArray* pChannels = load_atomic_pointer(m_pChannels);
+    for (QList<ChannelInfo*>::const_iterator i = pChannels->channels.constBegin();
+         i != pChannels->channels.constEnd(); ++i) {
         const ChannelInfo* pChannelInfo = *i;
         if (pChannelInfo->m_pChannel->getGroup() == group) {
             return pChannelInfo->m_pBuffer;
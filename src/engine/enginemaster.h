@@ -18,6 +18,7 @@
 #ifndef ENGINEMASTER_H
 #define ENGINEMASTER_H
 
+#include <QAtomicPointer>
 #include <QObject>
 #include <QVarLengthArray>
 
@@ -25,10 +26,12 @@
 #include "controlpushbutton.h"
 #include "engine/engineobject.h"
 #include "engine/enginechannel.h"
+#include "engine/enginetaskpool.h"
 #include "soundmanagerutil.h"
 #include "recording/recordingmanager.h"
 
 class EngineWorkerScheduler;
+class EngineGarbageCollector;
 class EngineBuffer;
 class EngineChannel;
 class EngineDeck;
@@ -37,6 +40,8 @@ class EngineVuMeter;
 class ControlPotmeter;
 class ControlPushButton;
 class EngineSideChain;
+class EngineMetering;
+class MeteringTap;
 class EffectsManager;
 class EngineEffectsManager;
 class SyncWorker;
@@ -89,9 +94,14 @@ class EngineMaster : public QObject, public AudioSource {
 
     void process(const int iBufferSize);
 
-    // Add an EngineChannel to the mixing engine. This is not thread safe --
-    // only call it before the engine has started mixing.
+    // Add an EngineChannel to the mixing engine. Takes ownership of pChannel.
+    // This may be called while the engine is mixing, but only from the main
+    // thread.
     void addChannel(EngineChannel* pChannel);
+    // Removes the channel of group from the mixing engine and deletes it once
+    // the callback no longer uses it. Returns false if there is no such
+    // channel. Must only be called from the main thread.
+    bool removeChannel(const QString& group);
     EngineChannel* getChannel(QString group);
     static inline double gainForOrientation(EngineChannel::ChannelOrientation orientation,
                                             double leftGain,
@@ -124,17 +134,47 @@ class EngineMaster : public QObject, public AudioSource {
         return m_pSideChain;
     }
 
+    // Objects that have been removed from the engine are retired here instead
+    // of being deleted while the callback may still use them.
+    EngineGarbageCollector* getGarbageCollector() const {
+        return m_pGarbageCollector;
+    }
+
     struct ChannelInfo {
         ChannelInfo()
                 : m_pChannel(NULL),
                   m_pBuffer(NULL),
                   m_pVolumeControl(NULL),
-                  m_pMuteControl(NULL) {
+                  m_pMuteControl(NULL),
+                  m_pMeteringTap(NULL),
+                  m_lastMasterGain(0),
+                  m_lastHeadphoneGain(0) {
         }
         EngineChannel* m_pChannel;
         CSAMPLE* m_pBuffer;
         ControlObject* m_pVolumeControl;
         ControlPushButton* m_pMuteControl;
+        // Owned by EngineMetering.
+        MeteringTap* m_pMeteringTap;
+        // The gains the channel was last mixed with. Only touched by the
+        // callback, which copies them into and out of the gain caches of the
+        // ChannelArray it mixes, so that ramping continues from where it was
+        // when the array is swapped.
+        CSAMPLE m_lastMasterGain;
+        CSAMPLE m_lastHeadphoneGain;
+    };
+
+    // The channels the engine mixes. A ChannelArray is never modified once it
+    // has been published to the callback. addChannel() and removeChannel()
+    // build a new one and swap it in atomically; the old one is retired to the
+    // EngineGarbageCollector.
+    struct ChannelArray {
+        QList<ChannelInfo*> channels;
+        // Gain caches, indexed like channels, for ChannelMixer. Only used by
+        // the callback. They are never shared with another ChannelArray so
+        // that writing to them does not detach (and allocate) in the callback.
+        QList<CSAMPLE> masterGainCache;
+        QList<CSAMPLE> headphoneGainCache;
     };
 
     class GainCalculator {
@@ -190,29 +230,76 @@ class EngineMaster : public QObject, public AudioSource {
     };
 
   private:
+    // Runs the effects of one channel on the EngineTaskPool.
+    class ChannelEffectsTask : public EngineTaskPool::Task {
+      public:
+        ChannelEffectsTask()
+                : m_pChannel(NULL),
+                  m_pBuffer(NULL),
+                  m_iBufferSize(0) {
+        }
+        ChannelEffectsTask(EngineChannel* pChannel, CSAMPLE* pBuffer,
+                           int iBufferSize)
+                : m_pChannel(pChannel),
+                  m_pBuffer(pBuffer),
+                  m_iBufferSize(iBufferSize) {
+        }
+        virtual void run() {
+            m_pChannel->processEffects(m_pBuffer, m_iBufferSize);
+        }
+
+      private:
+        EngineChannel* m_pChannel;
+        CSAMPLE* m_pBuffer;
+        int m_iBufferSize;
+    };
+
     void mixChannels(unsigned int channelBitvector, unsigned int maxChannels,
                      CSAMPLE* pOutput, unsigned int iBufferSize, GainCalculator* pGainCalculator);
 
     // Processes active channels. The master sync channel (if any) is processed
-    // first and all others are processed after. Sets the i'th bit of
+    // first and all others are processed after. The channel effects are then
+    // processed in parallel on m_pTaskPool, if there is one. Sets the i'th bit of
     // masterOutput and headphoneOutput if the i'th channel is enabled for the
     // master output or headphone output, respectively.
-    void processChannels(unsigned int* busChannelConnectionFlags,
+    void processChannels(const ChannelArray& channels,
+                         unsigned int* busChannelConnectionFlags,
                          unsigned int* headphoneOutput,
                          int iBufferSize);
 
+    // Sends the channels that are mixed into the master to the effect chains
+    // in BUS mode, post-fader, and mixes the bus returns into m_pMaster.
+    void processEffectBuses(const ChannelArray& channels,
+                            const unsigned int* busChannelConnectionFlags,
+                            int iBufferSize, unsigned int iSampleRate);
+
+    // Hands the channels that are mixed into the master to their meters,
+    // post-fader.
+    void processMeteringTaps(const ChannelArray& channels,
+                             const unsigned int* busChannelConnectionFlags,
+                             int iBufferSize);
+
+    // Builds a ChannelArray of channels for publishing.
+    static ChannelArray* createChannelArray(const QList<ChannelInfo*>& channels);
+    // Publishes pChannels to the callback and retires the previous array.
+    void swapChannelArray(ChannelArray* pChannels);
+    static void deleteRemovedChannel(void* pChannelInfo);
+
     EngineEffectsManager* m_pEngineEffectsManager;
     bool m_bRampingGain;
-    QList<ChannelInfo*> m_channels;
+    QAtomicPointer<ChannelArray> m_pChannels;
     QVarLengthArray<ChannelInfo*, 128> m_activeChannels;
-    QList<CSAMPLE> m_channelMasterGainCache;
-    QList<CSAMPLE> m_channelHeadphoneGainCache;
+    // NULL if the channel effects are processed serially.
+    EngineTaskPool* m_pTaskPool;
+    QVarLengthArray<ChannelEffectsTask, 128> m_effectsTasks;
+    QVarLengthArray<EngineTaskPool::Task*, 128> m_effectsTaskPointers;
 
     CSAMPLE* m_pOutputBusBuffers[3];
     CSAMPLE* m_pMaster;
     CSAMPLE* m_pHead;
 
     EngineWorkerScheduler* m_pWorkerScheduler;
+    EngineGarbageCollector* m_pGarbageCollector;
     EngineSync* m_pMasterSync;
 
     ControlObject* m_pMasterGain;
@@ -230,6 +317,8 @@ class EngineMaster : public QObject, public AudioSource {
 
     EngineVuMeter* m_pVumeter;
     EngineSideChain* m_pSideChain;
+    EngineMetering* m_pMetering;
+    MeteringTap* m_pMasterMeteringTap;
 
     ControlPotmeter* m_pCrossfader;
     ControlPotmeter* m_pHeadMix;
@@ -96,17 +96,18 @@ void EngineMicrophone::process(CSAMPLE* pOut, const int iBufferSize) {
     } else {
         SampleUtil::clear(pOut, iBufferSize);
     }
+}
 
-
+void EngineMicrophone::processEffects(CSAMPLE* pInOut, const int iBufferSize) {
     if (m_pEngineEffectsManager != NULL) {
         // Process effects enabled for this channel
         GroupFeatureState features;
         // This is out of date by a callback but some effects will want the RMS
         // volume.
         m_vuMeter.collectFeatures(&features);
-        m_pEngineEffectsManager->process(getGroup(), pOut, iBufferSize,
+        m_pEngineEffectsManager->process(getGroup(), pInOut, iBufferSize,
                                          m_pSampleRate->get(), features);
     }
     // Update VU meter
-    m_vuMeter.process(pOut, iBufferSize);
+    m_vuMeter.process(pInOut, iBufferSize);
 }
@@ -0,0 +1,97 @@
+#include "engine/enginetaskpool.h"
+
+#include "util/math.h"
+#include "util/performancetimer.h"
+#include "util/threadplacement.h"
+
+namespace {
+
+// How long run() spins for helpers that are still running a task before it
+// sleeps until they are done.
+const qint64 kSpinNanos = 100 * 1000;
+
+}  // anonymous namespace
+
+EngineTaskPool::EngineTaskPool(int numThreads)
+        : m_pTasks(NULL),
+          m_iTaskCount(0),
+          m_nextTask(0),
+          m_bQuit(false) {
+    for (int i = 0; i < numThreads; ++i) {
+        HelperThread* pThread = new HelperThread(this);
+        pThread->setObjectName(QString("EngineTaskPool %1").arg(i + 1));
+        pThread->start(QThread::TimeCriticalPriority);
+        m_threads.append(pThread);
+    }
+}
+
+EngineTaskPool::~EngineTaskPool() {
+    m_bQuit = true;
+    m_semaStart.release(m_threads.size());
+    foreach (HelperThread* pThread, m_threads) {
+        pThread->wait();
+        delete pThread;
+    }
+}
+
+void EngineTaskPool::run(Task* const* pTasks, int count) {
+    const int helpers = math_min(m_threads.size(), count - 1);
+    if (helpers <= 0) {
+        for (int i = 0; i < count; ++i) {
+            pTasks[i]->run();
+        }
+        return;
+    }
+
+    m_pTasks = pTasks;
+    m_iTaskCount = count;
+    m_nextTask = 0;
+    // Only as many helpers as there are tasks for us to share with.
+    m_semaStart.release(helpers);
+    runTasks();
+
+    // Every task is taken now. Helpers that have not woken up yet have
+    // nothing left to do, so take their start permits back instead of
+    // waiting for the scheduler to run them.
+    int started = helpers;
+    while (started > 0 && m_semaStart.tryAcquire()) {
+        --started;
+    }
+    // The others are finishing the task they took. Spin for them rather than
+    // sleeping on the semaphore and only block once a task runs longer than
+    // kSpinNanos.
+    PerformanceTimer timer;
+    timer.start();
+    while (started > 0 && timer.elapsed() < kSpinNanos) {
+        if (m_semaDone.tryAcquire()) {
+            --started;
+        }
+    }
+    if (started > 0) {
+        m_semaDone.acquire(started);
+    }
+    m_pTasks = NULL;
+    m_iTaskCount = 0;
+}
+
+void EngineTaskPool::runTasks() {
+    for (;;) {
+        const int task = m_nextTask.fetchAndAddOrdered(1);
+        if (task >= m_iTaskCount) {
+            return;
+        }
+        m_pTasks[task]->run();
+    }
+}
+
+void EngineTaskPool::helperLoop() {
+    ThreadPlacement::placeCurrentThread(ThreadPlacement::REALTIME_WORKER);
+    for (;;) {
+        m_semaStart.acquire();
+        if (m_bQuit) {
+            return;
+        }
+        runTasks();
+        m_semaDone.release();
+    }
+}
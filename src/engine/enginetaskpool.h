@@ -0,0 +1,69 @@
+#ifndef ENGINETASKPOOL_H
+#define ENGINETASKPOOL_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QSemaphore>
+#include <QThread>
+
+// EngineTaskPool runs independent pieces of work of the engine callback in
+// parallel. Unlike EngineWorker, which runs after the callback, run() returns
+// only when all tasks have completed, so the callback can use the results
+// right away.
+//
+// The calling thread works on the tasks too. With no helper threads, or a
+// single task, the tasks run serially in the calling thread. run() must only
+// be called from one thread at a time. It does not wait for helpers that
+// were not scheduled in time: the calling thread runs their share itself.
+class EngineTaskPool {
+  public:
+    class Task {
+      public:
+        virtual ~Task() { }
+        virtual void run() = 0;
+    };
+
+    explicit EngineTaskPool(int numThreads);
+    virtual ~EngineTaskPool();
+
+    int threadCount() const {
+        return m_threads.size();
+    }
+
+    // Runs the count tasks of pTasks and returns once all of them are done.
+    void run(Task* const* pTasks, int count);
+
+  private:
+    class HelperThread : public QThread {
+      public:
+        HelperThread(EngineTaskPool* pPool)
+                : m_pPool(pPool) {
+        }
+
+      protected:
+        void run() {
+            m_pPool->helperLoop();
+        }
+
+      private:
+        EngineTaskPool* m_pPool;
+    };
+
+    void helperLoop();
+    // Runs tasks until there are none left.
+    void runTasks();
+
+    QList<HelperThread*> m_threads;
+
+    // The tasks of the current run(). Published to the helpers by
+    // m_semaStart.
+    Task* const* m_pTasks;
+    int m_iTaskCount;
+    QAtomicInt m_nextTask;
+
+    QSemaphore m_semaStart;
+    QSemaphore m_semaDone;
+    volatile bool m_bQuit;
+};
+
+#endif /* ENGINETASKPOOL_H */
@@ -9,12 +9,18 @@ EngineWorker::EngineWorker()
 }
 
 EngineWorker::~EngineWorker() {
+    if (m_pScheduler) {
+        m_pScheduler->removeWorker(this);
+    }
 }
 
 void EngineWorker::run() {
 }
 
 void EngineWorker::setScheduler(EngineWorkerScheduler* pScheduler) {
+    if (m_pScheduler) {
+        m_pScheduler->removeWorker(this);
+    }
     m_pScheduler = pScheduler;
 }
 
@@ -2,10 +2,12 @@
 // Created 6/2/2010 by RJ Ryan (rryan@mit.edu)
 
 #include <QtDebug>
+#include <QMutexLocker>
 
 #include "engine/engineworker.h"
 #include "engine/engineworkerscheduler.h"
 #include "util/event.h"
+#include "util/threadplacement.h"
 
 EngineWorkerScheduler::EngineWorkerScheduler(QObject* pParent)
         : m_bWakeScheduler(false),
@@ -40,9 +42,24 @@ void EngineWorkerScheduler::runWorkers() {
     }
 }
 
+void EngineWorkerScheduler::removeWorker(EngineWorker* pWorker) {
+    // Wake the other workers that are still scheduled, so that pWorker is not
+    // left in the FIFO.
+    QMutexLocker locker(&m_mutex);
+    EngineWorker* pScheduled = NULL;
+    while (m_scheduleFIFO.read(&pScheduled, 1) == 1) {
+        if (pScheduled && pScheduled != pWorker) {
+            pScheduled->wake();
+        }
+    }
+}
+
 void EngineWorkerScheduler::run() {
+    ThreadPlacement::placeCurrentThread(ThreadPlacement::REALTIME_WORKER,
+                                        "EngineWorkerScheduler");
     while (!m_bQuit) {
         Event::start("EngineWorkerScheduler");
+        m_mutex.lock();
         EngineWorker* pWorker = NULL;
         while (m_scheduleFIFO.read(&pWorker, 1) == 1) {
             if (pWorker) {
@@ -50,7 +67,6 @@ void EngineWorkerScheduler::run() {
             }
         }
         Event::end("EngineWorkerScheduler");
-        m_mutex.lock();
         m_waitCondition.wait(&m_mutex); // unlock mutex and wait
         m_mutex.unlock();
     }
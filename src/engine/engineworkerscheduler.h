@@ -21,6 +21,9 @@ class EngineWorkerScheduler : public QThread {
 
     void runWorkers();
     void workerReady(EngineWorker* worker);
+    // Drops pWorker from the scheduled workers. Called by pWorker when it is
+    // unbound or deleted, once the callback can no longer schedule it.
+    void removeWorker(EngineWorker* pWorker);
 
   protected:
     void run();
@@ -32,6 +35,8 @@ class EngineWorkerScheduler : public QThread {
 
     FIFO<EngineWorker*> m_scheduleFIFO;
     QWaitCondition m_waitCondition;
+    // Held while reading m_scheduleFIFO, so that removeWorker() can read it
+    // too.
     QMutex m_mutex;
     volatile bool m_bQuit;
 };
@@ -0,0 +1,81 @@
+#include <QMutableListIterator>
+#include <QMutexLocker>
+
+#include "engine/metering/enginemetering.h"
+#include "engine/metering/meteringtap.h"
+#include "controlobjectslave.h"
+#include "util/threadplacement.h"
+#include "util/trace.h"
+
+namespace {
+
+// Fits the display frame rate, like the VU meters.
+const unsigned long kUpdateIntervalMillis = 1000 / 30;
+
+}  // namespace
+
+EngineMetering::EngineMetering()
+        : m_bStopThread(false) {
+    m_pSampleRate = new ControlObjectSlave("[Master]", "samplerate", this);
+    // The meters are for display only. They may lag behind anything else.
+    start(QThread::LowPriority);
+}
+
+EngineMetering::~EngineMetering() {
+    m_waitLock.lock();
+    m_bStopThread = true;
+    m_waitForStop.wakeAll();
+    m_waitLock.unlock();
+
+    // Wait until the thread has finished.
+    wait();
+
+    while (!m_taps.empty()) {
+        delete m_taps.takeLast();
+    }
+}
+
+MeteringTap* EngineMetering::addTap(const QString& group) {
+    MeteringTap* pTap = new MeteringTap(group);
+    QMutexLocker locker(&m_tapLock);
+    m_taps.append(pTap);
+    return pTap;
+}
+
+void EngineMetering::run() {
+    QThread::currentThread()->setObjectName("EngineMetering");
+    ThreadPlacement::placeCurrentThread(ThreadPlacement::BACKGROUND);
+
+    while (true) {
+        m_waitLock.lock();
+        if (!m_bStopThread) {
+            m_waitForStop.wait(&m_waitLock, kUpdateIntervalMillis);
+        }
+        const bool bStop = m_bStopThread;
+        m_waitLock.unlock();
+        if (bStop) {
+            return;
+        }
+        updateTaps();
+    }
+}
+
+void EngineMetering::updateTaps() {
+    Trace t("EngineMetering::updateTaps");
+    const int sampleRate = static_cast<int>(m_pSampleRate->get());
+    if (sampleRate <= 0) {
+        return;
+    }
+    QMutexLocker locker(&m_tapLock);
+    QMutableListIterator<MeteringTap*> it(m_taps);
+    while (it.hasNext()) {
+        MeteringTap* pTap = it.next();
+        if (pTap->isRetired()) {
+            // The tap and its controls belong to the main thread.
+            it.remove();
+            pTap->deleteLater();
+            continue;
+        }
+        pTap->update(sampleRate);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef ENGINEMETERING_H
+#define ENGINEMETERING_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+class ControlObjectSlave;
+class MeteringTap;
+
+// Runs the meters that are too costly for the callback: spectrum, loudness
+// and true peak. The callback copies the audio of every metered group into
+// its MeteringTap. This low priority thread reads the taps at the refresh
+// rate of the GUI, analyses the audio and publishes the readings as
+// controls.
+class EngineMetering : public QThread {
+    Q_OBJECT
+  public:
+    EngineMetering();
+    virtual ~EngineMetering();
+
+    // Creates the tap and the meter controls of group. Call from the main
+    // thread. The tap is deleted by EngineMetering after it was retired.
+    MeteringTap* addTap(const QString& group);
+
+  private:
+    void run();
+    void updateTaps();
+
+    // Indicates that the thread should exit.
+    volatile bool m_bStopThread;
+    QMutex m_waitLock;
+    QWaitCondition m_waitForStop;
+
+    // Protects m_taps.
+    QMutex m_tapLock;
+    QList<MeteringTap*> m_taps;
+
+    ControlObjectSlave* m_pSampleRate;
+};
+
+#endif /* ENGINEMETERING_H */
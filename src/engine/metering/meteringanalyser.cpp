@@ -0,0 +1,217 @@
+#include <math.h>
+#include <string.h>
+
+#include "engine/metering/meteringanalyser.h"
+#include "util/math.h"
+
+namespace {
+
+// Loudness is measured in blocks of 100 ms. The momentary loudness spans 4
+// of them, the short-term loudness 30.
+const int kBlocksPerSecond = 10;
+const int kMomentaryBlocks = 4;
+const int kShortTermBlocks = 30;
+
+// The true peak is found in the signal oversampled by 4 with a windowed sinc
+// of 12 taps per phase.
+const int kOversampling = 4;
+const int kTapsPerPhase = 12;
+
+const int kSpectrumSize = 2048;
+const double kLowestBandFrequency = 40.0;
+const double kHighestBandFrequency = 16000.0;
+const double kSpectrumRange = 60.0;
+
+}  // namespace
+
+// static
+const double MeteringAnalyser::kMinimumLevel = -70.0;
+
+void MeteringAnalyser::Biquad::setCoefficients(double b0, double b1, double b2,
+                                               double a1, double a2) {
+    this->b0 = b0;
+    this->b1 = b1;
+    this->b2 = b2;
+    this->a1 = a1;
+    this->a2 = a2;
+}
+
+void MeteringAnalyser::Biquad::reset() {
+    for (int channel = 0; channel < 2; ++channel) {
+        x1[channel] = x2[channel] = y1[channel] = y2[channel] = 0.0;
+    }
+}
+
+inline double MeteringAnalyser::Biquad::process(int channel, double x) {
+    const double y = b0 * x + b1 * x1[channel] + b2 * x2[channel]
+            - a1 * y1[channel] - a2 * y2[channel];
+    x2[channel] = x1[channel];
+    x1[channel] = x;
+    y2[channel] = y1[channel];
+    y1[channel] = y;
+    return y;
+}
+
+MeteringAnalyser::MeteringAnalyser(int sampleRate)
+        : m_iSampleRate(sampleRate),
+          m_iBlockFrames(math_max(sampleRate / kBlocksPerSecond, 1)),
+          m_blocks(kShortTermBlocks),
+          m_oversamplingTaps(kOversampling * kTapsPerPhase),
+          m_fft(kSpectrumSize),
+          m_window(kSpectrumSize),
+          m_spectrumInput(kSpectrumSize),
+          m_frame(kSpectrumSize),
+          m_magnitudes(kSpectrumSize / 2 + 1) {
+    // The K-weighting filters of BS.1770 for any sample rate, as derived by
+    // the EBU R 128 reference implementations.
+    double K = tan(M_PI * 1681.974450955533 / sampleRate);
+    double Q = 0.7071752369554196;
+    const double Vh = pow(10.0, 3.999843853973347 / 20.0);
+    const double Vb = pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K / Q + K * K;
+    m_shelf.setCoefficients((Vh + Vb * K / Q + K * K) / a0,
+                            2.0 * (K * K - Vh) / a0,
+                            (Vh - Vb * K / Q + K * K) / a0,
+                            2.0 * (K * K - 1.0) / a0,
+                            (1.0 - K / Q + K * K) / a0);
+    K = tan(M_PI * 38.13547087602444 / sampleRate);
+    Q = 0.5003270373238773;
+    a0 = 1.0 + K / Q + K * K;
+    m_highPass.setCoefficients(1.0, -2.0, 1.0,
+                               2.0 * (K * K - 1.0) / a0,
+                               (1.0 - K / Q + K * K) / a0);
+
+    // Phase p of the oversampling filter uses taps p, p + 4, p + 8, ...
+    const int taps = m_oversamplingTaps.size();
+    const double center = (taps - 1) / 2.0;
+    for (int i = 0; i < taps; ++i) {
+        const double x = (i - center) / kOversampling;
+        const double sinc = x == 0.0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        const double window = 0.42 - 0.5 * cos(2 * M_PI * (i + 0.5) / taps)
+                + 0.08 * cos(4 * M_PI * (i + 0.5) / taps);
+        m_oversamplingTaps[i] = sinc * window;
+    }
+    m_history[0].resize(2 * kTapsPerPhase);
+    m_history[1].resize(2 * kTapsPerPhase);
+
+    for (int i = 0; i < kSpectrumSize; ++i) {
+        m_window[i] = 0.5f - 0.5f * cos(2 * M_PI * i / kSpectrumSize);
+    }
+    const double binWidth = static_cast<double>(sampleRate) / kSpectrumSize;
+    const double highest = math_min(kHighestBandFrequency, sampleRate / 2.0);
+    int previous = 0;
+    for (int band = 0; band <= kSpectrumBands; ++band) {
+        const double frequency = kLowestBandFrequency *
+                pow(highest / kLowestBandFrequency,
+                    static_cast<double>(band) / kSpectrumBands);
+        // Every band covers at least one bin.
+        int bin = math_max(static_cast<int>(frequency / binWidth + 0.5),
+                           band == 0 ? 1 : previous + 1);
+        m_bandBins[band] = math_min(bin, kSpectrumSize / 2);
+        previous = m_bandBins[band];
+    }
+
+    reset();
+}
+
+void MeteringAnalyser::reset() {
+    m_shelf.reset();
+    m_highPass.reset();
+    m_iBlockFramesDone = 0;
+    m_blockSquares = 0.0;
+    m_blocks.fill(0.0);
+    m_iCurrentBlock = 0;
+    m_history[0].fill(0.0f);
+    m_history[1].fill(0.0f);
+    m_iHistoryPosition = 0;
+    m_truePeak = 0.0f;
+    m_spectrumInput.fill(0.0f);
+    m_iSpectrumPosition = 0;
+}
+
+void MeteringAnalyser::process(const CSAMPLE* pIn, int iLen) {
+    const float* pTaps = m_oversamplingTaps.constData();
+    for (int i = 0; i < iLen; i += 2) {
+        for (int channel = 0; channel < 2; ++channel) {
+            const double weighted = m_highPass.process(
+                    channel, m_shelf.process(channel, pIn[i + channel]));
+            m_blockSquares += weighted * weighted;
+
+            float* pHistory = m_history[channel].data();
+            pHistory[m_iHistoryPosition] = pIn[i + channel];
+            pHistory[m_iHistoryPosition + kTapsPerPhase] = pIn[i + channel];
+            // The newest sample is at the end of the contiguous taps.
+            const float* pRecent = pHistory + m_iHistoryPosition + 1;
+            for (int phase = 0; phase < kOversampling; ++phase) {
+                float sum = 0.0f;
+                for (int tap = 0; tap < kTapsPerPhase; ++tap) {
+                    sum += pRecent[kTapsPerPhase - 1 - tap] *
+                            pTaps[phase + tap * kOversampling];
+                }
+                m_truePeak = math_max(m_truePeak, static_cast<CSAMPLE>(fabs(sum)));
+            }
+        }
+        m_iHistoryPosition = (m_iHistoryPosition + 1) % kTapsPerPhase;
+
+        m_spectrumInput[m_iSpectrumPosition] = 0.5f * (pIn[i] + pIn[i + 1]);
+        m_iSpectrumPosition = (m_iSpectrumPosition + 1) % kSpectrumSize;
+
+        if (++m_iBlockFramesDone == m_iBlockFrames) {
+            m_iCurrentBlock = (m_iCurrentBlock + 1) % kShortTermBlocks;
+            m_blocks[m_iCurrentBlock] = m_blockSquares / m_iBlockFrames;
+            m_blockSquares = 0.0;
+            m_iBlockFramesDone = 0;
+        }
+    }
+}
+
+double MeteringAnalyser::loudness(int blocks) const {
+    double sum = 0.0;
+    for (int i = 0; i < blocks; ++i) {
+        sum += m_blocks[(m_iCurrentBlock - i + kShortTermBlocks) % kShortTermBlocks];
+    }
+    // Both channels are weighted with 1.
+    const double meanSquare = sum / blocks;
+    if (meanSquare <= 0.0) {
+        return kMinimumLevel;
+    }
+    return math_max(-0.691 + 10.0 * log10(meanSquare), kMinimumLevel);
+}
+
+double MeteringAnalyser::momentaryLoudness() const {
+    return loudness(kMomentaryBlocks);
+}
+
+double MeteringAnalyser::shortTermLoudness() const {
+    return loudness(kShortTermBlocks);
+}
+
+double MeteringAnalyser::takeTruePeak() {
+    const CSAMPLE peak = m_truePeak;
+    m_truePeak = 0.0f;
+    if (peak <= 0.0f) {
+        return kMinimumLevel;
+    }
+    return math_max(20.0 * log10(peak), kMinimumLevel);
+}
+
+void MeteringAnalyser::spectrum(double* pBands) {
+    for (int i = 0; i < kSpectrumSize; ++i) {
+        m_frame[i] = m_window[i] *
+                m_spectrumInput[(m_iSpectrumPosition + i) % kSpectrumSize];
+    }
+    m_fft.magnitudes(m_frame.constData(), m_magnitudes.data());
+    // A full scale sine reaches a quarter of the size with the Hann window.
+    const double fullScale = kSpectrumSize / 4.0;
+    for (int band = 0; band < kSpectrumBands; ++band) {
+        float peak = 0.0f;
+        for (int bin = m_bandBins[band]; bin < math_max(m_bandBins[band + 1],
+                                                        m_bandBins[band] + 1); ++bin) {
+            peak = math_max(peak, m_magnitudes[bin]);
+        }
+        const double level = peak > 0.0f ?
+                20.0 * log10(peak / fullScale) : -kSpectrumRange;
+        pBands[band] = math_clamp((level + kSpectrumRange) / kSpectrumRange,
+                                  0.0, 1.0);
+    }
+}
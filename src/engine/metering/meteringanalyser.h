@@ -0,0 +1,89 @@
+#ifndef METERINGANALYSER_H
+#define METERINGANALYSER_H
+
+#include <QVector>
+
+#include "util/fft.h"
+#include "util/types.h"
+
+// Computes the meter readings of a stereo signal: the momentary and
+// short-term loudness and the true peak following ITU-R BS.1770, and the
+// levels of a few logarithmically spaced frequency bands.
+//
+// The work is too costly for the callback. MeteringAnalyser is fed by the
+// metering thread from the audio a MeteringTap collected.
+class MeteringAnalyser {
+  public:
+    static const int kSpectrumBands = 16;
+    // The reading of silence, in LUFS and dBTP.
+    static const double kMinimumLevel;
+
+    explicit MeteringAnalyser(int sampleRate);
+
+    int sampleRate() const {
+        return m_iSampleRate;
+    }
+
+    // Forgets the signal so far, as if there was silence.
+    void reset();
+
+    // Takes iLen interleaved stereo samples.
+    void process(const CSAMPLE* pIn, int iLen);
+
+    // The loudness of the last 400 ms in LUFS.
+    double momentaryLoudness() const;
+    // The loudness of the last 3 s in LUFS.
+    double shortTermLoudness() const;
+    // The highest true peak since the last call in dBTP.
+    double takeTruePeak();
+    // The level of every band of the most recent samples, from 0 at -60 dBFS
+    // to 1 at full scale.
+    void spectrum(double* pBands);
+
+  private:
+    // A biquad section in direct form I for both channels.
+    struct Biquad {
+        void setCoefficients(double b0, double b1, double b2,
+                             double a1, double a2);
+        void reset();
+        inline double process(int channel, double x);
+
+        double b0, b1, b2, a1, a2;
+        double x1[2], x2[2], y1[2], y2[2];
+    };
+
+    double loudness(int blocks) const;
+
+    const int m_iSampleRate;
+
+    // K-weighting: the head shelving filter and the high pass.
+    Biquad m_shelf;
+    Biquad m_highPass;
+    int m_iBlockFrames;
+    int m_iBlockFramesDone;
+    double m_blockSquares;
+    // The mean squares of the last 100 ms blocks, the newest at
+    // m_iCurrentBlock.
+    QVector<double> m_blocks;
+    int m_iCurrentBlock;
+
+    // The polyphase filter of the 4 times oversampling for the true peak.
+    QVector<float> m_oversamplingTaps;
+    // The input history of each channel, stored twice so that the newest
+    // taps are always contiguous.
+    QVector<float> m_history[2];
+    int m_iHistoryPosition;
+    CSAMPLE m_truePeak;
+
+    FFT m_fft;
+    QVector<float> m_window;
+    // The most recent mono samples, m_iSpectrumPosition is the oldest.
+    QVector<float> m_spectrumInput;
+    int m_iSpectrumPosition;
+    QVector<float> m_frame;
+    QVector<float> m_magnitudes;
+    // The first and last FFT bin of every band.
+    int m_bandBins[kSpectrumBands + 1];
+};
+
+#endif /* METERINGANALYSER_H */
@@ -0,0 +1,107 @@
+#include "engine/metering/meteringtap.h"
+#include "controlobject.h"
+#include "sampleutil.h"
+#include "util/counter.h"
+
+namespace {
+
+// Holds a bit more than a second of audio at 44.1 kHz, enough for the
+// metering thread to be late for a few updates.
+const int kFifoSize = 131072;
+const int kWorkBufferSize = 8192;
+// After this many updates without audio the group is silent. Large audio
+// buffers are written less often than the meters are updated.
+const int kUpdatesUntilSilence = 15;
+
+}  // namespace
+
+MeteringTap::MeteringTap(const QString& group)
+        : m_fifo(kFifoSize),
+          m_pWorkBuffer(SampleUtil::alloc(kWorkBufferSize)),
+          m_pAnalyser(NULL),
+          m_iIdleUpdates(0),
+          m_retired(0) {
+    m_pMomentaryLoudness = new ControlObject(
+            ConfigKey(group, "loudness_momentary"));
+    m_pShortTermLoudness = new ControlObject(
+            ConfigKey(group, "loudness_short_term"));
+    m_pTruePeak = new ControlObject(ConfigKey(group, "true_peak"));
+    for (int band = 0; band < MeteringAnalyser::kSpectrumBands; ++band) {
+        m_pSpectrumBands[band] = new ControlObject(
+                ConfigKey(group, QString("spectrum_band_%1").arg(band + 1)));
+    }
+    publishSilence();
+}
+
+MeteringTap::~MeteringTap() {
+    delete m_pMomentaryLoudness;
+    delete m_pShortTermLoudness;
+    delete m_pTruePeak;
+    for (int band = 0; band < MeteringAnalyser::kSpectrumBands; ++band) {
+        delete m_pSpectrumBands[band];
+    }
+    delete m_pAnalyser;
+    SampleUtil::free(m_pWorkBuffer);
+}
+
+void MeteringTap::write(const CSAMPLE* pBuffer, CSAMPLE_GAIN gain,
+                        int iBufferSize) {
+    // Whole buffers only, so the channels stay interleaved.
+    if (m_fifo.writeAvailable() < iBufferSize) {
+        Counter("MeteringTap::write buffer overrun").increment();
+        return;
+    }
+    CSAMPLE* pRegion1;
+    ring_buffer_size_t size1;
+    CSAMPLE* pRegion2;
+    ring_buffer_size_t size2;
+    m_fifo.aquireWriteRegions(iBufferSize, &pRegion1, &size1,
+                              &pRegion2, &size2);
+    SampleUtil::copyWithGain(pRegion1, pBuffer, gain, size1);
+    if (size2 > 0) {
+        SampleUtil::copyWithGain(pRegion2, pBuffer + size1, gain, size2);
+    }
+    m_fifo.releaseWriteRegions(size1 + size2);
+}
+
+void MeteringTap::update(int sampleRate) {
+    if (m_pAnalyser == NULL || m_pAnalyser->sampleRate() != sampleRate) {
+        delete m_pAnalyser;
+        m_pAnalyser = new MeteringAnalyser(sampleRate);
+    }
+
+    int samplesRead = 0;
+    int samples;
+    while ((samples = m_fifo.read(m_pWorkBuffer, kWorkBufferSize)) > 0) {
+        m_pAnalyser->process(m_pWorkBuffer, samples);
+        samplesRead += samples;
+    }
+
+    if (samplesRead > 0) {
+        m_iIdleUpdates = 0;
+        publish();
+    } else if (++m_iIdleUpdates == kUpdatesUntilSilence) {
+        m_pAnalyser->reset();
+        publishSilence();
+    }
+}
+
+void MeteringTap::publish() {
+    m_pMomentaryLoudness->set(m_pAnalyser->momentaryLoudness());
+    m_pShortTermLoudness->set(m_pAnalyser->shortTermLoudness());
+    m_pTruePeak->set(m_pAnalyser->takeTruePeak());
+    double bands[MeteringAnalyser::kSpectrumBands];
+    m_pAnalyser->spectrum(bands);
+    for (int band = 0; band < MeteringAnalyser::kSpectrumBands; ++band) {
+        m_pSpectrumBands[band]->set(bands[band]);
+    }
+}
+
+void MeteringTap::publishSilence() {
+    m_pMomentaryLoudness->set(MeteringAnalyser::kMinimumLevel);
+    m_pShortTermLoudness->set(MeteringAnalyser::kMinimumLevel);
+    m_pTruePeak->set(MeteringAnalyser::kMinimumLevel);
+    for (int band = 0; band < MeteringAnalyser::kSpectrumBands; ++band) {
+        m_pSpectrumBands[band]->set(0.0);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef METERINGTAP_H
+#define METERINGTAP_H
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QString>
+
+#include "engine/metering/meteringanalyser.h"
+#include "util/fifo.h"
+#include "util/types.h"
+
+class ControlObject;
+
+// Collects the audio of one group for the metering thread and publishes the
+// readings of its MeteringAnalyser as controls of the group:
+//   loudness_momentary, loudness_short_term  LUFS
+//   true_peak                                dBTP
+//   spectrum_band_1 ... spectrum_band_16     0 to 1, low to high frequencies
+// Silence reads MeteringAnalyser::kMinimumLevel.
+//
+// Owned by EngineMetering. The tap and its controls belong to the main
+// thread.
+class MeteringTap : public QObject {
+    Q_OBJECT
+  public:
+    explicit MeteringTap(const QString& group);
+    virtual ~MeteringTap();
+
+    // Called from the callback, wait-free. Copies iBufferSize samples of
+    // pBuffer multiplied with gain. The buffer is dropped if the metering
+    // thread has fallen behind.
+    void write(const CSAMPLE* pBuffer, CSAMPLE_GAIN gain, int iBufferSize);
+
+    // Called from the metering thread. Analyses the samples written since
+    // the last update and publishes the readings.
+    void update(int sampleRate);
+
+    // Called when nothing writes to the tap anymore. The metering thread
+    // deletes retired taps.
+    void retire() {
+        m_retired = 1;
+    }
+    bool isRetired() const {
+        return m_retired;
+    }
+
+  private:
+    void publish();
+    void publishSilence();
+
+    FIFO<CSAMPLE> m_fifo;
+    CSAMPLE* m_pWorkBuffer;
+    MeteringAnalyser* m_pAnalyser;
+    // The number of updates without new samples.
+    int m_iIdleUpdates;
+    QAtomicInt m_retired;
+
+    ControlObject* m_pMomentaryLoudness;
+    ControlObject* m_pShortTermLoudness;
+    ControlObject* m_pTruePeak;
+    ControlObject* m_pSpectrumBands[MeteringAnalyser::kSpectrumBands];
+};
+
+#endif /* METERINGTAP_H */
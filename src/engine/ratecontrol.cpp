@@ -79,10 +79,6 @@ RateControl::RateControl(QString group,
 
     m_pSlipEnabled = new ControlObjectSlave(group, "slip_enabled", this);
 
-    m_pVCEnabled = ControlObject::getControl(ConfigKey(getGroup(), "vinylcontrol_enabled"));
-    m_pVCScratching = ControlObject::getControl(ConfigKey(getGroup(), "vinylcontrol_scratching"));
-    m_pVCMode = ControlObject::getControl(ConfigKey(getGroup(), "vinylcontrol_mode"));
-
     // Permanent rate-change buttons
     buttonRatePermDown =
         new ControlPushButton(ConfigKey(group,"rate_perm_down"));
@@ -410,36 +406,37 @@ SyncMode RateControl::getSyncMode() const {
     return syncModeFromDouble(m_pSyncMode->get());
 }
 
-double RateControl::calculateSpeed(double baserate, double speed, bool paused,
-                                  int iSamplesPerBuffer,
-                                  bool* reportScratching) {
+double RateControl::calculateSpeed(const DeckParams& params, double baserate,
+                                   double speed, int iSamplesPerBuffer,
+                                   bool* reportScratching) {
     *reportScratching = false;
+    const bool paused = !params.play;
     double rate = (paused ? 0 : 1.0);
-    double searching = m_pRateSearch->get();
+    double searching = params.rateSearch;
     if (searching) {
         // If searching is in progress, it overrides everything else
         rate = searching;
     } else {
         double wheelFactor = getWheelFactor();
         double jogFactor = getJogFactor();
-        bool bVinylControlEnabled = m_pVCEnabled && m_pVCEnabled->toBool();
-        bool useScratch2Value = m_pScratch2Enable->get() != 0;
+        bool bVinylControlEnabled = params.vinylControlEnabled;
+        bool useScratch2Value = params.scratch2Enable;
 
         // By default scratch2_enable is enough to determine if the user is
         // scratching or not. Moving platter controllers have to disable
         // "scratch2_indicates_scratching" if they are not scratching,
         // to allow things like key-lock.
-        if (useScratch2Value && m_pScratch2Scratching->get()) {
+        if (useScratch2Value && params.scratch2Scratching) {
             *reportScratching = true;
         }
 
         if (bVinylControlEnabled) {
-            if (m_pVCScratching->toBool()) {
+            if (params.vinylControlScratching) {
                 *reportScratching = true;
             }
             rate = speed;
         } else {
-            double scratchFactor = m_pScratch2->get();
+            double scratchFactor = params.scratch2;
             // Don't trust values from m_pScratch2
             if (isnan(scratchFactor)) {
                 scratchFactor = 0.0;
@@ -492,15 +489,15 @@ double RateControl::calculateSpeed(double baserate, double speed, bool paused,
                     // Only report user tweak if the user is not scratching.
                     userTweak = getTempRate() + wheelFactor + jogFactor;
                 }
-                rate = m_pBpmControl->calcSyncedRate(userTweak);
+                rate = m_pBpmControl->calcSyncedRate(params, userTweak);
             }
             // If we are reversing (and not scratching,) flip the rate.  This is ok even when syncing.
             // Reverse with vinyl is only ok if absolute mode isn't on.
-            int vcmode = m_pVCMode ? m_pVCMode->get() : MIXXX_VCMODE_ABSOLUTE;
+            int vcmode = params.vinylControlMode;
             // TODO(owen): Instead of just ignoring reverse mode, should we
             // disable absolute mode instead?
-            if (m_pReverseButton->get()
-                    && !m_pScratch2Enable->get()
+            if (params.reverse
+                    && !params.scratch2Enable
                     && (!bVinylControlEnabled || vcmode != MIXXX_VCMODE_ABSOLUTE)) {
                 rate = -rate;
             }
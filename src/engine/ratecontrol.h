@@ -7,6 +7,7 @@
 #include <QObject>
 
 #include "configobject.h"
+#include "engine/deckparams.h"
 #include "engine/enginecontrol.h"
 #include "engine/sync/syncable.h"
 
@@ -44,8 +45,9 @@ public:
     // Returns the current engine rate.  "reportScratching" is used to tell
     // the caller that the user is currently scratching, and this is used to
     // disable keylock.
-    double calculateSpeed(double baserate, double speed, bool paused,
-                         int iSamplesPerBuffer, bool* reportScratching);
+    double calculateSpeed(const DeckParams& params, double baserate,
+                          double speed, int iSamplesPerBuffer,
+                          bool* reportScratching);
     double getRawRate() const;
 
     // Set rate change when temp rate button is pressed
@@ -114,9 +116,6 @@ public:
 
     ControlPushButton* m_pScratch2Enable;
     ControlObject* m_pJog;
-    ControlObject* m_pVCEnabled;
-    ControlObject* m_pVCScratching;
-    ControlObject* m_pVCMode;
     ControlObject* m_pScratch2Scratching;
     Rotary* m_pJogFilter;
 
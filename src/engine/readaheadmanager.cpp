@@ -1,8 +1,6 @@
 // readaheadmanager.cpp
 // Created 8/2/2009 by RJ Ryan (rryan@mit.edu)
 
-#include <QMutexLocker>
-
 #include "engine/readaheadmanager.h"
 #include "sampleutil.h"
 #include "util/math.h"
@@ -11,6 +9,8 @@
 #include "cachingreader.h"
 
 ReadAheadManager::ReadAheadManager(CachingReader* pReader) :
+    m_iReadLogFirst(0),
+    m_iReadLogSize(0),
     m_iCurrentPosition(0),
     m_pReader(pReader),
     m_pCrossFadeBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)) {
@@ -139,15 +139,13 @@ void ReadAheadManager::addEngineControl(EngineControl* pControl) {
 }
 
 void ReadAheadManager::setNewPlaypos(int iNewPlaypos) {
-    QMutexLocker locker(&m_mutex);
     m_iCurrentPosition = iNewPlaypos;
-    m_readAheadLog.clear();
+    clearReadLog();
 }
 
 void ReadAheadManager::notifySeek(int iSeekPosition) {
-    QMutexLocker locker(&m_mutex);
     m_iCurrentPosition = iSeekPosition;
-    m_readAheadLog.clear();
+    clearReadLog();
 
     // TODO(XXX) notifySeek on the engine controls. EngineBuffer currently does
     // a fine job of this so it isn't really necessary but eventually I think
@@ -184,16 +182,20 @@ void ReadAheadManager::hintReader(double dRate, HintVector* pHintList) {
 
 void ReadAheadManager::addReadLogEntry(double virtualPlaypositionStart,
                                        double virtualPlaypositionEndNonInclusive) {
-    QMutexLocker locker(&m_mutex);
     ReadLogEntry newEntry(virtualPlaypositionStart,
                           virtualPlaypositionEndNonInclusive);
-    if (m_readAheadLog.size() > 0) {
-        ReadLogEntry& last = m_readAheadLog.last();
-        if (last.merge(newEntry)) {
-            return;
-        }
+    if (m_iReadLogSize > 0 && readLogLast().merge(newEntry)) {
+        return;
+    }
+    if (m_iReadLogSize == kReadLogCapacity) {
+        // Forget the oldest read. The position we report for it will be off
+        // until the played samples have caught up with the next one.
+        m_iReadLogFirst = (m_iReadLogFirst + 1) % kReadLogCapacity;
+        --m_iReadLogSize;
     }
-    m_readAheadLog.append(newEntry);
+    m_readAheadLog[(m_iReadLogFirst + m_iReadLogSize) % kReadLogCapacity] =
+            newEntry;
+    ++m_iReadLogSize;
 }
 
 int ReadAheadManager::getEffectiveVirtualPlaypositionFromLog(double currentVirtualPlayposition,
@@ -202,8 +204,7 @@ int ReadAheadManager::getEffectiveVirtualPlaypositionFromLog(double currentVirtu
         return currentVirtualPlayposition;
     }
 
-    QMutexLocker locker(&m_mutex);
-    if (m_readAheadLog.size() == 0) {
+    if (m_iReadLogSize == 0) {
         // No log entries to read from.
         qDebug() << this << "No read ahead log entries to read from. Case not currently handled.";
         // TODO(rryan) log through a stats pipe eventually
@@ -213,8 +214,8 @@ int ReadAheadManager::getEffectiveVirtualPlaypositionFromLog(double currentVirtu
     double virtualPlayposition = 0;
     bool shouldNotifySeek = false;
     bool direction = true;
-    while (m_readAheadLog.size() > 0 && numConsumedSamples > 0) {
-        ReadLogEntry& entry = m_readAheadLog.first();
+    while (m_iReadLogSize > 0 && numConsumedSamples > 0) {
+        ReadLogEntry& entry = readLogFirst();
         direction = entry.direction();
 
         // Notify EngineControls that we have taken a seek.
@@ -233,7 +234,8 @@ int ReadAheadManager::getEffectiveVirtualPlaypositionFromLog(double currentVirtu
 
         if (entry.length() == 0) {
             // This entry is empty now.
-            m_readAheadLog.removeFirst();
+            m_iReadLogFirst = (m_iReadLogFirst + 1) % kReadLogCapacity;
+            --m_iReadLogSize;
         }
         shouldNotifySeek = true;
     }
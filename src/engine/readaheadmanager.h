@@ -4,9 +4,7 @@
 #ifndef READAHEADMANGER_H
 #define READAHEADMANGER_H
 
-#include <QLinkedList>
 #include <QList>
-#include <QMutex>
 #include <QPair>
 
 #include "util/types.h"
@@ -25,6 +23,10 @@ class CachingReader;
 // seeks or the current play position is invalidated somehow, the Engine must
 // call notifySeek to inform the ReadAheadManager to reset itself to the seek
 // point.
+//
+// ReadAheadManager is not thread safe. It belongs to an EngineBuffer and must
+// only be used from the engine callback. It does not allocate memory after
+// construction.
 class ReadAheadManager {
   public:
     explicit ReadAheadManager(CachingReader* reader);
@@ -70,6 +72,11 @@ class ReadAheadManager {
         double virtualPlaypositionStart;
         double virtualPlaypositionEndNonInclusive;
 
+        ReadLogEntry()
+                : virtualPlaypositionStart(0),
+                  virtualPlaypositionEndNonInclusive(0) {
+        }
+
         ReadLogEntry(double virtualPlaypositionStart,
                      double virtualPlaypositionEndNonInclusive) {
             this->virtualPlaypositionStart = virtualPlaypositionStart;
@@ -118,9 +125,28 @@ class ReadAheadManager {
     void addReadLogEntry(double virtualPlaypositionStart,
                          double virtualPlaypositionEndNonInclusive);
 
-    QMutex m_mutex;
+    inline ReadLogEntry& readLogFirst() {
+        return m_readAheadLog[m_iReadLogFirst];
+    }
+    inline ReadLogEntry& readLogLast() {
+        return m_readAheadLog[(m_iReadLogFirst + m_iReadLogSize - 1) %
+                              kReadLogCapacity];
+    }
+    inline void clearReadLog() {
+        m_iReadLogFirst = 0;
+        m_iReadLogSize = 0;
+    }
+
+    // The log is consumed every callback and adjacent reads are merged, so
+    // it only holds more than a few entries if the scaler reads ahead through
+    // many tiny loops.
+    static const int kReadLogCapacity = 256;
+
     QList<EngineControl*> m_sEngineControls;
-    QLinkedList<ReadLogEntry> m_readAheadLog;
+    // A ring of the reads that have not been played yet, oldest first.
+    ReadLogEntry m_readAheadLog[kReadLogCapacity];
+    int m_iReadLogFirst;
+    int m_iReadLogSize;
     int m_iCurrentPosition;
     CachingReader* m_pReader;
     CSAMPLE* m_pCrossFadeBuffer;
@@ -27,6 +27,7 @@
 
 #include "engine/sidechain/enginesidechain.h"
 #include "engine/sidechain/sidechainworker.h"
+#include "util/threadplacement.h"
 #include "util/timer.h"
 #include "util/counter.h"
 #include "util/event.h"
@@ -94,6 +95,7 @@ void EngineSideChain::run() {
     // factor this out somehow), -kousu 2/2009
     unsigned static id = 0;
     QThread::currentThread()->setObjectName(QString("EngineSideChain %1").arg(++id));
+    ThreadPlacement::placeCurrentThread(ThreadPlacement::BACKGROUND);
 
     Event::start("EngineSideChain");
     while (!m_bStopThread) {
@@ -2,14 +2,19 @@
 
 #include <QMetaType>
 
+#include "engine/enginegarbagecollector.h"
 #include "engine/sync/internalclock.h"
 
 static const char* kInternalClockGroup = "[InternalClock]";
 
-BaseSyncableListener::BaseSyncableListener(ConfigObject<ConfigValue>* pConfig)
+BaseSyncableListener::BaseSyncableListener(
+        ConfigObject<ConfigValue>* pConfig,
+        EngineGarbageCollector* pGarbageCollector)
         : m_pConfig(pConfig),
           m_pInternalClock(new InternalClock(kInternalClockGroup, this)),
-          m_pMasterSyncable(NULL) {
+          m_pMasterSyncable(NULL),
+          m_pGarbageCollector(pGarbageCollector),
+          m_pSyncables(new QList<Syncable*>()) {
     qRegisterMetaType<SyncMode>("SyncMode");
     m_pInternalClock->setMasterBpm(124.0);
 }
@@ -19,14 +24,39 @@ BaseSyncableListener::~BaseSyncableListener() {
     m_pConfig->set(ConfigKey("[InternalClock]", "bpm"), ConfigValue(
         m_pInternalClock->getBpm()));
     delete m_pInternalClock;
+    delete m_pSyncables.fetchAndStoreOrdered(NULL);
 }
 
 void BaseSyncableListener::addSyncableDeck(Syncable* pSyncable) {
-    if (m_syncables.contains(pSyncable)) {
+    if (syncables().contains(pSyncable)) {
         qDebug() << "BaseSyncableListener: already has" << pSyncable;
         return;
     }
-    m_syncables.append(pSyncable);
+    QList<Syncable*>* pSyncables = new QList<Syncable*>(syncables());
+    pSyncables->append(pSyncable);
+    swapSyncables(pSyncables);
+}
+
+void BaseSyncableListener::removeSyncableDeck(Syncable* pSyncable) {
+    if (!syncables().contains(pSyncable)) {
+        return;
+    }
+    if (pSyncable->getSyncMode() != SYNC_NONE) {
+        // Hands master over to the internal clock if pSyncable was master.
+        requestSyncMode(pSyncable, SYNC_NONE);
+    }
+    QList<Syncable*>* pSyncables = new QList<Syncable*>(syncables());
+    pSyncables->removeOne(pSyncable);
+    swapSyncables(pSyncables);
+}
+
+void BaseSyncableListener::swapSyncables(QList<Syncable*>* pSyncables) {
+    QList<Syncable*>* pOld = m_pSyncables.fetchAndStoreOrdered(pSyncables);
+    if (m_pGarbageCollector) {
+        m_pGarbageCollector->retire(pOld);
+    } else {
+        delete pOld;
+    }
 }
 
 void BaseSyncableListener::onCallbackStart(int sampleRate, int bufferSize) {
@@ -42,7 +72,7 @@ EngineChannel* BaseSyncableListener::getMaster() const {
 }
 
 Syncable* BaseSyncableListener::getSyncableForGroup(const QString& group) {
-    foreach (Syncable* pSyncable, m_syncables) {
+    foreach (Syncable* pSyncable, syncables()) {
         if (pSyncable->getGroup() == group) {
             return pSyncable;
         }
@@ -51,7 +81,7 @@ Syncable* BaseSyncableListener::getSyncableForGroup(const QString& group) {
 }
 
 bool BaseSyncableListener::syncDeckExists() const {
-    foreach (const Syncable* pSyncable, m_syncables) {
+    foreach (const Syncable* pSyncable, syncables()) {
         if (pSyncable->getSyncMode() != SYNC_NONE && pSyncable->getBaseBpm() > 0) {
             return true;
         }
@@ -62,7 +92,7 @@ bool BaseSyncableListener::syncDeckExists() const {
 int BaseSyncableListener::playingSyncDeckCount() const {
     int playing_sync_decks = 0;
 
-    foreach (const Syncable* pSyncable, m_syncables) {
+    foreach (const Syncable* pSyncable, syncables()) {
         SyncMode sync_mode = pSyncable->getSyncMode();
         if (sync_mode == SYNC_NONE) {
             continue;
@@ -101,7 +131,7 @@ void BaseSyncableListener::setMasterBpm(Syncable* pSource, double bpm) {
     if (pSource != m_pInternalClock) {
         m_pInternalClock->setMasterBpm(bpm);
     }
-    foreach (Syncable* pSyncable, m_syncables) {
+    foreach (Syncable* pSyncable, syncables()) {
         if (pSyncable == pSource ||
                 pSyncable->getSyncMode() == SYNC_NONE) {
             continue;
@@ -114,7 +144,7 @@ void BaseSyncableListener::setMasterInstantaneousBpm(Syncable* pSource, double b
     if (pSource != m_pInternalClock) {
         m_pInternalClock->setInstantaneousBpm(bpm);
     }
-    foreach (Syncable* pSyncable, m_syncables) {
+    foreach (Syncable* pSyncable, syncables()) {
         if (pSyncable == pSource ||
                 pSyncable->getSyncMode() == SYNC_NONE) {
             continue;
@@ -127,7 +157,7 @@ void BaseSyncableListener::setMasterBaseBpm(Syncable* pSource, double bpm) {
     if (pSource != m_pInternalClock) {
         m_pInternalClock->setMasterBaseBpm(bpm);
     }
-    foreach (Syncable* pSyncable, m_syncables) {
+    foreach (Syncable* pSyncable, syncables()) {
         if (pSyncable == pSource ||
                 pSyncable->getSyncMode() == SYNC_NONE) {
             continue;
@@ -140,7 +170,7 @@ void BaseSyncableListener::setMasterBeatDistance(Syncable* pSource, double beat_
     if (pSource != m_pInternalClock) {
         m_pInternalClock->setMasterBeatDistance(beat_distance);
     }
-    foreach (Syncable* pSyncable, m_syncables) {
+    foreach (Syncable* pSyncable, syncables()) {
         if (pSyncable == pSource ||
                 pSyncable->getSyncMode() == SYNC_NONE) {
             continue;
@@ -154,7 +184,7 @@ void BaseSyncableListener::setMasterParams(Syncable* pSource, double beat_distan
     if (pSource != m_pInternalClock) {
         m_pInternalClock->setMasterParams(beat_distance, base_bpm, bpm);
     }
-    foreach (Syncable* pSyncable, m_syncables) {
+    foreach (Syncable* pSyncable, syncables()) {
         if (pSyncable == pSource ||
                 pSyncable->getSyncMode() == SYNC_NONE) {
             continue;
@@ -166,7 +196,7 @@ void BaseSyncableListener::setMasterParams(Syncable* pSource, double beat_distan
 void BaseSyncableListener::checkUniquePlayingSyncable() {
     int playing_sync_decks = 0;
     Syncable* unique_syncable = NULL;
-    foreach (Syncable* pSyncable, m_syncables) {
+    foreach (Syncable* pSyncable, syncables()) {
         SyncMode sync_mode = pSyncable->getSyncMode();
         if (sync_mode == SYNC_NONE) {
             continue;
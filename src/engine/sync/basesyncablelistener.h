@@ -1,18 +1,28 @@
 #ifndef BASESYNCABLELISTENER_H
 #define BASESYNCABLELISTENER_H
 
+#include <QAtomicPointer>
+#include <QList>
+
 #include "engine/sync/syncable.h"
 #include "configobject.h"
+#include "util/compatibility.h"
 
 class InternalClock;
 class EngineChannel;
+class EngineGarbageCollector;
 
 class BaseSyncableListener : public SyncableListener {
   public:
-    BaseSyncableListener(ConfigObject<ConfigValue>* pConfig);
+    BaseSyncableListener(ConfigObject<ConfigValue>* pConfig,
+                         EngineGarbageCollector* pGarbageCollector);
     virtual ~BaseSyncableListener();
 
     void addSyncableDeck(Syncable* pSyncable);
+    // Disables sync on pSyncable and forgets it. The callback that is running
+    // may still use pSyncable, so it must only be freed once that callback
+    // has completed.
+    void removeSyncableDeck(Syncable* pSyncable);
     EngineChannel* getMaster() const;
     void onCallbackStart(int sampleRate, int bufferSize);
     void onCallbackEnd(int sampleRate, int bufferSize);
@@ -85,14 +95,27 @@ class BaseSyncableListener : public SyncableListener {
     // Check if there is only one playing syncable deck, and notify it if so.
     void checkUniquePlayingSyncable();
 
+    // The list of all Syncables registered with BaseSyncableListener via
+    // addSyncableDeck.
+    const QList<Syncable*>& syncables() const {
+        return *load_atomic_pointer(m_pSyncables);
+    }
+
     ConfigObject<ConfigValue>* m_pConfig;
     // The InternalClock syncable.
     InternalClock* m_pInternalClock;
     // The current Syncable that is the master.
     Syncable* m_pMasterSyncable;
-    // The list of all Syncables registered with BaseSyncableListener via
-    // addSyncableDeck.
-    QList<Syncable*> m_syncables;
+
+  private:
+    // Publishes pSyncables and retires the previous list.
+    void swapSyncables(QList<Syncable*>* pSyncables);
+
+    EngineGarbageCollector* m_pGarbageCollector;
+    // Decks are added and removed while the callback runs, so a published list
+    // is never modified. A new one is swapped in atomically instead, like the
+    // channel array of EngineMaster.
+    QAtomicPointer<QList<Syncable*> > m_pSyncables;
 };
 
 #endif /* BASESYNCABLELISTENER_H */
@@ -23,8 +23,9 @@
 #include "engine/sync/internalclock.h"
 #include "util/assert.h"
 
-EngineSync::EngineSync(ConfigObject<ConfigValue>* pConfig)
-        : BaseSyncableListener(pConfig) {
+EngineSync::EngineSync(ConfigObject<ConfigValue>* pConfig,
+                       EngineGarbageCollector* pGarbageCollector)
+        : BaseSyncableListener(pConfig, pGarbageCollector) {
 }
 
 EngineSync::~EngineSync() {
@@ -104,7 +105,7 @@ void EngineSync::requestEnableSync(Syncable* pSyncable, bool bEnabled) {
             double targetBeatDistance = 0.0;
             double targetBaseBpm = 0.0;
 
-            foreach (const Syncable* other_deck, m_syncables) {
+            foreach (const Syncable* other_deck, syncables()) {
                 if (other_deck == pSyncable) {
                     // skip this deck
                     continue;
@@ -185,7 +186,7 @@ void EngineSync::notifyPlaying(Syncable* pSyncable, bool playing) {
         const Syncable* uniqueSyncDisabled = NULL;
         int playing_sync_decks = 0;
         int playing_nonsync_decks = 0;
-        foreach (Syncable* pOtherSyncable, m_syncables) {
+        foreach (Syncable* pOtherSyncable, syncables()) {
             if (pOtherSyncable->isPlaying()) {
                 if (pOtherSyncable->getSyncMode() != SYNC_NONE) {
                     uniqueSyncEnabled = pOtherSyncable;
@@ -218,7 +219,7 @@ void EngineSync::notifyTrackLoaded(Syncable* pSyncable, double suggested_bpm) {
     }
 
     bool sync_deck_exists = false;
-    foreach (const Syncable* pOtherSyncable, m_syncables) {
+    foreach (const Syncable* pOtherSyncable, syncables()) {
         if (pOtherSyncable == pSyncable) {
             continue;
         }
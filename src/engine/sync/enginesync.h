@@ -25,7 +25,8 @@
 
 class EngineSync : public BaseSyncableListener {
   public:
-    explicit EngineSync(ConfigObject<ConfigValue>* pConfig);
+    EngineSync(ConfigObject<ConfigValue>* pConfig,
+               EngineGarbageCollector* pGarbageCollector);
     virtual ~EngineSync();
 
     // Used by Syncables to tell EngineSync it wants to be enabled in a
@@ -3,6 +3,7 @@
 // Forked 11/11/2009 by Albert Santoni (alberts@mixxx.org)
 
 #include <QtDebug>
+#include <QMap>
 
 #include "library/analysisfeature.h"
 #include "library/librarytablemodel.h"
@@ -82,11 +83,18 @@ void AnalysisFeature::bindWidget(WLibrary* libraryWidget,
 
     m_pAnalysisView->installEventFilter(keyboard);
 
+    connect(m_pAnalysisView, SIGNAL(cpuShareChanged(int)),
+            this, SLOT(slotCpuShareChanged(int)));
+
     // Let the DlgAnalysis know whether or not analysis is active.
     bool bAnalysisActive = m_pAnalyserQueue != NULL;
     emit(analysisActive(bAnalysisActive));
 
     libraryWidget->registerView(m_sAnalysisViewName, m_pAnalysisView);
+
+    if (!bAnalysisActive) {
+        resumePendingJobs();
+    }
 }
 
 TreeItemModel* AnalysisFeature::getChildModel() {
@@ -108,38 +116,84 @@ void AnalysisFeature::activate() {
     emit(enableCoverArtDisplay(true));
 }
 
+void AnalysisFeature::startAnalyser() {
+    if (m_pAnalyserQueue != NULL) {
+        return;
+    }
+    // Save the old BPM detection prefs setting (on or off)
+    m_iOldBpmEnabled = m_pConfig->getValueString(ConfigKey("[BPM]","BPMDetectionEnabled")).toInt();
+    // Force BPM detection to be on.
+    m_pConfig->set(ConfigKey("[BPM]","BPMDetectionEnabled"), ConfigValue(1));
+    // Note: this sucks... we should refactor the prefs/analyser to fix this hacky bit ^^^^.
+
+    m_pAnalyserQueue = AnalyserQueue::createAnalysisFeatureAnalyserQueue(m_pConfig, m_pTrackCollection);
+    if (m_pAnalysisView) {
+        m_pAnalyserQueue->setCpuShare(m_pAnalysisView->cpuShare());
+    }
+
+    connect(m_pAnalyserQueue, SIGNAL(trackProgress(int)),
+            m_pAnalysisView, SLOT(trackAnalysisProgress(int)));
+    connect(m_pAnalyserQueue, SIGNAL(trackFinished(int)),
+            this, SLOT(slotProgressUpdate(int)));
+    connect(m_pAnalyserQueue, SIGNAL(trackFinished(int)),
+            m_pAnalysisView, SLOT(trackAnalysisFinished(int)));
+    connect(m_pAnalyserQueue, SIGNAL(analysersFinished(TrackPointer, int)),
+            this, SLOT(slotAnalysersFinished(TrackPointer, int)));
+
+    connect(m_pAnalyserQueue, SIGNAL(queueEmpty()),
+            this, SLOT(cleanupAnalyser()));
+    emit(analysisActive(true));
+}
+
 void AnalysisFeature::analyzeTracks(QList<int> trackIds) {
-    if (m_pAnalyserQueue == NULL) {
-        // Save the old BPM detection prefs setting (on or off)
-        m_iOldBpmEnabled = m_pConfig->getValueString(ConfigKey("[BPM]","BPMDetectionEnabled")).toInt();
-        // Force BPM detection to be on.
-        m_pConfig->set(ConfigKey("[BPM]","BPMDetectionEnabled"), ConfigValue(1));
-        // Note: this sucks... we should refactor the prefs/analyser to fix this hacky bit ^^^^.
-
-        m_pAnalyserQueue = AnalyserQueue::createAnalysisFeatureAnalyserQueue(m_pConfig, m_pTrackCollection);
-
-        connect(m_pAnalyserQueue, SIGNAL(trackProgress(int)),
-                m_pAnalysisView, SLOT(trackAnalysisProgress(int)));
-        connect(m_pAnalyserQueue, SIGNAL(trackFinished(int)),
-                this, SLOT(slotProgressUpdate(int)));
-        connect(m_pAnalyserQueue, SIGNAL(trackFinished(int)),
-                m_pAnalysisView, SLOT(trackAnalysisFinished(int)));
-
-        connect(m_pAnalyserQueue, SIGNAL(queueEmpty()),
-                this, SLOT(cleanupAnalyser()));
-        emit(analysisActive(true));
+    int analysers = m_pAnalysisView ? m_pAnalysisView->selectedAnalysers() :
+            AnalyserQueue::BEATS | AnalyserQueue::KEY | AnalyserQueue::REPLAYGAIN;
+    if (trackIds.isEmpty() || analysers == 0) {
+        return;
     }
+    // Fingerprint the tracks too since they are decoded anyway.
+    analysers |= AnalyserQueue::FINGERPRINT;
+    // Store the jobs first so that they survive a restart.
+    m_pTrackCollection->getAnalysisJobDAO().addJobs(trackIds, analysers);
+    queueTracks(trackIds, analysers);
+    setTitleProgress(0, trackIds.size());
+    emit(trackAnalysisStarted(trackIds.size()));
+}
 
+void AnalysisFeature::resumePendingJobs() {
+    AnalysisJobDAO& jobDao = m_pTrackCollection->getAnalysisJobDAO();
+    QList<AnalysisJob> jobs = jobDao.getPendingJobs();
+    if (jobs.isEmpty()) {
+        return;
+    }
+    qDebug() << "AnalysisFeature: resuming" << jobs.size() << "analysis jobs";
+
+    // Jobs with the same analysers are queued together.
+    QMap<int, QList<int> > trackIdsByAnalysers;
+    foreach (const AnalysisJob& job, jobs) {
+        trackIdsByAnalysers[job.second].append(job.first);
+    }
+    for (QMap<int, QList<int> >::const_iterator it = trackIdsByAnalysers.begin();
+         it != trackIdsByAnalysers.end(); ++it) {
+        queueTracks(it.value(), it.key());
+    }
+    setTitleProgress(0, jobs.size());
+    emit(trackAnalysisStarted(jobs.size()));
+}
+
+void AnalysisFeature::queueTracks(const QList<int>& trackIds, int analysers) {
+    startAnalyser();
+    AnalysisJobDAO& jobDao = m_pTrackCollection->getAnalysisJobDAO();
     foreach(int trackId, trackIds) {
         TrackPointer pTrack = m_pTrackCollection->getTrackDAO().getTrack(trackId);
         if (pTrack) {
             //qDebug() << this << "Queueing track for analysis" << pTrack->getLocation();
-            m_pAnalyserQueue->queueAnalyseTrack(pTrack);
+            m_pAnalyserQueue->queueAnalyseTrack(pTrack, analysers);
+        } else {
+            // The track was removed from the library.
+            jobDao.finishJob(trackId, analysers);
         }
     }
-    if(trackIds.size() > 0)
-    	setTitleProgress(0, trackIds.size());
-    emit(trackAnalysisStarted(trackIds.size()));
 }
 
 void AnalysisFeature::slotProgressUpdate(int num_left) {
@@ -150,11 +204,24 @@ void AnalysisFeature::slotProgressUpdate(int num_left) {
     }
 }
 
+void AnalysisFeature::slotAnalysersFinished(TrackPointer pTrack, int analysers) {
+    m_pTrackCollection->getAnalysisJobDAO().finishJob(pTrack->getId(), analysers);
+}
+
+void AnalysisFeature::slotCpuShareChanged(int percent) {
+    if (m_pAnalyserQueue != NULL) {
+        m_pAnalyserQueue->setCpuShare(percent);
+    }
+}
+
 void AnalysisFeature::stopAnalysis() {
     //qDebug() << this << "stopAnalysis()";
     if (m_pAnalyserQueue != NULL) {
         m_pAnalyserQueue->stop();
     }
+    // The user cancelled the remaining jobs, so do not resume them on the
+    // next start. Jobs are only kept when Mixxx is closed during analysis.
+    m_pTrackCollection->getAnalysisJobDAO().removeAllJobs();
 }
 
 void AnalysisFeature::cleanupAnalyser() {
@@ -45,14 +45,25 @@ class AnalysisFeature : public LibraryFeature {
 
   public slots:
     void activate();
+    // Queues the analyses checked in the analysis view for trackIds.
     void analyzeTracks(QList<int> trackIds);
 
   private slots:
     void slotProgressUpdate(int num_left);
+    void slotAnalysersFinished(TrackPointer pTrack, int analysers);
+    void slotCpuShareChanged(int percent);
     void stopAnalysis();
     void cleanupAnalyser();
 
   private:
+    // Creates the AnalyserQueue if it is not running.
+    void startAnalyser();
+    // Queues the jobs that were not finished when Mixxx was last closed.
+    void resumePendingJobs();
+    // Queues trackIds for the given analysers, starting the AnalyserQueue if
+    // needed. The jobs must already be stored in the AnalysisJobDAO.
+    void queueTracks(const QList<int>& trackIds, int analysers);
+
     // Sets the title of this feature to the default name, given by
     // m_sAnalysisTitleName
     void setTitleDefault();
@@ -57,6 +57,8 @@ AutoDJFeature::AutoDJFeature(Library* pLibrary,
             this, m_pConfig, pPlayerManager, m_iAutoDJPlaylistId, m_pTrackCollection);
     connect(m_pAutoDJProcessor, SIGNAL(loadTrackToPlayer(TrackPointer, QString, bool)),
             this, SIGNAL(loadTrackToPlayer(TrackPointer, QString, bool)));
+    connect(m_pAutoDJProcessor, SIGNAL(prestageTrack(TrackPointer)),
+            this, SIGNAL(prestageTrack(TrackPointer)));
 
 #ifdef __AUTODJCRATES__
 
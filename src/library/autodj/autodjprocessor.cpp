@@ -617,9 +617,39 @@ bool AutoDJProcessor::removeTrackFromTopOfQueue(TrackPointer pTrack) {
         emit(randomTrackRequested(tracksToAdd));
     }
 
+    prestageNextTrack();
     return true;
 }
 
+void AutoDJProcessor::prestageNextTrack() {
+    if (m_eState == ADJ_DISABLED) {
+        return;
+    }
+
+    // The top of the queue is usually already loaded into the idle deck, so
+    // look a few entries ahead.
+    const int kMaxLookahead = 3;
+    int rows = math_min(m_pAutoDJTableModel->rowCount(), kMaxLookahead);
+    for (int row = 0; row < rows; ++row) {
+        TrackPointer pTrack = m_pAutoDJTableModel->getTrack(
+                m_pAutoDJTableModel->index(row, 0));
+        if (!pTrack) {
+            continue;
+        }
+        bool loaded = false;
+        foreach (DeckAttributes* pDeck, m_decks) {
+            if (pDeck != NULL && pDeck->getLoadedTrack() == pTrack) {
+                loaded = true;
+                break;
+            }
+        }
+        if (!loaded) {
+            emit(prestageTrack(pTrack));
+            return;
+        }
+    }
+}
+
 void AutoDJProcessor::playerPlayChanged(DeckAttributes* pAttributes, bool playing) {
     if (sDebug) {
         qDebug() << this << "playerPlayChanged" << pAttributes->group << playing;
@@ -678,6 +708,9 @@ void AutoDJProcessor::playerTrackLoaded(DeckAttributes* pDeck, TrackPointer pTra
         qDebug() << this << "playerTrackLoaded" << pDeck->group
                  << (pTrack.isNull() ? "(null)" : pTrack->getLocation());
     }
+
+    // The track following the one just loaded is the next one we will need.
+    prestageNextTrack();
 }
 
 void AutoDJProcessor::playerTrackLoadFailed(DeckAttributes* pDeck, TrackPointer pTrack) {
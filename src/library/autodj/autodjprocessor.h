@@ -144,6 +144,9 @@ class AutoDJProcessor : public QObject {
     virtual void transitionTimeChanged(int time);
     virtual void autoDJStateChanged(AutoDJProcessor::AutoDJState state);
     virtual void randomTrackRequested(int);
+    // Emitted with the track that Auto DJ is going to load next so that it
+    // can be decoded ahead of time.
+    virtual void prestageTrack(TrackPointer pTrack);
 
   private slots:
     void playerPositionChanged(DeckAttributes* pDeck, double position);
@@ -169,6 +172,10 @@ class AutoDJProcessor : public QObject {
     bool loadNextTrackFromQueue(const DeckAttributes& pDeck, bool play = false);
     void calculateFadeThresholds(DeckAttributes* pAttributes);
 
+    // Requests staging of the first track in the queue that is not loaded
+    // into one of the Auto DJ decks.
+    void prestageNextTrack();
+
     // Removes the track loaded to the player group from the top of the AutoDJ
     // queue if it is present.
     bool removeLoadedTrackFromTopOfQueue(const DeckAttributes& deck);
@@ -16,6 +16,7 @@
 #include "widget/wlibrary.h"
 #include "widget/wlibrarytextbrowser.h"
 #include "util/assert.h"
+#include "util/performancetimer.h"
 
 BasePlaylistFeature::BasePlaylistFeature(QObject* parent,
                                          ConfigObject<ConfigValue>* pConfig,
@@ -352,10 +353,18 @@ void BasePlaylistFeature::slotImportPlaylist() {
     } else {
         return;
     }
+    PerformanceTimer timer;
+    timer.start();
+    playlist_parser->setTrackDAO(&m_trackDao);
     QStringList entries = playlist_parser->parse(playlist_file);
 
     // Iterate over the List that holds URLs of playlist entires
-    m_pPlaylistTableModel->addTracks(QModelIndex(), entries);
+    int tracksAdded = m_pPlaylistTableModel->addResolvedTracks(QModelIndex(),
+                                                              entries);
+    qint64 elapsedMillis = qMax(timer.elapsed() / 1000000, Q_INT64_C(1));
+    qDebug() << "Imported" << tracksAdded << "tracks from" << playlist_file
+             << "in" << elapsedMillis << "ms,"
+             << tracksAdded * 1000 / elapsedMillis << "tracks/s";
 
     // delete the parser object
     if (playlist_parser) {
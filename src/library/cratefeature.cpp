@@ -22,6 +22,7 @@
 #include "treeitem.h"
 #include "soundsourceproxy.h"
 #include "util/dnd.h"
+#include "util/performancetimer.h"
 #include "util/time.h"
 
 CrateFeature::CrateFeature(QObject* parent,
@@ -569,11 +570,18 @@ void CrateFeature::slotImportPlaylist() {
         return;
     }
 
+    PerformanceTimer timer;
+    timer.start();
+    playlist_parser->setTrackDAO(&m_pTrackCollection->getTrackDAO());
     QList<QString> entries = playlist_parser->parse(playlist_file);
     //qDebug() << "Size of Imported Playlist: " << entries.size();
 
     //Iterate over the List that holds URLs of playlist entires
-    m_crateTableModel.addTracks(QModelIndex(), entries);
+    int tracksAdded = m_crateTableModel.addResolvedTracks(QModelIndex(), entries);
+    qint64 elapsedMillis = qMax(timer.elapsed() / 1000000, Q_INT64_C(1));
+    qDebug() << "Imported" << tracksAdded << "tracks from" << playlist_file
+             << "in" << elapsedMillis << "ms,"
+             << tracksAdded * 1000 / elapsedMillis << "tracks/s";
 
     //delete the parser object
     if (playlist_parser)
@@ -100,16 +100,26 @@ bool CrateTableModel::addTrack(const QModelIndex& index, QString location) {
 
 int CrateTableModel::addTracks(const QModelIndex& index,
                                const QList<QString>& locations) {
-    Q_UNUSED(index);
     // If a track is dropped but it isn't in the library, then add it because
     // the user probably dropped a file from outside Mixxx into this crate.
-    QList<QFileInfo> fileInfoList;
-    foreach(QString fileLocation, locations) {
-        QFileInfo fileInfo(fileLocation);
-        if (fileInfo.exists()) {
-            fileInfoList.append(fileInfo);
+    // Locations that are in the library don't have to be checked on disk.
+    QSet<QString> knownLocations = m_trackDAO.getKnownTrackLocations(locations);
+    QList<QString> existingLocations;
+    foreach (const QString& location, locations) {
+        if (knownLocations.contains(location) || QFileInfo(location).exists()) {
+            existingLocations.append(location);
         }
     }
+    return addResolvedTracks(index, existingLocations);
+}
+
+int CrateTableModel::addResolvedTracks(const QModelIndex& index,
+                                       const QList<QString>& locations) {
+    Q_UNUSED(index);
+    QList<QFileInfo> fileInfoList;
+    foreach (const QString& location, locations) {
+        fileInfoList.append(QFileInfo(location));
+    }
 
     QList<int> trackIDs = m_trackDAO.addTracks(fileInfoList, true);
 
@@ -24,6 +24,10 @@ class CrateTableModel : public BaseSqlTableModel {
     bool addTrack(const QModelIndex &index, QString location);
     // Returns the number of unsuccessful track additions
     int addTracks(const QModelIndex& index, const QList<QString>& locations);
+    // Like addTracks() for locations that are known to exist, like the
+    // entries of a parsed playlist. They are not checked again.
+    int addResolvedTracks(const QModelIndex& index,
+                          const QList<QString>& locations);
     TrackModel::CapabilitiesFlags getCapabilities() const;
 
   private:
@@ -0,0 +1,109 @@
+#include <QtSql>
+#include <QtDebug>
+#include <QThread>
+
+#include "library/dao/analysisjobdao.h"
+#include "library/queryutil.h"
+
+AnalysisJobDAO::AnalysisJobDAO(QSqlDatabase& database)
+        : m_database(database) {
+}
+
+AnalysisJobDAO::~AnalysisJobDAO() {
+}
+
+void AnalysisJobDAO::initialize() {
+    qDebug() << "AnalysisJobDAO::initialize" << QThread::currentThread()
+             << m_database.connectionName();
+}
+
+bool AnalysisJobDAO::addJobs(const QList<int>& trackIds, int analysers) {
+    if (trackIds.isEmpty() || analysers == 0) {
+        return true;
+    }
+    ScopedTransaction transaction(m_database);
+
+    // Insert first so that a track that already has a job keeps its place in
+    // the queue, then merge the analysers into the job.
+    QSqlQuery insertQuery(m_database);
+    insertQuery.prepare("INSERT OR IGNORE INTO " ANALYSIS_JOBS_TABLE
+                        " (track_id, analysers) VALUES (:track_id, 0)");
+    QSqlQuery updateQuery(m_database);
+    updateQuery.prepare("UPDATE " ANALYSIS_JOBS_TABLE
+                        " SET analysers = analysers | :analysers"
+                        " WHERE track_id = :track_id");
+    foreach (int trackId, trackIds) {
+        insertQuery.bindValue(":track_id", trackId);
+        if (!insertQuery.exec()) {
+            LOG_FAILED_QUERY(insertQuery);
+            return false;
+        }
+        updateQuery.bindValue(":analysers", analysers);
+        updateQuery.bindValue(":track_id", trackId);
+        if (!updateQuery.exec()) {
+            LOG_FAILED_QUERY(updateQuery);
+            return false;
+        }
+    }
+    return transaction.commit();
+}
+
+bool AnalysisJobDAO::finishJob(int trackId, int analysers) {
+    ScopedTransaction transaction(m_database);
+    QSqlQuery query(m_database);
+    query.prepare("UPDATE " ANALYSIS_JOBS_TABLE
+                  " SET analysers = analysers & ~:analysers"
+                  " WHERE track_id = :track_id");
+    query.bindValue(":analysers", analysers);
+    query.bindValue(":track_id", trackId);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+
+    query.prepare("DELETE FROM " ANALYSIS_JOBS_TABLE
+                  " WHERE track_id = :track_id AND analysers = 0");
+    query.bindValue(":track_id", trackId);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return transaction.commit();
+}
+
+QList<AnalysisJob> AnalysisJobDAO::getPendingJobs() {
+    QList<AnalysisJob> jobs;
+    QSqlQuery query(m_database);
+    query.prepare("SELECT track_id, analysers FROM " ANALYSIS_JOBS_TABLE
+                  " WHERE analysers != 0 ORDER BY id");
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return jobs;
+    }
+    while (query.next()) {
+        jobs.append(AnalysisJob(query.value(0).toInt(),
+                                query.value(1).toInt()));
+    }
+    return jobs;
+}
+
+int AnalysisJobDAO::pendingJobCount() {
+    QSqlQuery query(m_database);
+    query.prepare("SELECT COUNT(*) FROM " ANALYSIS_JOBS_TABLE
+                  " WHERE analysers != 0");
+    if (!query.exec() || !query.next()) {
+        LOG_FAILED_QUERY(query);
+        return 0;
+    }
+    return query.value(0).toInt();
+}
+
+bool AnalysisJobDAO::removeAllJobs() {
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM " ANALYSIS_JOBS_TABLE);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return true;
+}
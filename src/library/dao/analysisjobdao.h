@@ -0,0 +1,41 @@
+#ifndef ANALYSISJOBDAO_H
+#define ANALYSISJOBDAO_H
+
+#include <QList>
+#include <QPair>
+#include <QSqlDatabase>
+
+#include "library/dao/dao.h"
+
+#define ANALYSIS_JOBS_TABLE "analysis_jobs"
+
+// A pending analysis job: the track id and the analysers (a combination of
+// AnalyserQueue::AnalyserType flags) that still have to run on it.
+typedef QPair<int, int> AnalysisJob;
+
+// Stores the tracks queued in the analysis feature so that an interrupted
+// analysis can be resumed after Mixxx restarts. Each track has at most one
+// job. Adding analysers to a track that already has a job merges them into
+// it, and finishing analysers removes them from it.
+class AnalysisJobDAO : public DAO {
+  public:
+    AnalysisJobDAO(QSqlDatabase& database);
+    virtual ~AnalysisJobDAO();
+
+    void setDatabase(QSqlDatabase& database) { m_database = database; }
+    void initialize();
+
+    bool addJobs(const QList<int>& trackIds, int analysers);
+    // Removes analysers from the job of trackId. The job is deleted once no
+    // analysers are left.
+    bool finishJob(int trackId, int analysers);
+    // Returns the pending jobs in the order they were added.
+    QList<AnalysisJob> getPendingJobs();
+    int pendingJobCount();
+    bool removeAllJobs();
+
+  private:
+    QSqlDatabase& m_database;
+};
+
+#endif // ANALYSISJOBDAO_H
@@ -10,7 +10,8 @@
 #include "library/queryutil.h"
 
 CrateDAO::CrateDAO(QSqlDatabase& database)
-        : m_database(database) {
+        : m_database(database),
+          m_queries(database) {
 }
 
 CrateDAO::~CrateDAO() {
@@ -319,9 +320,9 @@ void CrateDAO::copyCrateTracks(const int sourceCrateId, const int targetCrateId)
 }
 
 bool CrateDAO::addTrackToCrate(const int trackId, const int crateId) {
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO " CRATE_TRACKS_TABLE
-                  " (crate_id, track_id) VALUES (:crate_id, :track_id)");
+    CachedQuery query(m_queries.prepare(
+            "INSERT INTO " CRATE_TRACKS_TABLE
+            " (crate_id, track_id) VALUES (:crate_id, :track_id)"));
     query.bindValue(":crate_id", crateId);
     query.bindValue(":track_id", trackId);
 
@@ -340,8 +341,9 @@ bool CrateDAO::addTrackToCrate(const int trackId, const int crateId) {
 
 int CrateDAO::addTracksToCrate(const int crateId, QList<int>* trackIdList) {
     ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO " CRATE_TRACKS_TABLE " (crate_id, track_id) VALUES (:crate_id, :track_id)");
+    CachedQuery query(m_queries.prepare(
+            "INSERT INTO " CRATE_TRACKS_TABLE
+            " (crate_id, track_id) VALUES (:crate_id, :track_id)"));
 
     for (int i = 0; i < trackIdList->size(); ++i) {
         query.bindValue(":crate_id", crateId);
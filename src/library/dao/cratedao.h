@@ -9,6 +9,7 @@
 #include <QSqlDatabase>
 
 #include "library/dao/dao.h"
+#include "library/queryutil.h"
 #include "util.h"
 
 #define CRATE_TABLE "crates"
@@ -30,7 +31,10 @@ class CrateDAO : public QObject, public virtual DAO {
     CrateDAO(QSqlDatabase& database);
     virtual ~CrateDAO();
 
-    void setDatabase(QSqlDatabase& database) { m_database = database; }
+    void setDatabase(QSqlDatabase& database) {
+        m_database = database;
+        m_queries.clear();
+    }
 
     // Initialize this DAO, create the tables it relies on, etc.
     void initialize();
@@ -74,6 +78,7 @@ class CrateDAO : public QObject, public virtual DAO {
 
   private:
     QSqlDatabase& m_database;
+    PreparedQueryCache m_queries;
     DISALLOW_COPY_AND_ASSIGN(CrateDAO);
 };
 
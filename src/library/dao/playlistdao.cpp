@@ -8,7 +8,8 @@
 #include "util/math.h"
 
 PlaylistDAO::PlaylistDAO(QSqlDatabase& database)
-        : m_database(database) {
+        : m_database(database),
+          m_queries(database) {
 }
 
 PlaylistDAO::~PlaylistDAO() {
@@ -222,9 +223,9 @@ bool PlaylistDAO::appendTracksToPlaylist(const QList<int>& trackIds, const int p
     ++position;
 
     //Insert the song into the PlaylistTracks table
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO PlaylistTracks (playlist_id, track_id, position, pl_datetime_added)"
-                  "VALUES (:playlist_id, :track_id, :position, CURRENT_TIMESTAMP)");
+    CachedQuery query(m_queries.prepare(
+            "INSERT INTO PlaylistTracks (playlist_id, track_id, position, pl_datetime_added)"
+            "VALUES (:playlist_id, :track_id, :position, CURRENT_TIMESTAMP)"));
     query.bindValue(":playlist_id", playlistId);
 
 
@@ -485,28 +486,35 @@ int PlaylistDAO::insertTracksIntoPlaylist(const QList<int>& trackIds,
         position = max_position;
     }
 
-    QSqlQuery insertQuery(m_database);
-    insertQuery.prepare("INSERT INTO PlaylistTracks (playlist_id, track_id, position)"
-                        "VALUES (:playlist_id, :track_id, :position)");
-    QSqlQuery query(m_database);
-    int insertPositon = position;
+    QList<int> validTrackIds;
     foreach (int trackId, trackIds) {
-        if (trackId < 0) {
-            continue;
+        if (trackId >= 0) {
+            validTrackIds.append(trackId);
         }
-        // Move all tracks in playlist up by 1.
-        // TODO(XXX) We could do this in one query before the for loop.
-        query.prepare(QString("UPDATE PlaylistTracks SET position=position+1 "
-                              "WHERE position>=%1 AND "
-                              "playlist_id=%2").arg(insertPositon).arg(playlistId));
+    }
+    if (validTrackIds.isEmpty()) {
+        return 0;
+    }
 
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query);
-            continue;
-        }
+    // Move the tracks after position up to make room for all new tracks at
+    // once.
+    QSqlQuery query(m_database);
+    query.prepare(QString("UPDATE PlaylistTracks SET position=position+%1 "
+                          "WHERE position>=%2 AND playlist_id=%3")
+                  .arg(validTrackIds.size()).arg(position).arg(playlistId));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return 0;
+    }
 
+    CachedQuery insertQuery(m_queries.prepare(
+            "INSERT INTO PlaylistTracks (playlist_id, track_id, position)"
+            "VALUES (:playlist_id, :track_id, :position)"));
+    insertQuery.bindValue(":playlist_id", playlistId);
+    QList<int> addedTrackIds;
+    int insertPositon = position;
+    foreach (int trackId, validTrackIds) {
         // Insert the track at the given position
-        insertQuery.bindValue(":playlist_id", playlistId);
         insertQuery.bindValue(":track_id", trackId);
         insertQuery.bindValue(":position", insertPositon);
         if (!insertQuery.exec()) {
@@ -516,14 +524,27 @@ int PlaylistDAO::insertTracksIntoPlaylist(const QList<int>& trackIds,
 
         // Increment the insert position for the track.
         ++insertPositon;
-        ++tracksAdded;
+        addedTrackIds.append(trackId);
+    }
+    tracksAdded = addedTrackIds.size();
+
+    // Close the gap left by tracks that failed to insert.
+    if (tracksAdded < validTrackIds.size()) {
+        query.prepare(QString("UPDATE PlaylistTracks SET position=position-%1 "
+                              "WHERE position>=%2 AND playlist_id=%3")
+                      .arg(validTrackIds.size() - tracksAdded)
+                      .arg(position + validTrackIds.size())
+                      .arg(playlistId));
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return 0;
+        }
     }
 
     transaction.commit();
 
     insertPositon = position;
-    foreach (int trackId, trackIds) {
-        // TODO(XXX) The position is wrong if any track failed to insert.
+    foreach (int trackId, addedTrackIds) {
         emit(trackAdded(playlistId, trackId, insertPositon++));
     }
     emit(changed(playlistId));
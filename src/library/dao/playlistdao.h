@@ -6,6 +6,7 @@
 #include <QSqlDatabase>
 
 #include "library/dao/dao.h"
+#include "library/queryutil.h"
 #include "util.h"
 
 #define PLAYLIST_TABLE "Playlists"
@@ -40,7 +41,10 @@ class PlaylistDAO : public QObject, public virtual DAO {
     virtual ~PlaylistDAO();
 
     void initialize();
-    void setDatabase(QSqlDatabase& database) { m_database = database; }
+    void setDatabase(QSqlDatabase& database) {
+        m_database = database;
+        m_queries.clear();
+    }
     // Create a playlist, fails with -1 if already exists
     int createPlaylist(const QString& name, const HiddenType type = PLHT_NOT_HIDDEN);
     // Create a playlist, appends "(n)" if already exists, name becomes the new name
@@ -120,6 +124,7 @@ class PlaylistDAO : public QObject, public virtual DAO {
                                  int* pTrackDistance);
 
     QSqlDatabase& m_database;
+    PreparedQueryCache m_queries;
     DISALLOW_COPY_AND_ASSIGN(PlaylistDAO);
 };
 
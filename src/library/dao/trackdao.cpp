@@ -46,9 +46,9 @@ TrackCacheItem::~TrackCacheItem() {
     // qDebug() << "~TrackCacheItem" << m_pTrack << "ID"
     //          << m_pTrack->getId() << m_pTrack->getInfo();
 
-    // Signal to TrackDAO::saveTrack(TrackPointer) to save the track if it is
-    // dirty. Does not drop the strong reference to the track until saveTrack
-    // completes.
+    // Signal to TrackDAO::enqueueSaveTrack(TrackPointer) to save the track if
+    // it is dirty. TrackDAO holds a strong reference to the track until it is
+    // saved.
     if (m_pTrack->isDirty()) {
         emit(saveTrack(m_pTrack));
     }
@@ -56,13 +56,17 @@ TrackCacheItem::~TrackCacheItem() {
 
 // The number of recently used tracks to cache strong references to at
 // once. Once the n+1'th track is created, the TrackDAO's QCache deletes its
-// TrackCacheItem which signals to TrackDAO::saveTrack(TrackPointer) to save the
-// track and drop the strong reference. The recent tracks cache basically
+// TrackCacheItem which signals to TrackDAO::enqueueSaveTrack(TrackPointer) to
+// save the track and drop the strong reference. The recent tracks cache basically
 // functions to prevent repeated getTrack() calls for the same track from
 // repeatedly deserializing / serializing a track to the database since this is
 // expensive.
 const int kRecentTracksCacheSize = 5;
 
+// How long TrackDAO collects the tracks that expire from the recent tracks
+// cache before it saves them together in one transaction.
+const int kSaveDelayMillis = 500;
+
 TrackDAO::TrackDAO(QSqlDatabase& database,
                    CueDAO& cueDao,
                    PlaylistDAO& playlistDao,
@@ -71,6 +75,7 @@ TrackDAO::TrackDAO(QSqlDatabase& database,
                    LibraryHashDAO& libraryHashDao,
                    ConfigObject<ConfigValue> * pConfig)
         : m_database(database),
+          m_queries(database),
           m_cueDao(cueDao),
           m_playlistDao(playlistDao),
           m_crateDao(crateDao),
@@ -87,6 +92,10 @@ TrackDAO::TrackDAO(QSqlDatabase& database,
           m_trackLocationIdColumn(UndefinedRecordIndex),
           m_queryLibraryIdColumn(UndefinedRecordIndex),
           m_queryLibraryMixxxDeletedColumn(UndefinedRecordIndex) {
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(kSaveDelayMillis);
+    connect(&m_saveTimer, SIGNAL(timeout()),
+            this, SLOT(slotSavePendingTracks()));
 }
 
 TrackDAO::~TrackDAO() {
@@ -98,6 +107,7 @@ TrackDAO::~TrackDAO() {
 void TrackDAO::finish() {
     // Save all tracks that haven't been saved yet.
     QMutexLocker locker(&m_sTracksMutex);
+    QList<TrackPointer> dirtyTracks;
     QHashIterator<int, TrackWeakPointer> it(m_sTracks);
     while (it.hasNext()) {
         it.next();
@@ -106,7 +116,7 @@ void TrackDAO::finish() {
         TrackPointer pTrack = it.value();
         if (!pTrack.isNull()) {
             if (pTrack->isDirty()) {
-                saveTrack(pTrack);
+                dirtyTracks.append(pTrack);
             }
 
             // When this reference expires, tell the track to delete itself
@@ -114,6 +124,8 @@ void TrackDAO::finish() {
             pTrack->setDeleteOnReferenceExpiration(true);
         }
     }
+    saveTracks(dirtyTracks);
+    dirtyTracks.clear();
     m_sTracks.clear();
     locker.unlock();
 
@@ -127,6 +139,8 @@ void TrackDAO::finish() {
     // in the recent tracks cache. Deliver those events manually since we don't
     // have an event loop running anymore.
     QCoreApplication::sendPostedEvents(this, 0);
+    m_saveTimer.stop();
+    slotSavePendingTracks();
 
     // clear out played information on exit
     // crash prevention: if mixxx crashes, played information will be maintained
@@ -165,8 +179,8 @@ void TrackDAO::initialize() {
 int TrackDAO::getTrackId(const QString& absoluteFilePath) {
     //qDebug() << "TrackDAO::getTrackId" << QThread::currentThread() << m_database.connectionName();
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT library.id FROM library INNER JOIN track_locations ON library.location = track_locations.id WHERE track_locations.location=:location");
+    CachedQuery query(m_queries.prepare(
+            "SELECT library.id FROM library INNER JOIN track_locations ON library.location = track_locations.id WHERE track_locations.location=:location"));
     query.bindValue(":location", absoluteFilePath);
 
     if (!query.exec()) {
@@ -206,6 +220,25 @@ QList<int> TrackDAO::getTrackIds(const QList<QFileInfo>& files) {
     return ids;
 }
 
+QList<int> TrackDAO::getTrackIdsByFingerprint(const QString& fingerprint) {
+    QList<int> ids;
+    if (fingerprint.isEmpty()) {
+        return ids;
+    }
+    QSqlQuery query(m_database);
+    query.prepare("SELECT id FROM library "
+                  "WHERE fingerprint=:fingerprint AND mixxx_deleted=0");
+    query.bindValue(":fingerprint", fingerprint);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return ids;
+    }
+    while (query.next()) {
+        ids.append(query.value(0).toInt());
+    }
+    return ids;
+}
+
 QSet<QString> TrackDAO::getTrackLocations() {
     QSet<QString> locations;
     QSqlQuery query(m_database);
@@ -222,6 +255,30 @@ QSet<QString> TrackDAO::getTrackLocations() {
     return locations;
 }
 
+QSet<QString> TrackDAO::getKnownTrackLocations(const QStringList& locations) {
+    // Keeps the statements well below SQLite's length limit.
+    const int kLocationsPerQuery = 500;
+
+    QSet<QString> knownLocations;
+    FieldEscaper escaper(m_database);
+    for (int first = 0; first < locations.size(); first += kLocationsPerQuery) {
+        QStringList escapedLocations = escaper.escapeStrings(
+                locations.mid(first, kLocationsPerQuery));
+        QSqlQuery query(m_database);
+        query.prepare(QString("SELECT location FROM track_locations "
+                              "WHERE fs_deleted=0 AND location IN (%1)")
+                      .arg(escapedLocations.join(",")));
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            continue;
+        }
+        while (query.next()) {
+            knownLocations.insert(query.value(0).toString());
+        }
+    }
+    return knownLocations;
+}
+
 // Some code (eg. drag and drop) needs to just get a track's location, and it's
 // not worth retrieving a whole TrackInfoObject.
 QString TrackDAO::getTrackLocation(const int trackId) {
@@ -259,6 +316,26 @@ void TrackDAO::saveTrack(TrackPointer track) {
     }
 }
 
+void TrackDAO::enqueueSaveTrack(TrackPointer pTrack) {
+    if (!pTrack) {
+        return;
+    }
+    // Keeps a strong reference to the track until it is saved.
+    m_pendingSaves.insert(pTrack.data(), pTrack);
+    if (!m_saveTimer.isActive()) {
+        m_saveTimer.start();
+    }
+}
+
+void TrackDAO::slotSavePendingTracks() {
+    if (m_pendingSaves.isEmpty()) {
+        return;
+    }
+    QList<TrackPointer> tracks = m_pendingSaves.values();
+    m_pendingSaves.clear();
+    saveTracks(tracks);
+}
+
 void TrackDAO::saveTrack(TrackInfoObject* pTrack) {
     DEBUG_ASSERT_AND_HANDLE(pTrack != NULL) {
         return;
@@ -364,6 +441,61 @@ void TrackDAO::slotTrackChanged(TrackInfoObject* pTrack) {
 
 // No need to check here if the querys exist, this is already done in
 // addTracksAdd, which is the only function that calls this
+namespace {
+
+// Binds :bpm and the beats columns. Beats that were never decoded are
+// written back without decoding them.
+void bindTrackBeats(QSqlQuery* pQuery, TrackInfoObject* pTrack) {
+    QString beatsVersion = "";
+    QString beatsSubVersion = "";
+    QByteArray beatsBlob;
+    BeatsSummary summary;
+    // Fall back on cached BPM
+    double dBpm = pTrack->getBpm();
+
+    if (pTrack->getSerializedBeats(&beatsVersion, &beatsSubVersion,
+                                   &beatsBlob, &summary)) {
+        dBpm = summary.bpm;
+    }
+
+    pQuery->bindValue(":bpm", dBpm);
+    pQuery->bindValue(":beats_version", beatsVersion);
+    pQuery->bindValue(":beats_sub_version", beatsSubVersion);
+    pQuery->bindValue(":beats", beatsBlob.isNull() ?
+                      QVariant(QVariant::ByteArray) : QVariant(beatsBlob));
+    pQuery->bindValue(":beats_type", static_cast<int>(summary.type));
+    pQuery->bindValue(":beats_first_beat", summary.firstBeatSample);
+}
+
+// The library columns that TrackDAO::updateTrackRow() writes for each
+// TrackInfoObject::DirtyField. Cues are stored in a table of their own.
+struct DirtyFieldColumns {
+    int field;
+    const char* columns;
+};
+
+const DirtyFieldColumns kDirtyFieldColumns[] = {
+    { TrackInfoObject::DIRTY_METADATA,
+      "artist,title,album,album_artist,year,genre,composer,grouping,"
+      "filetype,tracknumber,comment,url" },
+    { TrackInfoObject::DIRTY_AUDIO_PROPERTIES,
+      "duration,bitrate,samplerate,channels,header_parsed" },
+    { TrackInfoObject::DIRTY_REPLAYGAIN, "replaygain" },
+    { TrackInfoObject::DIRTY_PLAY_COUNT, "timesplayed,played" },
+    { TrackInfoObject::DIRTY_RATING, "rating" },
+    { TrackInfoObject::DIRTY_CUE_POINT, "cuepoint" },
+    { TrackInfoObject::DIRTY_BEATS,
+      "bpm,beats_version,beats_sub_version,beats,beats_type,beats_first_beat" },
+    { TrackInfoObject::DIRTY_BPM_LOCK, "bpm_lock" },
+    { TrackInfoObject::DIRTY_KEYS,
+      "key,key_id,keys_version,keys_sub_version,keys" },
+    { TrackInfoObject::DIRTY_COVER_ART,
+      "coverart_source,coverart_type,coverart_location,coverart_hash" },
+    { TrackInfoObject::DIRTY_FINGERPRINT, "fingerprint" },
+};
+
+}  // anonymous namespace
+
 void TrackDAO::bindTrackToTrackLocationsInsert(TrackInfoObject* pTrack) {
     // gets called only in addTracksAdd
     m_pQueryTrackLocationInsert->bindValue(":location", pTrack->getLocation());
@@ -392,6 +524,7 @@ void TrackDAO::bindTrackToLibraryInsert(TrackInfoObject* pTrack, int trackLocati
     m_pQueryLibraryInsert->bindValue(":location", trackLocationId);
     m_pQueryLibraryInsert->bindValue(":comment", pTrack->getComment());
     m_pQueryLibraryInsert->bindValue(":url", pTrack->getURL());
+    m_pQueryLibraryInsert->bindValue(":fingerprint", pTrack->getFingerprint());
     m_pQueryLibraryInsert->bindValue(":duration", pTrack->getDuration());
     m_pQueryLibraryInsert->bindValue(":rating", pTrack->getRating());
     m_pQueryLibraryInsert->bindValue(":bitrate", pTrack->getBitrate());
@@ -415,25 +548,7 @@ void TrackDAO::bindTrackToLibraryInsert(TrackInfoObject* pTrack, int trackLocati
     m_pQueryLibraryInsert->bindValue(":coverart_location", coverInfo.coverLocation);
     m_pQueryLibraryInsert->bindValue(":coverart_hash", coverInfo.hash);
 
-    const QByteArray* pBeatsBlob = NULL;
-    QString beatsVersion = "";
-    QString beatsSubVersion = "";
-    BeatsPointer pBeats = pTrack->getBeats();
-    // Fall back on cached BPM
-    double dBpm = pTrack->getBpm();
-
-    if (pBeats) {
-        pBeatsBlob = pBeats->toByteArray();
-        beatsVersion = pBeats->getVersion();
-        beatsSubVersion = pBeats->getSubVersion();
-        dBpm = pBeats->getBpm();
-    }
-
-    m_pQueryLibraryInsert->bindValue(":bpm", dBpm);
-    m_pQueryLibraryInsert->bindValue(":beats_version", beatsVersion);
-    m_pQueryLibraryInsert->bindValue(":beats_sub_version", beatsSubVersion);
-    m_pQueryLibraryInsert->bindValue(":beats", pBeatsBlob ? *pBeatsBlob : QVariant(QVariant::ByteArray));
-    delete pBeatsBlob;
+    bindTrackBeats(m_pQueryLibraryInsert, pTrack);
 
     const Keys& keys = pTrack->getKeys();
     QByteArray* pKeysBlob = NULL;
@@ -490,16 +605,20 @@ void TrackDAO::addTracksPrepare() {
             "bitrate, samplerate, cuepoint, bpm, replaygain, wavesummaryhex, "
             "timesplayed, channels, mixxx_deleted, header_parsed, "
             "beats_version, beats_sub_version, beats, bpm_lock, "
+            "beats_type, beats_first_beat, "
             "keys_version, keys_sub_version, keys, "
-            "coverart_source, coverart_type, coverart_location, coverart_hash ) "
+            "coverart_source, coverart_type, coverart_location, coverart_hash, "
+            "fingerprint ) "
             "VALUES ("
             ":artist, :title, :album, :album_artist, :year, :genre, :tracknumber, :composer, :grouping, "
             ":filetype, :location, :comment, :url, :duration, :rating, :key, :key_id, "
             ":bitrate, :samplerate, :cuepoint, :bpm, :replaygain, :wavesummaryhex, "
             ":timesplayed, :channels, :mixxx_deleted, :header_parsed, "
             ":beats_version, :beats_sub_version, :beats, :bpm_lock, "
+            ":beats_type, :beats_first_beat, "
             ":keys_version, :keys_sub_version, :keys, "
-            ":coverart_source, :coverart_type, :coverart_location, :coverart_hash "
+            ":coverart_source, :coverart_type, :coverart_location, :coverart_hash, "
+            ":fingerprint "
             ")");
 
     m_pQueryLibraryUpdate->prepare("UPDATE library SET mixxx_deleted = 0 "
@@ -1111,10 +1230,18 @@ bool setTrackBeats(const QSqlRecord& record, const int column,
     QString beatsSubVersion = record.value(column + 2).toString();
     QByteArray beatsBlob = record.value(column + 3).toByteArray();
     bool bpmLocked = record.value(column + 4).toBool();
-    BeatsPointer pBeats = BeatFactory::loadBeatsFromByteArray(
-            pTrack, beatsVersion, beatsSubVersion, &beatsBlob);
-    if (pBeats) {
-        pTrack->setBeats(pBeats);
+    if (!beatsBlob.isEmpty()) {
+        // The beats are decoded when they are first needed, usually when the
+        // track is loaded into a player or analyzed.
+        BeatsSummary summary;
+        int type = record.value(column + 5).toInt();
+        if (type == BeatsSummary::GRID || type == BeatsSummary::MAP) {
+            summary.type = static_cast<BeatsSummary::Type>(type);
+            summary.firstBeatSample = record.value(column + 6).toDouble();
+        }
+        summary.bpm = bpm;
+        pTrack->setSerializedBeats(beatsVersion, beatsSubVersion, beatsBlob,
+                                   summary);
     } else {
         pTrack->setBpm(bpm);
     }
@@ -1145,6 +1272,12 @@ bool setTrackKey(const QSqlRecord& record, const int column,
     return false;
 }
 
+bool setTrackFingerprint(const QSqlRecord& record, const int column,
+                         TrackPointer pTrack) {
+    pTrack->setFingerprint(record.value(column).toString());
+    return false;
+}
+
 bool setTrackCoverInfo(const QSqlRecord& record, const int column,
                        TrackPointer pTrack) {
     CoverInfo coverInfo;
@@ -1200,6 +1333,7 @@ TrackPointer TrackDAO::getTrackFromDB(const int id) const {
         { "played", setTrackPlayed },
         { "datetime_added", setTrackDateAdded },
         { "header_parsed", setTrackHeaderParsed },
+        { "fingerprint", setTrackFingerprint },
 
         // Beat detection columns are handled by setTrackBeats. Do not change
         // the ordering of these columns or put other columns in between them!
@@ -1208,6 +1342,8 @@ TrackPointer TrackDAO::getTrackFromDB(const int id) const {
         { "beats_sub_version", NULL },
         { "beats", NULL },
         { "bpm_lock", NULL },
+        { "beats_type", NULL },
+        { "beats_first_beat", NULL },
 
         // Beat detection columns are handled by setTrackKey. Do not change the
         // ordering of these columns or put other columns in between them!
@@ -1313,7 +1449,7 @@ TrackPointer TrackDAO::getTrackFromDB(const int id) const {
     // expirations and it can produce dangerous signal loops.
     // See: https://bugs.launchpad.net/mixxx/+bug/1365708
     connect(pCacheItem, SIGNAL(saveTrack(TrackPointer)),
-            this, SLOT(saveTrack(TrackPointer)),
+            this, SLOT(enqueueSaveTrack(TrackPointer)),
             Qt::QueuedConnection);
 
     m_recentTracksCache.insert(id, pCacheItem);
@@ -1380,7 +1516,7 @@ TrackPointer TrackDAO::getTrack(const int id, const bool cacheOnly) const {
         // expirations and it can produce dangerous signal loops.
         // See: https://bugs.launchpad.net/mixxx/+bug/1365708
         connect(pCacheItem, SIGNAL(saveTrack(TrackPointer)),
-                this, SLOT(saveTrack(TrackPointer)),
+                this, SLOT(enqueueSaveTrack(TrackPointer)),
                 Qt::QueuedConnection);
 
         m_recentTracksCache.insert(id, pCacheItem);
@@ -1408,128 +1544,169 @@ void TrackDAO::updateTrack(TrackInfoObject* pTrack) {
 
     //qDebug() << "Updating track" << pTrack->getInfo() << "in database...";
 
-    int trackId = pTrack->getId();
-    DEBUG_ASSERT_AND_HANDLE(trackId >= 0) {
+    if (!updateTrackRow(pTrack)) {
         return;
     }
+    transaction.commit();
 
-    QSqlQuery query(m_database);
+    //qDebug() << "Update track in database took: " << time.elapsed() << "ms";
+    //time.start();
+    pTrack->setDirty(false);
+    //qDebug() << "Dirtying track took: " << time.elapsed() << "ms";
+}
 
-    //Update everything but "location", since that's what we identify the track by.
-    query.prepare("UPDATE library "
-                  "SET artist=:artist, "
-                  "title=:title, album=:album, "
-                  "album_artist=:album_artist, "
-                  "year=:year, genre=:genre, composer=:composer, "
-                  "grouping=:grouping, filetype=:filetype, "
-                  "tracknumber=:tracknumber, comment=:comment, url=:url, "
-                  "duration=:duration, rating=:rating, "
-                  "key=:key, key_id=:key_id, "
-                  "bitrate=:bitrate, samplerate=:samplerate, cuepoint=:cuepoint, "
-                  "bpm=:bpm, replaygain=:replaygain, "
-                  "timesplayed=:timesplayed, played=:played, "
-                  "channels=:channels, header_parsed=:header_parsed, "
-                  "beats_version=:beats_version, beats_sub_version=:beats_sub_version, beats=:beats, "
-                  "bpm_lock=:bpm_lock, "
-                  "keys_version=:keys_version, keys_sub_version=:keys_sub_version, keys=:keys, "
-                  "coverart_source=:coverart_source, coverart_type=:coverart_type, "
-                  "coverart_location=:coverart_location, coverart_hash=:coverart_hash "
-                  "WHERE id=:track_id");
-    query.bindValue(":artist", pTrack->getArtist());
-    query.bindValue(":title", pTrack->getTitle());
-    query.bindValue(":album", pTrack->getAlbum());
-    query.bindValue(":album_artist", pTrack->getAlbumArtist());
-    query.bindValue(":year", pTrack->getYear());
-    query.bindValue(":genre", pTrack->getGenre());
-    query.bindValue(":composer", pTrack->getComposer());
-    query.bindValue(":grouping", pTrack->getGrouping());
-    query.bindValue(":filetype", pTrack->getType());
-    query.bindValue(":tracknumber", pTrack->getTrackNumber());
-    query.bindValue(":comment", pTrack->getComment());
-    query.bindValue(":url", pTrack->getURL());
-    query.bindValue(":duration", pTrack->getDuration());
-    query.bindValue(":bitrate", pTrack->getBitrate());
-    query.bindValue(":samplerate", pTrack->getSampleRate());
-    query.bindValue(":cuepoint", pTrack->getCuePoint());
-
-    query.bindValue(":replaygain", pTrack->getReplayGain());
-    query.bindValue(":rating", pTrack->getRating());
-    query.bindValue(":timesplayed", pTrack->getTimesPlayed());
-    query.bindValue(":played", pTrack->getPlayed() ? 1 : 0);
-    query.bindValue(":channels", pTrack->getChannels());
-    query.bindValue(":header_parsed", pTrack->getHeaderParsed() ? 1 : 0);
-    //query.bindValue(":location", pTrack->getLocation());
-    query.bindValue(":track_id", trackId);
-
-    query.bindValue(":bpm_lock", pTrack->hasBpmLock() ? 1 : 0);
-
-    BeatsPointer pBeats = pTrack->getBeats();
-    QByteArray* pBeatsBlob = NULL;
-    QString beatsVersion = "";
-    QString beatsSubVersion = "";
-    double dBpm = pTrack->getBpm();
+void TrackDAO::saveTracks(const QList<TrackPointer>& tracks) {
+    QList<TrackPointer> updatedTracks;
+    QList<TrackPointer> newTracks;
 
-    if (pBeats) {
-        pBeatsBlob = pBeats->toByteArray();
-        beatsVersion = pBeats->getVersion();
-        beatsSubVersion = pBeats->getSubVersion();
-        dBpm = pBeats->getBpm();
+    ScopedTransaction transaction(m_database);
+    foreach (TrackPointer pTrack, tracks) {
+        if (!pTrack) {
+            continue;
+        }
+        if (pTrack->getId() == -1) {
+            newTracks.append(pTrack);
+        } else if (pTrack->isDirty() && updateTrackRow(pTrack.data())) {
+            updatedTracks.append(pTrack);
+        }
+    }
+    if (!transaction.commit()) {
+        return;
     }
-    query.bindValue(":beats", pBeatsBlob ? *pBeatsBlob : QVariant(QVariant::ByteArray));
-    query.bindValue(":beats_version", beatsVersion);
-    query.bindValue(":beats_sub_version", beatsSubVersion);
-    query.bindValue(":bpm", dBpm);
-    delete pBeatsBlob;
-
-    const Keys& keys = pTrack->getKeys();
-    QByteArray* pKeysBlob = NULL;
-    QString keysVersion = "";
-    QString keysSubVersion = "";
-    QString keyText = "";
-    mixxx::track::io::key::ChromaticKey key = mixxx::track::io::key::INVALID;
 
-    if (keys.isValid()) {
-        pKeysBlob = keys.toByteArray();
-        keysVersion = keys.getVersion();
-        keysSubVersion = keys.getSubVersion();
-        key = keys.getGlobalKey();
-        // TODO(rryan): Get this logic out of TIO.
-        keyText = pTrack->getKeyText();
+    foreach (TrackPointer pTrack, updatedTracks) {
+        pTrack->setDirty(false);
+        writeAudioMetaData(pTrack.data());
     }
 
-    query.bindValue(":keys", pKeysBlob ? *pKeysBlob : QVariant(QVariant::ByteArray));
-    query.bindValue(":keys_version", keysVersion);
-    query.bindValue(":keys_sub_version", keysSubVersion);
-    query.bindValue(":key", keyText);
-    query.bindValue(":key_id", static_cast<int>(key));
-    delete pKeysBlob;
+    // Adding a track runs its own transaction.
+    foreach (TrackPointer pTrack, newTracks) {
+        addTrack(pTrack.data(), false);
+    }
+}
 
-    CoverInfo coverInfo = pTrack->getCoverInfo();
-    query.bindValue(":coverart_source", coverInfo.source);
-    query.bindValue(":coverart_type", coverInfo.type);
-    query.bindValue(":coverart_location", coverInfo.coverLocation);
-    query.bindValue(":coverart_hash", coverInfo.hash);
+bool TrackDAO::updateTrackRow(TrackInfoObject* pTrack) {
+    int trackId = pTrack->getId();
+    DEBUG_ASSERT_AND_HANDLE(trackId >= 0) {
+        return false;
+    }
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-        return;
+    // Only write the columns that changed. Every combination of dirty fields
+    // is its own statement in the query cache.
+    const int dirtyFields = pTrack->getDirtyFields();
+    QStringList assignments;
+    for (unsigned int i = 0; i < sizeof(kDirtyFieldColumns) /
+                 sizeof(kDirtyFieldColumns[0]); ++i) {
+        if (dirtyFields & kDirtyFieldColumns[i].field) {
+            foreach (const QString& column,
+                     QString(kDirtyFieldColumns[i].columns).split(',')) {
+                assignments << QString("%1=:%1").arg(column);
+            }
+        }
     }
 
-    if (query.numRowsAffected() == 0) {
-        qWarning() << "updateTrack had no effect: trackId" << trackId << "invalid";
-        return;
+    if (!assignments.isEmpty()) {
+        //Update everything but "location", since that's what we identify the track by.
+        CachedQuery query(m_queries.prepare(
+                QString("UPDATE library SET %1 WHERE id=:track_id")
+                .arg(assignments.join(", "))));
+        query.bindValue(":track_id", trackId);
+
+        if (dirtyFields & TrackInfoObject::DIRTY_METADATA) {
+            query.bindValue(":artist", pTrack->getArtist());
+            query.bindValue(":title", pTrack->getTitle());
+            query.bindValue(":album", pTrack->getAlbum());
+            query.bindValue(":album_artist", pTrack->getAlbumArtist());
+            query.bindValue(":year", pTrack->getYear());
+            query.bindValue(":genre", pTrack->getGenre());
+            query.bindValue(":composer", pTrack->getComposer());
+            query.bindValue(":grouping", pTrack->getGrouping());
+            query.bindValue(":filetype", pTrack->getType());
+            query.bindValue(":tracknumber", pTrack->getTrackNumber());
+            query.bindValue(":comment", pTrack->getComment());
+            query.bindValue(":url", pTrack->getURL());
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_AUDIO_PROPERTIES) {
+            query.bindValue(":duration", pTrack->getDuration());
+            query.bindValue(":bitrate", pTrack->getBitrate());
+            query.bindValue(":samplerate", pTrack->getSampleRate());
+            query.bindValue(":channels", pTrack->getChannels());
+            query.bindValue(":header_parsed", pTrack->getHeaderParsed() ? 1 : 0);
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_REPLAYGAIN) {
+            query.bindValue(":replaygain", pTrack->getReplayGain());
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_PLAY_COUNT) {
+            query.bindValue(":timesplayed", pTrack->getTimesPlayed());
+            query.bindValue(":played", pTrack->getPlayed() ? 1 : 0);
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_RATING) {
+            query.bindValue(":rating", pTrack->getRating());
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_CUE_POINT) {
+            query.bindValue(":cuepoint", pTrack->getCuePoint());
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_BEATS) {
+            bindTrackBeats(&query, pTrack);
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_BPM_LOCK) {
+            query.bindValue(":bpm_lock", pTrack->hasBpmLock() ? 1 : 0);
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_KEYS) {
+            const Keys& keys = pTrack->getKeys();
+            QByteArray* pKeysBlob = NULL;
+            QString keysVersion = "";
+            QString keysSubVersion = "";
+            QString keyText = "";
+            mixxx::track::io::key::ChromaticKey key = mixxx::track::io::key::INVALID;
+
+            if (keys.isValid()) {
+                pKeysBlob = keys.toByteArray();
+                keysVersion = keys.getVersion();
+                keysSubVersion = keys.getSubVersion();
+                key = keys.getGlobalKey();
+                // TODO(rryan): Get this logic out of TIO.
+                keyText = pTrack->getKeyText();
+            }
+
+            query.bindValue(":keys", pKeysBlob ? *pKeysBlob : QVariant(QVariant::ByteArray));
+            query.bindValue(":keys_version", keysVersion);
+            query.bindValue(":keys_sub_version", keysSubVersion);
+            query.bindValue(":key", keyText);
+            query.bindValue(":key_id", static_cast<int>(key));
+            delete pKeysBlob;
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_COVER_ART) {
+            CoverInfo coverInfo = pTrack->getCoverInfo();
+            query.bindValue(":coverart_source", coverInfo.source);
+            query.bindValue(":coverart_type", coverInfo.type);
+            query.bindValue(":coverart_location", coverInfo.coverLocation);
+            query.bindValue(":coverart_hash", coverInfo.hash);
+        }
+        if (dirtyFields & TrackInfoObject::DIRTY_FINGERPRINT) {
+            query.bindValue(":fingerprint", pTrack->getFingerprint());
+        }
+
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return false;
+        }
+
+        if (query.numRowsAffected() == 0) {
+            qWarning() << "updateTrack had no effect: trackId" << trackId << "invalid";
+            return false;
+        }
     }
 
     //qDebug() << "Update track took : " << time.elapsed() << "ms. Now updating cues";
     //time.start();
-    m_analysisDao.saveTrackAnalyses(pTrack);
-    m_cueDao.saveTrackCues(trackId, pTrack);
-    transaction.commit();
-
-    //qDebug() << "Update track in database took: " << time.elapsed() << "ms";
-    //time.start();
-    pTrack->setDirty(false);
-    //qDebug() << "Dirtying track took: " << time.elapsed() << "ms";
+    if (dirtyFields & TrackInfoObject::DIRTY_WAVEFORM) {
+        m_analysisDao.saveTrackAnalyses(pTrack);
+    }
+    if (dirtyFields & TrackInfoObject::DIRTY_CUES) {
+        m_cueDao.saveTrackCues(trackId, pTrack);
+    }
+    return true;
 }
 
 // Mark all the tracks in the library as invalid.
@@ -1749,7 +1926,8 @@ void TrackDAO::detectMovedFiles(QSet<int>* pTracksMovedSetOld, QSet<int>* pTrack
 
 void TrackDAO::clearCache() {
     // Triggers a deletion of all the TrackCacheItems which in turn calls
-    // saveTrack(TrackPointer) for all of the tracks in the recent tracks cache.
+    // enqueueSaveTrack(TrackPointer) for all of the tracks in the recent tracks
+    // cache.
     m_recentTracksCache.clear();
 }
 
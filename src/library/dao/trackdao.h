@@ -11,9 +11,11 @@
 #include <QWeakPointer>
 #include <QCache>
 #include <QString>
+#include <QTimer>
 
 #include "configobject.h"
 #include "library/dao/dao.h"
+#include "library/queryutil.h"
 #include "trackinfoobject.h"
 #include "util.h"
 
@@ -65,7 +67,6 @@ const QString TRACKLOCATIONSTABLE_FILESIZE = "filesize";
 const QString TRACKLOCATIONSTABLE_FSDELETED = "fs_deleted";
 const QString TRACKLOCATIONSTABLE_NEEDSVERIFICATION = "needs_verification";
 
-class ScopedTransaction;
 class PlaylistDAO;
 class AnalysisDao;
 class CueDAO;
@@ -74,8 +75,8 @@ class LibraryHashDAO;
 
 // Holds a strong reference to a track while it is in the "recent tracks"
 // cache. Once it expires from the cache it signals to
-// TrackDAO::saveTrack(TrackPointer) to save the track if it is dirty and then
-// drops the strong reference. This prevents a race condition caused by caching
+// TrackDAO::enqueueSaveTrack(TrackPointer) to save the track if it is dirty and
+// then drops the strong reference. This prevents a race condition caused by caching
 // TrackPointers themselves within the QCache by holding a strong reference to
 // TrackPointer (and thereby serving it out of the weak pointer track cache) up
 // until the track has been saved to the database.
@@ -108,14 +109,23 @@ class TrackDAO : public QObject, public virtual DAO {
     virtual ~TrackDAO();
 
     void finish();
-    void setDatabase(QSqlDatabase& database) { m_database = database; }
+    void setDatabase(QSqlDatabase& database) {
+        m_database = database;
+        m_queries.clear();
+    }
 
     void initialize();
     int getTrackId(const QString& absoluteFilePath);
     QList<int> getTrackIds(const QList<QFileInfo>& files);
+    // Returns the tracks that have the given fingerprint, i.e. are most
+    // likely copies of the same recording.
+    QList<int> getTrackIdsByFingerprint(const QString& fingerprint);
     bool trackExistsInDatabase(const QString& absoluteFilePath);
     // Returns a set of all track locations in the library.
     QSet<QString> getTrackLocations();
+    // Returns the locations of locations that are track locations which were
+    // not found missing from the file system by the last scan.
+    QSet<QString> getKnownTrackLocations(const QStringList& locations);
     QString getTrackLocation(const int id);
     int addTrack(const QString& file, bool unremove);
     int addTrack(const QFileInfo& fileInfo, bool unremove);
@@ -142,6 +152,9 @@ class TrackDAO : public QObject, public virtual DAO {
                                bool* pAlreadyInLibrary);
 
     bool isDirty(int trackId);
+    // Saves the dirty tracks of tracks in a single transaction. Tracks that
+    // are not in the library yet are added.
+    void saveTracks(const QList<TrackPointer>& tracks);
     void markTracksAsMixxxDeleted(const QString& dir);
 
     // Scanning related calls. Should be elsewhere or private somehow.
@@ -171,6 +184,10 @@ class TrackDAO : public QObject, public virtual DAO {
     // on it. However, private parts of TrackDAO can use the raw saveTrack(TIO*)
     // call.
     void saveTrack(TrackPointer pTrack);
+    // Saves pTrack together with the other tracks that are enqueued within a
+    // short time, in a single transaction that only writes the changed
+    // columns.
+    void enqueueSaveTrack(TrackPointer pTrack);
 
     // Clears the cached TrackInfoObjects, which can be useful when the
     // underlying database tables change (eg. during a library rescan,
@@ -187,11 +204,15 @@ class TrackDAO : public QObject, public virtual DAO {
     void slotTrackChanged(TrackInfoObject* pTrack);
     void slotTrackClean(TrackInfoObject* pTrack);
     void slotTrackReferenceExpired(TrackInfoObject* pTrack);
+    void slotSavePendingTracks();
 
   private:
     bool isTrackFormatSupported(TrackInfoObject* pTrack) const;
     void saveTrack(TrackInfoObject* pTrack);
     void updateTrack(TrackInfoObject* pTrack);
+    // Writes pTrack, its analyses and its cues to the database. Must be called
+    // within a transaction.
+    bool updateTrackRow(TrackInfoObject* pTrack);
     void addTrack(TrackInfoObject* pTrack, bool unremove);
     TrackPointer getTrackFromDB(const int id) const;
     QString absoluteFilePath(QString location);
@@ -202,6 +223,7 @@ class TrackDAO : public QObject, public virtual DAO {
     void writeAudioMetaData(TrackInfoObject* pTrack);
 
     QSqlDatabase& m_database;
+    PreparedQueryCache m_queries;
     CueDAO& m_cueDao;
     PlaylistDAO& m_playlistDao;
     CrateDAO& m_crateDao;
@@ -213,8 +235,8 @@ class TrackDAO : public QObject, public virtual DAO {
     // Weak pointer cache of active tracks.
     static QHash<int, TrackWeakPointer> m_sTracks;
     // "Recent tracks" cache -- holds strong references to recently used
-    // tracks. When a track is expired, calls saveTrack(TrackPointer) without
-    // dropping the strong reference to the track. This prevents a race
+    // tracks. When a track is expired, calls enqueueSaveTrack(TrackPointer)
+    // without dropping the strong reference to the track. This prevents a race
     // condition where the strong reference is dropped and therefore cache-only
     // getTrack calls made by BaseSqlTableModel return null and serve stale
     // results from BaseTrackCache before the newly expired TrackPointer has
@@ -233,6 +255,10 @@ class TrackDAO : public QObject, public virtual DAO {
 
     QSet<int> m_tracksAddedSet;
 
+    // Tracks waiting for m_saveTimer to save them.
+    QHash<TrackInfoObject*, TrackPointer> m_pendingSaves;
+    QTimer m_saveTimer;
+
     DISALLOW_COPY_AND_ASSIGN(TrackDAO);
 };
 
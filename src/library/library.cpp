@@ -223,6 +223,8 @@ void Library::addFeature(LibraryFeature* feature) {
             this, SIGNAL(enableCoverArtDisplay(bool)));
     connect(feature, SIGNAL(trackSelected(TrackPointer)),
             this, SIGNAL(trackSelected(TrackPointer)));
+    connect(feature, SIGNAL(prestageTrack(TrackPointer)),
+            this, SIGNAL(prestageTrack(TrackPointer)));
 }
 
 void Library::slotShowTrackModel(QAbstractItemModel* model) {
@@ -104,6 +104,7 @@ public:
     // emit this signal to enable/disable the cover art widget
     void enableCoverArtDisplay(bool);
     void trackSelected(TrackPointer pTrack);
+    void prestageTrack(TrackPointer pTrack);
 
     void setTrackTableFont(const QFont& font);
     void setTrackTableRowHeight(int rowHeight);
@@ -96,6 +96,8 @@ class LibraryFeature : public QObject {
     // emit this signal to enable/disable the cover art widget
     void enableCoverArtDisplay(bool);
     void trackSelected(TrackPointer pTrack);
+    // emit this signal to hint that pTrack is likely to be loaded soon
+    void prestageTrack(TrackPointer pTrack);
 };
 
 #endif /* LIBRARYFEATURE_H */
@@ -13,16 +13,30 @@
 
 #include <QtDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QIODevice>
+#include <QSet>
+#include <QtConcurrentMap>
 
 #include "library/parser.h"
+#include "library/dao/trackdao.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+bool fileExists(const QString& location) {
+    return QFile::exists(location);
+}
+
+}  // anonymous namespace
 
 /**
    @author Ingo Kossyk (kossyki@cs.tu-berlin.de)
  **/
 
 
-Parser::Parser() : QObject()
+Parser::Parser() : QObject(),
+                   m_pTrackDao(NULL)
 {
 }
 
@@ -32,9 +46,78 @@ Parser::~Parser()
 
 }
 
+void Parser::setTrackDAO(TrackDAO* pTrackDao) {
+    m_pTrackDao = pTrackDao;
+}
+
 void Parser::clearLocations()
 {
     m_sLocations.clear();
+    m_entries.clear();
+}
+
+void Parser::addEntry(const QString& location, const QString& basepath) {
+    QStringList candidates;
+    candidates << location;
+    if (QFileInfo(location).isRelative()) {
+        candidates << basepath + "/" + location;
+    }
+    m_entries.append(candidates);
+}
+
+void Parser::resolveEntries() {
+    PerformanceTimer timer;
+    timer.start();
+
+    QStringList candidates;
+    foreach (const QStringList& entry, m_entries) {
+        candidates << entry;
+    }
+    QSet<QString> knownLocations;
+    if (m_pTrackDao) {
+        knownLocations = m_pTrackDao->getKnownTrackLocations(candidates);
+    }
+
+    // Checking a file can take milliseconds on a network share, so only the
+    // entries the library does not know are checked, all at once.
+    QStringList unknownLocations;
+    foreach (const QStringList& entry, m_entries) {
+        bool known = false;
+        foreach (const QString& candidate, entry) {
+            if (knownLocations.contains(candidate)) {
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            unknownLocations << entry;
+        }
+    }
+    unknownLocations.removeDuplicates();
+    QList<bool> exists = QtConcurrent::blockingMapped<QList<bool> >(
+            unknownLocations, fileExists);
+    QSet<QString> existingLocations;
+    for (int i = 0; i < unknownLocations.size(); ++i) {
+        if (exists[i]) {
+            existingLocations.insert(unknownLocations[i]);
+        }
+    }
+
+    foreach (const QStringList& entry, m_entries) {
+        foreach (const QString& candidate, entry) {
+            if (knownLocations.contains(candidate) ||
+                    existingLocations.contains(candidate)) {
+                m_sLocations.append(candidate);
+                break;
+            }
+        }
+    }
+
+    qDebug() << "Parser: resolved" << m_sLocations.size() << "of"
+             << m_entries.size() << "entries," << knownLocations.size()
+             << "known to the library, in"
+             << timer.elapsed() / 1000000 << "ms";
+    m_entries.clear();
 }
 
 long Parser::countParsed()
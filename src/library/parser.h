@@ -23,8 +23,11 @@ it afterwards fro proper functioning
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QList>
 
+class TrackDAO;
+
 class Parser : public QObject {
   public:
     static bool isPlaylistFilenameSupported(const QString& fileName) {
@@ -42,6 +45,10 @@ class Parser : public QObject {
      or 0 in order for the trackimporter to function**/
     virtual QList<QString> parse(QString) = 0;
 
+    // Lets the parser look up playlist entries among the track locations of
+    // the library before it checks whether they exist on disk.
+    void setTrackDAO(TrackDAO* pTrackDao);
+
 
 protected:
     /**Pointer to the parsed Filelocations**/
@@ -56,6 +63,19 @@ protected:
     bool isFilepath(QString);
     // check for Utf8 encoding
     static bool isUtf8(const char* string);
+
+    // Adds a playlist entry. It resolves to location if that is a file, or
+    // else to location relative to basepath.
+    void addEntry(const QString& location, const QString& basepath);
+    // Resolves the added entries and appends the ones that exist to
+    // m_sLocations, in order. Entries that are known track locations are
+    // found with one query, only the others are checked on disk, in parallel.
+    void resolveEntries();
+
+  private:
+    // The candidate paths of every added entry, in order of preference.
+    QList<QStringList> m_entries;
+    TrackDAO* m_pTrackDao;
 };
 
 #endif
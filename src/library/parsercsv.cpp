@@ -47,19 +47,19 @@ QList<QString> ParserCsv::parse(QString sFilename) {
             }
             for (int i = 1; i < tokens.size(); ++i) {
                 if (loc_coll < tokens[i].size()) {
-                    // Todo: check if path is relative
                     QFileInfo fi = tokens[i][loc_coll];
                     if (fi.isRelative()) {
                         // add base path
                         qDebug() << "is relative" << basepath << fi.filePath();
                         fi.setFile(basepath,fi.filePath());
                     }
-                    m_sLocations.append(fi.filePath());
+                    addEntry(fi.filePath(), basepath);
                 }
             }
         }
 
         file.close();
+        resolveEntries();
 
         if(m_sLocations.count() != 0)
             return m_sLocations;
@@ -84,10 +84,11 @@ QList<QString> ParserM3u::parse(QString sFilename)
                 break;
 
             //qDebug() << "ParserM3u: parsed: " << (sLine);
-            m_sLocations.append(sLine);
+            addEntry(sLine, basepath);
         }
 
         file.close();
+        resolveEntries();
         return m_sLocations;
     }
 
@@ -117,15 +118,10 @@ QString ParserM3u::getFilepath(QTextStream *stream, QString basepath)
             //qDebug() << "QURL UTF-8: " << location;
             QString trackLocation = location.toString();
             //qDebug() << "UTF8 TrackLocation:" << trackLocation;
-            if(isFilepath(trackLocation)) {
+            // Whether it is a file, possibly relative to the m3u dir, is
+            // checked for all entries at once in resolveEntries().
+            if (!trackLocation.isEmpty()) {
                 return trackLocation;
-            } else {
-                // Try relative to m3u dir
-                QString rel = basepath + "/" + trackLocation;
-                if (isFilepath(rel)) {
-                    return rel;
-                }
-                // We couldn't match this to a real file so ignore it
             }
         }
         textline = stream->readLine();
@@ -33,7 +33,7 @@ public:
     static bool writeM3U8File(const QString &file_str, QList<QString> &items, bool useRelativePath);
 
 private:
-    /**Reads a line from the file and returns filepath if a valid file**/
+    /**Reads lines from the file until it finds an entry and returns its filepath**/
     QString getFilepath(QTextStream *, QString);
 
 
@@ -67,12 +67,13 @@ QList<QString> ParserPls::parse(QString sFilename)
             if(psLine.isNull()) {
                 break;
             } else {
-                m_sLocations.append(psLine);
+                addEntry(psLine, basepath);
             }
 
         }
 
         file.close();
+        resolveEntries();
 
         if(m_sLocations.count() != 0)
             return m_sLocations;
@@ -130,15 +131,10 @@ QString ParserPls::getFilepath(QTextStream *stream, QString basepath)
             QString trackLocation = location.toString();
             //qDebug() << trackLocation;
 
-            if(isFilepath(trackLocation)) {
+            // Whether it is a file, possibly relative to the pls dir, is
+            // checked for all entries at once in resolveEntries().
+            if (!trackLocation.isEmpty()) {
                 return trackLocation;
-            } else {
-                // Try relative to m3u dir
-                QString rel = basepath + "/" + trackLocation;
-                if (isFilepath(rel)) {
-                    return rel;
-                }
-                // We couldn't match this to a real file so ignore it
             }
         }
         textline = stream->readLine();
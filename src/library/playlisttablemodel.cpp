@@ -70,6 +70,19 @@ void PlaylistTableModel::setTableModel(int playlistId) {
 
 int PlaylistTableModel::addTracks(const QModelIndex& index,
                                   const QList<QString>& locations) {
+    // Locations that are in the library don't have to be checked on disk.
+    QSet<QString> knownLocations = m_trackDAO.getKnownTrackLocations(locations);
+    QList<QString> existingLocations;
+    foreach (const QString& location, locations) {
+        if (knownLocations.contains(location) || QFileInfo(location).exists()) {
+            existingLocations.append(location);
+        }
+    }
+    return addResolvedTracks(index, existingLocations);
+}
+
+int PlaylistTableModel::addResolvedTracks(const QModelIndex& index,
+                                          const QList<QString>& locations) {
     if (locations.isEmpty()) {
         return 0;
     }
@@ -83,11 +96,8 @@ int PlaylistTableModel::addTracks(const QModelIndex& index,
     }
 
     QList<QFileInfo> fileInfoList;
-    foreach (QString fileLocation, locations) {
-        QFileInfo fileInfo(fileLocation);
-        if (fileInfo.exists()) {
-            fileInfoList.append(fileInfo);
-        }
+    foreach (const QString& location, locations) {
+        fileInfoList.append(QFileInfo(location));
     }
 
     QList<int> trackIds = m_trackDAO.addTracks(fileInfoList, true);
@@ -24,6 +24,10 @@ class PlaylistTableModel : public BaseSqlTableModel {
     // Adding multiple tracks at one to a playlist. Returns the number of
     // successful additions.
     int addTracks(const QModelIndex& index, const QList<QString>& locations);
+    // Like addTracks() for locations that are known to exist, like the
+    // entries of a parsed playlist. They are not checked again.
+    int addResolvedTracks(const QModelIndex& index,
+                          const QList<QString>& locations);
     bool appendTrack(const int trackId);
     void moveTrack(const QModelIndex& sourceIndex,
                    const QModelIndex& destIndex);
@@ -65,6 +65,78 @@ class ScopedTransaction {
     bool m_active;
 };
 
+// Caches the prepared queries of a database connection so that statements
+// which are executed often are only compiled once. Each DAO keeps one for its
+// connection and clears it in setDatabase().
+//
+// A cached query is reused by the next prepare() of the same SQL, so hold it
+// in a CachedQuery, which releases it when it goes out of scope. If the query
+// is still in use, e.g. because prepare() is called again while iterating
+// over its results, a fresh query is returned instead.
+class PreparedQueryCache {
+  public:
+    explicit PreparedQueryCache(QSqlDatabase& database)
+            : m_database(database),
+              m_hits(0),
+              m_misses(0) {
+    }
+
+    QSqlQuery prepare(const QString& statement) {
+        QHash<QString, QSqlQuery>::iterator it = m_queries.find(statement);
+        if (it != m_queries.end()) {
+            if (!it.value().isActive()) {
+                ++m_hits;
+                return it.value();
+            }
+            QSqlQuery query(m_database);
+            query.prepare(statement);
+            return query;
+        }
+        ++m_misses;
+        QSqlQuery query(m_database);
+        if (!query.prepare(statement)) {
+            LOG_FAILED_QUERY(query);
+            // Don't cache it; exec() reports the error to the caller.
+            return query;
+        }
+        m_queries.insert(statement, query);
+        return query;
+    }
+
+    void clear() {
+        m_queries.clear();
+    }
+
+    int size() const {
+        return m_queries.size();
+    }
+    int hits() const {
+        return m_hits;
+    }
+    int misses() const {
+        return m_misses;
+    }
+
+  private:
+    QSqlDatabase& m_database;
+    QHash<QString, QSqlQuery> m_queries;
+    int m_hits;
+    int m_misses;
+};
+
+// A query from a PreparedQueryCache. Releases the results of the query when it
+// goes out of scope so that the statement can be reused and does not keep
+// the database locked until then.
+class CachedQuery : public QSqlQuery {
+  public:
+    CachedQuery(const QSqlQuery& query)
+            : QSqlQuery(query) {
+    }
+    ~CachedQuery() {
+        finish();
+    }
+};
+
 class FieldEscaper {
   public:
     FieldEscaper(const QSqlDatabase& database)
@@ -14,7 +14,16 @@
 #include "util/assert.h"
 
 // static
-const int TrackCollection::kRequiredSchemaVersion = 24;
+const int TrackCollection::kRequiredSchemaVersion = 27;
+
+namespace {
+
+const QString kDatabaseFilename = "/mixxxdb.sqlite";
+// The schema XML is baked into the binary via Qt resources.
+const QString kSchemaFilename = ":/schema.xml";
+const QString kUpgradeConnectionName = "TrackCollection::upgradeDatabase";
+
+}  // namespace
 
 TrackCollection::TrackCollection(ConfigObject<ConfigValue>* pConfig)
         : m_pConfig(pConfig),
@@ -25,12 +34,13 @@ TrackCollection::TrackCollection(ConfigObject<ConfigValue>* pConfig)
           m_directoryDao(m_db),
           m_analysisDao(m_db, pConfig),
           m_libraryHashDao(m_db),
+          m_analysisJobDao(m_db),
           m_trackDao(m_db, m_cueDao, m_playlistDao, m_crateDao,
                      m_analysisDao, m_libraryHashDao, pConfig) {
     qDebug() << "Available QtSQL drivers:" << QSqlDatabase::drivers();
 
     m_db.setHostName("localhost");
-    m_db.setDatabaseName(pConfig->getSettingsPath().append("/mixxxdb.sqlite"));
+    m_db.setDatabaseName(pConfig->getSettingsPath().append(kDatabaseFilename));
     m_db.setUserName("mixxx");
     m_db.setPassword("mixxx");
     bool ok = m_db.open();
@@ -79,8 +89,6 @@ bool TrackCollection::checkForTables() {
     installSorting(m_db);
 #endif
 
-    // The schema XML is baked into the binary via Qt resources.
-    QString schemaFilename(":/schema.xml");
     QString okToExit = tr("Click OK to exit.");
     QString upgradeFailed = tr("Cannot upgrade database schema");
     QString upgradeToVersionFailed =
@@ -90,7 +98,7 @@ bool TrackCollection::checkForTables() {
                            "mixxx-devel@lists.sourceforge.net";
 
     SchemaManager::Result result = SchemaManager::upgradeToSchemaVersion(
-            schemaFilename, m_db, kRequiredSchemaVersion);
+            kSchemaFilename, m_db, kRequiredSchemaVersion);
     switch (result) {
         case SchemaManager::RESULT_BACKWARDS_INCOMPATIBLE:
             QMessageBox::warning(
@@ -129,9 +137,26 @@ bool TrackCollection::checkForTables() {
     m_cueDao.initialize();
     m_directoryDao.initialize();
     m_libraryHashDao.initialize();
+    m_analysisJobDao.initialize();
     return true;
 }
 
+// static
+void TrackCollection::upgradeDatabase(const QString& settingsPath) {
+    // The connection has to be gone before it can be removed.
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE",
+                                                    kUpgradeConnectionName);
+        db.setDatabaseName(settingsPath + kDatabaseFilename);
+        if (db.open()) {
+            SchemaManager::upgradeToSchemaVersion(kSchemaFilename, db,
+                                                  kRequiredSchemaVersion);
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(kUpgradeConnectionName);
+}
+
 QSqlDatabase& TrackCollection::getDatabase() {
     return m_db;
 }
@@ -152,6 +177,10 @@ DirectoryDAO& TrackCollection::getDirectoryDAO() {
     return m_directoryDao;
 }
 
+AnalysisJobDAO& TrackCollection::getAnalysisJobDAO() {
+    return m_analysisJobDao;
+}
+
 QSharedPointer<BaseTrackCache> TrackCollection::getTrackSource() {
     return m_defaultTrackSource;
 }
@@ -30,6 +30,7 @@
 #include "library/dao/cuedao.h"
 #include "library/dao/playlistdao.h"
 #include "library/dao/analysisdao.h"
+#include "library/dao/analysisjobdao.h"
 #include "library/dao/directorydao.h"
 #include "library/dao/libraryhashdao.h"
 
@@ -56,6 +57,12 @@ class TrackCollection : public QObject {
     virtual ~TrackCollection();
     bool checkForTables();
 
+    // Upgrades the schema of the library database in settingsPath on a
+    // connection of its own, so that startup can do it on a worker thread
+    // before the TrackCollection is created. Failures are left for
+    // checkForTables() to report.
+    static void upgradeDatabase(const QString& settingsPath);
+
     void resetLibaryCancellation();
     QSqlDatabase& getDatabase();
 
@@ -63,6 +70,7 @@ class TrackCollection : public QObject {
     TrackDAO& getTrackDAO();
     PlaylistDAO& getPlaylistDAO();
     DirectoryDAO& getDirectoryDAO();
+    AnalysisJobDAO& getAnalysisJobDAO();
     QSharedPointer<BaseTrackCache> getTrackSource();
     void setTrackSource(QSharedPointer<BaseTrackCache> trackSource);
     void cancelLibraryScan();
@@ -103,6 +111,7 @@ class TrackCollection : public QObject {
     DirectoryDAO m_directoryDao;
     AnalysisDao m_analysisDao;
     LibraryHashDAO m_libraryHashDao;
+    AnalysisJobDAO m_analysisJobDao;
     TrackDAO m_trackDao;
 };
 
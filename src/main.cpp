@@ -260,6 +260,11 @@ int main(int argc, char * argv[])
 \n\
     --developer             Enables developer-mode. Includes extra log info,\n\
                             stats on performance, and a Developer tools menu.\n\
+\n\
+    --recordSessionPath PATH\n\
+                            Records all control changes and track loads of\n\
+                            this session to PATH. The session can be\n\
+                            replayed with mixxx-bench.\n\
 \n\
     --safeMode              Enables safe-mode. Disables OpenGL waveforms,\n\
                             and spinning vinyl widgets. Try this option if\n\
@@ -29,6 +29,7 @@
 #include "analyserqueue.h"
 #include "controlpotmeter.h"
 #include "controlobjectslave.h"
+#include "control/controlrecorder.h"
 #include "deck.h"
 #include "defs_urls.h"
 #include "dlgabout.h"
@@ -43,6 +44,7 @@
 #include "library/coverartcache.h"
 #include "library/library.h"
 #include "library/library_preferences.h"
+#include "library/trackcollection.h"
 #include "library/scanner/libraryscanner.h"
 #include "library/librarytablemodel.h"
 #include "controllers/controllermanager.h"
@@ -57,14 +59,19 @@
 #include "soundmanagerutil.h"
 #include "soundsourceproxy.h"
 #include "trackinfoobject.h"
+#include "trackprestager.h"
+#include "sharedchunkcache.h"
 #include "upgrade.h"
 #include "waveform/waveformwidgetfactory.h"
 #include "widget/wwaveformviewer.h"
 #include "widget/wwidget.h"
 #include "widget/wspinny.h"
+#include "widget/repaintscheduler.h"
 #include "sharedglcontext.h"
 #include "util/debug.h"
+#include "util/startupgraph.h"
 #include "util/statsmanager.h"
+#include "util/threadplacement.h"
 #include "util/timer.h"
 #include "util/time.h"
 #include "util/version.h"
@@ -86,6 +93,10 @@
 #include "dlgprefmodplug.h"
 #endif
 
+#ifdef __LILV__
+#include "effects/lv2/lv2backend.h"
+#endif
+
 // static
 const int MixxxMainWindow::kMicrophoneCount = 4;
 // static
@@ -96,7 +107,9 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
           m_pDeveloperToolsDlg(NULL),
           m_runtime_timer("MixxxMainWindow::runtime"),
           m_cmdLineArgs(args),
-          m_iNumConfiguredDecks(0) {
+          m_iNumConfiguredDecks(0),
+          m_pApp(pApp),
+          m_bRescanLibrary(false) {
     // We use QSet<int> in signals in the library.
     qRegisterMetaType<QSet<int> >("QSet<int>");
 
@@ -115,10 +128,94 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
     m_pShoutcastManager = NULL;
 #endif
 
+    // Startup runs as a graph of phases. Whatever creates controls, QObjects
+    // or widgets runs in the main thread. Probing the controllers (and the
+    // sound devices on Linux), upgrading the library database and parsing
+    // the skin run on worker threads meanwhile. A phase must list every
+    // phase whose results it uses: the main thread runs its phases in the
+    // order they are added, but skips ahead past those that still wait for a
+    // worker.
+    StartupGraph startup;
+    const int settings = startup.addPhase(
+            "settings", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeSettings);
+    // The Windows host APIs of PortAudio initialize COM in the thread that
+    // calls Pa_Initialize, so that has to be the main thread. ALSA, JACK and
+    // OSS on Linux have no such ties and probe on a worker.
+#ifdef Q_OS_LINUX
+    const StartupGraph::Thread audioDevicesThread = StartupGraph::WORKER_THREAD;
+#else
+    const StartupGraph::Thread audioDevicesThread = StartupGraph::MAIN_THREAD;
+#endif
+    const int audioDevices = startup.addPhase(
+            "audio devices", audioDevicesThread,
+            this, &MixxxMainWindow::initializeAudioDevices,
+            QList<int>() << settings);
+    const int libraryDatabase = startup.addPhase(
+            "library database", StartupGraph::WORKER_THREAD,
+            this, &MixxxMainWindow::initializeLibraryDatabase,
+            QList<int>() << settings);
+    const int skinDocument = startup.addPhase(
+            "skin document", StartupGraph::WORKER_THREAD,
+            this, &MixxxMainWindow::initializeSkinDocument,
+            QList<int>() << settings);
+    const int controllers = startup.addPhase(
+            "controllers", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeControllers,
+            QList<int>() << settings);
+    const int controllerDevices = startup.addPhase(
+            "controller devices", StartupGraph::WORKER_THREAD,
+            this, &MixxxMainWindow::initializeControllerDevices,
+            QList<int>() << controllers);
+    const int engine = startup.addPhase(
+            "engine", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeEngine,
+            QList<int>() << settings);
+    const int effects = startup.addPhase(
+            "effects", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeEffects,
+            QList<int>() << engine);
+    const int sound = startup.addPhase(
+            "sound", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeSound,
+            QList<int>() << effects << audioDevices);
+    const int players = startup.addPhase(
+            "players", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializePlayers,
+            QList<int>() << sound << effects);
+    const int library = startup.addPhase(
+            "library", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeLibrary,
+            QList<int>() << players << libraryDatabase);
+    const int skin = startup.addPhase(
+            "skin", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeSkin,
+            QList<int>() << library << controllers << skinDocument);
+    startup.addPhase(
+            "controller setup", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeControllerSetup,
+            QList<int>() << skin << controllerDevices);
+    startup.addPhase(
+            "library scan", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeLibraryScanner,
+            QList<int>() << skin);
+    const int soundDevices = startup.addPhase(
+            "sound devices", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeSoundDevices,
+            QList<int>() << skin);
+    startup.addPhase(
+            "command line", StartupGraph::MAIN_THREAD,
+            this, &MixxxMainWindow::initializeCommandLine,
+            QList<int>() << soundDevices);
+    startup.run();
+}
+
+void MixxxMainWindow::initializeSettings() {
     // Check to see if this is the first time this version of Mixxx is run
     // after an upgrade and make any needed changes.
     Upgrade upgrader;
-    m_pConfig = upgrader.versionUpgrade(args.getSettingsPath());
+    m_pConfig = upgrader.versionUpgrade(m_cmdLineArgs.getSettingsPath());
+    m_bRescanLibrary = upgrader.rescanLibrary();
     ControlDoublePrivate::setUserConfig(m_pConfig);
 
     Sandbox::initialize(m_pConfig->getSettingsPath().append("/sandbox.cfg"));
@@ -129,7 +226,7 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
     }
 
     QString resourcePath = m_pConfig->getResourcePath();
-    initializeTranslations(pApp);
+    initializeTranslations(m_pApp);
 
     initializeFonts();
 
@@ -142,29 +239,111 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
     setAttribute(Qt::WA_AcceptTouchEvents);
     m_pTouchShift = new ControlPushButton(ConfigKey("[Controls]", "touch_shift"));
 
+    // Decide where the engine, reader and analyser threads run before any of
+    // them is started.
+    ThreadPlacement::configure(m_pConfig);
+
+    // Do not write meta data back to ID3 when meta data has changed
+    // Because multiple TrackDao objects can exists for a particular track
+    // writing meta data may ruin your MP3 file if done simultaneously.
+    // see Bug #728197
+    // For safety reasons, we deactivate this feature.
+    m_pConfig->set(ConfigKey("[Library]","WriteAudioTags"), ConfigValue(0));
+
+    // library dies in seemingly unrelated qtsql error about not having a
+    // sqlite driver if this path doesn't exist. Normally config->Save()
+    // above would make it but if it doesn't get run for whatever reason
+    // we get hosed -- bkgood
+    if (!QDir(m_cmdLineArgs.getSettingsPath()).exists()) {
+        QDir().mkpath(m_cmdLineArgs.getSettingsPath());
+    }
+
+    // Intialize default BPM system values
+    if (m_pConfig->getValueString(ConfigKey("[BPM]", "BPMRangeStart"))
+            .length() < 1) {
+        m_pConfig->set(ConfigKey("[BPM]", "BPMRangeStart"),ConfigValue(65));
+    }
+
+    if (m_pConfig->getValueString(ConfigKey("[BPM]", "BPMRangeEnd"))
+            .length() < 1) {
+        m_pConfig->set(ConfigKey("[BPM]", "BPMRangeEnd"),ConfigValue(135));
+    }
+
+    if (m_pConfig->getValueString(ConfigKey("[BPM]", "AnalyzeEntireSong"))
+            .length() < 1) {
+        m_pConfig->set(ConfigKey("[BPM]", "AnalyzeEntireSong"),ConfigValue(1));
+    }
+
+    // Register TrackPointer as a metatype since we use it in signals/slots
+    // regularly.
+    qRegisterMetaType<TrackPointer>("TrackPointer");
+
+    // The worker phases must not touch the config while the main thread
+    // changes it, so they get the paths they need from here.
+    m_settingsPath = m_pConfig->getSettingsPath();
+    m_pSkinLoader = new SkinLoader(m_pConfig);
+    m_skinPath = m_pSkinLoader->getSkinPath();
+}
+
+void MixxxMainWindow::initializeAudioDevices() {
+    SoundManager::acquirePortAudio();
+}
+
+void MixxxMainWindow::initializeLibraryDatabase() {
+    TrackCollection::upgradeDatabase(m_settingsPath);
+}
+
+void MixxxMainWindow::initializeSkinDocument() {
+    if (!m_skinPath.isEmpty()) {
+        LegacySkinParser::preloadSkin(m_skinPath);
+    }
+}
+
+void MixxxMainWindow::initializeControllers() {
+    // Initialize controller sub-system,
+    //  but do not set up controllers until the end of the application startup
+    qDebug() << "Creating ControllerManager";
+    m_pControllerManager = new ControllerManager(m_pConfig);
+}
+
+void MixxxMainWindow::initializeControllerDevices() {
+    m_pControllerManager->enumerateDevices();
+}
+
+void MixxxMainWindow::initializeEngine() {
     // Create the Effects subsystem.
     m_pEffectsManager = new EffectsManager(this, m_pConfig);
 
     // Starting the master (mixing of the channels and effects):
     m_pEngine = new EngineMaster(m_pConfig, "[Master]", m_pEffectsManager, true, true);
 
+    m_pRecordingManager = new RecordingManager(m_pConfig, m_pEngine);
+#ifdef __SHOUTCAST__
+    m_pShoutcastManager = new ShoutcastManager(m_pConfig, m_pEngine);
+#endif
+}
+
+void MixxxMainWindow::initializeEffects() {
     // Create effect backends. We do this after creating EngineMaster to allow
     // effect backends to refer to controls that are produced by the engine.
     NativeBackend* pNativeBackend = new NativeBackend(m_pEffectsManager);
     m_pEffectsManager->addEffectsBackend(pNativeBackend);
+#ifdef __LILV__
+    LV2Backend* pLV2Backend = new LV2Backend(m_pEffectsManager, m_pConfig);
+    m_pEffectsManager->addEffectsBackend(pLV2Backend);
+#endif
 
     // Sets up the default EffectChains and EffectRacks
     m_pEffectsManager->setupDefaults();
+}
 
-    m_pRecordingManager = new RecordingManager(m_pConfig, m_pEngine);
-#ifdef __SHOUTCAST__
-    m_pShoutcastManager = new ShoutcastManager(m_pConfig, m_pEngine);
-#endif
-
+void MixxxMainWindow::initializeSound() {
     // Initialize player device
     // while this is created here, setupDevices needs to be called sometime
     // after the players are added to the engine (as is done currently) -- bkgood
     m_pSoundManager = new SoundManager(m_pConfig, m_pEngine);
+    // The SoundManager holds on to PortAudio by itself now.
+    SoundManager::releasePortAudio();
 
     // TODO(rryan): Fold microphone and aux creation into a manager
     // (e.g. PlayerManager, though they aren't players).
@@ -217,27 +396,11 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
         auxiliary_passthrough->connectValueChanged(m_AuxiliaryMapper,
                                                    SLOT(map()));
     }
+}
 
-    // Do not write meta data back to ID3 when meta data has changed
-    // Because multiple TrackDao objects can exists for a particular track
-    // writing meta data may ruin your MP3 file if done simultaneously.
-    // see Bug #728197
-    // For safety reasons, we deactivate this feature.
-    m_pConfig->set(ConfigKey("[Library]","WriteAudioTags"), ConfigValue(0));
-
-    // library dies in seemingly unrelated qtsql error about not having a
-    // sqlite driver if this path doesn't exist. Normally config->Save()
-    // above would make it but if it doesn't get run for whatever reason
-    // we get hosed -- bkgood
-    if (!QDir(args.getSettingsPath()).exists()) {
-        QDir().mkpath(args.getSettingsPath());
-    }
-
-    // Register TrackPointer as a metatype since we use it in signals/slots
-    // regularly.
-    qRegisterMetaType<TrackPointer>("TrackPointer");
-
+void MixxxMainWindow::initializePlayers() {
     m_pGuiTick = new GuiTick();
+    RepaintScheduler::create();
 
 #ifdef __VINYLCONTROL__
     m_pVCManager = new VinylControlManager(this, m_pConfig, m_pSoundManager);
@@ -245,6 +408,13 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
     m_pVCManager = NULL;
 #endif
 
+    // Decodes the tracks that are likely to be loaded next ahead of time for
+    // the CachingReaders of all players.
+    TrackPrestager::create(m_pConfig);
+    // Lets the CachingReaders of all players share the chunks of a track that
+    // is loaded more than once.
+    SharedChunkCache::create(m_pConfig);
+
     // Create the player manager.
     m_pPlayerManager = new PlayerManager(m_pConfig, m_pSoundManager,
                                          m_pEffectsManager, m_pEngine);
@@ -271,7 +441,9 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
     pModplugPrefs->applySettings();
     delete pModplugPrefs; // not needed anymore
 #endif
+}
 
+void MixxxMainWindow::initializeLibrary() {
     CoverArtCache::create();
 
     m_pLibrary = new Library(this, m_pConfig,
@@ -280,8 +452,6 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
     m_pPlayerManager->bindToLibrary(m_pLibrary);
 
     // Get Music dir
-    bool hasChanged_MusicDir = false;
-
     QStringList dirs = m_pLibrary->getDirs();
     if (dirs.size() < 1) {
         // TODO(XXX) this needs to be smarter, we can't distinguish between an empty
@@ -297,38 +467,16 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
         if (!fd.isEmpty()) {
             // adds Folder to database.
             m_pLibrary->slotRequestAddDir(fd);
-            hasChanged_MusicDir = true;
+            m_bRescanLibrary = true;
         }
     }
+}
 
-    // Call inits to invoke all other construction parts
-
-    // Intialize default BPM system values
-    if (m_pConfig->getValueString(ConfigKey("[BPM]", "BPMRangeStart"))
-            .length() < 1) {
-        m_pConfig->set(ConfigKey("[BPM]", "BPMRangeStart"),ConfigValue(65));
-    }
-
-    if (m_pConfig->getValueString(ConfigKey("[BPM]", "BPMRangeEnd"))
-            .length() < 1) {
-        m_pConfig->set(ConfigKey("[BPM]", "BPMRangeEnd"),ConfigValue(135));
-    }
-
-    if (m_pConfig->getValueString(ConfigKey("[BPM]", "AnalyzeEntireSong"))
-            .length() < 1) {
-        m_pConfig->set(ConfigKey("[BPM]", "AnalyzeEntireSong"),ConfigValue(1));
-    }
-
-    // Initialize controller sub-system,
-    //  but do not set up controllers until the end of the application startup
-    qDebug() << "Creating ControllerManager";
-    m_pControllerManager = new ControllerManager(m_pConfig);
-
+void MixxxMainWindow::initializeSkin() {
     WaveformWidgetFactory::create();
     WaveformWidgetFactory::instance()->startVSync(this);
     WaveformWidgetFactory::instance()->setConfig(m_pConfig);
 
-    m_pSkinLoader = new SkinLoader(m_pConfig);
     connect(this, SIGNAL(newSkinLoaded()),
             this, SLOT(onNewSkinLoaded()));
     connect(this, SIGNAL(newSkinLoaded()),
@@ -379,23 +527,27 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
 
     //Install an event filter to catch certain QT events, such as tooltips.
     //This allows us to turn off tooltips.
-    pApp->installEventFilter(this); // The eventfilter is located in this
-                                    // Mixxx class as a callback.
+    m_pApp->installEventFilter(this); // The eventfilter is located in this
+                                      // Mixxx class as a callback.
 
     // If we were told to start in fullscreen mode on the command-line or if
     // user chose always starts in fullscreen mode, then turn on fullscreen
     // mode.
     bool fullscreenPref = m_pConfig->getValueString(
         ConfigKey("[Config]", "StartInFullscreen"), "0").toInt();
-    if (args.getStartInFullscreen() || fullscreenPref) {
+    if (m_cmdLineArgs.getStartInFullscreen() || fullscreenPref) {
         slotViewFullScreen(true);
     }
     emit(newSkinLoaded());
+}
 
+void MixxxMainWindow::initializeControllerSetup() {
     // Wait until all other ControlObjects are set up before initializing
     // controllers
     m_pControllerManager->setUpDevices();
+}
 
+void MixxxMainWindow::initializeLibraryScanner() {
     // Scan the library for new files and directories
     bool rescan = m_pConfig->getValueString(
         ConfigKey("[Library]","RescanOnStartup")).toInt();
@@ -420,9 +572,12 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
     connect(m_pLibraryScanner, SIGNAL(scanFinished()),
             m_pLibrary, SLOT(slotRefreshLibraryModels()));
 
-    if (rescan || hasChanged_MusicDir || upgrader.rescanLibrary()) {
+    if (rescan || m_bRescanLibrary) {
         m_pLibraryScanner->scan();
     }
+}
+
+void MixxxMainWindow::initializeSoundDevices() {
     slotNumDecksChanged(m_pNumDecks->get());
 
     // Try open player device If that fails, the preference panel is opened.
@@ -448,10 +603,18 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
         setupDevices = m_pSoundManager->setupDevices();
         numDevices = m_pSoundManager->getConfig().getOutputs().count();
     }
+}
+
+void MixxxMainWindow::initializeCommandLine() {
+    // Start recording before the command line tracks are loaded so that the
+    // session includes them.
+    if (m_cmdLineArgs.getRecordSessionEnabled()) {
+        ControlRecorder::start(m_cmdLineArgs.getRecordSessionPath());
+    }
 
     // Load tracks in args.qlMusicFiles (command line arguments) into player
     // 1 and 2:
-    const QList<QString>& musicFiles = args.getMusicFiles();
+    const QList<QString>& musicFiles = m_cmdLineArgs.getMusicFiles();
     for (int i = 0; i < (int)m_pPlayerManager->numDecks()
             && i < musicFiles.count(); ++i) {
         if (SoundSourceProxy::isFilenameSupported(musicFiles.at(i))) {
@@ -465,6 +628,8 @@ MixxxMainWindow::~MixxxMainWindow() {
     QTime qTime;
     qTime.start();
     Timer t("MixxxMainWindow::~MixxxMainWindow");
+    // Changes made while shutting down are not part of the session.
+    ControlRecorder::stop();
     t.start();
 
     qDebug() << "Destroying MixxxMainWindow";
@@ -518,6 +683,11 @@ MixxxMainWindow::~MixxxMainWindow() {
     qDebug() << "delete playerManager " << qTime.elapsed();
     delete m_pPlayerManager;
 
+    // The CachingReaderWorkers of the players may use the TrackPrestager and
+    // the SharedChunkCache.
+    TrackPrestager::destroy();
+    SharedChunkCache::destroy();
+
     // RecordingManager depends on config, engine
     qDebug() << "delete RecordingManager " << qTime.elapsed();
     delete m_pRecordingManager;
@@ -550,6 +720,7 @@ MixxxMainWindow::~MixxxMainWindow() {
     PlayerInfo::destroy();
     WaveformWidgetFactory::destroy();
 
+    RepaintScheduler::destroy();
     delete m_pGuiTick;
 
     // Check for leaked ControlObjects and give warnings.
@@ -156,6 +156,24 @@ class MixxxMainWindow : public QMainWindow {
     virtual bool event(QEvent* e);
 
   private:
+    // The phases of startup, see the constructor for their dependencies.
+    void initializeSettings();
+    void initializeAudioDevices();
+    void initializeLibraryDatabase();
+    void initializeSkinDocument();
+    void initializeControllers();
+    void initializeControllerDevices();
+    void initializeEngine();
+    void initializeEffects();
+    void initializeSound();
+    void initializePlayers();
+    void initializeLibrary();
+    void initializeSkin();
+    void initializeControllerSetup();
+    void initializeLibraryScanner();
+    void initializeSoundDevices();
+    void initializeCommandLine();
+
     void logBuildDetails();
     void initializeWindow();
     void initializeKeyboard();
@@ -288,6 +306,13 @@ class MixxxMainWindow : public QMainWindow {
     QSignalMapper* m_AuxiliaryMapper;
     QSignalMapper* m_TalkoverMapper;
 
+    QApplication* m_pApp;
+    // Read by the worker phases of startup.
+    QString m_settingsPath;
+    QString m_skinPath;
+    // Set when an upgrade or a new music directory calls for a rescan.
+    bool m_bRescanLibrary;
+
     static const int kMicrophoneCount;
     static const int kAuxiliaryCount;
 };
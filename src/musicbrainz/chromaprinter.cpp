@@ -4,12 +4,43 @@
 
 #include "musicbrainz/chromaprinter.h"
 #include "soundsourceproxy.h"
+#include "util/math.h"
+#include "util/timer.h"
+
+namespace {
+
+// AcoustID only stores a fingerprint for the first two minutes of a song on
+// their server so we need only a fingerprint of the first two minutes.
+// --kain88 July 2012
+const int kFingerprintSeconds = 120;
+
+// The audio is decoded and fed to chromaprint in blocks of this many samples
+// so that the memory used does not depend on the length of the track.
+const int kFingerprintBlockSize = 8192;
+
+inline ChromaprintContext* context(void* pContext) {
+    return static_cast<ChromaprintContext*>(pContext);
+}
+
+}  // anonymous namespace
 
 ChromaPrinter::ChromaPrinter(QObject* parent)
-             : QObject(parent) {
+             : QObject(parent),
+               m_pContext(NULL),
+               m_samplesNeeded(0),
+               m_bFailed(false) {
+}
+
+ChromaPrinter::~ChromaPrinter() {
+    reset();
 }
 
 QString ChromaPrinter::getFingerPrint(TrackPointer pTrack) {
+    QString fingerprint = pTrack->getFingerprint();
+    if (!fingerprint.isEmpty()) {
+        return fingerprint;
+    }
+
     SoundSourceProxy soundSourceProxy(pTrack);
     Mixxx::SoundSourcePointer pSoundSource(soundSourceProxy.open());
     if (pSoundSource.isNull()) {
@@ -20,46 +51,78 @@ QString ChromaPrinter::getFingerPrint(TrackPointer pTrack) {
         qDebug() << "Skipping empty file:" << pTrack->getLocation();
         return QString();
     }
-    return calcFingerPrint(pSoundSource);
+    fingerprint = calcFingerPrint(pSoundSource);
+    if (!fingerprint.isEmpty()) {
+        pTrack->setFingerprint(fingerprint);
+    }
+    return fingerprint;
 }
 
 QString ChromaPrinter::calcFingerPrint(const Mixxx::SoundSourcePointer& pSoundSource) {
-
-    // this is worth 2min of audio, multiply by 2 because we have 2 channels
-    // AcoustID only stores a fingerprint for the first two minutes of a song
-    // on their server so we need only a fingerprint of the first two minutes
-    // --kain88 July 2012
-    unsigned long maxFingerprintSamples = 120 * 2 * pSoundSource->getSampleRate();
-    unsigned long numFingerprintSamples = math_min(pSoundSource->length(), maxFingerprintSamples);
-
-    SAMPLE *pData = new SAMPLE[numFingerprintSamples];
-    QTime timerReadingFile;
-    timerReadingFile.start();
-    unsigned int read = pSoundSource->read(numFingerprintSamples, pData);
-
-    if (read!=numFingerprintSamples) {
-        qDebug() << "oh that's embarrasing I couldn't read the track";
+    ScopedTimer t("ChromaPrinter::calcFingerPrint");
+    if (!start(pSoundSource->getSampleRate())) {
         return QString();
     }
-    qDebug("reading file took: %d ms" , timerReadingFile.elapsed());
 
-    ChromaprintContext* ctx = chromaprint_new(CHROMAPRINT_ALGORITHM_DEFAULT);
+    SAMPLE data[kFingerprintBlockSize];
+    bool needMore = true;
+    while (needMore) {
+        unsigned int read = pSoundSource->read(kFingerprintBlockSize, data);
+        if (read == 0) {
+            break;
+        }
+        needMore = feed(data, read);
+    }
+    return finish();
+}
+
+bool ChromaPrinter::start(int sampleRate) {
+    reset();
+    if (sampleRate <= 0) {
+        return false;
+    }
+    m_pContext = chromaprint_new(CHROMAPRINT_ALGORITHM_DEFAULT);
     // we have 2 channels in mixxx always
-    chromaprint_start(ctx, pSoundSource->getSampleRate(), 2);
+    if (!chromaprint_start(context(m_pContext), sampleRate, 2)) {
+        qDebug() << "could not start fingerprint";
+        reset();
+        return false;
+    }
+    // multiply by 2 because we have 2 channels
+    m_samplesNeeded = static_cast<unsigned long>(kFingerprintSeconds) * 2 * sampleRate;
+    return true;
+}
 
-    QTime timerGeneratingFingerPrint;
-    timerGeneratingFingerPrint.start();
-    int success = chromaprint_feed(ctx, pData, numFingerprintSamples);
-    if (!success) {
+bool ChromaPrinter::feed(const SAMPLE* pData, int numSamples) {
+    if (m_pContext == NULL || m_bFailed || m_samplesNeeded == 0) {
+        return false;
+    }
+    int samples = static_cast<int>(
+            math_min(static_cast<unsigned long>(numSamples), m_samplesNeeded));
+    // Feed whole frames only.
+    samples -= samples % 2;
+    if (samples > 0 && !chromaprint_feed(context(m_pContext),
+                                         const_cast<SAMPLE*>(pData),
+                                         samples)) {
         qDebug() << "could not generate fingerprint";
-        delete [] pData;
+        m_bFailed = true;
+        return false;
+    }
+    m_samplesNeeded -= samples;
+    return m_samplesNeeded > 0;
+}
+
+QString ChromaPrinter::finish() {
+    if (m_pContext == NULL || m_bFailed) {
+        reset();
         return QString();
     }
-    chromaprint_finish(ctx);
+    chromaprint_finish(context(m_pContext));
 
     void* fprint = NULL;
     int size = 0;
-    int ret = chromaprint_get_raw_fingerprint(ctx, &fprint, &size);
+    int ret = chromaprint_get_raw_fingerprint(context(m_pContext), &fprint,
+                                              &size);
     QByteArray fingerprint;
     if (ret == 1) {
         void* encoded = NULL;
@@ -74,10 +137,15 @@ QString ChromaPrinter::calcFingerPrint(const Mixxx::SoundSourcePointer& pSoundSo
         chromaprint_dealloc(fprint);
         chromaprint_dealloc(encoded);
     }
-    chromaprint_free(ctx);
-    delete [] pData;
-
-    qDebug("generating fingerprint took: %d ms" , timerGeneratingFingerPrint.elapsed());
-
+    reset();
     return fingerprint;
 }
+
+void ChromaPrinter::reset() {
+    if (m_pContext != NULL) {
+        chromaprint_free(context(m_pContext));
+        m_pContext = NULL;
+    }
+    m_samplesNeeded = 0;
+    m_bFailed = false;
+}
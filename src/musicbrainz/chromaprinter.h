@@ -6,16 +6,42 @@
 #include "soundsource.h"
 #include "trackinfoobject.h"
 
+// Calculates the AcoustID fingerprint of the first two minutes of a track.
+// The audio is fed to chromaprint in small blocks, either by
+// getFingerPrint(), which decodes the track itself, or by a caller that
+// decodes it anyway through start(), feed() and finish().
 class ChromaPrinter: public QObject {
   Q_OBJECT
 
   public:
     ChromaPrinter(QObject* parent=NULL);
+    virtual ~ChromaPrinter();
+
+    // Returns the fingerprint of pTrack. A fingerprint that is cached on the
+    // track is returned without decoding it. A calculated fingerprint is
+    // stored on the track.
     QString getFingerPrint(TrackPointer pTrack);
 
-  private:
+    // Starts fingerprinting interleaved stereo audio at sampleRate.
+    bool start(int sampleRate);
+    // Feeds the next numSamples samples. Returns false once enough audio has
+    // been fed or on error; further samples are ignored.
+    bool feed(const SAMPLE* pData, int numSamples);
+    // Returns the fingerprint of the audio fed since start() or an empty
+    // string if it could not be calculated.
+    QString finish();
+    // Discards the audio fed since start().
+    void reset();
 
+  private:
     QString calcFingerPrint(const Mixxx::SoundSourcePointer& pSoundSource);
+
+    // The ChromaprintContext. It is opaque here so that only
+    // chromaprinter.cpp includes chromaprint.h.
+    void* m_pContext;
+    // The number of samples that are still needed for the fingerprint.
+    unsigned long m_samplesNeeded;
+    bool m_bFailed;
 };
 
 #endif //CHROMAPRINTER_H
@@ -19,6 +19,7 @@
 #include "effects/effectsmanager.h"
 #include "util/stat.h"
 #include "engine/enginedeck.h"
+#include "trackprestager.h"
 #include "util/assert.h"
 
 PlayerManager::PlayerManager(ConfigObject<ConfigValue>* pConfig,
@@ -92,6 +93,15 @@ void PlayerManager::bindToLibrary(Library* pLibrary) {
     connect(this, SIGNAL(loadLocationToPlayer(QString, QString)),
             pLibrary, SLOT(slotLoadLocationToPlayer(QString, QString)));
 
+    // Stage tracks the user is likely to load next.
+    TrackPrestager* pPrestager = TrackPrestager::instance();
+    if (pPrestager) {
+        connect(pLibrary, SIGNAL(trackSelected(TrackPointer)),
+                pPrestager, SLOT(slotPrestageTrack(TrackPointer)));
+        connect(pLibrary, SIGNAL(prestageTrack(TrackPointer)),
+                pPrestager, SLOT(slotPrestageTrack(TrackPointer)));
+    }
+
     m_pAnalyserQueue = AnalyserQueue::createDefaultAnalyserQueue(m_pConfig,
             pLibrary->getTrackCollection());
 
@@ -0,0 +1,167 @@
+#include <QtDebug>
+#include <QMutexLocker>
+
+#include "sharedchunkcache.h"
+#include "cachingreaderworker.h"
+#include "sampleutil.h"
+#include "util/assert.h"
+#include "util/math.h"
+
+namespace {
+
+const int kDefaultMemoryLimitMB = 128;
+
+SharedChunkCache* s_pSharedChunkCache = NULL;
+
+}  // anonymous namespace
+
+// static
+SharedChunkCache* SharedChunkCache::create(ConfigObject<ConfigValue>* pConfig) {
+    if (!s_pSharedChunkCache) {
+        int memoryLimitMB = pConfig->getValueString(
+                ConfigKey("[ChunkCache]", "MemoryLimitMB"),
+                QString::number(kDefaultMemoryLimitMB)).toInt();
+        s_pSharedChunkCache = new SharedChunkCache(
+                math_max(0, memoryLimitMB) * 1024 * 1024 /
+                CachingReaderWorker::kChunkLength);
+    }
+    return s_pSharedChunkCache;
+}
+
+// static
+SharedChunkCache* SharedChunkCache::instance() {
+    return s_pSharedChunkCache;
+}
+
+// static
+void SharedChunkCache::destroy() {
+    SharedChunkCache* pCache = s_pSharedChunkCache;
+    s_pSharedChunkCache = NULL;
+    delete pCache;
+}
+
+SharedChunkCache::SharedChunkCache(int maxChunks)
+        : m_iMaxChunks(maxChunks),
+          m_iPrivateChunks(0) {
+}
+
+SharedChunkCache::~SharedChunkCache() {
+    // All CachingReaders must have released their chunks by now.
+    DEBUG_ASSERT(referencedChunkCount() == 0);
+    foreach (SharedChunk* pChunk, m_chunks) {
+        deleteChunk(pChunk);
+    }
+}
+
+void SharedChunkCache::deleteChunk(SharedChunk* pChunk) {
+    SampleUtil::free(pChunk->data);
+    delete pChunk;
+}
+
+SharedChunk* SharedChunkCache::acquire(int trackId, int chunkNumber) {
+    if (trackId < 0) {
+        return NULL;
+    }
+    QMutexLocker locker(&m_mutex);
+    SharedChunk* pChunk = m_chunks.value(ChunkKey(trackId, chunkNumber), NULL);
+    if (pChunk == NULL || !pChunk->ready) {
+        return NULL;
+    }
+    if (pChunk->references++ == 0) {
+        m_unreferenced.removeOne(pChunk);
+    }
+    return pChunk;
+}
+
+SharedChunk* SharedChunkCache::allocate(int trackId, int chunkNumber) {
+    // Tracks that are not in the library have no id to share them by.
+    if (trackId < 0 || m_iMaxChunks <= 0) {
+        return NULL;
+    }
+    const ChunkKey key(trackId, chunkNumber);
+    QMutexLocker locker(&m_mutex);
+    if (m_chunks.contains(key)) {
+        return NULL;
+    }
+    if (!makeRoomLocked(1)) {
+        return NULL;
+    }
+
+    SharedChunk* pChunk = new SharedChunk;
+    pChunk->track_id = trackId;
+    pChunk->chunk_number = chunkNumber;
+    pChunk->length = 0;
+    pChunk->data = SampleUtil::alloc(CachingReaderWorker::kSamplesPerChunk);
+    pChunk->references = 1;
+    pChunk->ready = false;
+    m_chunks.insert(key, pChunk);
+    return pChunk;
+}
+
+void SharedChunkCache::publish(SharedChunk* pChunk, int length) {
+    QMutexLocker locker(&m_mutex);
+    if (length <= 0) {
+        m_chunks.remove(ChunkKey(pChunk->track_id, pChunk->chunk_number));
+        deleteChunk(pChunk);
+        return;
+    }
+    pChunk->length = length;
+    pChunk->ready = true;
+}
+
+void SharedChunkCache::release(SharedChunk* pChunk) {
+    QMutexLocker locker(&m_mutex);
+    DEBUG_ASSERT_AND_HANDLE(pChunk->references > 0) {
+        return;
+    }
+    if (--pChunk->references == 0) {
+        m_unreferenced.append(pChunk);
+        makeRoomLocked(0);
+    }
+}
+
+void SharedChunkCache::addPrivateChunk() {
+    QMutexLocker locker(&m_mutex);
+    ++m_iPrivateChunks;
+    makeRoomLocked(0);
+}
+
+void SharedChunkCache::removePrivateChunks(int numChunks) {
+    QMutexLocker locker(&m_mutex);
+    DEBUG_ASSERT(numChunks <= m_iPrivateChunks);
+    m_iPrivateChunks = math_max(0, m_iPrivateChunks - numChunks);
+}
+
+bool SharedChunkCache::makeRoomLocked(int numNewChunks) {
+    while (m_chunks.size() + m_iPrivateChunks + numNewChunks > m_iMaxChunks) {
+        if (!evictOldestLocked()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SharedChunkCache::evictOldestLocked() {
+    if (m_unreferenced.isEmpty()) {
+        return false;
+    }
+    SharedChunk* pChunk = m_unreferenced.takeFirst();
+    m_chunks.remove(ChunkKey(pChunk->track_id, pChunk->chunk_number));
+    deleteChunk(pChunk);
+    return true;
+}
+
+int SharedChunkCache::chunkCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_chunks.size();
+}
+
+int SharedChunkCache::referencedChunkCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_chunks.size() - m_unreferenced.size();
+}
+
+int SharedChunkCache::privateChunkCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_iPrivateChunks;
+}
@@ -0,0 +1,103 @@
+#ifndef SHAREDCHUNKCACHE_H
+#define SHAREDCHUNKCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+
+#include "configobject.h"
+#include "util.h"
+#include "util/types.h"
+
+// A decoded chunk of a track, shared by all CachingReaders that play the
+// track. The numbering and size match CachingReaderWorker.
+struct SharedChunk {
+    int track_id;
+    int chunk_number;
+    int length;
+    CSAMPLE* data;
+    // The number of CachingReader chunks that point at data. A chunk with
+    // references is never evicted.
+    int references;
+    // False while the chunk is being decoded.
+    bool ready;
+};
+
+// SharedChunkCache is a process-wide cache of decoded chunks keyed by track id
+// and chunk number. When the same track is loaded into several decks, e.g. for
+// a doubles routine, or into a deck and the preview deck, the
+// CachingReaderWorkers look here before decoding a chunk and point their
+// CachingReader's chunk at the shared data instead. Every chunk is decoded and
+// held in memory only once.
+//
+// The chunks a CachingReader holds (the region around its playhead, its cues
+// and loops) are referenced and so pinned in memory. Chunks no reader holds are
+// kept in least-recently-released order until the memory limit is reached.
+// While a cache exists, CachingReaders allocate memory of their own only for
+// chunks the cache cannot take, and that memory counts against the limit too.
+// Only CachingReader and CachingReaderWorker threads use the cache, never the
+// engine.
+class SharedChunkCache {
+  public:
+    static SharedChunkCache* create(ConfigObject<ConfigValue>* pConfig);
+    // Returns NULL if no SharedChunkCache has been created.
+    static SharedChunkCache* instance();
+    static void destroy();
+
+    explicit SharedChunkCache(int maxChunks);
+    virtual ~SharedChunkCache();
+
+    // Returns the decoded chunk with a new reference, or NULL if it is not
+    // cached.
+    SharedChunk* acquire(int trackId, int chunkNumber);
+
+    // Returns a referenced chunk to decode trackId's chunk into, or NULL if it
+    // is already cached or being decoded, or if the memory limit is taken up
+    // by referenced chunks. Pass it to publish() once it has been decoded.
+    SharedChunk* allocate(int trackId, int chunkNumber);
+
+    // Makes a chunk returned by allocate() available to acquire(). A length
+    // of 0 means decoding failed; the chunk is discarded and released.
+    void publish(SharedChunk* pChunk, int length);
+
+    // Drops a reference returned by acquire() or allocate().
+    void release(SharedChunk* pChunk);
+
+    // Accounts for a chunk a CachingReader allocated in its own memory because
+    // allocate() failed. Unreferenced chunks are evicted to make room for it.
+    // Never fails, since the reader has nowhere else to decode to.
+    void addPrivateChunk();
+    // Called by a CachingReader that frees numChunks chunks added with
+    // addPrivateChunk().
+    void removePrivateChunks(int numChunks);
+
+    int chunkCount() const;
+    int referencedChunkCount() const;
+    int privateChunkCount() const;
+
+  private:
+    typedef QPair<int, int> ChunkKey;
+
+    // Frees the least recently released chunk. Must hold m_mutex. Returns
+    // false if every chunk is referenced.
+    bool evictOldestLocked();
+    // Evicts until the cached and private chunks fit into the limit, leaving
+    // room for numNewChunks more. Must hold m_mutex. Returns false if every
+    // chunk is referenced before that.
+    bool makeRoomLocked(int numNewChunks);
+    void deleteChunk(SharedChunk* pChunk);
+
+    const int m_iMaxChunks;
+
+    mutable QMutex m_mutex;
+    QHash<ChunkKey, SharedChunk*> m_chunks;
+    // Chunks without references, least recently released first.
+    QList<SharedChunk*> m_unreferenced;
+    // The number of chunks CachingReaders hold in their own memory.
+    int m_iPrivateChunks;
+
+    DISALLOW_COPY_AND_ASSIGN(SharedChunkCache);
+};
+
+#endif /* SHAREDCHUNKCACHE_H */
@@ -4,6 +4,7 @@
 #include "skin/legacyskinparser.h"
 
 #include <QDir>
+#include <QDirIterator>
 #include <QGridLayout>
 #include <QLabel>
 #include <QMutexLocker>
@@ -80,6 +81,8 @@ using mixxx::skin::SkinManifest;
 
 QList<const char*> LegacySkinParser::s_channelStrs;
 QMutex LegacySkinParser::s_safeStringMutex;
+QHash<QString, QDomElement> LegacySkinParser::s_preloadedDocuments;
+QMutex LegacySkinParser::s_preloadedDocumentsMutex;
 
 static bool sDebug = false;
 
@@ -171,6 +174,12 @@ QDomElement LegacySkinParser::openSkin(QString skinPath) {
     }
 
     QString skinXmlPath = skinDir.filePath("skin.xml");
+    QDomElement preloaded = preloadedDocument(
+            QFileInfo(skinXmlPath).absoluteFilePath());
+    if (!preloaded.isNull()) {
+        return preloaded;
+    }
+
     QFile skinXmlFile(skinXmlPath);
 
     if (!skinXmlFile.open(QIODevice::ReadOnly)) {
@@ -196,6 +205,41 @@ QDomElement LegacySkinParser::openSkin(QString skinPath) {
     return skin.documentElement();
 }
 
+// static
+void LegacySkinParser::preloadSkin(const QString& skinPath) {
+    QHash<QString, QDomElement> documents;
+    QDirIterator it(skinPath, QStringList("*.xml"), QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString absolutePath = QFileInfo(it.next()).absoluteFilePath();
+        QFile file(absolutePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        // Files that fail to parse are left to openSkin() and loadTemplate()
+        // to report.
+        QDomDocument document;
+        if (document.setContent(&file)) {
+            documents.insert(absolutePath, document.documentElement());
+        }
+    }
+
+    QMutexLocker locker(&s_preloadedDocumentsMutex);
+    s_preloadedDocuments = documents;
+}
+
+// static
+QDomElement LegacySkinParser::preloadedDocument(const QString& absolutePath) {
+    QMutexLocker locker(&s_preloadedDocumentsMutex);
+    return s_preloadedDocuments.value(absolutePath);
+}
+
+// static
+void LegacySkinParser::clearPreloadedDocuments() {
+    QMutexLocker locker(&s_preloadedDocumentsMutex);
+    s_preloadedDocuments.clear();
+}
+
 // static
 QList<QString> LegacySkinParser::getSchemeList(QString qSkinPath) {
 
@@ -299,6 +343,7 @@ QWidget* LegacySkinParser::parseSkin(QString skinPath, QWidget* pParent) {
 
     if (skinDocument.isNull()) {
         qDebug() << "LegacySkinParser::parseSkin - failed for skin:" << skinPath;
+        clearPreloadedDocuments();
         return NULL;
     }
 
@@ -335,6 +380,8 @@ QWidget* LegacySkinParser::parseSkin(QString skinPath, QWidget* pParent) {
     m_pContext = new SkinContext(m_pConfig, skinPath + "/skin.xml");
     m_pContext->setSkinBasePath(skinPath.append("/"));
     QList<QWidget*> widgets = parseNode(skinDocument);
+    // Reloading the skin reads the files again.
+    clearPreloadedDocuments();
 
     if (widgets.empty()) {
         SKIN_WARNING(skinDocument, *m_pContext) << "Skin produced no widgets!";
@@ -1355,6 +1402,12 @@ QDomElement LegacySkinParser::loadTemplate(const QString& path) {
         return it.value();
     }
 
+    QDomElement preloaded = preloadedDocument(absolutePath);
+    if (!preloaded.isNull()) {
+        m_templateCache[absolutePath] = preloaded;
+        return preloaded;
+    }
+
     QFile templateFile(absolutePath);
 
     if (!templateFile.open(QIODevice::ReadOnly)) {
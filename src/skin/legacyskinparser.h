@@ -5,6 +5,7 @@
 #include <QString>
 #include <QList>
 #include <QDomElement>
+#include <QHash>
 #include <QMutex>
 
 #include "configobject.h"
@@ -42,12 +43,23 @@ class LegacySkinParser : public QObject, public SkinParser {
     static mixxx::skin::SkinManifest getSkinManifest(QDomElement skinDocument);
     static void freeChannelStrings();
 
+    // Reads skin.xml and the templates of the skin at skinPath ahead of time,
+    // so that startup can parse the files on a worker thread while it creates
+    // the players. The next parseSkin() uses these documents and drops them
+    // when it is done. Thread-safe.
+    static void preloadSkin(const QString& skinPath);
+
     static Qt::MouseButton parseButtonState(QDomNode node,
                                             const SkinContext& context);
 
   private:
     static QDomElement openSkin(QString skinPath);
 
+    // Returns the document element preloadSkin() read from the file at
+    // absolutePath, or a null element.
+    static QDomElement preloadedDocument(const QString& absolutePath);
+    static void clearPreloadedDocuments();
+
     QList<QWidget*> parseNode(QDomElement node);
 
     // Support for various legacy behavior
@@ -136,6 +148,8 @@ class LegacySkinParser : public QObject, public SkinParser {
     QHash<QString, QDomElement> m_templateCache;
     static QList<const char*> s_channelStrs;
     static QMutex s_safeStringMutex;
+    static QHash<QString, QDomElement> s_preloadedDocuments;
+    static QMutex s_preloadedDocumentsMutex;
 };
 
 
@@ -38,6 +38,7 @@
 #include "controlobjectslave.h"
 #include "util/performancetimer.h"
 #include "util/denormalsarezero.h"
+#include "util/threadplacement.h"
 
 static const int kDriftReserve = 1; // Buffer for drift correction 1 full, 1 for r/w, 1 empty
 static const int kFifoSize = 2 * kDriftReserve + 1; // Buffer for drift correction 1 full, 1 for r/w, 1 empty
@@ -750,6 +751,9 @@ int SoundDevicePortAudio::callbackProcessClkRef(const unsigned int framesPerBuff
     // in Linux userland, for example, this will have no effect.
     if (!m_bSetThreadPriority) {
         QThread::currentThread()->setPriority(QThread::TimeCriticalPriority);
+        ThreadPlacement::placeCurrentThread(
+                ThreadPlacement::AUDIO_CALLBACK,
+                QString("SoundDevicePortAudio %1").arg(getInternalName()));
         m_bSetThreadPriority = true;
 
         // This disables the denormals calculations, to avoid a
@@ -35,6 +35,9 @@
 
 #ifdef __PORTAUDIO__
 typedef PaError (*SetJackClientName)(const char *name);
+
+// static
+bool SoundManager::s_bPortAudioAcquired = false;
 #endif
 
 SoundManager::SoundManager(ConfigObject<ConfigValue> *pConfig,
@@ -546,7 +549,35 @@ QList<AudioInput> SoundManager::registeredInputs() const {
     return m_registeredDestinations.keys();
 }
 
-void SoundManager::setJACKName() const {
+// static
+void SoundManager::acquirePortAudio() {
+#ifdef __PORTAUDIO__
+#ifdef Q_OS_LINUX
+    setJACKName();
+#endif
+    // PortAudio counts its initializations. The SoundManager initializes it
+    // again and only terminates it for real once we released it here.
+    PaError err = Pa_Initialize();
+    if (err != paNoError) {
+        qDebug() << "Error:" << Pa_GetErrorText(err);
+        return;
+    }
+    s_bPortAudioAcquired = true;
+#endif
+}
+
+// static
+void SoundManager::releasePortAudio() {
+#ifdef __PORTAUDIO__
+    if (s_bPortAudioAcquired) {
+        Pa_Terminate();
+        s_bPortAudioAcquired = false;
+    }
+#endif
+}
+
+// static
+void SoundManager::setJACKName() {
 #ifdef __PORTAUDIO__
 #ifdef Q_OS_LINUX
     typedef PaError (*SetJackClientName)(const char *name);
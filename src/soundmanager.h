@@ -69,6 +69,16 @@ class SoundManager : public QObject {
     // Creates a list of sound devices that PortAudio sees.
     void queryDevices();
 
+    // Initializes PortAudio ahead of the SoundManager. PortAudio probes every
+    // host API and device when it is initialized, which is slow enough that
+    // startup does it on a worker thread on Linux while it creates the
+    // engine. The Windows host APIs initialize COM in the calling thread, so
+    // elsewhere it must be called from the main thread. The SoundManager then
+    // finds PortAudio initialized. Call releasePortAudio() once the
+    // SoundManager exists.
+    static void acquirePortAudio();
+    static void releasePortAudio();
+
     // Opens all the devices chosen by the user in the preferences dialog, and
     // establishes the proper connections between them and the mixing engine.
     Result setupDevices();
@@ -114,7 +124,7 @@ class SoundManager : public QObject {
     void inputRegistered(AudioInput input, AudioDestination *dest);
 
   private:
-    void setJACKName() const;
+    static void setJACKName();
 
     EngineMaster *m_pMaster;
     ConfigObject<ConfigValue> *m_pConfig;
@@ -132,6 +142,11 @@ class SoundManager : public QObject {
     QHash<AudioInput, AudioDestination*> m_registeredDestinations;
     ControlObject* m_pControlObjectSoundStatusCO;
     ControlObject* m_pControlObjectVinylControlGainCO;
+
+#ifdef __PORTAUDIO__
+    // Whether acquirePortAudio() initialized PortAudio.
+    static bool s_bPortAudioAcquired;
+#endif
 };
 
 #endif
@@ -4,12 +4,15 @@
 
 #include "trackinfoobject.h"
 #include "analyserwaveform.h"
+#include "engine/enginefilterbessel4.h"
 #include "test/mixxxtest.h"
+#include "util/performancetimer.h"
 
 #define BIGBUF_SIZE (1024 * 1024)  //Megabyte
 #define CANARY_SIZE (1024*4)
 #define MAGIC_FLOAT 1234.567890f
 #define CANARY_FLOAT 0.0f
+#define FILTER_BLOCK_SIZE 4096
 
 namespace {
 
@@ -95,4 +98,115 @@ TEST_F(AnalyserWaveformTest, wrongTotalSamples) {
         EXPECT_FLOAT_EQ(canaryBigBuf[i], CANARY_FLOAT);
     }
 }
+
+// The fused filter bank has to find the same peaks as the separate Bessel
+// filters the engine uses. The engine filters fade in over their first
+// buffer, so the peaks are compared from the second buffer on.
+TEST_F(AnalyserWaveformTest, filterBankMatchesEngineFilters) {
+    const int sampleRate = 44100;
+    EngineFilterBessel4Low low(sampleRate, 600);
+    EngineFilterBessel4Band mid(sampleRate, 600, 4000);
+    EngineFilterBessel4High high(sampleRate, 4000);
+    WaveformFilterBank filterBank(sampleRate, 600, 4000);
+
+    qsrand(1);
+    CSAMPLE* input = new CSAMPLE[2 * FILTER_BLOCK_SIZE];
+    for (int i = 0; i < 2 * FILTER_BLOCK_SIZE; i += 2) {
+        double t = static_cast<double>(i / 2) / sampleRate;
+        input[i] = 0.5 * sin(2 * M_PI * 100 * t) +
+                0.2 * (static_cast<double>(qrand()) / RAND_MAX - 0.5);
+        input[i + 1] = 0.3 * sin(2 * M_PI * 1000 * t) +
+                0.3 * sin(2 * M_PI * 8000 * t);
+    }
+    CSAMPLE* output[FilterCount];
+    for (int f = 0; f < FilterCount; ++f) {
+        output[f] = new CSAMPLE[FILTER_BLOCK_SIZE];
+    }
+
+    CSAMPLE peaks[WaveformFilterBank::kLanes];
+    for (int block = 0; block < 2; ++block) {
+        const CSAMPLE* pInput = &input[block * FILTER_BLOCK_SIZE];
+        low.process(pInput, output[Low], FILTER_BLOCK_SIZE);
+        mid.process(pInput, output[Mid], FILTER_BLOCK_SIZE);
+        high.process(pInput, output[High], FILTER_BLOCK_SIZE);
+        for (int i = 0; i < WaveformFilterBank::kLanes; ++i) {
+            peaks[i] = 0.0f;
+        }
+        filterBank.process(pInput, FILTER_BLOCK_SIZE / 2, peaks);
+    }
+
+    const CSAMPLE* pInput = &input[FILTER_BLOCK_SIZE];
+    for (int c = 0; c < ChannelCount; ++c) {
+        ChannelIndex channel = static_cast<ChannelIndex>(c);
+        CSAMPLE overall = 0.0f;
+        for (int i = c; i < FILTER_BLOCK_SIZE; i += 2) {
+            overall = math_max(overall, static_cast<CSAMPLE>(fabs(pInput[i])));
+        }
+        EXPECT_FLOAT_EQ(overall,
+                        peaks[WaveformFilterBank::overallLane(channel)]);
+        for (int f = 0; f < FilterCount; ++f) {
+            FilterIndex filter = static_cast<FilterIndex>(f);
+            CSAMPLE peak = 0.0f;
+            for (int i = c; i < FILTER_BLOCK_SIZE; i += 2) {
+                peak = math_max(peak, static_cast<CSAMPLE>(fabs(output[f][i])));
+            }
+            EXPECT_GT(peak, 0.01f);
+            EXPECT_NEAR(peak, peaks[WaveformFilterBank::lane(filter, channel)],
+                        1e-5);
+        }
+    }
+
+    for (int f = 0; f < FilterCount; ++f) {
+        delete [] output[f];
+    }
+    delete [] input;
+}
+
+// Compares the time per frame of the analyser with the separate filter passes
+// it used before. Only logs the result, slow machines don't fail.
+TEST_F(AnalyserWaveformTest, benchmark) {
+    const int sampleRate = tio->getSampleRate();
+    const int blockSize = 2 * 32768;
+    CSAMPLE* buffers[FilterCount];
+    for (int f = 0; f < FilterCount; ++f) {
+        buffers[f] = new CSAMPLE[blockSize];
+    }
+    EngineFilterBessel4Low low(sampleRate, 600);
+    EngineFilterBessel4Band mid(sampleRate, 600, 4000);
+    EngineFilterBessel4High high(sampleRate, 4000);
+
+    PerformanceTimer timer;
+    timer.start();
+    CSAMPLE peaks[FilterCount + 1] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < BIGBUF_SIZE; i += blockSize) {
+        low.process(&bigbuf[i], buffers[Low], blockSize);
+        mid.process(&bigbuf[i], buffers[Mid], blockSize);
+        high.process(&bigbuf[i], buffers[High], blockSize);
+        for (int j = 0; j < blockSize; ++j) {
+            for (int f = 0; f < FilterCount; ++f) {
+                peaks[f] = math_max(peaks[f], static_cast<CSAMPLE>(fabs(buffers[f][j])));
+            }
+            peaks[FilterCount] = math_max(peaks[FilterCount],
+                                          static_cast<CSAMPLE>(fabs(bigbuf[i + j])));
+        }
+    }
+    qint64 separateElapsed = timer.restart();
+
+    aw->initialise(tio, sampleRate, BIGBUF_SIZE);
+    for (int i = 0; i < BIGBUF_SIZE; i += blockSize) {
+        aw->process(&bigbuf[i], blockSize);
+    }
+    aw->finalise(tio);
+    qint64 fusedElapsed = timer.elapsed();
+
+    const int frames = BIGBUF_SIZE / 2;
+    qDebug() << "Separate filter passes:" << separateElapsed / frames
+             << "ns per frame, AnalyserWaveform::process:"
+             << fusedElapsed / frames << "ns per frame";
+    EXPECT_FLOAT_EQ(MAGIC_FLOAT, peaks[FilterCount]);
+
+    for (int f = 0; f < FilterCount; ++f) {
+        delete [] buffers[f];
+    }
+}
 }
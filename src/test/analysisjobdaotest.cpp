@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <QtSql>
+
+#include "library/dao/analysisjobdao.h"
+#include "test/librarytest.h"
+
+namespace {
+
+class AnalysisJobDAOTest : public LibraryTest {
+  protected:
+    virtual void SetUp() {
+        dao().removeAllJobs();
+    }
+
+    virtual void TearDown() {
+        dao().removeAllJobs();
+    }
+
+    AnalysisJobDAO& dao() {
+        return collection()->getAnalysisJobDAO();
+    }
+};
+
+TEST_F(AnalysisJobDAOTest, AddMergesAnalysers) {
+    QList<int> trackIds;
+    trackIds << 3 << 1 << 2;
+    ASSERT_TRUE(dao().addJobs(trackIds, 0x04));
+    ASSERT_TRUE(dao().addJobs(QList<int>() << 1 << 4, 0x08));
+
+    QList<AnalysisJob> jobs = dao().getPendingJobs();
+    ASSERT_EQ(4, jobs.size());
+    // Merging keeps a job in its place in the queue.
+    EXPECT_EQ(AnalysisJob(3, 0x04), jobs[0]);
+    EXPECT_EQ(AnalysisJob(1, 0x0C), jobs[1]);
+    EXPECT_EQ(AnalysisJob(2, 0x04), jobs[2]);
+    EXPECT_EQ(AnalysisJob(4, 0x08), jobs[3]);
+    EXPECT_EQ(4, dao().pendingJobCount());
+}
+
+TEST_F(AnalysisJobDAOTest, FinishRemovesAnalysers) {
+    ASSERT_TRUE(dao().addJobs(QList<int>() << 1 << 2, 0x0C));
+
+    ASSERT_TRUE(dao().finishJob(1, 0x04));
+    QList<AnalysisJob> jobs = dao().getPendingJobs();
+    ASSERT_EQ(2, jobs.size());
+    EXPECT_EQ(AnalysisJob(1, 0x08), jobs[0]);
+
+    // The job is gone once all of its analysers finished.
+    ASSERT_TRUE(dao().finishJob(1, 0x08));
+    jobs = dao().getPendingJobs();
+    ASSERT_EQ(1, jobs.size());
+    EXPECT_EQ(AnalysisJob(2, 0x0C), jobs[0]);
+
+    ASSERT_TRUE(dao().removeAllJobs());
+    EXPECT_EQ(0, dao().pendingJobCount());
+}
+
+}  // namespace
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <QtDebug>
+#include <QVector>
+
+#include "analyserfingerprint.h"
+#include "musicbrainz/chromaprinter.h"
+#include "sampleutil.h"
+#include "util/math.h"
+
+namespace {
+
+class ChromaPrinterTest : public testing::Test {
+  protected:
+    ChromaPrinterTest()
+            : m_iSampleRate(11025) {
+    }
+
+    // Returns seconds of interleaved stereo audio with a changing pitch so
+    // that the fingerprint is not trivial.
+    QVector<SAMPLE> createAudio(int seconds) {
+        QVector<SAMPLE> audio(seconds * m_iSampleRate * 2);
+        double phase = 0.0;
+        for (int i = 0; i < audio.size() / 2; ++i) {
+            double frequency = 220.0 * (1 + (i / m_iSampleRate) % 4);
+            phase += 2 * M_PI * frequency / m_iSampleRate;
+            SAMPLE value = static_cast<SAMPLE>(8000 * sin(phase));
+            audio[2 * i] = value;
+            audio[2 * i + 1] = value;
+        }
+        return audio;
+    }
+
+    int m_iSampleRate;
+};
+
+TEST_F(ChromaPrinterTest, FeedingInBlocksMatchesSingleFeed) {
+    QVector<SAMPLE> audio = createAudio(20);
+
+    ChromaPrinter whole;
+    ASSERT_TRUE(whole.start(m_iSampleRate));
+    whole.feed(audio.constData(), audio.size());
+    QString expected = whole.finish();
+    ASSERT_FALSE(expected.isEmpty());
+
+    ChromaPrinter blocks;
+    ASSERT_TRUE(blocks.start(m_iSampleRate));
+    const int kBlockSize = 1000;
+    for (int i = 0; i < audio.size(); i += kBlockSize) {
+        blocks.feed(audio.constData() + i, qMin(kBlockSize, audio.size() - i));
+    }
+    EXPECT_EQ(expected, blocks.finish());
+}
+
+TEST_F(ChromaPrinterTest, StopsAfterTwoMinutes) {
+    QVector<SAMPLE> audio = createAudio(60);
+
+    ChromaPrinter printer;
+    ASSERT_TRUE(printer.start(m_iSampleRate));
+    EXPECT_TRUE(printer.feed(audio.constData(), audio.size()));
+    EXPECT_FALSE(printer.feed(audio.constData(), audio.size()));
+    // Anything after the first two minutes is ignored.
+    EXPECT_FALSE(printer.feed(audio.constData(), audio.size()));
+    EXPECT_FALSE(printer.finish().isEmpty());
+}
+
+TEST_F(ChromaPrinterTest, AnalyserCachesFingerprintOnTrack) {
+    QVector<SAMPLE> audio = createAudio(20);
+    QVector<CSAMPLE> samples(audio.size());
+    SampleUtil::convertS16ToFloat32(samples.data(), audio.constData(),
+                                    audio.size());
+
+    TrackPointer pTrack(new TrackInfoObject(), &QObject::deleteLater);
+    AnalyserFingerprint analyser;
+    ASSERT_TRUE(analyser.initialise(pTrack, m_iSampleRate, audio.size()));
+    analyser.process(samples.constData(), samples.size());
+    analyser.finalise(pTrack);
+
+    ChromaPrinter printer;
+    ASSERT_TRUE(printer.start(m_iSampleRate));
+    printer.feed(audio.constData(), audio.size());
+    EXPECT_EQ(printer.finish(), pTrack->getFingerprint());
+
+    // Tracks with a fingerprint are not analysed again.
+    EXPECT_TRUE(analyser.loadStored(pTrack));
+    EXPECT_FALSE(analyser.initialise(pTrack, m_iSampleRate, audio.size()));
+}
+
+}  // namespace
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <QtDebug>
+#include <QScopedPointer>
+
+#include "track/beatfactory.h"
+#include "track/beatgrid.h"
+#include "track/beatmap.h"
+#include "track/compactserialization.h"
+#include "track/keyfactory.h"
+#include "proto/beats.pb.h"
+
+namespace {
+
+class CompactSerializationTest : public testing::Test {
+  protected:
+    CompactSerializationTest()
+            : m_pTrack(new TrackInfoObject(), &QObject::deleteLater),
+              m_iSampleRate(44100) {
+        m_pTrack->setSampleRate(m_iSampleRate);
+    }
+
+    QVector<double> createBeatVector(double first_beat,
+                                     int num_beats,
+                                     double beat_length) {
+        QVector<double> beats;
+        for (int i = 0; i < num_beats; ++i) {
+            beats.append(first_beat + i * beat_length);
+        }
+        return beats;
+    }
+
+    TrackPointer m_pTrack;
+    int m_iSampleRate;
+};
+
+TEST_F(CompactSerializationTest, ReaderWriterRoundTrip) {
+    CompactWriter writer("TEST", 3);
+    writer.writeUInt8(200);
+    writer.writeVarUInt(300);
+    writer.writeVarInt(-5);
+    writer.writeVarInt(1LL << 40);
+    writer.writeDouble(123.456);
+    writer.writeString(QString::fromUtf8("B\xe2\x99\xad minor"));
+    QScopedPointer<QByteArray> pData(writer.takeByteArray());
+
+    CompactReader reader(*pData, "TEST");
+    ASSERT_TRUE(reader.isValid());
+    EXPECT_EQ(3, reader.formatVersion());
+    EXPECT_EQ(200, reader.readUInt8());
+    EXPECT_EQ(300u, reader.readVarUInt());
+    EXPECT_EQ(-5, reader.readVarInt());
+    EXPECT_EQ(1LL << 40, reader.readVarInt());
+    EXPECT_DOUBLE_EQ(123.456, reader.readDouble());
+    EXPECT_EQ(QString::fromUtf8("B\xe2\x99\xad minor"), reader.readString());
+    EXPECT_TRUE(reader.isValid());
+    EXPECT_TRUE(reader.atEnd());
+
+    // Reading past the end invalidates the reader.
+    EXPECT_EQ(0, reader.readUInt8());
+    EXPECT_FALSE(reader.isValid());
+
+    // Wrong magic.
+    CompactReader other(*pData, "ABCD");
+    EXPECT_FALSE(other.isValid());
+}
+
+TEST_F(CompactSerializationTest, BeatMapRoundTrip) {
+    const int numBeats = 1000;
+    // 128 BPM at 44.1 kHz.
+    QVector<double> beats = createBeatVector(1234, numBeats,
+                                             m_iSampleRate * 60.0 / 128);
+    BeatMap map(m_pTrack, 0, beats);
+
+    QScopedPointer<QByteArray> pData(map.toByteArray());
+    // Magic and format version, the beat count, the first beat and then
+    // 3 bytes for each further beat.
+    EXPECT_EQ(5 + 2 + 2 + (numBeats - 1) * 3, pData->size());
+
+    BeatMap copy(m_pTrack, 0, pData.data());
+    EXPECT_DOUBLE_EQ(map.getBpm(), copy.getBpm());
+    QScopedPointer<BeatIterator> pExpected(map.findBeats(0, 1E10));
+    QScopedPointer<BeatIterator> pActual(copy.findBeats(0, 1E10));
+    int count = 0;
+    while (pExpected->hasNext()) {
+        ASSERT_TRUE(pActual->hasNext());
+        EXPECT_DOUBLE_EQ(pExpected->next(), pActual->next());
+        ++count;
+    }
+    EXPECT_FALSE(pActual->hasNext());
+    EXPECT_EQ(numBeats, count);
+}
+
+TEST_F(CompactSerializationTest, BeatMapReadsLegacyProtobuf) {
+    mixxx::track::io::BeatMap legacy;
+    for (int i = 0; i < 4; ++i) {
+        mixxx::track::io::Beat* pBeat = legacy.add_beat();
+        pBeat->set_frame_position(100 + i * 1000);
+        pBeat->set_enabled(i != 2);
+        pBeat->set_source(mixxx::track::io::USER);
+    }
+    std::string output;
+    legacy.SerializeToString(&output);
+    QByteArray legacyData(output.data(), output.length());
+
+    BeatMap map(m_pTrack, 0, &legacyData);
+    // Writing it again uses the compact format and keeps the disabled beat.
+    QScopedPointer<QByteArray> pData(map.toByteArray());
+    EXPECT_TRUE(CompactReader::hasMagic(*pData, "MXBM"));
+    BeatMap copy(m_pTrack, 0, pData.data());
+
+    QScopedPointer<BeatIterator> pBeats(copy.findBeats(0, 1E10));
+    ASSERT_TRUE(pBeats->hasNext());
+    EXPECT_DOUBLE_EQ(200, pBeats->next());
+    ASSERT_TRUE(pBeats->hasNext());
+    EXPECT_DOUBLE_EQ(2200, pBeats->next());
+    ASSERT_TRUE(pBeats->hasNext());
+    EXPECT_DOUBLE_EQ(6200, pBeats->next());
+    EXPECT_FALSE(pBeats->hasNext());
+}
+
+TEST_F(CompactSerializationTest, BeatGridRoundTrip) {
+    BeatGrid grid(m_pTrack.data(), 0);
+    grid.setBpm(128.5);
+    grid.translate(5000);
+
+    QScopedPointer<QByteArray> pData(grid.toByteArray());
+    BeatGrid copy(m_pTrack.data(), 0, pData.data());
+    EXPECT_DOUBLE_EQ(128.5, copy.getBpm());
+    EXPECT_DOUBLE_EQ(grid.findNextBeat(0), copy.findNextBeat(0));
+}
+
+TEST_F(CompactSerializationTest, KeysRoundTrip) {
+    Keys keys = KeyFactory::makeBasicKeys(mixxx::track::io::key::F_SHARP_MINOR,
+                                          mixxx::track::io::key::USER);
+    QScopedPointer<QByteArray> pData(keys.toByteArray());
+    Keys copy(pData.data());
+    EXPECT_TRUE(copy.isValid());
+    EXPECT_EQ(mixxx::track::io::key::F_SHARP_MINOR, copy.getGlobalKey());
+}
+
+TEST_F(CompactSerializationTest, TrackDecodesBeatsLazily) {
+    QVector<double> beats = createBeatVector(100, 64, 22050.0);
+    BeatsPointer pMap(new BeatMap(m_pTrack, 0, beats));
+    QScopedPointer<QByteArray> pData(pMap->toByteArray());
+    BeatsSummary summary = BeatFactory::makeSummary(pMap);
+    EXPECT_EQ(BeatsSummary::MAP, summary.type);
+    EXPECT_DOUBLE_EQ(200, summary.firstBeatSample);
+
+    TrackPointer pTrack(new TrackInfoObject(), &QObject::deleteLater);
+    pTrack->setSampleRate(m_iSampleRate);
+    pTrack->setSerializedBeats(BEAT_MAP_2_VERSION, "", *pData, summary);
+    EXPECT_DOUBLE_EQ(summary.bpm, pTrack->getBpm());
+
+    // Undecoded beats are handed back as they were set.
+    QString version;
+    QString subVersion;
+    QByteArray blob;
+    BeatsSummary storedSummary;
+    ASSERT_TRUE(pTrack->getSerializedBeats(&version, &subVersion, &blob,
+                                           &storedSummary));
+    EXPECT_EQ(QString(BEAT_MAP_2_VERSION), version);
+    EXPECT_EQ(*pData, blob);
+
+    BeatsPointer pDecoded = pTrack->getBeats();
+    ASSERT_TRUE(pDecoded);
+    EXPECT_EQ(QString(BEAT_MAP_2_VERSION), pDecoded->getVersion());
+    EXPECT_DOUBLE_EQ(pMap->getBpm(), pDecoded->getBpm());
+    EXPECT_DOUBLE_EQ(200, pDecoded->findNextBeat(0));
+}
+
+}  // namespace
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QScopedPointer>
+
+#include "configobject.h"
+#include "util/backgroundfilewriter.h"
+
+namespace {
+
+class ConfigObjectTest : public testing::Test {
+  protected:
+    ConfigObjectTest()
+            : m_path(QDir::temp().filePath("mixxx_configobject_test.cfg")) {
+    }
+
+    virtual void SetUp() {
+        removeFiles();
+    }
+
+    virtual void TearDown() {
+        removeFiles();
+    }
+
+    void removeFiles() {
+        BackgroundFileWriter::flush();
+        QFile::remove(m_path);
+        QFile::remove(m_path + ".snapshot");
+    }
+
+    QString m_path;
+};
+
+TEST_F(ConfigObjectTest, SaveIsWrittenOnFlush) {
+    ConfigObject<ConfigValue> config(m_path);
+    config.set(ConfigKey("[Master]", "num_decks"), ConfigValue(4));
+    config.Save();
+
+    BackgroundFileWriter::flush();
+    EXPECT_TRUE(QFile::exists(m_path));
+    EXPECT_TRUE(QFile::exists(m_path + ".snapshot"));
+    EXPECT_FALSE(QFile::exists(m_path + ".tmp"));
+}
+
+TEST_F(ConfigObjectTest, ReopenReadsLatestSave) {
+    {
+        ConfigObject<ConfigValue> config(m_path);
+        config.set(ConfigKey("[Master]", "num_decks"), ConfigValue(2));
+        config.Save();
+        // Queued saves of the same file are coalesced into the last one.
+        config.set(ConfigKey("[Master]", "num_decks"), ConfigValue(4));
+        config.set(ConfigKey("[Library]", "Directory"), ConfigValue("/music"));
+        config.Save();
+    }
+
+    // Loaded from the snapshot.
+    ConfigObject<ConfigValue> config(m_path);
+    EXPECT_STREQ("4", qPrintable(
+            config.getValueString(ConfigKey("[Master]", "num_decks"))));
+    EXPECT_STREQ("/music", qPrintable(
+            config.getValueString(ConfigKey("[Library]", "Directory"))));
+}
+
+TEST_F(ConfigObjectTest, EditedFileIsPreferredOverSnapshot) {
+    {
+        ConfigObject<ConfigValue> config(m_path);
+        config.set(ConfigKey("[Master]", "num_decks"), ConfigValue(2));
+        config.Save();
+    }
+
+    // Edit the file by hand. The snapshot no longer matches it.
+    QFile file(m_path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("\n[Master]\nnum_decks 3\n");
+    file.close();
+
+    ConfigObject<ConfigValue> config(m_path);
+    EXPECT_STREQ("3", qPrintable(
+            config.getValueString(ConfigKey("[Master]", "num_decks"))));
+}
+
+TEST_F(ConfigObjectTest, WriteAtomicallyReplacesFile) {
+    ASSERT_TRUE(BackgroundFileWriter::writeAtomically(m_path, "first"));
+    ASSERT_TRUE(BackgroundFileWriter::writeAtomically(m_path, "second"));
+
+    QFile file(m_path);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    EXPECT_EQ(QByteArray("second"), file.readAll());
+}
+
+}  // namespace
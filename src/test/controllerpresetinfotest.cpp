@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+
+#include "controllers/controllerpresetinfo.h"
+#include "controllers/defs_controllers.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+class ControllerPresetInfoTest : public MixxxTest {
+  protected:
+    virtual void SetUp() {
+        QDir().mkpath(localPresetsPath(config()));
+        m_presetPath = localPresetsPath(config()) + "Test_Device" +
+                MIDI_PRESET_EXTENSION;
+        m_indexPath = QDir(config()->getSettingsPath()).filePath(
+                "controller_preset_index.dat");
+    }
+
+    virtual void TearDown() {
+        QFile::remove(m_presetPath);
+        QFile::remove(m_indexPath);
+    }
+
+    void writePreset(const QString& name) {
+        QFile file(m_presetPath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(QString(
+            "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+            "<MixxxControllerPreset mixxxVersion=\"1.12.0+\" schemaVersion=\"1\">\n"
+            "  <info><name>%1</name><author>Tester</author></info>\n"
+            "  <controller id=\"Test\"/>\n"
+            "</MixxxControllerPreset>\n").arg(name).toUtf8());
+    }
+
+    QString presetName(PresetInfoEnumerator* pEnumerator) {
+        foreach (const PresetInfo& preset,
+                 pEnumerator->getPresets(MIDI_PRESET_EXTENSION)) {
+            if (QFileInfo(preset.getPath()) == QFileInfo(m_presetPath)) {
+                return preset.getName();
+            }
+        }
+        return QString();
+    }
+
+    QString m_presetPath;
+    QString m_indexPath;
+};
+
+TEST_F(ControllerPresetInfoTest, IndexIsWrittenAndReused) {
+    writePreset("Indexed");
+    {
+        PresetInfoEnumerator enumerator(config());
+        EXPECT_QSTRING_EQ("Indexed", presetName(&enumerator));
+        EXPECT_LT(0, enumerator.numParsedPresets());
+    }
+    EXPECT_TRUE(QFile::exists(m_indexPath));
+
+    // A second enumerator gets the same info from the index without parsing
+    // any file.
+    PresetInfoEnumerator enumerator(config());
+    EXPECT_QSTRING_EQ("Indexed", presetName(&enumerator));
+    EXPECT_EQ(0, enumerator.numParsedPresets());
+}
+
+TEST_F(ControllerPresetInfoTest, ChangedPresetIsReparsed) {
+    writePreset("Before");
+    {
+        PresetInfoEnumerator enumerator(config());
+        EXPECT_QSTRING_EQ("Before", presetName(&enumerator));
+    }
+
+    // The new name changes the size of the file, so this does not depend on
+    // the resolution of the modification time.
+    writePreset("After the change");
+    PresetInfoEnumerator enumerator(config());
+    EXPECT_QSTRING_EQ("After the change", presetName(&enumerator));
+    // Only the changed preset.
+    EXPECT_EQ(1, enumerator.numParsedPresets());
+}
+
+TEST_F(ControllerPresetInfoTest, CorruptIndexIsIgnored) {
+    writePreset("Valid");
+    QFile index(m_indexPath);
+    ASSERT_TRUE(index.open(QIODevice::WriteOnly));
+    index.write("garbage");
+    index.close();
+
+    PresetInfoEnumerator enumerator(config());
+    EXPECT_QSTRING_EQ("Valid", presetName(&enumerator));
+}
+
+}  // namespace
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <QtDebug>
+#include <QDir>
+#include <QScopedPointer>
+
+#include "controlobject.h"
+#include "controlobjectslave.h"
+#include "control/controlrecorder.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+class ControlRecorderTest : public MixxxTest {
+  protected:
+    virtual void SetUp() {
+        m_sessionPath = QDir::temp().filePath("mixxx-controlrecordertest.session");
+        m_pControl.reset(new ControlObject(ConfigKey("[Test]", "control")));
+    }
+
+    virtual void TearDown() {
+        ControlRecorder::stop();
+        m_pControl.reset();
+        QFile::remove(m_sessionPath);
+    }
+
+    QString m_sessionPath;
+    QScopedPointer<ControlObject> m_pControl;
+};
+
+TEST_F(ControlRecorderTest, RecordAndReadSession) {
+    // Non-default values are part of the initial state.
+    m_pControl->set(2.0);
+    ASSERT_TRUE(ControlRecorder::start(m_sessionPath));
+    EXPECT_TRUE(ControlRecorder::isRecording());
+
+    ControlObjectSlave slave(ConfigKey("[Test]", "control"));
+    slave.set(0.25);
+    ControlRecorder::recordTrackLoad("[Channel1]", "/music/a\ttab.mp3", true);
+    ControlRecorder::stop();
+    EXPECT_FALSE(ControlRecorder::isRecording());
+
+    // Not recorded after stop().
+    slave.set(0.5);
+
+    QList<ControlSessionEvent> events;
+    ASSERT_TRUE(ControlRecorder::readSession(m_sessionPath, &events));
+    ASSERT_EQ(3, events.size());
+
+    EXPECT_EQ(ControlSessionEvent::SET, events[0].type);
+    EXPECT_EQ(0, events[0].nanos);
+    EXPECT_EQ(ConfigKey("[Test]", "control"), events[0].key);
+    EXPECT_DOUBLE_EQ(2.0, events[0].value);
+
+    EXPECT_EQ(ControlSessionEvent::SET, events[1].type);
+    EXPECT_EQ(ConfigKey("[Test]", "control"), events[1].key);
+    EXPECT_DOUBLE_EQ(0.25, events[1].value);
+
+    EXPECT_EQ(ControlSessionEvent::LOAD, events[2].type);
+    EXPECT_EQ(QString("[Channel1]"), events[2].key.group);
+    EXPECT_EQ(QString("/music/a\ttab.mp3"), events[2].location);
+    EXPECT_DOUBLE_EQ(1.0, events[2].value);
+    EXPECT_LE(events[1].nanos, events[2].nanos);
+}
+
+TEST_F(ControlRecorderTest, RejectsOtherFiles) {
+    QFile file(m_sessionPath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write("[Channel1]\n");
+    file.close();
+
+    QList<ControlSessionEvent> events;
+    EXPECT_FALSE(ControlRecorder::readSession(m_sessionPath, &events));
+    EXPECT_TRUE(events.isEmpty());
+}
+
+}  // namespace
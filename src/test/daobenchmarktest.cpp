@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <QtSql>
+
+#include "library/queryutil.h"
+#include "test/librarytest.h"
+#include "util/performancetimer.h"
+
+// Microbenchmarks of the DAO calls that run once per track. They check the
+// results and log the time per call, they don't fail when they are slow.
+// They are disabled by default. Run them with
+//   mixxx-test --gtest_also_run_disabled_tests --gtest_filter=DAOBenchmarkTest.*
+
+namespace {
+
+const QString kTrackLocationTest(QDir::currentPath() %
+                                 "/src/test/id3-test-data/cover-test.mp3");
+const int kIterations = 1000;
+
+class DAOBenchmarkTest : public LibraryTest {
+  protected:
+    QList<int> fakeTrackIds(int count) {
+        QList<int> trackIds;
+        for (int i = 1; i <= count; ++i) {
+            trackIds.append(i);
+        }
+        return trackIds;
+    }
+};
+
+TEST_F(DAOBenchmarkTest, PreparedQueryCacheReusesQueries) {
+    PreparedQueryCache cache(collection()->getDatabase());
+    const QString statement("SELECT id FROM library WHERE id=:id");
+    {
+        CachedQuery query(cache.prepare(statement));
+        query.bindValue(":id", 1);
+        ASSERT_TRUE(query.exec());
+        // Still in use, so this gets a query of its own.
+        CachedQuery nested(cache.prepare(statement));
+        nested.bindValue(":id", 2);
+        ASSERT_TRUE(nested.exec());
+    }
+    CachedQuery query(cache.prepare(statement));
+    query.bindValue(":id", 3);
+    ASSERT_TRUE(query.exec());
+
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(1, cache.misses());
+    EXPECT_EQ(1, cache.hits());
+}
+
+TEST_F(DAOBenchmarkTest, DISABLED_GetTrackId) {
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    int trackId = trackDao.addTrack(kTrackLocationTest, false);
+    ASSERT_NE(-1, trackId);
+
+    PerformanceTimer timer;
+    timer.start();
+    for (int i = 0; i < kIterations; ++i) {
+        ASSERT_EQ(trackId, trackDao.getTrackId(kTrackLocationTest));
+    }
+    qDebug() << "TrackDAO::getTrackId:" << timer.elapsed() / kIterations
+             << "ns per call";
+}
+
+TEST_F(DAOBenchmarkTest, DISABLED_AddTracksToCrate) {
+    CrateDAO& crateDao = collection()->getCrateDAO();
+    int singleCrateId = crateDao.createCrate("single");
+    int bulkCrateId = crateDao.createCrate("bulk");
+    ASSERT_NE(-1, singleCrateId);
+    ASSERT_NE(-1, bulkCrateId);
+    QList<int> trackIds = fakeTrackIds(kIterations);
+
+    PerformanceTimer timer;
+    timer.start();
+    foreach (int trackId, trackIds) {
+        ASSERT_TRUE(crateDao.addTrackToCrate(trackId, singleCrateId));
+    }
+    qint64 singleElapsed = timer.restart();
+    EXPECT_EQ(kIterations, crateDao.addTracksToCrate(bulkCrateId, &trackIds));
+    qint64 bulkElapsed = timer.elapsed();
+
+    EXPECT_EQ(static_cast<unsigned int>(kIterations),
+              crateDao.crateSize(singleCrateId));
+    EXPECT_EQ(static_cast<unsigned int>(kIterations),
+              crateDao.crateSize(bulkCrateId));
+    // The track is in the crate already.
+    EXPECT_FALSE(crateDao.addTrackToCrate(1, singleCrateId));
+    qDebug() << "CrateDAO::addTrackToCrate:" << singleElapsed / kIterations
+             << "ns per track, addTracksToCrate:" << bulkElapsed / kIterations
+             << "ns per track";
+}
+
+TEST_F(DAOBenchmarkTest, DISABLED_AppendTracksToPlaylist) {
+    PlaylistDAO& playlistDao = collection()->getPlaylistDAO();
+    int singlePlaylistId = playlistDao.createPlaylist("single");
+    int bulkPlaylistId = playlistDao.createPlaylist("bulk");
+    ASSERT_NE(-1, singlePlaylistId);
+    ASSERT_NE(-1, bulkPlaylistId);
+    QList<int> trackIds = fakeTrackIds(kIterations);
+
+    PerformanceTimer timer;
+    timer.start();
+    foreach (int trackId, trackIds) {
+        ASSERT_TRUE(playlistDao.appendTrackToPlaylist(trackId, singlePlaylistId));
+    }
+    qint64 singleElapsed = timer.restart();
+    ASSERT_TRUE(playlistDao.appendTracksToPlaylist(trackIds, bulkPlaylistId));
+    qint64 bulkElapsed = timer.elapsed();
+
+    EXPECT_EQ(trackIds, playlistDao.getTrackIds(singlePlaylistId));
+    EXPECT_EQ(trackIds, playlistDao.getTrackIds(bulkPlaylistId));
+    qDebug() << "PlaylistDAO::appendTrackToPlaylist:"
+             << singleElapsed / kIterations
+             << "ns per track, appendTracksToPlaylist:"
+             << bulkElapsed / kIterations << "ns per track";
+}
+
+TEST_F(DAOBenchmarkTest, DISABLED_SaveTracks) {
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    QStringList locations;
+    locations << kTrackLocationTest
+              << QDir::currentPath() + "/src/test/id3-test-data/artist.mp3"
+              << QDir::currentPath() + "/src/test/id3-test-data/TOAL_TPE2.mp3";
+    QList<TrackPointer> tracks;
+    foreach (const QString& location, locations) {
+        int trackId = trackDao.addTrack(location, false);
+        ASSERT_NE(-1, trackId);
+        TrackPointer pTrack = trackDao.getTrack(trackId);
+        ASSERT_FALSE(pTrack.isNull());
+        tracks.append(pTrack);
+    }
+
+    PerformanceTimer timer;
+    timer.start();
+    for (int i = 0; i < kIterations; ++i) {
+        foreach (TrackPointer pTrack, tracks) {
+            pTrack->setRating(i % 5 + 1);
+        }
+        trackDao.saveTracks(tracks);
+    }
+    qDebug() << "TrackDAO::saveTracks:"
+             << timer.elapsed() / (kIterations * tracks.size())
+             << "ns per track";
+
+    QSqlQuery query(collection()->getDatabase());
+    query.prepare("SELECT rating FROM library WHERE id=:id");
+    foreach (TrackPointer pTrack, tracks) {
+        EXPECT_FALSE(pTrack->isDirty());
+        query.bindValue(":id", pTrack->getId());
+        ASSERT_TRUE(query.exec());
+        ASSERT_TRUE(query.next());
+        EXPECT_EQ((kIterations - 1) % 5 + 1, query.value(0).toInt());
+    }
+}
+
+}  // namespace
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <QScopedPointer>
+
+#include "controlobject.h"
+#include "engine/deckparams.h"
+
+namespace {
+
+class DeckParamsTest : public testing::Test {
+  protected:
+    virtual void SetUp() {
+        m_pSampleRate.reset(new ControlObject(ConfigKey("[Master]", "samplerate")));
+        m_pSampleRate->set(44100);
+        m_pPlay.reset(new ControlObject(ConfigKey("[DeckParamsTest]", "play")));
+        m_pScratch2.reset(new ControlObject(ConfigKey("[DeckParamsTest]", "scratch2")));
+        m_pQuantize.reset(new ControlObject(ConfigKey("[DeckParamsTest]", "quantize")));
+    }
+
+    QScopedPointer<ControlObject> m_pSampleRate;
+    QScopedPointer<ControlObject> m_pPlay;
+    QScopedPointer<ControlObject> m_pScratch2;
+    QScopedPointer<ControlObject> m_pQuantize;
+};
+
+TEST_F(DeckParamsTest, ReadsControlsWhenCreated) {
+    m_pPlay->set(1.0);
+    DeckParamsJournal journal("[DeckParamsTest]");
+    const DeckParams& params = journal.update();
+    EXPECT_DOUBLE_EQ(44100, params.sampleRate);
+    EXPECT_TRUE(params.play);
+    EXPECT_FALSE(params.quantize);
+    // Controls that do not exist read as 0.
+    EXPECT_FALSE(params.vinylControlEnabled);
+    EXPECT_EQ(0, params.vinylControlMode);
+}
+
+TEST_F(DeckParamsTest, ChangesShowUpInNextUpdate) {
+    DeckParamsJournal journal("[DeckParamsTest]");
+    EXPECT_FALSE(journal.update().play);
+
+    m_pPlay->set(1.0);
+    m_pScratch2->set(-2.5);
+    m_pQuantize->set(1.0);
+    // The snapshot is only taken by update().
+    EXPECT_FALSE(journal.params().play);
+
+    const DeckParams& params = journal.update();
+    EXPECT_TRUE(params.play);
+    EXPECT_DOUBLE_EQ(-2.5, params.scratch2);
+    EXPECT_TRUE(params.quantize);
+
+    m_pSampleRate->set(48000);
+    EXPECT_DOUBLE_EQ(48000, journal.update().sampleRate);
+}
+
+TEST_F(DeckParamsTest, SecondUpdatePicksUpChangesMadeInTheCallback) {
+    DeckParamsJournal journal("[DeckParamsTest]");
+    m_pPlay->set(1.0);
+    const DeckParams& params = journal.update();
+    EXPECT_TRUE(params.play);
+
+    // The engine stops the deck, e.g. at the end of the track.
+    m_pPlay->set(0.0);
+    EXPECT_TRUE(params.play);
+    journal.update();
+    EXPECT_FALSE(params.play);
+}
+
+}  // namespace
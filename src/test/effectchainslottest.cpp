@@ -110,3 +110,37 @@ TEST_F(EffectChainSlotTest, ChainSlotMirrorsLoadedChain_Clear) {
     ControlObject::set(ConfigKey(group, "clear"), 1.0);
     EXPECT_DOUBLE_EQ(0.0, ControlObject::get(ConfigKey(group, "loaded")));
 }
+
+TEST_F(EffectChainSlotTest, ChainSlotSendLevelsPropagateToChain) {
+    m_pEffectsManager->registerGroup("[Channel1]");
+    m_pEffectsManager->registerGroup("[Channel2]");
+    EffectChainPointer pChain(new EffectChain(m_pEffectsManager.data(),
+                                              "org.mixxx.test.chain1"));
+    int iRackNumber = 0;
+    int iChainNumber = 0;
+
+    StandardEffectRackPointer pRack = m_pEffectsManager->addStandardEffectRack();
+    EffectChainSlotPointer pSlot = pRack->addEffectChainSlot();
+    pSlot->clear();
+
+    QString group = StandardEffectRack::formatEffectChainSlotGroupString(
+        iRackNumber, iChainNumber);
+
+    // Send levels are properties of the slot, like the enabled groups.
+    ControlObject::set(ConfigKey(group, "group_[Channel1]_send"), 0.25);
+    pSlot->loadEffectChain(pChain);
+    EXPECT_DOUBLE_EQ(0.25, pChain->sendLevelForGroup("[Channel1]"));
+    EXPECT_DOUBLE_EQ(1.0, pChain->sendLevelForGroup("[Channel2]"));
+
+    ControlObject::set(ConfigKey(group, "group_[Channel2]_send"), 0.5);
+    EXPECT_DOUBLE_EQ(0.5, pChain->sendLevelForGroup("[Channel2]"));
+
+    // Only channels can be sent to the bus.
+    EXPECT_TRUE(ControlObject::getControl(
+        ConfigKey(group, "group_[Master]_send"), false) == NULL);
+    EXPECT_TRUE(ControlObject::getControl(
+        ConfigKey(group, "group_[Headphone]_send"), false) == NULL);
+
+    ControlObject::set(ConfigKey(group, "insertion_type"), EffectChain::BUS);
+    EXPECT_EQ(EffectChain::BUS, pChain->insertionType());
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <QScopedPointer>
+
+#include "controlobjectslave.h"
+#include "engine/deckparams.h"
+#include "test/mockedenginebackendtest.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+
+// Benchmarks of the per-callback work of EngineBuffer. They log the time per
+// callback, they don't fail when it is slow. Run them on both sides of a change
+// to compare. They are disabled by default. Run them with
+//   mixxx-test --gtest_also_run_disabled_tests --gtest_filter=EngineBufferBenchmarkTest.*
+
+namespace {
+
+const int kWarmupCallbacks = 100;
+const int kCallbacks = 10000;
+const int kControlReads = 1000000;
+
+// Reads the controls of DeckParams one by one every callback, like
+// EngineBuffer did before it used a DeckParamsJournal.
+class DeckControlReader {
+  public:
+    explicit DeckControlReader(const QString& group)
+            : m_sampleRate("[Master]", "samplerate"),
+              m_rateSearch(group, "rateSearch"),
+              m_scratch2(group, "scratch2"),
+              m_vinylControlMode(group, "vinylcontrol_mode"),
+              m_play(group, "play"),
+              m_fwd(group, "fwd"),
+              m_back(group, "back"),
+              m_reverse(group, "reverse"),
+              m_repeat(group, "repeat"),
+              m_quantize(group, "quantize"),
+              m_scratch2Enable(group, "scratch2_enable"),
+              m_scratch2Scratching(group, "scratch2_indicates_scratching"),
+              m_vinylControlEnabled(group, "vinylcontrol_enabled"),
+              m_vinylControlScratching(group, "vinylcontrol_scratching") {
+    }
+
+    void read(DeckParams* pParams) {
+        pParams->sampleRate = m_sampleRate.get();
+        pParams->rateSearch = m_rateSearch.get();
+        pParams->scratch2 = m_scratch2.get();
+        pParams->vinylControlMode = static_cast<int>(m_vinylControlMode.get());
+        pParams->play = m_play.get() != 0.0;
+        pParams->fwd = m_fwd.get() != 0.0;
+        pParams->back = m_back.get() != 0.0;
+        pParams->reverse = m_reverse.get() != 0.0;
+        pParams->repeat = m_repeat.get() != 0.0;
+        pParams->quantize = m_quantize.get() > 0.0;
+        pParams->scratch2Enable = m_scratch2Enable.get() != 0.0;
+        pParams->scratch2Scratching = m_scratch2Scratching.get() != 0.0;
+        pParams->vinylControlEnabled = m_vinylControlEnabled.get() != 0.0;
+        pParams->vinylControlScratching = m_vinylControlScratching.get() != 0.0;
+    }
+
+  private:
+    ControlObjectSlave m_sampleRate;
+    ControlObjectSlave m_rateSearch;
+    ControlObjectSlave m_scratch2;
+    ControlObjectSlave m_vinylControlMode;
+    ControlObjectSlave m_play;
+    ControlObjectSlave m_fwd;
+    ControlObjectSlave m_back;
+    ControlObjectSlave m_reverse;
+    ControlObjectSlave m_repeat;
+    ControlObjectSlave m_quantize;
+    ControlObjectSlave m_scratch2Enable;
+    ControlObjectSlave m_scratch2Scratching;
+    ControlObjectSlave m_vinylControlEnabled;
+    ControlObjectSlave m_vinylControlScratching;
+};
+
+class EngineBufferBenchmarkTest : public MockedEngineBackendTest {
+  protected:
+    void play(const char* group) {
+        ControlObject::getControl(ConfigKey(group, "play"))->set(1.0);
+    }
+};
+
+TEST_F(EngineBufferBenchmarkTest, DISABLED_DeckParamsJournalVsControlReads) {
+    play(m_sGroup1);
+    DeckControlReader reader(m_sGroup1);
+    DeckParamsJournal journal(m_sGroup1);
+
+    DeckParams params;
+    PerformanceTimer timer;
+    timer.start();
+    for (int i = 0; i < kControlReads; ++i) {
+        reader.read(&params);
+    }
+    const qint64 readNanos = timer.elapsed();
+    EXPECT_TRUE(params.play);
+
+    bool bPlay = false;
+    timer.start();
+    for (int i = 0; i < kControlReads; ++i) {
+        bPlay = journal.update().play;
+    }
+    const qint64 journalNanos = timer.elapsed();
+    EXPECT_TRUE(bPlay);
+
+    qDebug() << "Reading the deck controls:"
+             << readNanos / kControlReads << "ns per callback";
+    qDebug() << "DeckParamsJournal::update():"
+             << journalNanos / kControlReads << "ns per callback";
+}
+
+TEST_F(EngineBufferBenchmarkTest, DISABLED_ProcessPerCallback) {
+    play(m_sGroup1);
+    play(m_sGroup2);
+    play(m_sGroup3);
+    for (int i = 0; i < kWarmupCallbacks; ++i) {
+        ProcessBuffer();
+    }
+
+    qint64 maxNanos = 0;
+    PerformanceTimer total;
+    total.start();
+    for (int i = 0; i < kCallbacks; ++i) {
+        PerformanceTimer timer;
+        timer.start();
+        ProcessBuffer();
+        maxNanos = math_max(maxNanos, timer.elapsed());
+    }
+    const qint64 totalNanos = total.elapsed();
+
+    qDebug() << "EngineMaster::process() with 3 playing decks:"
+             << totalNanos / kCallbacks << "ns per callback on average,"
+             << maxNanos << "ns at most";
+}
+
+}  // namespace
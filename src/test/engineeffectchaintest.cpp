@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+
+#include <QMap>
+#include <QPair>
+#include <QSet>
+#include <QtDebug>
+
+#include "effects/effectinstantiator.h"
+#include "effects/effectmanifest.h"
+#include "effects/effectprocessor.h"
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectchain.h"
+#include "engine/effects/message.h"
+#include "sampleutil.h"
+#include "util/fifo.h"
+#include "util/math.h"
+
+namespace {
+
+const unsigned int kNumSamples = 1024;
+const unsigned int kSampleRate = 44100;
+const CSAMPLE kChannel1 = 0.1f;
+const CSAMPLE kChannel2 = 0.2f;
+const CSAMPLE kMix = 0.5f;
+
+struct DoublingGroupState {
+};
+
+// Doubles its input and counts how often each group is processed.
+class DoublingProcessor : public GroupEffectProcessor<DoublingGroupState> {
+  public:
+    void processGroup(const QString& group,
+                      DoublingGroupState* pState,
+                      const CSAMPLE* pInput, CSAMPLE* pOutput,
+                      const unsigned int numSamples,
+                      const unsigned int sampleRate,
+                      const EffectProcessor::EnableState enableState,
+                      const GroupFeatureState& groupFeatures) {
+        Q_UNUSED(pState);
+        Q_UNUSED(sampleRate);
+        Q_UNUSED(enableState);
+        Q_UNUSED(groupFeatures);
+        SampleUtil::copyWithGain(pOutput, pInput, 2.0, numSamples);
+        ++m_calls[group];
+    }
+
+    QMap<QString, int> m_calls;
+};
+
+class DoublingInstantiator : public EffectInstantiator {
+  public:
+    explicit DoublingInstantiator(DoublingProcessor* pProcessor)
+            : m_pProcessor(pProcessor) {
+    }
+
+    EffectProcessor* instantiate(EngineEffect* pEngineEffect,
+                                 const EffectManifest& manifest) {
+        Q_UNUSED(pEngineEffect);
+        Q_UNUSED(manifest);
+        return m_pProcessor;
+    }
+
+  private:
+    DoublingProcessor* m_pProcessor;
+};
+
+// Drives an EngineEffectChain in BUS mode the way EngineMaster does: the
+// channels are processed, summed into the master, sent to the bus, and the
+// bus return is mixed into the master.
+class EngineEffectChainTest : public testing::Test {
+  protected:
+    virtual void SetUp() {
+        QPair<EffectsRequestPipe*, EffectsResponsePipe*> pipes =
+                TwoWayMessagePipe<EffectsRequest*, EffectsResponse>::makeTwoWayMessagePipe(
+                    64, 64, false, false);
+        m_pRequestPipe = pipes.first;
+        m_pResponsePipe = pipes.second;
+
+        m_pChain = new EngineEffectChain("org.mixxx.test.chain");
+        m_bBusGroupStateSent = false;
+        m_pProcessor = new DoublingProcessor();
+        EffectManifest manifest;
+        manifest.setId("org.mixxx.test.doubling");
+        manifest.setEffectRampsFromDry(true);
+        QSet<QString> groups;
+        groups << "[Channel1]" << "[Channel2]";
+        m_pEffect = new EngineEffect(
+            manifest, groups,
+            EffectInstantiatorPointer(new DoublingInstantiator(m_pProcessor)));
+
+        EffectsRequest add;
+        add.type = EffectsRequest::ADD_EFFECT_TO_CHAIN;
+        add.AddEffectToChain.pEffect = m_pEffect;
+        add.AddEffectToChain.iIndex = 0;
+        sendRequest(add);
+        setParameters(EffectChain::BUS, true);
+        enableForGroup("[Channel1]");
+        enableForGroup("[Channel2]");
+
+        m_pChannel1 = SampleUtil::alloc(kNumSamples);
+        m_pChannel2 = SampleUtil::alloc(kNumSamples);
+        m_pMaster = SampleUtil::alloc(kNumSamples);
+    }
+
+    virtual void TearDown() {
+        delete m_pChain;
+        delete m_pEffect;
+        delete m_pRequestPipe;
+        delete m_pResponsePipe;
+        SampleUtil::free(m_pChannel1);
+        SampleUtil::free(m_pChannel2);
+        SampleUtil::free(m_pMaster);
+    }
+
+    void sendRequest(const EffectsRequest& request) {
+        ASSERT_TRUE(m_pChain->processEffectsRequest(request, m_pResponsePipe));
+        EffectsResponse response;
+        while (m_pRequestPipe->readMessages(&response, 1) == 1) {
+            EXPECT_TRUE(response.success);
+        }
+    }
+
+    void setParameters(EffectChain::InsertionType type, bool enabled) {
+        EffectsRequest request;
+        request.type = EffectsRequest::SET_EFFECT_CHAIN_PARAMETERS;
+        request.SetEffectChainParameters.enabled = enabled;
+        request.SetEffectChainParameters.insertion_type = type;
+        request.SetEffectChainParameters.mix = kMix;
+        if (type == EffectChain::BUS && !m_bBusGroupStateSent) {
+            // Like EffectChain, the bus state is created here and not in
+            // the callback.
+            request.busGroupStates.append(
+                    qMakePair(m_pEffect, m_pEffect->createGroupState()));
+            m_bBusGroupStateSent = true;
+        }
+        sendRequest(request);
+    }
+
+    void enableForGroup(const QString& group) {
+        EffectsRequest request;
+        request.type = EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_GROUP;
+        request.group = group;
+        // The chain takes ownership.
+        request.pGroupBuffer = SampleUtil::alloc(kNumSamples);
+        sendRequest(request);
+    }
+
+    void callback() {
+        SampleUtil::fill(m_pChannel1, kChannel1, kNumSamples);
+        SampleUtil::fill(m_pChannel2, kChannel2, kNumSamples);
+        GroupFeatureState features;
+        m_pChain->process("[Channel1]", m_pChannel1, kNumSamples, kSampleRate,
+                          features);
+        m_pChain->process("[Channel2]", m_pChannel2, kNumSamples, kSampleRate,
+                          features);
+        SampleUtil::copy2WithGain(m_pMaster, m_pChannel1, 1.0,
+                                  m_pChannel2, 1.0, kNumSamples);
+        m_pChain->sendToBus("[Channel1]", m_pChannel1, 1.0, kNumSamples);
+        m_pChain->sendToBus("[Channel2]", m_pChannel2, 1.0, kNumSamples);
+        m_pChain->processBus(m_pMaster, kNumSamples, kSampleRate);
+        m_pChain->onCallbackEnd(kNumSamples, kSampleRate);
+    }
+
+    // The largest step between two frames of the master.
+    CSAMPLE maxMasterStep() const {
+        CSAMPLE step = 0;
+        for (unsigned int i = 2; i < kNumSamples; ++i) {
+            step = math_max(step, static_cast<CSAMPLE>(
+                fabs(m_pMaster[i] - m_pMaster[i - 2])));
+        }
+        return step;
+    }
+
+    EffectsRequestPipe* m_pRequestPipe;
+    EffectsResponsePipe* m_pResponsePipe;
+    EngineEffectChain* m_pChain;
+    DoublingProcessor* m_pProcessor;
+    EngineEffect* m_pEffect;
+    bool m_bBusGroupStateSent;
+    CSAMPLE* m_pChannel1;
+    CSAMPLE* m_pChannel2;
+    CSAMPLE* m_pMaster;
+};
+
+TEST_F(EngineEffectChainTest, BusIsProcessedOnceAndMixedAtChainMix) {
+    // Let the sends and the return ramp in.
+    callback();
+    callback();
+    m_pProcessor->m_calls.clear();
+
+    callback();
+    EXPECT_EQ(0, m_pProcessor->m_calls.value("[Channel1]"));
+    EXPECT_EQ(0, m_pProcessor->m_calls.value("[Channel2]"));
+    EXPECT_EQ(1, m_pProcessor->m_calls.value(EngineEffectChain::busGroup()));
+
+    // The dry channels plus the doubled sum of the channels at the mix.
+    const CSAMPLE sum = kChannel1 + kChannel2;
+    for (unsigned int i = 0; i < kNumSamples; ++i) {
+        EXPECT_NEAR(sum + kMix * 2 * sum, m_pMaster[i], 1e-6);
+    }
+}
+
+TEST_F(EngineEffectChainTest, SwitchingToInsertRampsOutTheReturn) {
+    callback();
+    callback();
+    const CSAMPLE sum = kChannel1 + kChannel2;
+    const CSAMPLE busLevel = sum + kMix * 2 * sum;
+    const CSAMPLE insertLevel = sum * (1 - kMix) + sum * 2 * kMix;
+
+    setParameters(EffectChain::INSERT, true);
+    callback();
+    EXPECT_NEAR(busLevel, m_pMaster[0], 0.01);
+    EXPECT_NEAR(insertLevel, m_pMaster[kNumSamples - 1], 1e-6);
+    EXPECT_GT(0.01, maxMasterStep());
+
+    // And back.
+    setParameters(EffectChain::BUS, true);
+    callback();
+    EXPECT_NEAR(insertLevel, m_pMaster[0], 0.01);
+    EXPECT_NEAR(busLevel, m_pMaster[kNumSamples - 1], 1e-6);
+    EXPECT_GT(0.01, maxMasterStep());
+}
+
+TEST_F(EngineEffectChainTest, DisablingRampsOutTheReturn) {
+    callback();
+    callback();
+    const CSAMPLE sum = kChannel1 + kChannel2;
+
+    setParameters(EffectChain::BUS, false);
+    callback();
+    EXPECT_NEAR(sum + kMix * 2 * sum, m_pMaster[0], 0.01);
+    EXPECT_NEAR(sum, m_pMaster[kNumSamples - 1], 1e-6);
+    EXPECT_GT(0.01, maxMasterStep());
+
+    m_pProcessor->m_calls.clear();
+    callback();
+    EXPECT_EQ(0, m_pProcessor->m_calls.value(EngineEffectChain::busGroup()));
+    EXPECT_NEAR(sum, m_pMaster[0], 1e-6);
+}
+
+TEST_F(EngineEffectChainTest, GroupAddedAfterLoadIsProcessedOncePrepared) {
+    setParameters(EffectChain::INSERT, true);
+    // Like a sampler that was added after the effect was loaded.
+    enableForGroup("[Sampler1]");
+    m_pChain->prepareGroup("[Sampler1]");
+
+    SampleUtil::fill(m_pChannel1, kChannel1, kNumSamples);
+    GroupFeatureState features;
+    m_pChain->process("[Sampler1]", m_pChannel1, kNumSamples, kSampleRate,
+                      features);
+    EXPECT_EQ(1, m_pProcessor->m_calls.value("[Sampler1]"));
+}
+
+}  // namespace
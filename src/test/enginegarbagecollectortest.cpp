@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <QScopedPointer>
+
+#include "engine/enginegarbagecollector.h"
+
+namespace {
+
+class Tracked {
+  public:
+    explicit Tracked(int* pDeleted)
+            : m_pDeleted(pDeleted) {
+    }
+    ~Tracked() {
+        ++(*m_pDeleted);
+    }
+
+  private:
+    int* m_pDeleted;
+};
+
+class EngineGarbageCollectorTest : public testing::Test {
+  protected:
+    virtual void SetUp() {
+        m_iDeleted = 0;
+        // The collector thread is not started so that the tests decide when
+        // collect() runs.
+        m_pCollector.reset(new EngineGarbageCollector());
+    }
+
+    int m_iDeleted;
+    QScopedPointer<EngineGarbageCollector> m_pCollector;
+};
+
+TEST_F(EngineGarbageCollectorTest, EngineRetiredObjectsOutliveTheCallback) {
+    m_pCollector->onCallbackStart();
+    m_pCollector->retireFromEngine(new Tracked(&m_iDeleted));
+    EXPECT_EQ(0, m_pCollector->collect());
+    EXPECT_EQ(0, m_iDeleted);
+    m_pCollector->onCallbackEnd();
+
+    EXPECT_EQ(1, m_pCollector->collect());
+    EXPECT_EQ(1, m_iDeleted);
+}
+
+TEST_F(EngineGarbageCollectorTest, RetireWhileEngineIsIdle) {
+    m_pCollector->onCallbackStart();
+    m_pCollector->onCallbackEnd();
+
+    m_pCollector->retire(new Tracked(&m_iDeleted));
+    EXPECT_EQ(1, m_pCollector->collect());
+    EXPECT_EQ(1, m_iDeleted);
+}
+
+TEST_F(EngineGarbageCollectorTest, RetireDuringCallback) {
+    m_pCollector->onCallbackStart();
+    // Another thread unlinks an object the running callback may still use.
+    m_pCollector->retire(new Tracked(&m_iDeleted));
+    EXPECT_EQ(0, m_pCollector->collect());
+    m_pCollector->onCallbackEnd();
+
+    // A callback that started afterwards cannot see the object.
+    m_pCollector->onCallbackStart();
+    m_pCollector->retire(new Tracked(&m_iDeleted));
+    EXPECT_EQ(1, m_pCollector->collect());
+    EXPECT_EQ(1, m_iDeleted);
+    m_pCollector->onCallbackEnd();
+    EXPECT_EQ(1, m_pCollector->collect());
+    EXPECT_EQ(2, m_iDeleted);
+}
+
+TEST_F(EngineGarbageCollectorTest, DestructorFreesPendingObjects) {
+    m_pCollector->onCallbackStart();
+    m_pCollector->retireFromEngine(new Tracked(&m_iDeleted));
+    m_pCollector->retire(new Tracked(&m_iDeleted));
+    m_pCollector.reset();
+    EXPECT_EQ(2, m_iDeleted);
+}
+
+}  // namespace
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QCoreApplication>
+#include <QThread>
 #include <QtDebug>
 
 #include "util/types.h"
@@ -12,6 +14,7 @@
 
 #include "test/mixxxtest.h"
 
+using ::testing::NiceMock;
 using ::testing::Return;
 using ::testing::_;
 
@@ -35,6 +38,38 @@ class EngineChannelMock : public EngineChannel {
     MOCK_METHOD1(postProcess, void(const int iBufferSize));
 };
 
+// Calls EngineMaster::process() in a loop like the sound device callback.
+class RenderThread : public QThread {
+  public:
+    explicit RenderThread(EngineMaster* pMaster)
+            : m_pMaster(pMaster),
+              m_bStop(false),
+              m_iCallbacks(0) {
+    }
+
+    void stop() {
+        m_bStop = true;
+        wait();
+    }
+
+    int callbacks() const {
+        return m_iCallbacks;
+    }
+
+  protected:
+    void run() {
+        while (!m_bStop) {
+            m_pMaster->process(MAX_BUFFER_LEN);
+            ++m_iCallbacks;
+        }
+    }
+
+  private:
+    EngineMaster* m_pMaster;
+    volatile bool m_bStop;
+    volatile int m_iCallbacks;
+};
+
 class EngineMasterTest : public MixxxTest {
   protected:
     virtual void SetUp() {
@@ -46,6 +81,8 @@ class EngineMasterTest : public MixxxTest {
     virtual void TearDown() {
         delete m_pMaster;
         delete m_pMasterEnabled;
+        // Removed channels are deleted in the main thread.
+        QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
     }
 
     void ClearBuffer(CSAMPLE* pBuffer, int length) {
@@ -400,4 +437,68 @@ TEST_F(EngineMasterTest, SingleChannelPFLOutputWorks) {
     AssertWholeBufferEquals(pHeadphoneBuffer, 0.1f, MAX_BUFFER_LEN);
 }
 
+TEST_F(EngineMasterTest, RemoveChannel) {
+    EngineChannelMock* pChannel1 = new EngineChannelMock("[Test1]", EngineChannel::LEFT);
+    m_pMaster->addChannel(pChannel1);
+    EngineChannelMock* pChannel2 = new EngineChannelMock("[Test2]", EngineChannel::RIGHT);
+    m_pMaster->addChannel(pChannel2);
+
+    EXPECT_TRUE(m_pMaster->removeChannel("[Test1]"));
+    EXPECT_FALSE(m_pMaster->removeChannel("[Test1]"));
+    EXPECT_TRUE(m_pMaster->getChannel("[Test1]") == NULL);
+    EXPECT_EQ(pChannel2, m_pMaster->getChannel("[Test2]"));
+
+    // The removed channel is not processed anymore.
+    CSAMPLE* pChannelBuffer = const_cast<CSAMPLE*>(m_pMaster->getChannelBuffer("[Test2]"));
+    FillBuffer(pChannelBuffer, 0.2f, MAX_BUFFER_LEN);
+    EXPECT_CALL(*pChannel2, isActive())
+            .Times(1)
+            .WillOnce(Return(true));
+    EXPECT_CALL(*pChannel2, isMaster())
+            .Times(1)
+            .WillOnce(Return(true));
+    EXPECT_CALL(*pChannel2, isPFL())
+            .Times(1)
+            .WillOnce(Return(false));
+    EXPECT_CALL(*pChannel2, process(_, _))
+            .Times(1)
+            .WillOnce(Return());
+    m_pMaster->process(MAX_BUFFER_LEN);
+    AssertWholeBufferEquals(m_pMaster->getMasterBuffer(), 0.2f, MAX_BUFFER_LEN);
+}
+
+TEST_F(EngineMasterTest, AddAndRemoveChannelsWhileRendering) {
+    const int kIterations = 200;
+    const int kMaxChannels = 8;
+
+    RenderThread renderThread(m_pMaster);
+    renderThread.start();
+
+    QStringList groups;
+    for (int i = 0; i < kIterations; ++i) {
+        // Unique groups, because the controls of removed channels are only
+        // deleted once the main thread processes its events.
+        QString group = QString("[Stress%1]").arg(i);
+        NiceMock<EngineChannelMock>* pChannel = new NiceMock<EngineChannelMock>(
+                group.toLatin1().constData(), EngineChannel::CENTER);
+        ON_CALL(*pChannel, isActive()).WillByDefault(Return(true));
+        ON_CALL(*pChannel, isMaster()).WillByDefault(Return(true));
+        ON_CALL(*pChannel, isPFL()).WillByDefault(Return(i % 2 == 0));
+        m_pMaster->addChannel(pChannel);
+        groups.append(group);
+
+        if (groups.size() > kMaxChannels || i % 3 == 0) {
+            EXPECT_TRUE(m_pMaster->removeChannel(groups.takeFirst()));
+        }
+        QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+        QThread::yieldCurrentThread();
+    }
+
+    renderThread.stop();
+    EXPECT_GT(renderThread.callbacks(), 0);
+    foreach (const QString& group, groups) {
+        EXPECT_TRUE(m_pMaster->getChannel(group) != NULL);
+    }
+}
+
 }  // namespace
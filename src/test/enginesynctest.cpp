@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QCoreApplication>
 #include <QtDebug>
 
 #include "configobject.h"
@@ -1418,3 +1419,40 @@ TEST_F(EngineSyncTest, MasterBpmNeverZero) {
     EXPECT_EQ(128.0,
               ControlObject::getControl(ConfigKey(m_sInternalClockGroup, "bpm"))->get());
 }
+
+TEST_F(EngineSyncTest, RemoveMasterDeck) {
+    QScopedPointer<ControlObjectThread> pFileBpm1(getControlObjectThread(
+        ConfigKey(m_sGroup1, "file_bpm")));
+    pFileBpm1->set(128.0);
+    QScopedPointer<ControlObjectThread> pFileBpm2(getControlObjectThread(
+        ConfigKey(m_sGroup2, "file_bpm")));
+    pFileBpm2->set(128.0);
+
+    QScopedPointer<ControlObjectThread> pButtonMasterSync1(getControlObjectThread(
+            ConfigKey(m_sGroup1, "sync_mode")));
+    pButtonMasterSync1->slotSet(SYNC_MASTER);
+    QScopedPointer<ControlObjectThread> pButtonMasterSync2(getControlObjectThread(
+            ConfigKey(m_sGroup2, "sync_mode")));
+    pButtonMasterSync2->slotSet(SYNC_FOLLOWER);
+    ControlObject::getControl(ConfigKey(m_sGroup1, "play"))->set(1.0);
+    ControlObject::getControl(ConfigKey(m_sGroup2, "play"))->set(1.0);
+    ProcessBuffer();
+    assertIsMaster(m_sGroup1);
+
+    // Removing the master deck hands master over to the internal clock and
+    // EngineSync forgets the deck.
+    ASSERT_TRUE(m_pEngineMaster->removeChannel(m_sGroup1));
+    m_pChannel1 = NULL;
+    assertIsMaster(m_sInternalClockGroup);
+    assertIsFollower(m_sGroup2);
+    EXPECT_TRUE(m_pEngineSync->getSyncableForGroup(m_sGroup1) == NULL);
+
+    // Free the deck once no callback uses it anymore and keep rendering.
+    ProcessBuffer();
+    m_pEngineMaster->getGarbageCollector()->collect();
+    QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+    ProcessBuffer();
+    ProcessBuffer();
+    assertIsMaster(m_sInternalClockGroup);
+    assertIsFollower(m_sGroup2);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <QAtomicInt>
+#include <QVector>
+
+#include "engine/enginetaskpool.h"
+#include "util/sleepableqthread.h"
+
+namespace {
+
+class CountingTask : public EngineTaskPool::Task {
+  public:
+    CountingTask()
+            : m_iRuns(0),
+              m_pTotal(NULL) {
+    }
+
+    void setTotal(QAtomicInt* pTotal) {
+        m_pTotal = pTotal;
+    }
+
+    virtual void run() {
+        ++m_iRuns;
+        m_pTotal->fetchAndAddOrdered(1);
+    }
+
+    int m_iRuns;
+
+  private:
+    QAtomicInt* m_pTotal;
+};
+
+// Takes longer than run() is willing to spin for.
+class SleepingTask : public EngineTaskPool::Task {
+  public:
+    SleepingTask()
+            : m_done(0) {
+    }
+
+    virtual void run() {
+        SleepableQThread::msleep(20);
+        m_done.fetchAndStoreOrdered(1);
+    }
+
+    QAtomicInt m_done;
+};
+
+void runTasks(EngineTaskPool* pPool, int count) {
+    QAtomicInt total(0);
+    QVector<CountingTask> tasks(count);
+    QVector<EngineTaskPool::Task*> pointers;
+    for (int i = 0; i < count; ++i) {
+        tasks[i].setTotal(&total);
+        pointers.append(&tasks[i]);
+    }
+    pPool->run(pointers.constData(), pointers.size());
+
+    // run() returns only after every task ran exactly once.
+    EXPECT_EQ(count, static_cast<int>(total));
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(1, tasks[i].m_iRuns);
+    }
+}
+
+TEST(EngineTaskPoolTest, RunsTasksWithoutHelpers) {
+    EngineTaskPool pool(0);
+    EXPECT_EQ(0, pool.threadCount());
+    runTasks(&pool, 5);
+}
+
+TEST(EngineTaskPoolTest, RunsEveryTaskOnce) {
+    EngineTaskPool pool(3);
+    EXPECT_EQ(3, pool.threadCount());
+    for (int i = 0; i < 200; ++i) {
+        // Fewer, as many and more tasks than threads.
+        runTasks(&pool, i % 9);
+    }
+}
+
+TEST(EngineTaskPoolTest, WaitsForLongTasks) {
+    EngineTaskPool pool(3);
+    for (int i = 0; i < 5; ++i) {
+        SleepingTask tasks[4];
+        EngineTaskPool::Task* pointers[4] = {
+            &tasks[0], &tasks[1], &tasks[2], &tasks[3]
+        };
+        pool.run(pointers, 4);
+        for (int j = 0; j < 4; ++j) {
+            EXPECT_EQ(1, static_cast<int>(tasks[j].m_done));
+        }
+    }
+}
+
+}  // namespace
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <QtDebug>
+#include <QThread>
+#include <QVector>
+
+#include <math.h>
+
+#include "util/fft.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+// The textbook iterative radix-2 transform of the full complex sequence in
+// double precision, with the twiddle factors computed up front. The results
+// of FFT are compared to it and the benchmark measures against it.
+class ReferenceFFT {
+  public:
+    explicit ReferenceFFT(int size)
+            : m_size(size),
+              m_bitReverse(size),
+              m_cos(size / 2),
+              m_sin(size / 2) {
+        int bits = 0;
+        while ((1 << bits) < size) {
+            ++bits;
+        }
+        for (int i = 0; i < size; ++i) {
+            int reversed = 0;
+            for (int bit = 0; bit < bits; ++bit) {
+                if (i & (1 << bit)) {
+                    reversed |= 1 << (bits - 1 - bit);
+                }
+            }
+            m_bitReverse[i] = reversed;
+        }
+        for (int i = 0; i < size / 2; ++i) {
+            m_cos[i] = cos(2 * M_PI * i / size);
+            m_sin[i] = -sin(2 * M_PI * i / size);
+        }
+    }
+
+    void transform(const float* pIn, QVector<double>* pReal,
+                   QVector<double>* pImag) const {
+        pReal->resize(m_size);
+        pImag->resize(m_size);
+        double* pR = pReal->data();
+        double* pI = pImag->data();
+        for (int i = 0; i < m_size; ++i) {
+            pR[m_bitReverse[i]] = pIn[i];
+            pI[i] = 0.0;
+        }
+        for (int half = 1; half < m_size; half *= 2) {
+            const int twiddleStep = m_size / (half * 2);
+            for (int start = 0; start < m_size; start += half * 2) {
+                for (int i = 0; i < half; ++i) {
+                    const double wr = m_cos[i * twiddleStep];
+                    const double wi = m_sin[i * twiddleStep];
+                    const int even = start + i;
+                    const int odd = even + half;
+                    const double tr = wr * pR[odd] - wi * pI[odd];
+                    const double ti = wr * pI[odd] + wi * pR[odd];
+                    pR[odd] = pR[even] - tr;
+                    pI[odd] = pI[even] - ti;
+                    pR[even] += tr;
+                    pI[even] += ti;
+                }
+            }
+        }
+    }
+
+  private:
+    int m_size;
+    QVector<int> m_bitReverse;
+    QVector<double> m_cos;
+    QVector<double> m_sin;
+};
+
+QVector<float> makeSignal(int size) {
+    QVector<float> signal(size);
+    qsrand(size);
+    for (int i = 0; i < size; ++i) {
+        signal[i] = sin(2 * M_PI * 5 * i / size) +
+                0.5 * cos(2 * M_PI * 0.3 * i) +
+                0.2 * (static_cast<double>(qrand()) / RAND_MAX - 0.5);
+    }
+    return signal;
+}
+
+class FFTThread : public QThread {
+  public:
+    FFTThread(const QVector<float>& signal)
+            : m_signal(signal),
+              m_magnitudes(signal.size() / 2 + 1) {
+    }
+
+    const QVector<float>& magnitudes() const {
+        return m_magnitudes;
+    }
+
+  protected:
+    void run() {
+        for (int i = 0; i < 100; ++i) {
+            FFT fft(m_signal.size());
+            fft.magnitudes(m_signal.constData(), m_magnitudes.data());
+        }
+    }
+
+  private:
+    QVector<float> m_signal;
+    QVector<float> m_magnitudes;
+};
+
+class FFTTest : public testing::Test {
+};
+
+TEST_F(FFTTest, matchesDft) {
+    const int size = 64;
+    FFT fft(size);
+    QVector<float> signal = makeSignal(size);
+    QVector<float> magnitudes(fft.bins());
+    fft.magnitudes(signal.constData(), magnitudes.data());
+    for (int k = 0; k < fft.bins(); ++k) {
+        double real = 0.0;
+        double imag = 0.0;
+        for (int i = 0; i < size; ++i) {
+            real += signal[i] * cos(2 * M_PI * k * i / size);
+            imag -= signal[i] * sin(2 * M_PI * k * i / size);
+        }
+        EXPECT_NEAR(sqrt(real * real + imag * imag), magnitudes[k], 1e-4);
+    }
+}
+
+TEST_F(FFTTest, matchesReferenceForAllSizes) {
+    for (int size = 2; size <= 65536; size *= 2) {
+        FFT fft(size);
+        QVector<float> signal = makeSignal(size);
+        QVector<float> real(fft.bins());
+        QVector<float> imag(fft.bins());
+        fft.forward(signal.constData(), real.data(), imag.data());
+
+        QVector<double> referenceReal;
+        QVector<double> referenceImag;
+        ReferenceFFT(size).transform(signal.constData(),
+                                     &referenceReal, &referenceImag);
+        // Single precision loses a little with every stage.
+        const double tolerance = 1e-5 * sqrt(static_cast<double>(size)) *
+                log(static_cast<double>(size));
+        for (int k = 0; k < fft.bins(); ++k) {
+            ASSERT_NEAR(referenceReal[k], real[k], tolerance)
+                    << "size " << size << " bin " << k;
+            ASSERT_NEAR(referenceImag[k], imag[k], tolerance)
+                    << "size " << size << " bin " << k;
+        }
+    }
+}
+
+TEST_F(FFTTest, inverseRestoresSignal) {
+    for (int size = 2; size <= 65536; size *= 2) {
+        FFT fft(size);
+        QVector<float> signal = makeSignal(size);
+        QVector<float> real(fft.bins());
+        QVector<float> imag(fft.bins());
+        QVector<float> output(size);
+        fft.forward(signal.constData(), real.data(), imag.data());
+        fft.inverse(real.constData(), imag.constData(), output.data());
+        for (int i = 0; i < size; ++i) {
+            ASSERT_NEAR(signal[i], output[i] / size, 1e-5)
+                    << "size " << size << " sample " << i;
+        }
+    }
+}
+
+TEST_F(FFTTest, plansAreShared) {
+    EXPECT_EQ(FFT::plan(1024).data(), FFT::plan(1024).data());
+    EXPECT_NE(FFT::plan(1024).data(), FFT::plan(2048).data());
+    EXPECT_EQ(2048, FFT::plan(2048)->size);
+}
+
+TEST_F(FFTTest, concurrentTransforms) {
+    const int size = 4096;
+    QVector<float> signal = makeSignal(size);
+    QVector<float> expected(size / 2 + 1);
+    FFT(size).magnitudes(signal.constData(), expected.data());
+
+    QList<FFTThread*> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.append(new FFTThread(signal));
+    }
+    foreach (FFTThread* pThread, threads) {
+        pThread->start();
+    }
+    foreach (FFTThread* pThread, threads) {
+        pThread->wait();
+        for (int k = 0; k < expected.size(); ++k) {
+            ASSERT_FLOAT_EQ(expected[k], pThread->magnitudes()[k]);
+        }
+        delete pThread;
+    }
+}
+
+// Compares the time of a transform with the reference implementation. Only
+// logs the result, slow machines don't fail.
+TEST_F(FFTTest, benchmark) {
+    const int sizes[] = { 256, 1024, 4096, 65536 };
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        const int size = sizes[s];
+        const int runs = 4 * 1024 * 1024 / size;
+        QVector<float> signal = makeSignal(size);
+        QVector<double> referenceReal;
+        QVector<double> referenceImag;
+        ReferenceFFT reference(size);
+        FFT fft(size);
+        QVector<float> real(fft.bins());
+        QVector<float> imag(fft.bins());
+
+        PerformanceTimer timer;
+        timer.start();
+        for (int i = 0; i < runs; ++i) {
+            reference.transform(signal.constData(), &referenceReal, &referenceImag);
+        }
+        qint64 referenceElapsed = timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            fft.forward(signal.constData(), real.data(), imag.data());
+        }
+        qint64 elapsed = timer.elapsed();
+
+        qDebug() << "FFT size" << size << ":" << elapsed / runs
+                 << "ns, reference" << referenceElapsed / runs << "ns,"
+                 << static_cast<double>(referenceElapsed) / elapsed << "times faster";
+    }
+}
+
+}  // namespace
@@ -0,0 +1,96 @@
+/*
+ * A minimal LV2 plugin for lv2backendtest: a stereo amplifier whose gain is
+ * a linear factor. It is built into src/test/lv2/mixxx_test_gain.lv2.
+ */
+
+#include <stdlib.h>
+
+#include <lv2/lv2plug.in/ns/lv2core/lv2.h>
+
+#define GAIN_URI "urn:mixxx:test:gain"
+
+enum {
+    GAIN_GAIN = 0,
+    GAIN_INPUT_L = 1,
+    GAIN_INPUT_R = 2,
+    GAIN_OUTPUT_L = 3,
+    GAIN_OUTPUT_R = 4,
+    GAIN_PEAK = 5
+};
+
+typedef struct {
+    const float* gain;
+    const float* input[2];
+    float* output[2];
+    float* peak;
+} Gain;
+
+static LV2_Handle instantiate(const LV2_Descriptor* descriptor,
+                              double rate,
+                              const char* bundle_path,
+                              const LV2_Feature* const* features) {
+    (void)descriptor;
+    (void)rate;
+    (void)bundle_path;
+    (void)features;
+    return (LV2_Handle)calloc(1, sizeof(Gain));
+}
+
+static void connect_port(LV2_Handle instance, uint32_t port, void* data) {
+    Gain* gain = (Gain*)instance;
+    switch (port) {
+        case GAIN_GAIN:
+            gain->gain = (const float*)data;
+            break;
+        case GAIN_INPUT_L:
+        case GAIN_INPUT_R:
+            gain->input[port - GAIN_INPUT_L] = (const float*)data;
+            break;
+        case GAIN_OUTPUT_L:
+        case GAIN_OUTPUT_R:
+            gain->output[port - GAIN_OUTPUT_L] = (float*)data;
+            break;
+        case GAIN_PEAK:
+            gain->peak = (float*)data;
+            break;
+    }
+}
+
+static void run(LV2_Handle instance, uint32_t n_samples) {
+    Gain* gain = (Gain*)instance;
+    const float factor = *gain->gain;
+    float peak = 0;
+    uint32_t i;
+    int channel;
+    for (channel = 0; channel < 2; ++channel) {
+        for (i = 0; i < n_samples; ++i) {
+            const float sample = gain->input[channel][i] * factor;
+            gain->output[channel][i] = sample;
+            if (sample > peak) {
+                peak = sample;
+            } else if (-sample > peak) {
+                peak = -sample;
+            }
+        }
+    }
+    *gain->peak = peak;
+}
+
+static void cleanup(LV2_Handle instance) {
+    free(instance);
+}
+
+static const LV2_Descriptor descriptor = {
+    GAIN_URI,
+    instantiate,
+    connect_port,
+    NULL,  /* activate */
+    run,
+    NULL,  /* deactivate */
+    cleanup,
+    NULL   /* extension_data */
+};
+
+LV2_SYMBOL_EXPORT const LV2_Descriptor* lv2_descriptor(uint32_t index) {
+    return index == 0 ? &descriptor : NULL;
+}
@@ -0,0 +1,297 @@
+#ifdef __LILV__
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QThread>
+
+#include "effects/lv2/lv2backend.h"
+#include "effects/lv2/lv2effectprocessor.h"
+#include "effects/lv2/lv2manifestindex.h"
+#include "effects/lv2/lv2worker.h"
+#include "engine/effects/engineeffect.h"
+#include "sampleutil.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+class LV2ManifestIndexTest : public testing::Test {
+  protected:
+    LV2ManifestIndexTest()
+            : m_indexPath(QDir::temp().filePath("mixxx_lv2_index_test.dat")) {
+    }
+
+    virtual void TearDown() {
+        QFile::remove(m_indexPath);
+    }
+
+    LV2Manifest makeManifest() {
+        LV2Manifest manifest;
+        manifest.setUri("urn:mixxx:test:amp");
+        manifest.setBundleUri("file:///usr/lib/lv2/amp.lv2/");
+        manifest.setStatus(LV2Manifest::AVAILABLE);
+        manifest.setUsesWorker(true);
+        manifest.effectManifestPointer()->setId(manifest.uri());
+        manifest.effectManifestPointer()->setName("Amp");
+        manifest.addPort(LV2Manifest::PORT_CONTROL_INPUT);
+        manifest.addPort(LV2Manifest::PORT_AUDIO_INPUT);
+        manifest.addPort(LV2Manifest::PORT_AUDIO_INPUT);
+        manifest.addPort(LV2Manifest::PORT_AUDIO_OUTPUT);
+        manifest.addPort(LV2Manifest::PORT_AUDIO_OUTPUT);
+        manifest.addPort(LV2Manifest::PORT_OPTIONAL);
+        EffectManifestParameter* pParameter =
+                manifest.effectManifestPointer()->addParameter();
+        pParameter->setId("gain");
+        pParameter->setName("Gain");
+        pParameter->setControlHint(EffectManifestParameter::CONTROL_KNOB_LINEAR);
+        pParameter->setMinimum(-90);
+        pParameter->setMaximum(24);
+        pParameter->setDefault(0);
+        return manifest;
+    }
+
+    QString m_indexPath;
+};
+
+TEST_F(LV2ManifestIndexTest, SaveAndLoad) {
+    LV2ManifestIndex::Fingerprint fingerprint;
+    fingerprint.append(qMakePair(QString("/usr/lib/lv2/amp.lv2/manifest.ttl"),
+                                 static_cast<qint64>(1234)));
+
+    LV2ManifestIndex index;
+    index.setFingerprint(fingerprint);
+    index.addManifest(makeManifest());
+    ASSERT_TRUE(index.save(m_indexPath));
+
+    LV2ManifestIndex loaded;
+    ASSERT_TRUE(loaded.load(m_indexPath));
+    EXPECT_TRUE(loaded.fingerprint() == fingerprint);
+    ASSERT_EQ(1, loaded.manifests().size());
+
+    const LV2Manifest& manifest = loaded.manifests().first();
+    EXPECT_TRUE(manifest.isAvailable());
+    EXPECT_TRUE(manifest.usesWorker());
+    EXPECT_STREQ("urn:mixxx:test:amp", qPrintable(manifest.uri()));
+    EXPECT_EQ(6, manifest.numPorts());
+    EXPECT_EQ(LV2Manifest::PORT_OPTIONAL, manifest.portType(5));
+    ASSERT_EQ(2, manifest.audioInputPorts().size());
+    EXPECT_EQ(1, manifest.audioInputPorts()[0]);
+    EXPECT_EQ(2, manifest.audioInputPorts()[1]);
+    ASSERT_EQ(1, manifest.controlInputPorts().size());
+    EXPECT_EQ(0, manifest.controlInputPorts()[0]);
+
+    const QList<EffectManifestParameter>& parameters =
+            manifest.effectManifest().parameters();
+    ASSERT_EQ(1, parameters.size());
+    EXPECT_STREQ("gain", qPrintable(parameters[0].id()));
+    EXPECT_DOUBLE_EQ(-90, parameters[0].getMinimum());
+    EXPECT_DOUBLE_EQ(24, parameters[0].getMaximum());
+}
+
+TEST_F(LV2ManifestIndexTest, CorruptIndexIsRejected) {
+    QFile file(m_indexPath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("not an index");
+    file.close();
+
+    LV2ManifestIndex index;
+    EXPECT_FALSE(index.load(m_indexPath));
+    EXPECT_TRUE(index.manifests().isEmpty());
+}
+
+// A plugin whose work() answers every request with the request incremented
+// by one.
+struct FakePlugin {
+    FakePlugin()
+            : lastResponse(0),
+              numResponses(0),
+              numEndRuns(0) {
+    }
+    int lastResponse;
+    int numResponses;
+    int numEndRuns;
+};
+
+LV2_Worker_Status fakeWork(LV2_Handle instance,
+                           LV2_Worker_Respond_Function respond,
+                           LV2_Worker_Respond_Handle handle,
+                           uint32_t size, const void* data) {
+    Q_UNUSED(instance);
+    EXPECT_EQ(sizeof(int), size);
+    int response = *static_cast<const int*>(data) + 1;
+    return respond(handle, sizeof(response), &response);
+}
+
+LV2_Worker_Status fakeWorkResponse(LV2_Handle instance,
+                                   uint32_t size, const void* body) {
+    EXPECT_EQ(sizeof(int), size);
+    FakePlugin* pPlugin = static_cast<FakePlugin*>(instance);
+    pPlugin->lastResponse = *static_cast<const int*>(body);
+    ++pPlugin->numResponses;
+    return LV2_WORKER_SUCCESS;
+}
+
+LV2_Worker_Status fakeEndRun(LV2_Handle instance) {
+    ++static_cast<FakePlugin*>(instance)->numEndRuns;
+    return LV2_WORKER_SUCCESS;
+}
+
+class SleepThread : public QThread {
+  public:
+    static void msleep(unsigned long msecs) {
+        QThread::msleep(msecs);
+    }
+};
+
+TEST(LV2WorkerTest, RequestsAreAnsweredInTheAudioThread) {
+    LV2WorkerThread thread;
+    thread.start();
+
+    FakePlugin plugin;
+    LV2_Worker_Interface workerInterface;
+    workerInterface.work = &fakeWork;
+    workerInterface.work_response = &fakeWorkResponse;
+    workerInterface.end_run = &fakeEndRun;
+
+    LV2Worker worker(&thread);
+    worker.setInterface(&workerInterface, &plugin);
+
+    const LV2_Worker_Schedule* pSchedule =
+            static_cast<const LV2_Worker_Schedule*>(
+                    worker.scheduleFeature()->data);
+    int request = 41;
+    ASSERT_EQ(LV2_WORKER_SUCCESS,
+              pSchedule->schedule_work(pSchedule->handle,
+                                       sizeof(request), &request));
+
+    // Responses are only delivered by deliverResponses(), never by the worker
+    // thread itself.
+    for (int i = 0; i < 1000 && plugin.numResponses == 0; ++i) {
+        SleepThread::msleep(1);
+        worker.deliverResponses();
+    }
+    EXPECT_EQ(1, plugin.numResponses);
+    EXPECT_EQ(42, plugin.lastResponse);
+    EXPECT_LE(1, plugin.numEndRuns);
+}
+
+TEST(LV2WorkerTest, OversizedRequestIsRefused) {
+    LV2WorkerThread thread;
+    thread.start();
+
+    FakePlugin plugin;
+    LV2_Worker_Interface workerInterface;
+    workerInterface.work = &fakeWork;
+    workerInterface.work_response = &fakeWorkResponse;
+    workerInterface.end_run = &fakeEndRun;
+
+    LV2Worker worker(&thread);
+    worker.setInterface(&workerInterface, &plugin);
+
+    const LV2_Worker_Schedule* pSchedule =
+            static_cast<const LV2_Worker_Schedule*>(
+                    worker.scheduleFeature()->data);
+    QByteArray request(1024 * 1024, 'x');
+    EXPECT_EQ(LV2_WORKER_ERR_NO_SPACE,
+              pSchedule->schedule_work(pSchedule->handle,
+                                       request.size(), request.constData()));
+}
+
+class LV2ProcessorInstantiator : public EffectInstantiator {
+  public:
+    LV2ProcessorInstantiator(const LV2Manifest& manifest, LV2Backend* pBackend)
+            : m_manifest(manifest),
+              m_pBackend(pBackend) {
+    }
+
+    EffectProcessor* instantiate(EngineEffect* pEngineEffect,
+                                 const EffectManifest& manifest) {
+        Q_UNUSED(manifest);
+        return new LV2EffectProcessor(pEngineEffect, m_manifest, m_pBackend);
+    }
+
+  private:
+    LV2Manifest m_manifest;
+    LV2Backend* m_pBackend;
+};
+
+// Points LV2_PATH at src/test/lv2, which holds the mixxx_test_gain.lv2
+// bundle. Its binary is built with the tests.
+class LV2BackendTest : public MixxxTest {
+  protected:
+    virtual void SetUp() {
+        m_oldLv2Path = qgetenv("LV2_PATH");
+        qputenv("LV2_PATH", QDir::currentPath().append("/src/test/lv2")
+                .toLocal8Bit());
+    }
+
+    virtual void TearDown() {
+        qputenv("LV2_PATH", m_oldLv2Path);
+    }
+
+    QByteArray m_oldLv2Path;
+};
+
+TEST_F(LV2BackendTest, ProcessesTheTestPlugin) {
+    LV2Backend backend(NULL, config());
+    const LV2Manifest* pManifest = NULL;
+    foreach (const LV2Manifest& manifest, backend.manifests()) {
+        if (manifest.uri() == "urn:mixxx:test:gain") {
+            pManifest = &manifest;
+            break;
+        }
+    }
+    ASSERT_TRUE(pManifest != NULL);
+    ASSERT_TRUE(pManifest->isAvailable());
+    ASSERT_EQ(6, pManifest->numPorts());
+    EXPECT_EQ(LV2Manifest::PORT_CONTROL_OUTPUT, pManifest->portType(5));
+
+    QSet<QString> groups;
+    groups << "[Channel1]" << "[Channel2]";
+    EngineEffect effect(pManifest->effectManifest(), groups,
+                        EffectInstantiatorPointer(
+                                new LV2ProcessorInstantiator(*pManifest,
+                                                             &backend)));
+    EngineEffectParameter* pGain = effect.getParameterById("gain");
+    ASSERT_TRUE(pGain != NULL);
+    EXPECT_DOUBLE_EQ(1.0, pGain->value());
+
+    const unsigned int numSamples = 1024;
+    CSAMPLE* pInput = SampleUtil::alloc(numSamples);
+    CSAMPLE* pOutput = SampleUtil::alloc(numSamples);
+    for (unsigned int i = 0; i < numSamples; ++i) {
+        pInput[i] = (i % 64) / 64.0f - 0.5f;
+    }
+    GroupFeatureState features;
+    // Skip the fade in of a newly loaded effect.
+    effect.onCallbackEnd();
+    const float gains[] = { 0.5f, 2.0f, 0.0f };
+    for (int callback = 0; callback < 3; ++callback) {
+        pGain->setValue(gains[callback]);
+        // Each group has its own instance of the plugin.
+        const char* groupNames[] = { "[Channel1]", "[Channel2]" };
+        for (int group = 0; group < 2; ++group) {
+            SampleUtil::fill(pOutput, 100.0f, numSamples);
+            effect.process(groupNames[group], pInput, pOutput, numSamples,
+                           44100, EffectProcessor::ENABLED, features);
+            for (unsigned int i = 0; i < numSamples; ++i) {
+                ASSERT_FLOAT_EQ(pInput[i] * gains[callback], pOutput[i]);
+            }
+        }
+        effect.onCallbackEnd();
+    }
+
+    // Groups the processor has no instance for pass through unchanged.
+    effect.process("[Channel3]", pInput, pOutput, numSamples, 44100,
+                   EffectProcessor::ENABLED, features);
+    for (unsigned int i = 0; i < numSamples; ++i) {
+        ASSERT_FLOAT_EQ(pInput[i], pOutput[i]);
+    }
+    SampleUtil::free(pInput);
+    SampleUtil::free(pOutput);
+}
+
+}  // namespace
+
+#endif  // __LILV__
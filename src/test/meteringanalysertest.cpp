@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <QtDebug>
+#include <QVector>
+
+#include <math.h>
+
+#include "engine/metering/meteringanalyser.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+class MeteringAnalyserTest : public testing::Test {
+  protected:
+    // A sine of the same phase in both channels.
+    static QVector<CSAMPLE> makeSine(int sampleRate, double frequency,
+                                     double amplitude, double phase,
+                                     double seconds) {
+        const int frames = static_cast<int>(seconds * sampleRate);
+        QVector<CSAMPLE> samples(2 * frames);
+        for (int i = 0; i < frames; ++i) {
+            const CSAMPLE value = amplitude *
+                    sin(2 * M_PI * frequency * i / sampleRate + phase);
+            samples[2 * i] = value;
+            samples[2 * i + 1] = value;
+        }
+        return samples;
+    }
+
+    static void feed(MeteringAnalyser* pAnalyser, const QVector<CSAMPLE>& samples) {
+        // Blocks of the size the metering thread reads.
+        const int blockSize = 2048;
+        for (int i = 0; i < samples.size(); i += blockSize) {
+            pAnalyser->process(samples.constData() + i,
+                               qMin(blockSize, samples.size() - i));
+        }
+    }
+};
+
+TEST_F(MeteringAnalyserTest, silence) {
+    MeteringAnalyser analyser(44100);
+    QVector<CSAMPLE> samples(2 * 44100, 0.0f);
+    feed(&analyser, samples);
+    EXPECT_DOUBLE_EQ(MeteringAnalyser::kMinimumLevel, analyser.momentaryLoudness());
+    EXPECT_DOUBLE_EQ(MeteringAnalyser::kMinimumLevel, analyser.shortTermLoudness());
+    EXPECT_DOUBLE_EQ(MeteringAnalyser::kMinimumLevel, analyser.takeTruePeak());
+    double bands[MeteringAnalyser::kSpectrumBands];
+    analyser.spectrum(bands);
+    for (int band = 0; band < MeteringAnalyser::kSpectrumBands; ++band) {
+        EXPECT_DOUBLE_EQ(0.0, bands[band]);
+    }
+}
+
+// A 1 kHz sine at -20 dBFS in both channels reads -20 LUFS. K-weighting
+// raises 1 kHz by the 0.691 dB the loudness formula subtracts.
+TEST_F(MeteringAnalyserTest, loudnessOfSine) {
+    const int sampleRates[] = { 44100, 48000, 96000 };
+    for (int i = 0; i < 3; ++i) {
+        MeteringAnalyser analyser(sampleRates[i]);
+        feed(&analyser, makeSine(sampleRates[i], 1000.0, 0.1, 0.0, 4.0));
+        EXPECT_NEAR(-20.0, analyser.momentaryLoudness(), 0.1)
+                << "sample rate " << sampleRates[i];
+        EXPECT_NEAR(-20.0, analyser.shortTermLoudness(), 0.1)
+                << "sample rate " << sampleRates[i];
+    }
+}
+
+TEST_F(MeteringAnalyserTest, shortTermIsSlowerThanMomentary) {
+    MeteringAnalyser analyser(48000);
+    feed(&analyser, makeSine(48000, 1000.0, 0.1, 0.0, 4.0));
+    feed(&analyser, QVector<CSAMPLE>(2 * 48000, 0.0f));
+    EXPECT_DOUBLE_EQ(MeteringAnalyser::kMinimumLevel, analyser.momentaryLoudness());
+    // 2 of the 3 seconds are still loud, 10 log10(2/3) below -20 LUFS.
+    EXPECT_NEAR(-21.76, analyser.shortTermLoudness(), 0.1);
+}
+
+// A sine at a quarter of the sample rate, sampled 45 degrees off its peaks,
+// has sample peaks 3 dB below its true peak.
+TEST_F(MeteringAnalyserTest, truePeakBetweenSamples) {
+    MeteringAnalyser analyser(48000);
+    feed(&analyser, makeSine(48000, 12000.0, 0.5, M_PI / 4, 1.0));
+    EXPECT_NEAR(-6.02, analyser.takeTruePeak(), 0.3);
+    // Taking the peak resets it. The oversampling filter still rings at the
+    // start of the silence, so skip that.
+    QVector<CSAMPLE> silence(2 * 48000, 0.0f);
+    feed(&analyser, silence);
+    analyser.takeTruePeak();
+    feed(&analyser, silence);
+    EXPECT_DOUBLE_EQ(MeteringAnalyser::kMinimumLevel, analyser.takeTruePeak());
+}
+
+TEST_F(MeteringAnalyserTest, spectrumOfSine) {
+    MeteringAnalyser analyser(44100);
+    feed(&analyser, makeSine(44100, 1000.0, 1.0, 0.0, 1.0));
+    double bands[MeteringAnalyser::kSpectrumBands];
+    analyser.spectrum(bands);
+    int loudest = 0;
+    for (int band = 0; band < MeteringAnalyser::kSpectrumBands; ++band) {
+        if (bands[band] > bands[loudest]) {
+            loudest = band;
+        }
+    }
+    // 40 Hz to 16 kHz in 16 bands, 1 kHz is in the 9th.
+    EXPECT_EQ(8, loudest);
+    EXPECT_NEAR(1.0, bands[loudest], 0.05);
+    EXPECT_LT(bands[0], 0.2);
+    EXPECT_LT(bands[MeteringAnalyser::kSpectrumBands - 1], 0.2);
+}
+
+// Logs how much of a core metering a channel takes. Only logs the result,
+// slow machines don't fail.
+TEST_F(MeteringAnalyserTest, benchmark) {
+    const int sampleRate = 44100;
+    QVector<CSAMPLE> samples = makeSine(sampleRate, 440.0, 0.5, 0.0, 10.0);
+    MeteringAnalyser analyser(sampleRate);
+    double bands[MeteringAnalyser::kSpectrumBands];
+    PerformanceTimer timer;
+    timer.start();
+    // Ten seconds, read at 30 Hz like the metering thread.
+    const int updateSize = 2 * sampleRate / 30;
+    for (int i = 0; i < samples.size(); i += updateSize) {
+        analyser.process(samples.constData() + i,
+                         qMin(updateSize, samples.size() - i));
+        analyser.momentaryLoudness();
+        analyser.shortTermLoudness();
+        analyser.takeTruePeak();
+        analyser.spectrum(bands);
+    }
+    qint64 elapsed = timer.elapsed();
+    qDebug() << "Metering 10 s of a channel took" << elapsed / 1000000 << "ms,"
+             << elapsed / 1e8 << "% of a core";
+}
+
+}  // namespace
@@ -41,6 +41,9 @@ MixxxTest::~MixxxTest() {
         delete pCDP->getCreatorCO();
     }
 
+    // Writes out everything the test saved before the files are deleted.
+    m_pConfig.reset();
+
     // recursivly delete all config files used for the test.
     // TODO(kain88) --
     //     switch to use QDir::removeRecursivly() once we switched to Qt5.
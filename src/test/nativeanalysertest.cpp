@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <QtDebug>
+#include <QVector>
+
+#include <math.h>
+
+#include "analysis/decimator.h"
+#include "analysis/nativebeattracker.h"
+#include "analysis/nativekeydetector.h"
+#include "util/fft.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+
+using namespace mixxx::track::io::key;
+
+namespace {
+
+const int kSampleRate = 44100;
+const int kBlockSize = 8192;
+
+class NativeAnalyserTest : public testing::Test {
+  protected:
+    // A kick drum on every beat and a hi-hat between the beats, starting at
+    // offset seconds.
+    static QVector<CSAMPLE> makeDrums(double bpm, double offset, double seconds) {
+        const int frames = static_cast<int>(seconds * kSampleRate);
+        const double period = 60.0 * kSampleRate / bpm;
+        QVector<CSAMPLE> samples(2 * frames, 0.0f);
+        qsrand(3);
+        for (double beat = offset * kSampleRate; beat < frames; beat += period) {
+            const int start = static_cast<int>(beat);
+            for (int i = 0; i < kSampleRate / 5 && start + i < frames; ++i) {
+                const double t = static_cast<double>(i) / kSampleRate;
+                const double frequency = 60 + 80 * exp(-t * 40);
+                const CSAMPLE value = 0.8 * exp(-t * 25) *
+                        sin(2 * M_PI * frequency * t);
+                samples[2 * (start + i)] += value;
+                samples[2 * (start + i) + 1] += value;
+            }
+            const int hat = static_cast<int>(beat + period / 2);
+            for (int i = 0; i < kSampleRate / 30 && hat + i < frames; ++i) {
+                const double t = static_cast<double>(i) / kSampleRate;
+                const CSAMPLE value = 0.2 * exp(-t * 120) *
+                        (static_cast<double>(qrand()) / RAND_MAX - 0.5);
+                samples[2 * (hat + i)] += value;
+                samples[2 * (hat + i) + 1] += value;
+            }
+        }
+        return samples;
+    }
+
+    // Plays the chords of a progression for two seconds each, four times.
+    // The notes are semitones relative to middle C.
+    static QVector<CSAMPLE> makeChords(const int chords[][3], int count) {
+        const int chordFrames = 2 * kSampleRate;
+        QVector<CSAMPLE> samples;
+        for (int repeat = 0; repeat < 4; ++repeat) {
+            for (int chord = 0; chord < count; ++chord) {
+                for (int i = 0; i < chordFrames; ++i) {
+                    const double t = static_cast<double>(i) / kSampleRate;
+                    double value = 0.0;
+                    for (int note = 0; note < 3; ++note) {
+                        const double frequency =
+                                261.6256 * pow(2.0, chords[chord][note] / 12.0);
+                        for (int harmonic = 1; harmonic <= 4; ++harmonic) {
+                            value += 0.15 / harmonic * exp(-t * 0.7) *
+                                    sin(2 * M_PI * frequency * harmonic * t);
+                        }
+                    }
+                    samples.append(value);
+                    samples.append(value);
+                }
+            }
+        }
+        return samples;
+    }
+
+    template <typename Analyser>
+    static void feed(Analyser* pAnalyser, const QVector<CSAMPLE>& samples) {
+        for (int i = 0; i < samples.size(); i += kBlockSize) {
+            pAnalyser->process(samples.constData() + i,
+                               math_min(kBlockSize, samples.size() - i));
+        }
+    }
+
+    // Checks the tempo and that the beats are on the kicks.
+    static void expectBeats(double bpm, double offset) {
+        QVector<CSAMPLE> samples = makeDrums(bpm, offset, 60.0);
+        NativeBeatTracker tracker(kSampleRate, false);
+        feed(&tracker, samples);
+        QVector<double> beats = tracker.finalise();
+
+        EXPECT_NEAR(bpm, tracker.bpm(), bpm * 0.01);
+        ASSERT_GT(beats.size(), static_cast<int>(bpm * 0.9));
+        const double period = 60.0 * kSampleRate / bpm;
+        double error = 0.0;
+        for (int i = 0; i < beats.size(); ++i) {
+            double deviation = fmod(beats[i] - offset * kSampleRate, period);
+            if (deviation > period / 2) {
+                deviation -= period;
+            } else if (deviation < -period / 2) {
+                deviation += period;
+            }
+            error += fabs(deviation);
+        }
+        // Within 20 ms on average.
+        EXPECT_LT(error / beats.size(), 0.020 * kSampleRate);
+    }
+
+    // Checks that the progression is detected in the given key for most of
+    // the track. Single chords may briefly suggest a neighbouring key.
+    static void expectKey(const int chords[][3], int count, ChromaticKey key) {
+        QVector<CSAMPLE> samples = makeChords(chords, count);
+        NativeKeyDetector detector(kSampleRate, false);
+        feed(&detector, samples);
+        KeyChangeList changes = detector.finalise();
+
+        ASSERT_FALSE(changes.isEmpty());
+        const double frames = samples.size() / 2;
+        double duration = 0.0;
+        for (int i = 0; i < changes.size(); ++i) {
+            const double end = i + 1 < changes.size() ?
+                    changes[i + 1].second : frames;
+            if (changes[i].first == key) {
+                duration += end - changes[i].second;
+            }
+        }
+        EXPECT_GT(duration, 0.6 * frames);
+    }
+};
+
+TEST_F(NativeAnalyserTest, decimatorKeepsPassbandRemovesAliases) {
+    Decimator decimator(4);
+    const int size = 4096;
+    const double binWidth = kSampleRate / 4.0 / size;
+    // A tone of about 1 kHz on the left and one that would fold back to
+    // about 4 kHz on the right, both in the center of an FFT bin.
+    const int passbandBin = 372;
+    const int aliasBin = 1476;
+    QVector<CSAMPLE> samples(2 * kSampleRate);
+    for (int i = 0; i < kSampleRate; ++i) {
+        const double t = static_cast<double>(i) / kSampleRate;
+        samples[2 * i] = 0.5 * sin(2 * M_PI * passbandBin * binWidth * t);
+        samples[2 * i + 1] = 0.5 * sin(
+                2 * M_PI * (kSampleRate / 4.0 + aliasBin * binWidth) * t);
+    }
+    QVector<float> output;
+    decimator.process(samples.constData(), samples.size(), &output);
+    ASSERT_NEAR(kSampleRate / 4, output.size(), 64);
+
+    FFT fft(size);
+    QVector<float> magnitudes(size / 2 + 1);
+    fft.magnitudes(output.constData() + 1024, magnitudes.data());
+    // The mono mix has half the amplitude of each channel.
+    const float passband = magnitudes[passbandBin];
+    EXPECT_NEAR(0.25 * size / 2, passband, 0.25 * size / 2 * 0.05);
+    EXPECT_LT(magnitudes[aliasBin], passband * 0.01);
+}
+
+TEST_F(NativeAnalyserTest, beatTrackerFindsTempoAndPhase) {
+    expectBeats(128.0, 0.3);
+    expectBeats(95.0, 0.1);
+    expectBeats(140.0, 0.5);
+    expectBeats(110.5, 0.2);
+}
+
+TEST_F(NativeAnalyserTest, beatTrackerSilence) {
+    QVector<CSAMPLE> samples(2 * 10 * kSampleRate, 0.0f);
+    NativeBeatTracker tracker(kSampleRate, false);
+    feed(&tracker, samples);
+    EXPECT_TRUE(tracker.finalise().isEmpty());
+}
+
+TEST_F(NativeAnalyserTest, keyDetectorFindsMajorAndMinor) {
+    // I-IV-V-I in C major.
+    const int cMajor[][3] = { { 0, 4, 7 }, { 5, 9, 12 }, { 7, 11, 14 }, { 0, 4, 7 } };
+    expectKey(cMajor, 4, C_MAJOR);
+    // i-iv-V-i in A minor.
+    const int aMinor[][3] = { { -3, 0, 4 }, { 2, 5, 9 }, { -1, 4, 8 }, { -3, 0, 4 } };
+    expectKey(aMinor, 4, A_MINOR);
+    // The same progressions transposed to F# major and E minor.
+    const int fSharpMajor[][3] = { { 6, 10, 13 }, { 11, 15, 18 }, { 13, 17, 20 }, { 6, 10, 13 } };
+    expectKey(fSharpMajor, 4, F_SHARP_MAJOR);
+    const int eMinor[][3] = { { 4, 7, 11 }, { 9, 12, 16 }, { 6, 11, 15 }, { 4, 7, 11 } };
+    expectKey(eMinor, 4, E_MINOR);
+}
+
+TEST_F(NativeAnalyserTest, estimateKeyOfChroma) {
+    // C, E and G.
+    const double cMajorTriad[12] = { 1, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0 };
+    EXPECT_EQ(C_MAJOR, NativeKeyDetector::estimateKey(cMajorTriad));
+    // A, C and E.
+    const double aMinorTriad[12] = { 1, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0 };
+    EXPECT_EQ(A_MINOR, NativeKeyDetector::estimateKey(aMinorTriad));
+    const double silence[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    EXPECT_EQ(INVALID, NativeKeyDetector::estimateKey(silence));
+}
+
+// Reports how many tracks of three minutes both analysers get through per
+// minute. Only logs the result, slow machines don't fail.
+TEST_F(NativeAnalyserTest, benchmark) {
+    QVector<CSAMPLE> samples = makeDrums(128.0, 0.0, 180.0);
+    PerformanceTimer timer;
+    timer.start();
+    NativeBeatTracker tracker(kSampleRate, false);
+    feed(&tracker, samples);
+    tracker.finalise();
+    qint64 beatsElapsed = timer.restart();
+    NativeKeyDetector detector(kSampleRate, false);
+    feed(&detector, samples);
+    detector.finalise();
+    qint64 keyElapsed = timer.elapsed();
+
+    qDebug() << "Native beat tracker:" << beatsElapsed / 1000000 << "ms,"
+             << 60e9 / beatsElapsed << "tracks/minute";
+    qDebug() << "Native key detector:" << keyElapsed / 1000000 << "ms,"
+             << 60e9 / keyElapsed << "tracks/minute";
+}
+
+}  // namespace
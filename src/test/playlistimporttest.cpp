@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+
+#include "library/parserm3u.h"
+#include "library/parsercsv.h"
+#include "test/librarytest.h"
+
+namespace {
+
+const QString kTestDataDir(QDir::currentPath() % "/src/test/id3-test-data");
+
+class PlaylistImportTest : public LibraryTest {
+  protected:
+    // The playlists and the files they refer to relatively are written to a
+    // directory of their own in the system temp path. QTemporaryDir would do
+    // this but needs Qt 5.
+    virtual void SetUp() {
+        m_playlistDir = QDir::tempPath() +
+                QString("/mixxx-playlistimporttest-%1")
+                .arg(QCoreApplication::applicationPid());
+        ASSERT_TRUE(QDir().mkpath(m_playlistDir));
+        ASSERT_TRUE(QFile::copy(kTestDataDir + "/artist.mp3",
+                                playlistPath("artist.mp3")));
+    }
+
+    virtual void TearDown() {
+        QDir dir(m_playlistDir);
+        foreach (const QString& fileName, dir.entryList(QDir::Files)) {
+            dir.remove(fileName);
+        }
+        QDir().rmdir(m_playlistDir);
+    }
+
+    QString playlistPath(const QString& fileName) {
+        return m_playlistDir + "/" + fileName;
+    }
+
+    void writePlaylist(const QString& fileName, const QString& contents) {
+        QFile file(playlistPath(fileName));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+        file.write(contents.toUtf8());
+    }
+
+    QString m_playlistDir;
+};
+
+TEST_F(PlaylistImportTest, M3uResolvesKnownRelativeAndExistingEntries) {
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    const QString knownLocation = kTestDataDir + "/cover-test.mp3";
+    ASSERT_NE(-1, trackDao.addTrack(knownLocation, false));
+
+    writePlaylist("import.m3u",
+                  "#EXTM3U\n"
+                  "#EXTINF\n" + knownLocation + "\n"
+                  "#EXTINF\nmissing.mp3\n"
+                  "#EXTINF\nartist.mp3\n"
+                  "#EXTINF\n" + kTestDataDir + "/cover-test.ogg\n");
+
+    ParserM3u parser;
+    parser.setTrackDAO(&trackDao);
+    QList<QString> locations = parser.parse(playlistPath("import.m3u"));
+
+    // Entries keep their order, the missing file is dropped and the relative
+    // one is found next to the playlist.
+    ASSERT_EQ(3, locations.size());
+    EXPECT_QSTRING_EQ(knownLocation, locations[0]);
+    EXPECT_QSTRING_EQ(playlistPath("artist.mp3"), locations[1]);
+    EXPECT_QSTRING_EQ(kTestDataDir + "/cover-test.ogg", locations[2]);
+}
+
+TEST_F(PlaylistImportTest, CsvWithoutLibrary) {
+    writePlaylist("import.csv",
+                  "\"#\",\"Location\"\n"
+                  "\"1\",\"artist.mp3\"\n"
+                  "\"2\",\"missing.mp3\"\n");
+
+    ParserCsv parser;
+    QList<QString> locations = parser.parse(playlistPath("import.csv"));
+
+    ASSERT_EQ(1, locations.size());
+    EXPECT_QSTRING_EQ(playlistPath("artist.mp3"), locations[0]);
+}
+
+TEST_F(PlaylistImportTest, InsertTracksIntoPlaylist) {
+    PlaylistDAO& playlistDao = collection()->getPlaylistDAO();
+    int playlistId = playlistDao.createPlaylist("import");
+    ASSERT_NE(-1, playlistId);
+    ASSERT_TRUE(playlistDao.appendTracksToPlaylist(
+            QList<int>() << 1 << 2 << 3, playlistId));
+
+    // Invalid ids are skipped without leaving a gap.
+    EXPECT_EQ(2, playlistDao.insertTracksIntoPlaylist(
+            QList<int>() << 10 << -1 << 11, playlistId, 2));
+    EXPECT_EQ(QList<int>() << 1 << 10 << 11 << 2 << 3,
+              playlistDao.getTrackIds(playlistId));
+    EXPECT_EQ(5, playlistDao.getMaxPosition(playlistId));
+}
+
+}  // namespace
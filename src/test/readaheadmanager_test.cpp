@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 
 #include <QtDebug>
+#include <QAtomicPointer>
 #include <QScopedPointer>
+#include <QThread>
+
+#include <cstdlib>
+#include <new>
 
 #include "mixxxtest.h"
 #include "cachingreader.h"
@@ -9,7 +14,88 @@
 #include "engine/enginecontrol.h"
 #include "engine/readaheadmanager.h"
 #include "sampleutil.h"
+#include "util/compatibility.h"
 #include "util/defs.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+// The thread whose heap allocations are counted, or NULL. Other threads of the
+// test binary, e.g. CachingReaderWorkers, never count.
+QAtomicPointer<void> s_countingThread(NULL);
+int s_iAllocations = 0;
+
+inline void countAllocation() {
+    void* countingThread = load_atomic_pointer(s_countingThread);
+    if (countingThread != NULL &&
+            countingThread == static_cast<void*>(QThread::currentThreadId())) {
+        ++s_iAllocations;
+    }
+}
+
+// Counts the allocations of the current thread while it is in scope.
+class ScopedAllocationCounter {
+  public:
+    ScopedAllocationCounter() {
+        s_iAllocations = 0;
+        s_countingThread.fetchAndStoreOrdered(
+                static_cast<void*>(QThread::currentThreadId()));
+    }
+    ~ScopedAllocationCounter() {
+        s_countingThread.fetchAndStoreOrdered(NULL);
+    }
+    int allocations() const {
+        return s_iAllocations;
+    }
+};
+
+}  // anonymous namespace
+
+#ifdef __GLIBC__
+// Qt containers grow with malloc and realloc, so count those. operator new
+// allocates with malloc as well.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+
+void* malloc(size_t size) {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, size_t size) {
+    countAllocation();
+    return __libc_realloc(p, size);
+}
+}  // extern "C"
+#else
+void* operator new(std::size_t size) {
+    countAllocation();
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) throw() {
+    std::free(p);
+}
+
+void operator delete[](void* p) throw() {
+    std::free(p);
+}
+#endif
 
 class StubReader : public CachingReader {
   public:
@@ -65,6 +151,41 @@ class StubLoopControl : public EngineControl {
     QList<double> m_processReturnValues;
 };
 
+// Loops between two samples like LoopingControl does.
+class StubLoopingControl : public EngineControl {
+  public:
+    StubLoopingControl(double loopStart, double loopEnd)
+        : EngineControl("[test]", NULL),
+          m_loopStart(loopStart),
+          m_loopEnd(loopEnd) { }
+
+    double nextTrigger(const double dRate,
+                       const double currentSample,
+                       const double totalSamples,
+                       const int iBufferSize) {
+        Q_UNUSED(currentSample);
+        Q_UNUSED(totalSamples);
+        Q_UNUSED(iBufferSize);
+        return dRate < 0 ? m_loopStart : m_loopEnd;
+    }
+
+    virtual double process(const double dRate,
+                           const double dCurrentSample,
+                           const double dTotalSamples,
+                           const int iBufferSize) {
+        Q_UNUSED(dTotalSamples);
+        Q_UNUSED(iBufferSize);
+        if (dRate < 0) {
+            return dCurrentSample <= m_loopStart ? m_loopEnd : kNoTrigger;
+        }
+        return dCurrentSample >= m_loopEnd ? m_loopStart : kNoTrigger;
+    }
+
+  private:
+    const double m_loopStart;
+    const double m_loopEnd;
+};
+
 class ReadAheadManagerTest : public MixxxTest {
   public:
     ReadAheadManagerTest() : m_pBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)) { }
@@ -106,3 +227,49 @@ TEST_F(ReadAheadManagerTest, InReverseLoopEnableSeekForward) {
     EXPECT_EQ(0, m_pReadAheadManager->getNextSamples(-1.0, m_pBuffer, 100));
     EXPECT_EQ(100, m_pReadAheadManager->getPlaypos());
 }
+
+TEST_F(ReadAheadManagerTest, LoopingInReverseWrapsTheLog) {
+    // A short loop is taken several times per callback, so the log holds many
+    // entries and wraps around. The playposition must stay inside the loop.
+    StubLoopingControl loop(1000, 1600);
+    ReadAheadManager manager(m_pReader.data());
+    manager.addEngineControl(&loop);
+    manager.setNewPlaypos(1000);
+
+    const int kCallbacks = 10000;
+    const int kSamplesPerCallback = 1024;
+    double playposition = 1000;
+    int forwardAllocations = 0;
+    int reverseAllocations = 0;
+
+    PerformanceTimer timer;
+    timer.start();
+    for (int i = 0; i < kCallbacks; ++i) {
+        // Change direction every 100 callbacks like when scratching.
+        const double rate = (i / 100) % 2 == 0 ? 1.0 : -1.0;
+        ScopedAllocationCounter counter;
+        // Read a bit more than is played, like the scalers do.
+        int samplesRead = 0;
+        for (int reads = 0; reads < 16 && samplesRead < kSamplesPerCallback + 64;
+                ++reads) {
+            samplesRead += manager.getNextSamples(
+                    rate, m_pBuffer + samplesRead,
+                    kSamplesPerCallback + 64 - samplesRead);
+        }
+        playposition = manager.getEffectiveVirtualPlaypositionFromLog(
+                playposition, kSamplesPerCallback);
+        if (rate < 0) {
+            reverseAllocations += counter.allocations();
+        } else {
+            forwardAllocations += counter.allocations();
+        }
+    }
+    qint64 elapsed = timer.elapsed();
+
+    EXPECT_EQ(0, forwardAllocations);
+    EXPECT_EQ(0, reverseAllocations);
+    EXPECT_LE(1000, playposition);
+    EXPECT_GE(1600, playposition);
+    qDebug() << "ReadAheadManager:" << elapsed / kCallbacks
+             << "ns per callback while looping";
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <QScopedPointer>
+
+#include "mixxxtest.h"
+#include "controlobject.h"
+#include "waveform/guitick.h"
+#include "widget/repaintscheduler.h"
+
+namespace {
+
+class TestClient : public RepaintScheduler::Client {
+  public:
+    TestClient()
+            : m_iRepaints(0) {
+    }
+
+    bool schedule() {
+        return scheduleRepaint();
+    }
+
+    virtual void onScheduledRepaint() {
+        ++m_iRepaints;
+    }
+
+    int m_iRepaints;
+};
+
+class RepaintSchedulerTest : public MixxxTest {
+  protected:
+    virtual void SetUp() {
+        m_dTickTime = 0.0;
+        m_pGuiTick.reset(new GuiTick());
+        RepaintScheduler::create();
+    }
+
+    virtual void TearDown() {
+        RepaintScheduler::destroy();
+        m_pGuiTick.reset();
+    }
+
+    void tick() {
+        m_dTickTime += 0.02;
+        ControlObject::set(ConfigKey("[Master]", "guiTickTime"), m_dTickTime);
+    }
+
+    QScopedPointer<GuiTick> m_pGuiTick;
+    double m_dTickTime;
+};
+
+TEST_F(RepaintSchedulerTest, CoalescesUpdatesPerTick) {
+    TestClient client;
+    EXPECT_TRUE(client.schedule());
+    EXPECT_TRUE(client.schedule());
+    EXPECT_TRUE(client.schedule());
+    EXPECT_EQ(0, client.m_iRepaints);
+
+    tick();
+    EXPECT_EQ(1, client.m_iRepaints);
+
+    // Nothing scheduled, nothing to repaint.
+    tick();
+    EXPECT_EQ(1, client.m_iRepaints);
+
+    EXPECT_TRUE(client.schedule());
+    tick();
+    EXPECT_EQ(2, client.m_iRepaints);
+}
+
+TEST_F(RepaintSchedulerTest, DeletedClientIsUnscheduled) {
+    TestClient* pClient = new TestClient();
+    TestClient other;
+    EXPECT_TRUE(pClient->schedule());
+    EXPECT_TRUE(other.schedule());
+    delete pClient;
+
+    tick();
+    EXPECT_EQ(1, other.m_iRepaints);
+}
+
+TEST_F(RepaintSchedulerTest, UpdatesDirectlyWithoutScheduler) {
+    RepaintScheduler::destroy();
+    TestClient client;
+    EXPECT_FALSE(client.schedule());
+    EXPECT_EQ(0, client.m_iRepaints);
+}
+
+}  // namespace
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include "sharedchunkcache.h"
+
+namespace {
+
+// Decodes a fake chunk of trackId into the cache and returns it referenced.
+SharedChunk* decode(SharedChunkCache* pCache, int trackId, int chunkNumber) {
+    SharedChunk* pChunk = pCache->allocate(trackId, chunkNumber);
+    if (pChunk != NULL) {
+        pChunk->data[0] = static_cast<CSAMPLE>(chunkNumber);
+        pCache->publish(pChunk, 2);
+    }
+    return pChunk;
+}
+
+TEST(SharedChunkCacheTest, SecondReaderSharesDecodedChunk) {
+    SharedChunkCache cache(4);
+    EXPECT_EQ(NULL, cache.acquire(1, 0));
+
+    SharedChunk* pDeck1 = decode(&cache, 1, 0);
+    ASSERT_TRUE(pDeck1 != NULL);
+
+    // The second deck gets the same data instead of decoding it again.
+    SharedChunk* pDeck2 = cache.acquire(1, 0);
+    ASSERT_EQ(pDeck1, pDeck2);
+    EXPECT_EQ(2, pDeck2->length);
+    EXPECT_EQ(2, pDeck2->references);
+    EXPECT_EQ(1, cache.chunkCount());
+
+    cache.release(pDeck1);
+    cache.release(pDeck2);
+    EXPECT_EQ(0, cache.referencedChunkCount());
+    // Still cached for the next reader.
+    EXPECT_EQ(1, cache.chunkCount());
+}
+
+TEST(SharedChunkCacheTest, ChunkIsNotSharedWhileDecoding) {
+    SharedChunkCache cache(4);
+    SharedChunk* pChunk = cache.allocate(1, 0);
+    ASSERT_TRUE(pChunk != NULL);
+
+    EXPECT_EQ(NULL, cache.acquire(1, 0));
+    // Nobody else decodes it at the same time either.
+    EXPECT_EQ(NULL, cache.allocate(1, 0));
+
+    // A failed decode discards the chunk.
+    cache.publish(pChunk, 0);
+    EXPECT_EQ(0, cache.chunkCount());
+}
+
+TEST(SharedChunkCacheTest, TracksWithoutIdAreNotShared) {
+    SharedChunkCache cache(4);
+    EXPECT_EQ(NULL, cache.allocate(-1, 0));
+}
+
+TEST(SharedChunkCacheTest, OnlyUnreferencedChunksAreEvicted) {
+    SharedChunkCache cache(2);
+    SharedChunk* pPinned = decode(&cache, 1, 0);
+    SharedChunk* pReleased = decode(&cache, 1, 1);
+    ASSERT_TRUE(pPinned != NULL);
+    ASSERT_TRUE(pReleased != NULL);
+    cache.release(pReleased);
+
+    // The unreferenced chunk makes room for the new one.
+    SharedChunk* pNew = decode(&cache, 2, 0);
+    ASSERT_TRUE(pNew != NULL);
+    EXPECT_EQ(2, cache.chunkCount());
+    EXPECT_EQ(NULL, cache.acquire(1, 1));
+
+    // Everything is pinned, so the reader has to use its own memory.
+    EXPECT_EQ(NULL, cache.allocate(2, 1));
+
+    SharedChunk* pAgain = cache.acquire(1, 0);
+    EXPECT_EQ(pPinned, pAgain);
+    cache.release(pAgain);
+    cache.release(pPinned);
+    cache.release(pNew);
+}
+
+TEST(SharedChunkCacheTest, PrivateChunksCountAgainstTheLimit) {
+    SharedChunkCache cache(2);
+    SharedChunk* pReleased = decode(&cache, 1, 0);
+    ASSERT_TRUE(pReleased != NULL);
+    cache.release(pReleased);
+    SharedChunk* pPinned = decode(&cache, 1, 1);
+    ASSERT_TRUE(pPinned != NULL);
+
+    // A reader that had to decode into its own memory evicts the
+    // unreferenced chunk.
+    cache.addPrivateChunk();
+    EXPECT_EQ(1, cache.privateChunkCount());
+    EXPECT_EQ(1, cache.chunkCount());
+    EXPECT_EQ(NULL, cache.acquire(1, 0));
+
+    // The limit is used up by the pinned and the private chunk.
+    EXPECT_EQ(NULL, cache.allocate(2, 0));
+
+    cache.removePrivateChunks(1);
+    EXPECT_EQ(0, cache.privateChunkCount());
+    SharedChunk* pNew = decode(&cache, 2, 0);
+    EXPECT_TRUE(pNew != NULL);
+    cache.release(pNew);
+    cache.release(pPinned);
+}
+
+}  // namespace
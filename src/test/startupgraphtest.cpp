@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QStringList>
+#include <QThread>
+
+#include "util/sleepableqthread.h"
+#include "util/startupgraph.h"
+
+namespace {
+
+// Records the order the phases ran in and the thread each ran on.
+class Phases {
+  public:
+    Phases()
+            : m_pMainThread(QThread::currentThread()),
+              m_bWorkersOverlapped(false) {
+    }
+
+    void settings() {
+        record("settings");
+    }
+    void engine() {
+        record("engine");
+    }
+    void players() {
+        record("players");
+    }
+    void skin() {
+        record("skin");
+    }
+    void devices() {
+        record("devices");
+    }
+    void database() {
+        record("database");
+    }
+
+    // Two worker phases that only finish if they run at the same time.
+    void firstWorker() {
+        record("firstWorker");
+        m_firstStarted.release();
+        m_bWorkersOverlapped = m_secondStarted.tryAcquire(1, 5000);
+    }
+    void secondWorker() {
+        record("secondWorker");
+        m_secondStarted.release();
+        m_firstStarted.tryAcquire(1, 5000);
+    }
+
+    // A worker phase that keeps the main thread waiting.
+    void slowWorker() {
+        SleepableQThread::msleep(100);
+        record("slowWorker");
+    }
+
+    int indexOf(const QString& phase) const {
+        QMutexLocker locker(&m_mutex);
+        return m_order.indexOf(phase);
+    }
+    bool ranInMainThread(const QString& phase) const {
+        QMutexLocker locker(&m_mutex);
+        return m_mainThreadPhases.contains(phase);
+    }
+    int count() const {
+        QMutexLocker locker(&m_mutex);
+        return m_order.size();
+    }
+    bool workersOverlapped() const {
+        return m_bWorkersOverlapped;
+    }
+
+  private:
+    void record(const QString& phase) {
+        QMutexLocker locker(&m_mutex);
+        m_order.append(phase);
+        if (QThread::currentThread() == m_pMainThread) {
+            m_mainThreadPhases.append(phase);
+        }
+    }
+
+    QThread* m_pMainThread;
+    mutable QMutex m_mutex;
+    QStringList m_order;
+    QStringList m_mainThreadPhases;
+    QSemaphore m_firstStarted;
+    QSemaphore m_secondStarted;
+    bool m_bWorkersOverlapped;
+};
+
+TEST(StartupGraphTest, RunsPhasesAfterTheirDependencies) {
+    Phases phases;
+    StartupGraph graph;
+    const int settings = graph.addPhase("settings", StartupGraph::MAIN_THREAD,
+                                        &phases, &Phases::settings);
+    const int devices = graph.addPhase("devices", StartupGraph::WORKER_THREAD,
+                                       &phases, &Phases::devices,
+                                       QList<int>() << settings);
+    const int engine = graph.addPhase("engine", StartupGraph::MAIN_THREAD,
+                                      &phases, &Phases::engine,
+                                      QList<int>() << settings);
+    const int players = graph.addPhase("players", StartupGraph::MAIN_THREAD,
+                                       &phases, &Phases::players,
+                                       QList<int>() << engine << devices);
+    const int database = graph.addPhase("database", StartupGraph::WORKER_THREAD,
+                                        &phases, &Phases::database,
+                                        QList<int>() << settings);
+    graph.addPhase("skin", StartupGraph::MAIN_THREAD, &phases, &Phases::skin,
+                   QList<int>() << players << database);
+    graph.run();
+
+    EXPECT_EQ(6, phases.count());
+    EXPECT_LT(phases.indexOf("settings"), phases.indexOf("devices"));
+    EXPECT_LT(phases.indexOf("settings"), phases.indexOf("engine"));
+    EXPECT_LT(phases.indexOf("devices"), phases.indexOf("players"));
+    EXPECT_LT(phases.indexOf("engine"), phases.indexOf("players"));
+    EXPECT_LT(phases.indexOf("players"), phases.indexOf("skin"));
+    EXPECT_LT(phases.indexOf("database"), phases.indexOf("skin"));
+
+    EXPECT_TRUE(phases.ranInMainThread("settings"));
+    EXPECT_TRUE(phases.ranInMainThread("engine"));
+    EXPECT_TRUE(phases.ranInMainThread("players"));
+    EXPECT_TRUE(phases.ranInMainThread("skin"));
+    EXPECT_FALSE(phases.ranInMainThread("devices"));
+    EXPECT_FALSE(phases.ranInMainThread("database"));
+}
+
+TEST(StartupGraphTest, RunsIndependentWorkersConcurrently) {
+    Phases phases;
+    StartupGraph graph;
+    graph.addPhase("first", StartupGraph::WORKER_THREAD,
+                   &phases, &Phases::firstWorker);
+    graph.addPhase("second", StartupGraph::WORKER_THREAD,
+                   &phases, &Phases::secondWorker);
+    graph.run();
+    EXPECT_TRUE(phases.workersOverlapped());
+}
+
+TEST(StartupGraphTest, MainThreadSkipsAheadWhileWaiting) {
+    Phases phases;
+    StartupGraph graph;
+    const int slow = graph.addPhase("slow", StartupGraph::WORKER_THREAD,
+                                    &phases, &Phases::slowWorker);
+    graph.addPhase("players", StartupGraph::MAIN_THREAD,
+                   &phases, &Phases::players, QList<int>() << slow);
+    graph.addPhase("engine", StartupGraph::MAIN_THREAD,
+                   &phases, &Phases::engine);
+    graph.run();
+
+    // The engine does not wait for the slow worker, the players do.
+    EXPECT_LT(phases.indexOf("engine"), phases.indexOf("slowWorker"));
+    EXPECT_LT(phases.indexOf("slowWorker"), phases.indexOf("players"));
+}
+
+TEST(StartupGraphTest, ReportsEveryPhaseAndTheCriticalPath) {
+    Phases phases;
+    StartupGraph graph;
+    const int settings = graph.addPhase("settings", StartupGraph::MAIN_THREAD,
+                                        &phases, &Phases::settings);
+    const int slow = graph.addPhase("slow", StartupGraph::WORKER_THREAD,
+                                    &phases, &Phases::slowWorker,
+                                    QList<int>() << settings);
+    const int engine = graph.addPhase("engine", StartupGraph::MAIN_THREAD,
+                                      &phases, &Phases::engine,
+                                      QList<int>() << settings);
+    graph.addPhase("players", StartupGraph::MAIN_THREAD,
+                   &phases, &Phases::players, QList<int>() << engine << slow);
+    graph.run();
+
+    const QString report = graph.report();
+    EXPECT_TRUE(report.contains("engine"));
+    EXPECT_TRUE(report.contains("worker"));
+    EXPECT_TRUE(report.contains("Critical path: settings > slow > players"));
+    EXPECT_EQ(report, StartupGraph::lastReport());
+}
+
+}  // namespace
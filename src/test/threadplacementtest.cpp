@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "util/threadplacement.h"
+
+namespace {
+
+class ThreadPlacementTest : public testing::Test {
+  protected:
+    virtual void SetUp() {
+        m_sysfs = QDir(QDir::temp().filePath("mixxx_threadplacement_test"));
+        removeSysfs();
+        // Two physical cores with two hyperthreads each. The siblings of a
+        // core are numbered apart like on most x86 machines, and every core
+        // is a NUMA node of its own.
+        writeFile("online", "0-3\n");
+        for (int cpu = 0; cpu < 4; ++cpu) {
+            QString cpuDir = QString("cpu%1").arg(cpu);
+            writeFile(cpuDir + "/topology/core_id", QString("%1\n").arg(cpu % 2));
+            writeFile(cpuDir + "/topology/physical_package_id", "0\n");
+            m_sysfs.mkpath(cpuDir + QString("/node%1").arg(cpu % 2));
+        }
+    }
+
+    virtual void TearDown() {
+        removeSysfs();
+    }
+
+    void writeFile(const QString& path, const QString& contents) {
+        QString filePath = m_sysfs.filePath(path);
+        m_sysfs.mkpath(QFileInfo(filePath).path());
+        QFile file(filePath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+        file.write(contents.toLatin1());
+    }
+
+    void removeSysfs() {
+        for (int cpu = 0; cpu < 4; ++cpu) {
+            QString cpuDir = QString("cpu%1").arg(cpu);
+            QFile::remove(m_sysfs.filePath(cpuDir + "/topology/core_id"));
+            QFile::remove(m_sysfs.filePath(cpuDir + "/topology/physical_package_id"));
+            m_sysfs.rmpath(cpuDir + "/topology");
+            m_sysfs.rmpath(cpuDir + QString("/node%1").arg(cpu % 2));
+        }
+        QFile::remove(m_sysfs.filePath("online"));
+        m_sysfs.rmpath(".");
+    }
+
+    QDir m_sysfs;
+};
+
+TEST_F(ThreadPlacementTest, ParseCpuList) {
+    EXPECT_EQ(QList<int>(), ThreadPlacement::parseCpuList(""));
+    EXPECT_EQ(QList<int>() << 3, ThreadPlacement::parseCpuList("3\n"));
+    EXPECT_EQ(QList<int>() << 0 << 1 << 2 << 3 << 6 << 8 << 9,
+              ThreadPlacement::parseCpuList("6,0-3, 8-9"));
+    // Garbage is skipped, duplicates are merged.
+    EXPECT_EQ(QList<int>() << 1 << 2,
+              ThreadPlacement::parseCpuList("2,x,1-2,-1"));
+}
+
+TEST_F(ThreadPlacementTest, ReadTopology) {
+    QList<ThreadPlacement::Cpu> topology =
+            ThreadPlacement::readTopology(m_sysfs.path());
+    ASSERT_EQ(4, topology.size());
+    EXPECT_EQ(2, topology[2].id);
+    EXPECT_EQ(topology[0].core, topology[2].core);
+    EXPECT_NE(topology[0].core, topology[1].core);
+    EXPECT_EQ(0, topology[2].node);
+    EXPECT_EQ(1, topology[3].node);
+}
+
+TEST_F(ThreadPlacementTest, BackgroundAvoidsSiblingsOfRealtimeCpus) {
+    QList<ThreadPlacement::Cpu> topology =
+            ThreadPlacement::readTopology(m_sysfs.path());
+    // CPU 0 shares its core with the realtime CPU 2.
+    EXPECT_EQ(QList<int>() << 1 << 3,
+              ThreadPlacement::backgroundCpus(topology, QList<int>() << 2));
+    EXPECT_EQ(QList<int>(),
+              ThreadPlacement::backgroundCpus(topology, QList<int>() << 0 << 1));
+}
+
+TEST_F(ThreadPlacementTest, RealtimeCpusStayOnOneNode) {
+    QList<ThreadPlacement::Cpu> topology =
+            ThreadPlacement::readTopology(m_sysfs.path());
+    EXPECT_EQ(QList<int>() << 1 << 3,
+              ThreadPlacement::restrictToFirstNode(
+                      topology, QList<int>() << 1 << 2 << 3));
+    EXPECT_EQ(QList<int>(),
+              ThreadPlacement::restrictToFirstNode(topology, QList<int>()));
+}
+
+}  // namespace
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <QtSql>
+
+#include "test/librarytest.h"
+#include "trackinfoobject.h"
+
+namespace {
+
+const QString kTrackLocationTest(QDir::currentPath() %
+                                 "/src/test/id3-test-data/cover-test.mp3");
+
+class TrackDirtyFieldsTest : public LibraryTest {
+  protected:
+    QString libraryValue(int trackId, const QString& column) {
+        QSqlQuery query(collection()->getDatabase());
+        query.prepare(QString("SELECT %1 FROM library WHERE id=:id").arg(column));
+        query.bindValue(":id", trackId);
+        if (!query.exec() || !query.next()) {
+            return QString();
+        }
+        return query.value(0).toString();
+    }
+
+    void setLibraryValue(int trackId, const QString& column,
+                         const QString& value) {
+        QSqlQuery query(collection()->getDatabase());
+        query.prepare(QString("UPDATE library SET %1=:value WHERE id=:id")
+                      .arg(column));
+        query.bindValue(":value", value);
+        query.bindValue(":id", trackId);
+        ASSERT_TRUE(query.exec());
+    }
+};
+
+TEST_F(TrackDirtyFieldsTest, SettersRecordChangedFields) {
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    int trackId = trackDao.addTrack(kTrackLocationTest, false);
+    ASSERT_NE(-1, trackId);
+    TrackPointer pTrack = trackDao.getTrack(trackId);
+    ASSERT_FALSE(pTrack.isNull());
+    EXPECT_EQ(TrackInfoObject::DIRTY_NONE, pTrack->getDirtyFields());
+
+    pTrack->setRating(3);
+    EXPECT_TRUE(pTrack->isDirty());
+    EXPECT_EQ(TrackInfoObject::DIRTY_RATING, pTrack->getDirtyFields());
+
+    pTrack->setPlayedAndUpdatePlaycount(true);
+    pTrack->setBpmLock(true);
+    EXPECT_EQ(TrackInfoObject::DIRTY_RATING |
+              TrackInfoObject::DIRTY_PLAY_COUNT |
+              TrackInfoObject::DIRTY_BPM_LOCK,
+              pTrack->getDirtyFields());
+
+    // Saving cleans all fields, and setting a value that does not change
+    // anything dirties nothing.
+    trackDao.saveTracks(QList<TrackPointer>() << pTrack);
+    pTrack->setRating(3);
+    EXPECT_FALSE(pTrack->isDirty());
+    EXPECT_EQ(TrackInfoObject::DIRTY_NONE, pTrack->getDirtyFields());
+}
+
+TEST_F(TrackDirtyFieldsTest, SaveOnlyWritesChangedColumns) {
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    int trackId = trackDao.addTrack(kTrackLocationTest, false);
+    ASSERT_NE(-1, trackId);
+    TrackPointer pTrack = trackDao.getTrack(trackId);
+    ASSERT_FALSE(pTrack.isNull());
+    ASSERT_FALSE(pTrack->isDirty());
+
+    // Somebody else changes the title behind the back of the track.
+    setLibraryValue(trackId, "title", "Changed elsewhere");
+
+    pTrack->setRating(4);
+    trackDao.saveTracks(QList<TrackPointer>() << pTrack);
+    EXPECT_FALSE(pTrack->isDirty());
+    EXPECT_EQ(TrackInfoObject::DIRTY_NONE, pTrack->getDirtyFields());
+    EXPECT_QSTRING_EQ("4", libraryValue(trackId, "rating"));
+    // The rating update did not rewrite the title.
+    EXPECT_QSTRING_EQ("Changed elsewhere", libraryValue(trackId, "title"));
+
+    pTrack->setTitle("New title");
+    trackDao.saveTracks(QList<TrackPointer>() << pTrack);
+    EXPECT_QSTRING_EQ("New title", libraryValue(trackId, "title"));
+}
+
+TEST_F(TrackDirtyFieldsTest, OnlyUnsavedWaveformsDirtyTheTrack) {
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    int trackId = trackDao.addTrack(kTrackLocationTest, false);
+    ASSERT_NE(-1, trackId);
+    TrackPointer pTrack = trackDao.getTrack(trackId);
+    ASSERT_FALSE(pTrack.isNull());
+
+    // A waveform loaded from the analysis table is not saved again.
+    WaveformPointer pStored(new Waveform(44100, 44100, 441, -1));
+    pStored->setDirty(false);
+    pTrack->setWaveform(pStored);
+    EXPECT_FALSE(pTrack->isDirty());
+
+    pTrack->setWaveformSummary(
+            WaveformPointer(new Waveform(44100, 44100, 441, 100)));
+    EXPECT_EQ(TrackInfoObject::DIRTY_WAVEFORM, pTrack->getDirtyFields());
+}
+
+}  // namespace
@@ -0,0 +1,11 @@
+#ifndef ANALYSER_PREFERENCES_H
+#define ANALYSER_PREFERENCES_H
+
+// Preferences shared by the beat and key analysers.
+
+#define VAMP_CONFIG_KEY "[Vamp]"
+
+// The built-in analysers are stored like a Vamp plugin of this library.
+#define NATIVE_ANALYSER_LIBRARY "mixxx-native"
+
+#endif /* ANALYSER_PREFERENCES_H */
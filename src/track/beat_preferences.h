@@ -1,11 +1,12 @@
 #ifndef BEAT_PREFERENCES_H
 #define BEAT_PREFERENCES_H
 
-#define VAMP_CONFIG_KEY "[Vamp]"
+#include "track/analyser_preferences.h"
 
 // VAMP_CONFIG_KEY Preferences
 #define VAMP_ANALYSER_BEAT_LIBRARY "AnalyserBeatLibrary"
 #define VAMP_ANALYSER_BEAT_PLUGIN_ID "AnalyserBeatPluginID"
+#define NATIVE_ANALYSER_BEAT_PLUGIN_ID "mixxx-beattracker:0"
 
 #define BPM_CONFIG_KEY "[BPM]"
 
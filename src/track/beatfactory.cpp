@@ -5,18 +5,21 @@
 #include "track/beatmap.h"
 #include "track/beatfactory.h"
 #include "track/beatutils.h"
+#include "util/math.h"
 
-BeatsPointer BeatFactory::loadBeatsFromByteArray(TrackPointer pTrack,
+BeatsPointer BeatFactory::loadBeatsFromByteArray(TrackInfoObject* pTrack,
                                                  QString beatsVersion,
                                                  QString beatsSubVersion,
                                                  QByteArray* beatsSerialized) {
     if (beatsVersion == BEAT_GRID_1_VERSION ||
-        beatsVersion == BEAT_GRID_2_VERSION) {
-        BeatGrid* pGrid = new BeatGrid(pTrack.data(), 0, beatsSerialized);
+        beatsVersion == BEAT_GRID_2_VERSION ||
+        beatsVersion == BEAT_GRID_3_VERSION) {
+        BeatGrid* pGrid = new BeatGrid(pTrack, 0, beatsSerialized);
         pGrid->setSubVersion(beatsSubVersion);
         qDebug() << "Successfully deserialized BeatGrid";
         return BeatsPointer(pGrid, &BeatFactory::deleteBeats);
-    } else if (beatsVersion == BEAT_MAP_VERSION) {
+    } else if (beatsVersion == BEAT_MAP_VERSION ||
+               beatsVersion == BEAT_MAP_2_VERSION) {
         BeatMap* pMap = new BeatMap(pTrack, 0, beatsSerialized);
         pMap->setSubVersion(beatsSubVersion);
         qDebug() << "Successfully deserialized BeatMap";
@@ -33,12 +36,26 @@ BeatsPointer BeatFactory::makeBeatGrid(TrackInfoObject* pTrack, double dBpm,
     return BeatsPointer(pGrid, &BeatFactory::deleteBeats);
 }
 
+// static
+BeatsSummary BeatFactory::makeSummary(const BeatsPointer& pBeats) {
+    BeatsSummary summary;
+    if (!pBeats) {
+        return summary;
+    }
+    summary.type = pBeats->getVersion() == BEAT_MAP_2_VERSION ?
+            BeatsSummary::MAP : BeatsSummary::GRID;
+    // getBpm() returns -1 when invalid.
+    summary.bpm = math_max(0.0, pBeats->getBpm());
+    summary.firstBeatSample = math_max(0.0, pBeats->findNextBeat(0));
+    return summary;
+}
+
 // static
 QString BeatFactory::getPreferredVersion(const bool bEnableFixedTempoCorrection) {
     if (bEnableFixedTempoCorrection) {
-        return BEAT_GRID_2_VERSION;
+        return BEAT_GRID_3_VERSION;
     }
-    return BEAT_MAP_VERSION;
+    return BEAT_MAP_2_VERSION;
 }
 
 QString BeatFactory::getPreferredSubVersion(
@@ -98,7 +115,7 @@ BeatsPointer BeatFactory::makePreferredBeats(
                                                       extraVersionInfo);
 
     BeatUtils::printBeatStatistics(beats, iSampleRate);
-    if (version == BEAT_GRID_2_VERSION) {
+    if (version == BEAT_GRID_3_VERSION) {
         double globalBpm = BeatUtils::calculateBpm(beats, iSampleRate, iMinBpm, iMaxBpm);
         double firstBeat = BeatUtils::calculateFixedTempoFirstBeat(
             bEnableOffsetCorrection,
@@ -108,7 +125,7 @@ BeatsPointer BeatFactory::makePreferredBeats(
         pGrid->setGrid(globalBpm, firstBeat * 2);
         pGrid->setSubVersion(subVersion);
         return BeatsPointer(pGrid, &BeatFactory::deleteBeats);
-    } else if (version == BEAT_MAP_VERSION) {
+    } else if (version == BEAT_MAP_2_VERSION) {
         BeatMap* pBeatMap = new BeatMap(pTrack, iSampleRate, beats);
         pBeatMap->setSubVersion(subVersion);
         return BeatsPointer(pBeatMap, &BeatFactory::deleteBeats);
@@ -7,13 +7,17 @@
 
 class BeatFactory {
   public:
-    static BeatsPointer loadBeatsFromByteArray(TrackPointer pTrack,
+    static BeatsPointer loadBeatsFromByteArray(TrackInfoObject* pTrack,
                                                QString beatsVersion,
                                                QString beatsSubVersion,
                                                QByteArray* beatsSerialized);
     static BeatsPointer makeBeatGrid(TrackInfoObject* pTrack,
                                      double dBpm, double dFirstBeatSample);
 
+    // Returns the summary of pBeats that is stored alongside its
+    // serialization.
+    static BeatsSummary makeSummary(const BeatsPointer& pBeats);
+
     static QString getPreferredVersion(const bool bEnableFixedTempoCorrection);
 
     static QString getPreferredSubVersion(
@@ -2,10 +2,14 @@
 #include <QtDebug>
 
 #include "track/beatgrid.h"
+#include "track/compactserialization.h"
 #include "util/math.h"
 
 static const int kFrameSize = 2;
 
+static const char* const kCompactMagic = "MXBG";
+static const quint8 kCompactFormatVersion = 1;
+
 struct BeatGridData {
     double bpm;
     double firstBeat;
@@ -69,14 +73,56 @@ void BeatGrid::setGrid(double dBpm, double dFirstBeatSample) {
 
 QByteArray* BeatGrid::toByteArray() const {
     QMutexLocker locker(&m_mutex);
-    std::string output;
-    m_grid.SerializeToString(&output);
-    QByteArray* pByteArray = new QByteArray(output.data(), output.length());
+    CompactWriter writer(kCompactMagic, kCompactFormatVersion);
+    writer.writeDouble(m_grid.bpm().bpm());
+    writer.writeUInt8(m_grid.bpm().source());
+    writer.writeVarInt(m_grid.first_beat().frame_position());
+    writer.writeUInt8(m_grid.first_beat().enabled() ? 1 : 0);
+    writer.writeUInt8(m_grid.first_beat().source());
     // Caller is responsible for delete
-    return pByteArray;
+    return writer.takeByteArray();
+}
+
+bool BeatGrid::readCompactByteArray(const QByteArray& byteArray) {
+    CompactReader reader(byteArray, kCompactMagic);
+    if (!reader.isValid() || reader.formatVersion() != kCompactFormatVersion) {
+        return false;
+    }
+    const double dBpm = reader.readDouble();
+    const int bpmSource = reader.readUInt8();
+    const qint64 firstBeatFrame = reader.readVarInt();
+    const bool firstBeatEnabled = reader.readUInt8() != 0;
+    const int firstBeatSource = reader.readUInt8();
+    if (!reader.isValid() ||
+            !mixxx::track::io::Source_IsValid(bpmSource) ||
+            !mixxx::track::io::Source_IsValid(firstBeatSource)) {
+        return false;
+    }
+
+    mixxx::track::io::BeatGrid grid;
+    grid.mutable_bpm()->set_bpm(dBpm);
+    grid.mutable_bpm()->set_source(
+            static_cast<mixxx::track::io::Source>(bpmSource));
+    grid.mutable_first_beat()->set_frame_position(
+            static_cast<int>(firstBeatFrame));
+    grid.mutable_first_beat()->set_enabled(firstBeatEnabled);
+    grid.mutable_first_beat()->set_source(
+            static_cast<mixxx::track::io::Source>(firstBeatSource));
+    m_grid = grid;
+    m_dBeatLength = (60.0 * m_iSampleRate / bpm()) * kFrameSize;
+    return true;
 }
 
 void BeatGrid::readByteArray(const QByteArray* pByteArray) {
+    if (CompactReader::hasMagic(*pByteArray, kCompactMagic)) {
+        if (!readCompactByteArray(*pByteArray)) {
+            qDebug() << "ERROR: Could not parse BeatGrid from QByteArray of size"
+                     << pByteArray->size();
+        }
+        return;
+    }
+
+    // Legacy protobuf serialization.
     mixxx::track::io::BeatGrid grid;
     if (grid.ParseFromArray(pByteArray->constData(), pByteArray->length())) {
         m_grid = grid;
@@ -103,7 +149,7 @@ double BeatGrid::bpm() const {
 
 QString BeatGrid::getVersion() const {
     QMutexLocker locker(&m_mutex);
-    return BEAT_GRID_2_VERSION;
+    return BEAT_GRID_3_VERSION;
 }
 
 QString BeatGrid::getSubVersion() const {
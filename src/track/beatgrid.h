@@ -10,6 +10,9 @@
 
 #define BEAT_GRID_1_VERSION "BeatGrid-1.0"
 #define BEAT_GRID_2_VERSION "BeatGrid-2.0"
+// Versions 1 and 2 are protobuf messages, version 3 is the compact format of
+// track/compactserialization.h.
+#define BEAT_GRID_3_VERSION "BeatGrid-3.0"
 
 // BeatGrid is an implementation of the Beats interface that implements an
 // infinite grid of beats, aligned to a song simply by a starting offset of the
@@ -74,6 +77,8 @@ class BeatGrid : public QObject, public virtual Beats {
     double bpm() const;
 
     void readByteArray(const QByteArray* pByteArray);
+    // Returns false if byteArray is not a valid compact serialization.
+    bool readCompactByteArray(const QByteArray& byteArray);
     // For internal use only.
     bool isValid() const;
 
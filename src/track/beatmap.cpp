@@ -11,12 +11,22 @@
 
 #include "track/beatmap.h"
 #include "track/beatutils.h"
+#include "track/compactserialization.h"
 #include "util/math.h"
 
 using mixxx::track::io::Beat;
 
 const int kFrameSize = 2;
 
+// The compact serialization stores the delta of every beat to the previous
+// one. The lowest bit of the delta tells if a flags byte follows, which is
+// only the case for beats that are disabled or not from the analyser.
+const char* const kCompactMagic = "MXBM";
+const quint8 kCompactFormatVersion = 1;
+const quint8 kBeatDisabledFlag = 0x01;
+const int kBeatSourceShift = 1;
+const quint8 kBeatSourceMask = 0x03;
+
 inline double samplesToFrames(const double samples) {
     return floor(samples / kFrameSize);
 }
@@ -62,6 +72,16 @@ BeatMap::BeatMap(TrackPointer pTrack, int iSampleRate,
                  const QByteArray* pByteArray)
         : QObject(),
           m_mutex(QMutex::Recursive) {
+    initialize(pTrack.data(), iSampleRate);
+    if (pByteArray != NULL) {
+        readByteArray(pByteArray);
+    }
+}
+
+BeatMap::BeatMap(TrackInfoObject* pTrack, int iSampleRate,
+                 const QByteArray* pByteArray)
+        : QObject(),
+          m_mutex(QMutex::Recursive) {
     initialize(pTrack, iSampleRate);
     if (pByteArray != NULL) {
         readByteArray(pByteArray);
@@ -72,18 +92,18 @@ BeatMap::BeatMap(TrackPointer pTrack, int iSampleRate,
                  const QVector<double>& beats)
         : QObject(),
           m_mutex(QMutex::Recursive) {
-    initialize(pTrack, iSampleRate);
+    initialize(pTrack.data(), iSampleRate);
     if (beats.size() > 0) {
         createFromBeatVector(beats);
     }
 }
 
-void BeatMap::initialize(TrackPointer pTrack, int iSampleRate) {
+void BeatMap::initialize(TrackInfoObject* pTrack, int iSampleRate) {
     m_iSampleRate = iSampleRate > 0 ? iSampleRate : pTrack->getSampleRate();
     m_dCachedBpm = 0;
     m_dLastFrame = 0;
 
-    if (!pTrack.isNull()) {
+    if (pTrack != NULL) {
         // BeatMap should live in the same thread as the track it is associated
         // with.
         moveToThread(pTrack->thread());
@@ -95,21 +115,74 @@ BeatMap::~BeatMap() {
 
 QByteArray* BeatMap::toByteArray() const {
     QMutexLocker locker(&m_mutex);
-    // No guarantees BeatLists are made of a data type which located adjacent
-    // items in adjacent memory locations.
-    mixxx::track::io::BeatMap map;
-
-    for (int i = 0; i < m_beats.size(); ++i) {
-        map.add_beat()->CopyFrom(m_beats[i]);
+    CompactWriter writer(kCompactMagic, kCompactFormatVersion);
+    writer.writeVarUInt(m_beats.size());
+    qint64 previousFrame = 0;
+    foreach (const Beat& beat, m_beats) {
+        quint8 flags = beat.enabled() ? 0 : kBeatDisabledFlag;
+        flags |= (static_cast<quint8>(beat.source()) & kBeatSourceMask)
+                << kBeatSourceShift;
+        // The beats are in increasing order, so the delta is never negative.
+        const quint64 delta = beat.frame_position() - previousFrame;
+        previousFrame = beat.frame_position();
+        writer.writeVarUInt(delta * 2 + (flags != 0 ? 1 : 0));
+        if (flags != 0) {
+            writer.writeUInt8(flags);
+        }
     }
+    return writer.takeByteArray();
+}
 
-    std::string output;
-    map.SerializeToString(&output);
-    QByteArray* pByteArray = new QByteArray(output.data(), output.length());
-    return pByteArray;
+bool BeatMap::readCompactByteArray(const QByteArray& byteArray) {
+    CompactReader reader(byteArray, kCompactMagic);
+    if (!reader.isValid() || reader.formatVersion() != kCompactFormatVersion) {
+        return false;
+    }
+    const quint64 count = reader.readVarUInt();
+    // Every beat takes at least one byte.
+    if (count > static_cast<quint64>(byteArray.size())) {
+        return false;
+    }
+    BeatList beats;
+    beats.reserve(static_cast<int>(count));
+    qint64 frame = 0;
+    for (quint64 i = 0; i < count && reader.isValid(); ++i) {
+        const quint64 value = reader.readVarUInt();
+        const bool hasFlags = value & 1;
+        frame += static_cast<qint64>(value >> 1);
+        quint8 flags = hasFlags ? reader.readUInt8() : 0;
+
+        Beat beat;
+        beat.set_frame_position(static_cast<int>(frame));
+        if (flags & kBeatDisabledFlag) {
+            beat.set_enabled(false);
+        }
+        int source = (flags >> kBeatSourceShift) & kBeatSourceMask;
+        if (source != mixxx::track::io::ANALYSER &&
+                mixxx::track::io::Source_IsValid(source)) {
+            beat.set_source(static_cast<mixxx::track::io::Source>(source));
+        }
+        beats.append(beat);
+    }
+    if (!reader.isValid()) {
+        return false;
+    }
+    m_beats = beats;
+    return true;
 }
 
 void BeatMap::readByteArray(const QByteArray* pByteArray) {
+    if (CompactReader::hasMagic(*pByteArray, kCompactMagic)) {
+        if (!readCompactByteArray(*pByteArray)) {
+            qDebug() << "ERROR: Could not parse BeatMap from QByteArray of size"
+                     << pByteArray->size();
+            return;
+        }
+        onBeatlistChanged();
+        return;
+    }
+
+    // Legacy protobuf serialization.
     mixxx::track::io::BeatMap map;
     if (!map.ParseFromArray(pByteArray->constData(), pByteArray->size())) {
         qDebug() << "ERROR: Could not parse BeatMap from QByteArray of size"
@@ -147,7 +220,7 @@ void BeatMap::createFromBeatVector(const QVector<double>& beats) {
 
 QString BeatMap::getVersion() const {
     QMutexLocker locker(&m_mutex);
-    return BEAT_MAP_VERSION;
+    return BEAT_MAP_2_VERSION;
 }
 
 QString BeatMap::getSubVersion() const {
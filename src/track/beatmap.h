@@ -16,6 +16,9 @@
 #include "proto/beats.pb.h"
 
 #define BEAT_MAP_VERSION "BeatMap-1.0"
+// Version 1 is a protobuf message, version 2 is the compact format of
+// track/compactserialization.h.
+#define BEAT_MAP_2_VERSION "BeatMap-2.0"
 
 typedef QList<mixxx::track::io::Beat> BeatList;
 
@@ -28,6 +31,10 @@ class BeatMap : public QObject, public Beats {
     // provided then the BeatMap will be deserialized from the byte array.
     BeatMap(TrackPointer pTrack, int iSampleRate,
             const QByteArray* pByteArray=NULL);
+    // Same as above for use by the track itself, which has no TrackPointer to
+    // itself.
+    BeatMap(TrackInfoObject* pTrack, int iSampleRate,
+            const QByteArray* pByteArray);
     // Construct a BeatMap. iSampleRate may be provided if a more accurate
     // sample rate is known than the one associated with the Track. If it is
     // zero then the track's sample rate will be used. A list of beat locations
@@ -78,8 +85,10 @@ class BeatMap : public QObject, public Beats {
     void updated();
 
   private:
-    void initialize(TrackPointer pTrack, int iSampleRate);
+    void initialize(TrackInfoObject* pTrack, int iSampleRate);
     void readByteArray(const QByteArray* pByteArray);
+    // Returns false if byteArray is not a valid compact serialization.
+    bool readCompactByteArray(const QByteArray& byteArray);
     void createFromBeatVector(const QVector<double>& beats);
     void onBeatlistChanged();
 
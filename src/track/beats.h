@@ -16,6 +16,28 @@ class BeatIterator {
     virtual double next() = 0;
 };
 
+// A fixed-size summary of a Beats object. The library stores it in columns
+// next to the serialized beats so that tracks can be listed and loaded
+// without decoding the beats.
+struct BeatsSummary {
+    // Stored in the database, do not renumber.
+    enum Type {
+        NONE = 0,
+        GRID = 1,
+        MAP = 2,
+    };
+
+    BeatsSummary()
+            : type(NONE),
+              bpm(0.0),
+              firstBeatSample(0.0) {
+    }
+
+    Type type;
+    double bpm;
+    double firstBeatSample;
+};
+
 // Beats is a pure abstract base class for BPM and beat management classes. It
 // provides a specification of all methods a beat-manager class must provide, as
 // well as a capability model for representing optional features.
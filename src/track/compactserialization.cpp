@@ -0,0 +1,123 @@
+#include <QtEndian>
+#include <string.h>
+
+#include "track/compactserialization.h"
+
+namespace {
+
+const int kMagicLength = 4;
+// A 64-bit varint takes at most 10 bytes.
+const int kMaxVarIntBytes = 10;
+
+}  // anonymous namespace
+
+CompactWriter::CompactWriter(const char* magic, quint8 formatVersion) {
+    m_data.append(magic, kMagicLength);
+    writeUInt8(formatVersion);
+}
+
+void CompactWriter::writeUInt8(quint8 value) {
+    m_data.append(static_cast<char>(value));
+}
+
+void CompactWriter::writeVarUInt(quint64 value) {
+    while (value >= 0x80) {
+        m_data.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    m_data.append(static_cast<char>(value));
+}
+
+void CompactWriter::writeVarInt(qint64 value) {
+    // Zigzag encoding maps small negative numbers to small unsigned ones.
+    writeVarUInt((static_cast<quint64>(value) << 1) ^
+                 static_cast<quint64>(value >> 63));
+}
+
+void CompactWriter::writeDouble(double value) {
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uchar bytes[sizeof(bits)];
+    qToLittleEndian(bits, bytes);
+    m_data.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+void CompactWriter::writeString(const QString& value) {
+    QByteArray utf8 = value.toUtf8();
+    writeVarUInt(utf8.size());
+    m_data.append(utf8);
+}
+
+// static
+bool CompactReader::hasMagic(const QByteArray& data, const char* magic) {
+    return data.size() > kMagicLength &&
+            memcmp(data.constData(), magic, kMagicLength) == 0;
+}
+
+CompactReader::CompactReader(const QByteArray& data, const char* magic)
+        : m_data(data),
+          m_iPosition(0),
+          m_formatVersion(0),
+          m_bValid(hasMagic(data, magic)) {
+    if (m_bValid) {
+        m_iPosition = kMagicLength;
+        m_formatVersion = readUInt8();
+    }
+}
+
+quint8 CompactReader::readUInt8() {
+    if (!m_bValid || m_iPosition >= m_data.size()) {
+        m_bValid = false;
+        return 0;
+    }
+    return static_cast<quint8>(m_data.at(m_iPosition++));
+}
+
+quint64 CompactReader::readVarUInt() {
+    quint64 value = 0;
+    for (int i = 0; i < kMaxVarIntBytes; ++i) {
+        quint8 byte = readUInt8();
+        if (!m_bValid) {
+            return 0;
+        }
+        value |= static_cast<quint64>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    // Too long to be a varint.
+    m_bValid = false;
+    return 0;
+}
+
+qint64 CompactReader::readVarInt() {
+    quint64 value = readVarUInt();
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+double CompactReader::readDouble() {
+    const int kSize = sizeof(quint64);
+    if (!m_bValid || m_iPosition + kSize > m_data.size()) {
+        m_bValid = false;
+        return 0.0;
+    }
+    quint64 bits = qFromLittleEndian<quint64>(
+            reinterpret_cast<const uchar*>(m_data.constData() + m_iPosition));
+    m_iPosition += kSize;
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+QString CompactReader::readString() {
+    quint64 length = readVarUInt();
+    if (!m_bValid ||
+            length > static_cast<quint64>(m_data.size() - m_iPosition)) {
+        m_bValid = false;
+        return QString();
+    }
+    QString value = QString::fromUtf8(m_data.constData() + m_iPosition,
+                                      static_cast<int>(length));
+    m_iPosition += static_cast<int>(length);
+    return value;
+}
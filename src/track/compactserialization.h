@@ -0,0 +1,72 @@
+#ifndef COMPACTSERIALIZATION_H
+#define COMPACTSERIALIZATION_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+// CompactWriter and CompactReader implement the small binary format used to
+// store beats and keys in the library. A blob starts with a 4 character magic
+// followed by a format version byte. Integers are written as little-endian
+// base 128 varints (signed ones zigzag encoded first). A BeatMap stores each
+// beat as the distance in frames to the previous one, shifted left by one bit
+// for a flags marker, which takes 3 bytes per beat at usual tempos.
+//
+// The magic makes the format distinguishable from the protobuf messages that
+// were stored before, which never start with these bytes.
+class CompactWriter {
+  public:
+    CompactWriter(const char* magic, quint8 formatVersion);
+
+    void writeUInt8(quint8 value);
+    void writeVarUInt(quint64 value);
+    void writeVarInt(qint64 value);
+    void writeDouble(double value);
+    void writeString(const QString& value);
+
+    // Returns the serialized data. The caller takes ownership.
+    QByteArray* takeByteArray() {
+        return new QByteArray(m_data);
+    }
+
+  private:
+    QByteArray m_data;
+};
+
+class CompactReader {
+  public:
+    // Returns true if data starts with magic, i.e. it was written by a
+    // CompactWriter with the same magic.
+    static bool hasMagic(const QByteArray& data, const char* magic);
+
+    CompactReader(const QByteArray& data, const char* magic);
+
+    // The format version of the data, or 0 if the magic did not match.
+    quint8 formatVersion() const {
+        return m_formatVersion;
+    }
+
+    // False once a read ran past the end of the data or the magic did not
+    // match. The read methods return 0 (or an empty string) in that case.
+    bool isValid() const {
+        return m_bValid;
+    }
+
+    bool atEnd() const {
+        return m_iPosition >= m_data.size();
+    }
+
+    quint8 readUInt8();
+    quint64 readVarUInt();
+    qint64 readVarInt();
+    double readDouble();
+    QString readString();
+
+  private:
+    const QByteArray& m_data;
+    int m_iPosition;
+    quint8 m_formatVersion;
+    bool m_bValid;
+};
+
+#endif /* COMPACTSERIALIZATION_H */
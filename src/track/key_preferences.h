@@ -1,12 +1,13 @@
 #ifndef KEY_PREFERENCES_H
 #define KEY_PREFERENCES_H
 
-#define VAMP_CONFIG_KEY "[Vamp]"
+#include "track/analyser_preferences.h"
 
 // VAMP_CONFIG_KEY Preferences
 #define VAMP_ANALYSER_KEY_LIBRARY "AnalyserKeyLibrary"
 #define VAMP_ANALYSER_KEY_PLUGIN_ID "AnalyserKeyPluginID"
 #define VAMP_ANALYSER_KEY_DEFAULT_PLUGIN_ID "qm-keydetector:2"
+#define NATIVE_ANALYSER_KEY_PLUGIN_ID "mixxx-keydetector:0"
 
 #define KEY_CONFIG_KEY "[Key]"
 
@@ -11,7 +11,7 @@ using mixxx::track::io::key::KeyMap;
 Keys KeyFactory::loadKeysFromByteArray(const QString& keysVersion,
                                        const QString& keysSubVersion,
                                        QByteArray* keysSerialized) {
-    if (keysVersion == KEY_MAP_VERSION) {
+    if (keysVersion == KEY_MAP_VERSION || keysVersion == KEY_MAP_2_VERSION) {
         Keys keys(keysSerialized);
         keys.setSubVersion(keysSubVersion);
         qDebug() << "Successfully deserialized KeyMap";
@@ -48,7 +48,7 @@ Keys KeyFactory::makeBasicKeysFromText(const QString& global_key_text,
 
 // static
 QString KeyFactory::getPreferredVersion() {
-    return KEY_MAP_VERSION;
+    return KEY_MAP_2_VERSION;
 }
 
 // static
@@ -87,7 +87,7 @@ Keys KeyFactory::makePreferredKeys(
     const QString version = getPreferredVersion();
     const QString subVersion = getPreferredSubVersion(extraVersionInfo);
 
-    if (version == KEY_MAP_VERSION) {
+    if (version == KEY_MAP_2_VERSION) {
         KeyMap key_map;
         for (KeyChangeList::const_iterator it = key_changes.begin();
              it != key_changes.end(); ++it) {
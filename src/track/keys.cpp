@@ -2,10 +2,14 @@
 #include <QtDebug>
 
 #include "track/keys.h"
+#include "track/compactserialization.h"
 
 using mixxx::track::io::key::ChromaticKey;
 using mixxx::track::io::key::KeyMap;
 
+static const char* const kCompactMagic = "MXKM";
+static const quint8 kCompactFormatVersion = 1;
+
 Keys::Keys(const QByteArray* pByteArray) {
     if (pByteArray) {
         readByteArray(pByteArray);
@@ -32,14 +36,23 @@ Keys& Keys::operator=(const Keys& other) {
 
 QByteArray* Keys::toByteArray() const {
     QMutexLocker locker(&m_mutex);
-    std::string output;
-    m_keyMap.SerializeToString(&output);
-    QByteArray* pByteArray = new QByteArray(output.data(), output.length());
-    return pByteArray;
+    CompactWriter writer(kCompactMagic, kCompactFormatVersion);
+    writer.writeUInt8(m_keyMap.global_key());
+    writer.writeUInt8(m_keyMap.source());
+    writer.writeString(QString::fromStdString(m_keyMap.global_key_text()));
+    writer.writeVarUInt(m_keyMap.key_change_size());
+    qint64 previousFrame = 0;
+    for (int i = 0; i < m_keyMap.key_change_size(); ++i) {
+        const KeyMap::KeyChange& change = m_keyMap.key_change(i);
+        writer.writeVarInt(change.frame_position() - previousFrame);
+        writer.writeUInt8(change.key());
+        previousFrame = change.frame_position();
+    }
+    return writer.takeByteArray();
 }
 
 QString Keys::getVersion() const {
-    return KEY_MAP_VERSION;
+    return KEY_MAP_2_VERSION;
 }
 
 QString Keys::getSubVersion() const {
@@ -65,7 +78,53 @@ QString Keys::getGlobalKeyText() const {
     return QString::fromStdString(m_keyMap.global_key_text());
 }
 
+bool Keys::readCompactByteArray(const QByteArray& byteArray) {
+    CompactReader reader(byteArray, kCompactMagic);
+    if (!reader.isValid() || reader.formatVersion() != kCompactFormatVersion) {
+        return false;
+    }
+    KeyMap keyMap;
+    const int globalKey = reader.readUInt8();
+    const int source = reader.readUInt8();
+    const QString globalKeyText = reader.readString();
+    if (!mixxx::track::io::key::ChromaticKey_IsValid(globalKey) ||
+            !mixxx::track::io::key::Source_IsValid(source)) {
+        return false;
+    }
+    keyMap.set_global_key(static_cast<ChromaticKey>(globalKey));
+    keyMap.set_source(static_cast<mixxx::track::io::key::Source>(source));
+    if (!globalKeyText.isEmpty()) {
+        keyMap.set_global_key_text(globalKeyText.toStdString());
+    }
+
+    const quint64 count = reader.readVarUInt();
+    qint64 frame = 0;
+    for (quint64 i = 0; i < count && reader.isValid(); ++i) {
+        frame += reader.readVarInt();
+        const int key = reader.readUInt8();
+        if (!mixxx::track::io::key::ChromaticKey_IsValid(key)) {
+            return false;
+        }
+        KeyMap::KeyChange* pChange = keyMap.add_key_change();
+        pChange->set_frame_position(static_cast<int>(frame));
+        pChange->set_key(static_cast<ChromaticKey>(key));
+    }
+    if (!reader.isValid()) {
+        return false;
+    }
+    m_keyMap = keyMap;
+    return true;
+}
+
 void Keys::readByteArray(const QByteArray* pByteArray) {
+    if (CompactReader::hasMagic(*pByteArray, kCompactMagic)) {
+        if (!readCompactByteArray(*pByteArray)) {
+            qDebug() << "ERROR: Could not parse Keys from QByteArray of size"
+                     << pByteArray->size();
+        }
+        return;
+    }
+    // Legacy protobuf serialization.
     if (!m_keyMap.ParseFromArray(pByteArray->constData(), pByteArray->size())) {
         qDebug() << "ERROR: Could not parse Keys from QByteArray of size"
                  << pByteArray->size();
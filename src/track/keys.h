@@ -9,6 +9,9 @@
 #include "proto/keys.pb.h"
 
 #define KEY_MAP_VERSION "KeyMap-1.0"
+// Version 1 is a protobuf message, version 2 is the compact format of
+// track/compactserialization.h.
+#define KEY_MAP_2_VERSION "KeyMap-2.0"
 
 typedef QVector<QPair<mixxx::track::io::key::ChromaticKey, double> > KeyChangeList;
 
@@ -49,6 +52,8 @@ class Keys {
     Keys(const mixxx::track::io::key::KeyMap& m_keyMap);
 
     void readByteArray(const QByteArray* pByteArray);
+    // Returns false if byteArray is not a valid compact serialization.
+    bool readCompactByteArray(const QByteArray& byteArray);
 
     mutable QMutex m_mutex;
     QString m_subVersion;
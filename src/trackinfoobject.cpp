@@ -49,6 +49,7 @@ TrackInfoObject::TrackInfoObject(const QString& file,
           m_pSecurityToken(pToken.isNull() ? Sandbox::openSecurityToken(
                   m_fileInfo, true) : pToken),
           m_qMutex(QMutex::Recursive),
+          m_bHasSerializedBeats(false),
           m_analyserProgress(-1) {
     initialize(parseHeader, parseCoverArt);
 }
@@ -60,12 +61,14 @@ TrackInfoObject::TrackInfoObject(const QFileInfo& fileInfo,
           m_pSecurityToken(pToken.isNull() ? Sandbox::openSecurityToken(
                   m_fileInfo, true) : pToken),
           m_qMutex(QMutex::Recursive),
+          m_bHasSerializedBeats(false),
           m_analyserProgress(-1) {
     initialize(parseHeader, parseCoverArt);
 }
 
 TrackInfoObject::TrackInfoObject(const QDomNode &nodeHeader)
         : m_qMutex(QMutex::Recursive),
+          m_bHasSerializedBeats(false),
           m_analyserProgress(-1) {
     QString filename = XmlParse::selectNodeQString(nodeHeader, "Filename");
     QString location = XmlParse::selectNodeQString(nodeHeader, "Filepath") + "/" +  filename;
@@ -100,12 +103,14 @@ TrackInfoObject::TrackInfoObject(const QDomNode &nodeHeader)
     m_bPlayed = false;
     m_bDeleteOnReferenceExpiration = false;
     m_bDirty = false;
+    m_dirtyFields = DIRTY_NONE;
     m_bLocationChanged = false;
 }
 
 void TrackInfoObject::initialize(bool parseHeader, bool parseCoverArt) {
     m_bDeleteOnReferenceExpiration = false;
     m_bDirty = false;
+    m_dirtyFields = DIRTY_NONE;
     m_bLocationChanged = false;
 
     m_sArtist = "";
@@ -114,6 +119,7 @@ void TrackInfoObject::initialize(bool parseHeader, bool parseCoverArt) {
     m_sComment = "";
     m_sYear = "";
     m_sURL = "";
+    m_sFingerprint = "";
     m_iDuration = 0;
     m_iBitrate = 0;
     m_iTimesPlayed = 0;
@@ -256,7 +262,7 @@ void TrackInfoObject::parseArtist() {
     if (filename.count('-') == 1) {
         m_sArtist = filename.section('-', 0, 0).trimmed();
     }
-    setDirty(true);
+    markDirty(DIRTY_METADATA);
 }
 
 void TrackInfoObject::parseTitle() {
@@ -270,7 +276,7 @@ void TrackInfoObject::parseTitle() {
     } else {
         m_sTitle = filename.section('.', 0, -2).trimmed();
     }
-    setDirty(true);
+    markDirty(DIRTY_METADATA);
 }
 
 void TrackInfoObject::parseFilename() {
@@ -285,7 +291,7 @@ void TrackInfoObject::parseFilename() {
     // Find the type
     QString filename = m_fileInfo.fileName();
     m_sType = filename.section(".",-1).toLower().trimmed();
-    setDirty(true);
+    markDirty(DIRTY_METADATA);
 }
 
 QString TrackInfoObject::getDurationStr() const {
@@ -302,7 +308,7 @@ void TrackInfoObject::setLocation(const QString& location) {
     if (newFileInfo != m_fileInfo) {
         m_fileInfo = newFileInfo;
         m_bLocationChanged = true;
-        setDirty(true);
+        markDirty(DIRTY_ALL);
     }
 }
 
@@ -355,7 +361,7 @@ void TrackInfoObject::setReplayGain(float f) {
     //qDebug() << "Reported ReplayGain value: " << m_fReplayGain;
     if (m_fReplayGain != f) {
         m_fReplayGain = f;
-        setDirty(true);
+        markDirty(DIRTY_REPLAYGAIN);
     }
     lock.unlock();
     emit(ReplayGainUpdated(f));
@@ -363,6 +369,9 @@ void TrackInfoObject::setReplayGain(float f) {
 
 double TrackInfoObject::getBpm() const {
     QMutexLocker lock(&m_qMutex);
+    if (m_bHasSerializedBeats) {
+        return m_serializedBeats.summary.bpm;
+    }
     if (!m_pBeats) {
         return 0;
     }
@@ -380,6 +389,7 @@ void TrackInfoObject::setBpm(double f) {
     }
 
     QMutexLocker lock(&m_qMutex);
+    decodeSerializedBeatsLocked();
     // TODO(rryan): Assume always dirties.
     bool dirty = false;
     if (f == 0.0) {
@@ -396,7 +406,7 @@ void TrackInfoObject::setBpm(double f) {
     }
 
     if (dirty) {
-        setDirty(true);
+        markDirty(DIRTY_BEATS);
     }
 
     lock.unlock();
@@ -416,6 +426,10 @@ void TrackInfoObject::setBeats(BeatsPointer pBeats) {
     // This whole method is not so great. The fact that Beats is an ABC is
     // limiting with respect to QObject and signals/slots.
 
+    // The new beats replace any that were not decoded yet.
+    m_bHasSerializedBeats = false;
+    m_serializedBeats = SerializedBeats();
+
     QObject* pObject = NULL;
     if (m_pBeats) {
         pObject = dynamic_cast<QObject*>(m_pBeats.data());
@@ -434,7 +448,7 @@ void TrackInfoObject::setBeats(BeatsPointer pBeats) {
                     this, SLOT(slotBeatsUpdated()));
         }
     }
-    setDirty(true);
+    markDirty(DIRTY_BEATS);
     lock.unlock();
     emit(bpmUpdated(bpm));
     emit(beatsUpdated());
@@ -442,12 +456,91 @@ void TrackInfoObject::setBeats(BeatsPointer pBeats) {
 
 BeatsPointer TrackInfoObject::getBeats() const {
     QMutexLocker lock(&m_qMutex);
+    decodeSerializedBeatsLocked();
     return m_pBeats;
 }
 
+void TrackInfoObject::setSerializedBeats(const QString& version,
+                                         const QString& subVersion,
+                                         const QByteArray& beatsBlob,
+                                         const BeatsSummary& summary) {
+    QMutexLocker lock(&m_qMutex);
+    if (m_pBeats) {
+        QObject* pObject = dynamic_cast<QObject*>(m_pBeats.data());
+        if (pObject) {
+            disconnect(pObject, SIGNAL(updated()),
+                       this, SLOT(slotBeatsUpdated()));
+        }
+        m_pBeats.clear();
+    }
+    m_serializedBeats.version = version;
+    m_serializedBeats.subVersion = subVersion;
+    m_serializedBeats.blob = beatsBlob;
+    m_serializedBeats.summary = summary;
+    m_bHasSerializedBeats = true;
+}
+
+bool TrackInfoObject::getSerializedBeats(QString* pVersion,
+                                         QString* pSubVersion,
+                                         QByteArray* pBeatsBlob,
+                                         BeatsSummary* pSummary) const {
+    QMutexLocker lock(&m_qMutex);
+    // Rows written before the summary columns existed have no summary. Those
+    // are decoded once here and written back in the compact format.
+    if (m_bHasSerializedBeats &&
+            m_serializedBeats.summary.type != BeatsSummary::NONE) {
+        *pVersion = m_serializedBeats.version;
+        *pSubVersion = m_serializedBeats.subVersion;
+        *pBeatsBlob = m_serializedBeats.blob;
+        *pSummary = m_serializedBeats.summary;
+        return true;
+    }
+    decodeSerializedBeatsLocked();
+    if (!m_pBeats) {
+        return false;
+    }
+    QByteArray* pBlob = m_pBeats->toByteArray();
+    *pBeatsBlob = *pBlob;
+    delete pBlob;
+    *pVersion = m_pBeats->getVersion();
+    *pSubVersion = m_pBeats->getSubVersion();
+    *pSummary = BeatFactory::makeSummary(m_pBeats);
+    return true;
+}
+
+void TrackInfoObject::decodeSerializedBeatsLocked() const {
+    if (!m_bHasSerializedBeats) {
+        return;
+    }
+    ScopedTimer t("TrackInfoObject::decodeSerializedBeats");
+    SerializedBeats serialized = m_serializedBeats;
+    m_bHasSerializedBeats = false;
+    m_serializedBeats = SerializedBeats();
+
+    // The beats only read the sample rate and thread of the track.
+    TrackInfoObject* pTrack = const_cast<TrackInfoObject*>(this);
+    BeatsPointer pBeats = BeatFactory::loadBeatsFromByteArray(
+            pTrack, serialized.version, serialized.subVersion,
+            &serialized.blob);
+    if (!pBeats && serialized.summary.bpm > 0.0) {
+        // Fall back on the cached BPM.
+        pBeats = BeatFactory::makeBeatGrid(
+                pTrack, serialized.summary.bpm,
+                serialized.summary.firstBeatSample);
+    }
+    m_pBeats = pBeats;
+    if (m_pBeats) {
+        QObject* pObject = dynamic_cast<QObject*>(m_pBeats.data());
+        if (pObject) {
+            connect(pObject, SIGNAL(updated()),
+                    this, SLOT(slotBeatsUpdated()));
+        }
+    }
+}
+
 void TrackInfoObject::slotBeatsUpdated() {
     QMutexLocker lock(&m_qMutex);
-    setDirty(true);
+    markDirty(DIRTY_BEATS);
     double bpm = m_pBeats->getBpm();
     lock.unlock();
     emit(bpmUpdated(bpm));
@@ -465,7 +558,7 @@ void TrackInfoObject::setHeaderParsed(bool parsed)
     QMutexLocker lock(&m_qMutex);
     if (m_bHeaderParsed != parsed) {
         m_bHeaderParsed = parsed;
-        setDirty(true);
+        markDirty(DIRTY_AUDIO_PROPERTIES);
     }
 }
 
@@ -506,7 +599,7 @@ void TrackInfoObject::setDuration(int i) {
     QMutexLocker lock(&m_qMutex);
     if (m_iDuration != i) {
         m_iDuration = i;
-        setDirty(true);
+        markDirty(DIRTY_AUDIO_PROPERTIES);
     }
 }
 
@@ -520,7 +613,7 @@ void TrackInfoObject::setTitle(const QString& s) {
     QString title = s.trimmed();
     if (m_sTitle != title) {
         m_sTitle = title;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -534,7 +627,7 @@ void TrackInfoObject::setArtist(const QString& s) {
     QString artist = s.trimmed();
     if (m_sArtist != artist) {
         m_sArtist = artist;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -548,7 +641,7 @@ void TrackInfoObject::setAlbum(const QString& s) {
     QString album = s.trimmed();
     if (m_sAlbum != album) {
         m_sAlbum = album;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -562,7 +655,7 @@ void TrackInfoObject::setAlbumArtist(const QString& s) {
     QString st = s.trimmed();
     if (m_sAlbumArtist != st) {
         m_sAlbumArtist = st;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -576,7 +669,7 @@ void TrackInfoObject::setYear(const QString& s) {
     QString year = s.trimmed();
     if (m_sYear != year) {
         m_sYear = year;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -590,7 +683,7 @@ void TrackInfoObject::setGenre(const QString& s) {
     QString genre = s.trimmed();
     if (m_sGenre != genre) {
         m_sGenre = genre;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -604,7 +697,7 @@ void TrackInfoObject::setComposer(const QString& s) {
     QString composer = s.trimmed();
     if (m_sComposer != composer) {
         m_sComposer = composer;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -618,7 +711,7 @@ void TrackInfoObject::setGrouping(const QString& s) {
     QString grouping = s.trimmed();
     if (m_sGrouping != grouping) {
         m_sGrouping = grouping;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -632,7 +725,7 @@ void TrackInfoObject::setTrackNumber(const QString& s) {
     QString tn = s.trimmed();
     if (m_sTrackNumber != tn) {
         m_sTrackNumber = tn;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -645,7 +738,7 @@ void TrackInfoObject::setTimesPlayed(int t) {
     QMutexLocker lock(&m_qMutex);
     if (t != m_iTimesPlayed) {
         m_iTimesPlayed = t;
-        setDirty(true);
+        markDirty(DIRTY_PLAY_COUNT);
     }
 }
 
@@ -663,11 +756,11 @@ void TrackInfoObject::setPlayedAndUpdatePlaycount(bool bPlayed) {
     QMutexLocker lock(&m_qMutex);
     if (bPlayed) {
         ++m_iTimesPlayed;
-        setDirty(true);
+        markDirty(DIRTY_PLAY_COUNT);
     }
     else if (m_bPlayed && !bPlayed) {
         m_iTimesPlayed = math_max(0, m_iTimesPlayed - 1);
-        setDirty(true);
+        markDirty(DIRTY_PLAY_COUNT);
     }
     m_bPlayed = bPlayed;
 }
@@ -676,7 +769,7 @@ void TrackInfoObject::setPlayed(bool bPlayed) {
     QMutexLocker lock(&m_qMutex);
     if (bPlayed != m_bPlayed) {
         m_bPlayed = bPlayed;
-        setDirty(true);
+        markDirty(DIRTY_PLAY_COUNT);
     }
 }
 
@@ -689,7 +782,7 @@ void TrackInfoObject::setComment(const QString& s) {
     QMutexLocker lock(&m_qMutex);
     if (s != m_sComment) {
         m_sComment = s;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -702,7 +795,7 @@ void TrackInfoObject::setType(const QString& s) {
     QMutexLocker lock(&m_qMutex);
     if (s != m_sType) {
         m_sType = s;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -710,7 +803,7 @@ void TrackInfoObject::setSampleRate(int iSampleRate) {
     QMutexLocker lock(&m_qMutex);
     if (m_iSampleRate != iSampleRate) {
         m_iSampleRate = iSampleRate;
-        setDirty(true);
+        markDirty(DIRTY_AUDIO_PROPERTIES);
     }
 }
 
@@ -723,7 +816,7 @@ void TrackInfoObject::setChannels(int iChannels) {
     QMutexLocker lock(&m_qMutex);
     if (m_iChannels != iChannels) {
         m_iChannels = iChannels;
-        setDirty(true);
+        markDirty(DIRTY_AUDIO_PROPERTIES);
     }
 }
 
@@ -750,7 +843,7 @@ void TrackInfoObject::setBitrate(int i) {
     QMutexLocker lock(&m_qMutex);
     if (m_iBitrate != i) {
         m_iBitrate = i;
-        setDirty(true);
+        markDirty(DIRTY_AUDIO_PROPERTIES);
     }
 }
 
@@ -788,7 +881,7 @@ void TrackInfoObject::setURL(const QString& url) {
     QMutexLocker lock(&m_qMutex);
     if (m_sURL != url) {
         m_sURL = url;
-        setDirty(true);
+        markDirty(DIRTY_METADATA);
     }
 }
 
@@ -797,12 +890,28 @@ QString TrackInfoObject::getURL() {
     return m_sURL;
 }
 
+QString TrackInfoObject::getFingerprint() const {
+    QMutexLocker lock(&m_qMutex);
+    return m_sFingerprint;
+}
+
+void TrackInfoObject::setFingerprint(const QString& fingerprint) {
+    QMutexLocker lock(&m_qMutex);
+    if (m_sFingerprint != fingerprint) {
+        m_sFingerprint = fingerprint;
+        markDirty(DIRTY_FINGERPRINT);
+    }
+}
+
 ConstWaveformPointer TrackInfoObject::getWaveform() {
     return m_waveform;
 }
 
 void TrackInfoObject::setWaveform(ConstWaveformPointer pWaveform) {
     m_waveform = pWaveform;
+    if (pWaveform && pWaveform->isDirty()) {
+        markDirty(DIRTY_WAVEFORM);
+    }
     emit(waveformUpdated());
 }
 
@@ -812,6 +921,9 @@ ConstWaveformPointer TrackInfoObject::getWaveformSummary() const {
 
 void TrackInfoObject::setWaveformSummary(ConstWaveformPointer pWaveform) {
     m_waveformSummary = pWaveform;
+    if (pWaveform && pWaveform->isDirty()) {
+        markDirty(DIRTY_WAVEFORM);
+    }
     emit(waveformSummaryUpdated());
 }
 
@@ -832,7 +944,7 @@ void TrackInfoObject::setCuePoint(float cue) {
     QMutexLocker lock(&m_qMutex);
     if (m_fCuePoint != cue) {
         m_fCuePoint = cue;
-        setDirty(true);
+        markDirty(DIRTY_CUE_POINT);
     }
 }
 
@@ -842,7 +954,7 @@ float TrackInfoObject::getCuePoint() {
 }
 
 void TrackInfoObject::slotCueUpdated() {
-    setDirty(true);
+    markDirty(DIRTY_CUES);
     emit(cuesUpdated());
 }
 
@@ -853,7 +965,7 @@ Cue* TrackInfoObject::addCue() {
     connect(cue, SIGNAL(updated()),
             this, SLOT(slotCueUpdated()));
     m_cuePoints.push_back(cue);
-    setDirty(true);
+    markDirty(DIRTY_CUES);
     lock.unlock();
     emit(cuesUpdated());
     return cue;
@@ -864,7 +976,7 @@ void TrackInfoObject::removeCue(Cue* cue) {
     disconnect(cue, 0, this, 0);
     // TODO(XXX): Delete the cue point.
     m_cuePoints.removeOne(cue);
-    setDirty(true);
+    markDirty(DIRTY_CUES);
     lock.unlock();
     emit(cuesUpdated());
 }
@@ -889,32 +1001,40 @@ void TrackInfoObject::setCuePoints(QList<Cue*> cuePoints) {
         connect(cue, SIGNAL(updated()),
                 this, SLOT(slotCueUpdated()));
     }
-    setDirty(true);
+    markDirty(DIRTY_CUES);
     lock.unlock();
     emit(cuesUpdated());
 }
 
 void TrackInfoObject::setDirty(bool bDirty) {
+    if (bDirty) {
+        markDirty(DIRTY_ALL);
+        return;
+    }
 
     QMutexLocker lock(&m_qMutex);
-    bool change = m_bDirty != bDirty;
-    m_bDirty = bDirty;
+    bool change = m_bDirty;
+    m_bDirty = false;
+    m_dirtyFields = DIRTY_NONE;
+    lock.unlock();
+    if (change) {
+        emit(clean(this));
+    }
+}
+
+void TrackInfoObject::markDirty(int fields) {
+    QMutexLocker lock(&m_qMutex);
+    bool change = !m_bDirty;
+    m_bDirty = true;
+    m_dirtyFields |= fields;
     lock.unlock();
     // qDebug() << "Track" << m_iId << getInfo() << (change? "changed" : "unchanged")
-    //          << "set" << (bDirty ? "dirty" : "clean");
+    //          << "set dirty" << fields;
     if (change) {
-        if (m_bDirty) {
-            emit(dirty(this));
-        } else {
-            emit(clean(this));
-        }
+        emit(dirty(this));
     }
     // Emit a changed signal regardless if this attempted to set us dirty.
-    if (bDirty) {
-        emit(changed(this));
-    }
-
-    //qDebug() << QString("TrackInfoObject %1 %2 set to %3").arg(QString::number(m_iId), m_fileInfo.absoluteFilePath(), m_bDirty ? "dirty" : "clean");
+    emit(changed(this));
 }
 
 bool TrackInfoObject::isDirty() {
@@ -922,6 +1042,11 @@ bool TrackInfoObject::isDirty() {
     return m_bDirty;
 }
 
+int TrackInfoObject::getDirtyFields() const {
+    QMutexLocker lock(&m_qMutex);
+    return m_dirtyFields;
+}
+
 bool TrackInfoObject::locationChanged() {
     QMutexLocker lock(&m_qMutex);
     return m_bLocationChanged;
@@ -936,13 +1061,13 @@ void TrackInfoObject::setRating (int rating) {
     QMutexLocker lock(&m_qMutex);
     if (rating != m_Rating) {
         m_Rating = rating;
-        setDirty(true);
+        markDirty(DIRTY_RATING);
     }
 }
 
 void TrackInfoObject::setKeys(Keys keys) {
     QMutexLocker lock(&m_qMutex);
-    setDirty(true);
+    markDirty(DIRTY_KEYS);
     m_keys = keys;
     // Might be INVALID. We don't care.
     mixxx::track::io::key::ChromaticKey newKey = m_keys.getGlobalKey();
@@ -976,7 +1101,7 @@ void TrackInfoObject::setKey(mixxx::track::io::key::ChromaticKey key,
     }
 
     if (dirty) {
-        setDirty(true);
+        markDirty(DIRTY_KEYS);
     }
 
     // Might be INVALID. We don't care.
@@ -1000,7 +1125,7 @@ void TrackInfoObject::setKeyText(QString key,
              newKeys.getGlobalKeyText() != m_keys.getGlobalKeyText());
     if (dirty) {
         m_keys = newKeys;
-        setDirty(true);
+        markDirty(DIRTY_KEYS);
         // Might be INVALID. We don't care.
         mixxx::track::io::key::ChromaticKey newKey = m_keys.getGlobalKey();
         lock.unlock();
@@ -1026,7 +1151,7 @@ void TrackInfoObject::setBpmLock(bool bpmLock) {
     QMutexLocker lock(&m_qMutex);
     if (bpmLock != m_bBpmLock) {
         m_bBpmLock = bpmLock;
-        setDirty(true);
+        markDirty(DIRTY_BPM_LOCK);
     }
 }
 
@@ -1040,7 +1165,7 @@ void TrackInfoObject::setCoverInfo(const CoverInfo& info) {
     if (info != m_coverArt.info) {
         m_coverArt = CoverArt();
         m_coverArt.info = info;
-        setDirty(true);
+        markDirty(DIRTY_COVER_ART);
         lock.unlock();
         emit(coverArtUpdated());
     }
@@ -1055,7 +1180,7 @@ void TrackInfoObject::setCoverArt(const CoverArt& cover) {
     QMutexLocker lock(&m_qMutex);
     if (cover != m_coverArt) {
         m_coverArt = cover;
-        setDirty(true);
+        markDirty(DIRTY_COVER_ART);
         lock.unlock();
         emit(coverArtUpdated());
     }
@@ -47,6 +47,32 @@ typedef QWeakPointer<TrackInfoObject> TrackWeakPointer;
 class TrackInfoObject : public QObject {
     Q_OBJECT
   public:
+    // The groups of library columns that a change to the track can touch.
+    // TrackDAO only writes the groups that are dirty.
+    enum DirtyField {
+        DIRTY_NONE = 0x0000,
+        // Artist, title, album, album artist, year, genre, composer,
+        // grouping, track number, comment, URL and file type.
+        DIRTY_METADATA = 0x0001,
+        // Duration, bitrate, sample rate, channels and header_parsed.
+        DIRTY_AUDIO_PROPERTIES = 0x0002,
+        DIRTY_REPLAYGAIN = 0x0004,
+        // Times played and played.
+        DIRTY_PLAY_COUNT = 0x0008,
+        DIRTY_RATING = 0x0010,
+        DIRTY_CUE_POINT = 0x0020,
+        // The cue points in the cues table.
+        DIRTY_CUES = 0x0040,
+        DIRTY_BEATS = 0x0080,
+        DIRTY_BPM_LOCK = 0x0100,
+        DIRTY_KEYS = 0x0200,
+        DIRTY_COVER_ART = 0x0400,
+        DIRTY_FINGERPRINT = 0x0800,
+        // The waveform and waveform summary in the analysis table.
+        DIRTY_WAVEFORM = 0x1000,
+        DIRTY_ALL = 0x1FFF
+    };
+
     // Initialize a new track with the filename.
     TrackInfoObject(const QString& file="",
                     SecurityTokenPointer pToken=SecurityTokenPointer(),
@@ -223,6 +249,11 @@ class TrackInfoObject : public QObject {
     // Set URL for track
     void setURL(const QString& url);
 
+    // Get the AcoustID fingerprint of the first two minutes of the track, or
+    // an empty string if it was not calculated yet.
+    QString getFingerprint() const;
+    void setFingerprint(const QString& fingerprint);
+
     ConstWaveformPointer getWaveform();
     void setWaveform(ConstWaveformPointer pWaveform);
 
@@ -244,6 +275,8 @@ class TrackInfoObject : public QObject {
     void setCuePoints(QList<Cue*> cuePoints);
 
     bool isDirty();
+    // Returns the DirtyFields that changed since the track was last saved.
+    int getDirtyFields() const;
 
     // Returns true if the track location has changed
     bool locationChanged();
@@ -251,12 +284,26 @@ class TrackInfoObject : public QObject {
     // Set the track's full file path
     void setLocation(const QString& location);
 
-    // Get the track's Beats list
+    // Get the track's Beats list. Beats set with setSerializedBeats() are
+    // decoded on the first call.
     BeatsPointer getBeats() const;
 
     // Set the track's Beats
     void setBeats(BeatsPointer beats);
 
+    // Sets the track's beats from their serialization without decoding them.
+    // Until getBeats() is called getBpm() is answered from the summary. Does
+    // not mark the track dirty.
+    void setSerializedBeats(const QString& version, const QString& subVersion,
+                            const QByteArray& beatsBlob,
+                            const BeatsSummary& summary);
+    // Returns the serialization and summary of the track's beats. Beats that
+    // were never decoded are returned as they were set. Returns false if the
+    // track has no beats.
+    bool getSerializedBeats(QString* pVersion, QString* pSubVersion,
+                            QByteArray* pBeatsBlob,
+                            BeatsSummary* pSummary) const;
+
     void setKeys(Keys keys);
     const Keys& getKeys() const;
     double getNumericKey() const;
@@ -315,8 +362,10 @@ class TrackInfoObject : public QObject {
     void parseTitle();
 
     // Set whether the TIO is dirty not. This should never be called except by
-    // TIO local methods or the TrackDAO.
+    // TIO local methods or the TrackDAO. Setting it dirty marks all fields.
     void setDirty(bool bDirty);
+    // Sets the TIO dirty and records which DirtyFields changed.
+    void markDirty(int fields);
 
     // Set a unique identifier for the track. Only used by services like
     // TrackDAO
@@ -329,6 +378,8 @@ class TrackInfoObject : public QObject {
     // Flag that indicates whether or not the TIO has changed. This is used by
     // TrackDAO to determine whether or not to write the Track back.
     bool m_bDirty;
+    // The DirtyFields that changed since the track was last saved.
+    int m_dirtyFields;
 
     // Special flag for telling if the track location was changed.
     bool m_bLocationChanged;
@@ -365,6 +416,8 @@ class TrackInfoObject : public QObject {
     QString m_sComment;
     // URL (used in promo track)
     QString m_sURL;
+    // Encoded chromaprint fingerprint
+    QString m_sFingerprint;
     // Duration of track in seconds
     int m_iDuration;
     // Sample rate
@@ -401,8 +454,22 @@ class TrackInfoObject : public QObject {
     // Mutex protecting access to object
     mutable QMutex m_qMutex;
 
-    // Storage for the track's beats
-    BeatsPointer m_pBeats;
+    // Decodes the beats set by setSerializedBeats(), if any. Must hold
+    // m_qMutex.
+    void decodeSerializedBeatsLocked() const;
+
+    // Storage for the track's beats. Mutable since they are decoded lazily.
+    mutable BeatsPointer m_pBeats;
+
+    // Beats that have not been decoded yet.
+    struct SerializedBeats {
+        QString version;
+        QString subVersion;
+        QByteArray blob;
+        BeatsSummary summary;
+    };
+    mutable SerializedBeats m_serializedBeats;
+    mutable bool m_bHasSerializedBeats;
 
     //Visual waveform data
     ConstWaveformPointer m_waveform;
@@ -0,0 +1,308 @@
+#include <QtDebug>
+#include <QMutexLocker>
+#include <QSet>
+
+#include "trackprestager.h"
+#include "cachingreaderworker.h"
+#include "library/dao/cue.h"
+#include "playerinfo.h"
+#include "sampleutil.h"
+#include "soundsourceproxy.h"
+#include "util/counter.h"
+#include "util/event.h"
+#include "util/math.h"
+
+namespace {
+
+const int kDefaultLeadInSeconds = 10;
+const int kDefaultMemoryLimitMB = 64;
+
+// The number of seconds to stage after every cue and hotcue position.
+const int kCueRegionSeconds = 2;
+
+// Hovering over the library produces a stream of requests. Only the most
+// recent ones are worth staging.
+const int kMaxPendingRequests = 2;
+
+TrackPrestager* s_pTrackPrestager = NULL;
+
+}  // anonymous namespace
+
+int PrestagedTrack::takeChunk(int chunk_number, CSAMPLE* pDest) {
+    QHash<int, QVector<CSAMPLE> >::iterator it = m_chunks.find(chunk_number);
+    if (it == m_chunks.end()) {
+        return 0;
+    }
+    const QVector<CSAMPLE>& chunk = it.value();
+    int length = chunk.size();
+    memcpy(pDest, chunk.constData(), sizeof(*pDest) * length);
+    m_chunks.erase(it);
+    return length;
+}
+
+// static
+TrackPrestager* TrackPrestager::create(ConfigObject<ConfigValue>* pConfig) {
+    if (!s_pTrackPrestager) {
+        s_pTrackPrestager = new TrackPrestager(pConfig);
+        s_pTrackPrestager->start(QThread::LowPriority);
+    }
+    return s_pTrackPrestager;
+}
+
+// static
+TrackPrestager* TrackPrestager::instance() {
+    return s_pTrackPrestager;
+}
+
+// static
+void TrackPrestager::destroy() {
+    TrackPrestager* pPrestager = s_pTrackPrestager;
+    s_pTrackPrestager = NULL;
+    delete pPrestager;
+}
+
+TrackPrestager::TrackPrestager(ConfigObject<ConfigValue>* pConfig)
+        : m_pConfig(pConfig),
+          m_bAbortCurrent(false),
+          m_iStagedChunks(0),
+          m_iMaxChunks(0),
+          m_bStop(false),
+          m_pSample(new SAMPLE[CachingReaderWorker::kSamplesPerChunk]) {
+    int memoryLimitMB = m_pConfig->getValueString(
+            ConfigKey("[Prestage]", "MemoryLimitMB"),
+            QString::number(kDefaultMemoryLimitMB)).toInt();
+    m_iMaxChunks = math_max(0, memoryLimitMB) * 1024 * 1024 /
+            CachingReaderWorker::kChunkLength;
+}
+
+TrackPrestager::~TrackPrestager() {
+    stop();
+    wait();
+    delete [] m_pSample;
+}
+
+void TrackPrestager::stop() {
+    QMutexLocker locker(&m_mutex);
+    m_bStop = true;
+    m_bAbortCurrent = true;
+    m_requestAvailable.wakeAll();
+}
+
+void TrackPrestager::slotPrestageTrack(TrackPointer pTrack) {
+    if (!pTrack || m_iMaxChunks <= 0) {
+        return;
+    }
+    if (!m_pConfig->getValueString(
+            ConfigKey("[Prestage]", "Enabled"), "1").toInt()) {
+        return;
+    }
+    // Nothing to gain for a track that a player already holds.
+    if (PlayerInfo::instance().isTrackLoaded(pTrack)) {
+        return;
+    }
+
+    PrestageRequest request;
+    request.location = pTrack->getLocation();
+    request.pTrack = pTrack;
+    if (request.location.isEmpty()) {
+        return;
+    }
+
+    float cuePoint = pTrack->getCuePoint();
+    if (cuePoint > 0) {
+        request.cuePositions.append(static_cast<int>(cuePoint));
+    }
+    const QList<Cue*>& cuePoints = pTrack->getCuePoints();
+    foreach (Cue* pCue, cuePoints) {
+        if (pCue->getType() == Cue::CUE || pCue->getType() == Cue::LOAD) {
+            int position = pCue->getPosition();
+            if (position > 0) {
+                request.cuePositions.append(position);
+            }
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (m_pCurrent && m_pCurrent->getLocation() == request.location) {
+        return;
+    }
+    int stagedIndex = indexOfStagedLocked(request.location);
+    if (stagedIndex >= 0) {
+        // Already staged, mark it as the most recently requested one.
+        m_staged.move(stagedIndex, m_staged.size() - 1);
+        return;
+    }
+    for (int i = 0; i < m_requests.size(); ++i) {
+        if (m_requests[i].location == request.location) {
+            m_requests.removeAt(i);
+            break;
+        }
+    }
+    m_requests.append(request);
+    while (m_requests.size() > kMaxPendingRequests) {
+        m_requests.removeFirst();
+    }
+    m_requestAvailable.wakeAll();
+}
+
+PrestagedTrackPointer TrackPrestager::takeStagedTrack(const TrackPointer& pTrack) {
+    if (!pTrack) {
+        return PrestagedTrackPointer();
+    }
+    const QString location = pTrack->getLocation();
+
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_requests.size(); ++i) {
+        if (m_requests[i].location == location) {
+            m_requests.removeAt(i);
+            break;
+        }
+    }
+
+    // Let the staging thread finish the chunk it is decoding and publish what
+    // it has so far.
+    while (m_pCurrent && m_pCurrent->getLocation() == location) {
+        m_bAbortCurrent = true;
+        m_currentFinished.wait(&m_mutex);
+    }
+
+    int stagedIndex = indexOfStagedLocked(location);
+    if (stagedIndex < 0) {
+        return PrestagedTrackPointer();
+    }
+    PrestagedTrackPointer pStaged = m_staged.takeAt(stagedIndex);
+    m_iStagedChunks -= pStaged->chunkCount();
+    return pStaged;
+}
+
+int TrackPrestager::indexOfStagedLocked(const QString& location) const {
+    for (int i = 0; i < m_staged.size(); ++i) {
+        if (m_staged[i]->getLocation() == location) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool TrackPrestager::evictOldestLocked() {
+    if (m_staged.isEmpty()) {
+        return false;
+    }
+    PrestagedTrackPointer pOldest = m_staged.takeFirst();
+    m_iStagedChunks -= pOldest->chunkCount();
+    return true;
+}
+
+QList<int> TrackPrestager::chunksForRequest(const PrestageRequest& request,
+                                            int numSamples,
+                                            int sampleRate) const {
+    int leadInSeconds = m_pConfig->getValueString(
+            ConfigKey("[Prestage]", "LeadInSeconds"),
+            QString::number(kDefaultLeadInSeconds)).toInt();
+    const int kSamplesPerChunk = CachingReaderWorker::kSamplesPerChunk;
+    const int lastChunk = (numSamples - 1) / kSamplesPerChunk;
+
+    // Samples are interleaved stereo.
+    int leadInChunks = (leadInSeconds * sampleRate * 2) / kSamplesPerChunk + 1;
+    int cueChunks = (kCueRegionSeconds * sampleRate * 2) / kSamplesPerChunk + 1;
+
+    QSet<int> chunks;
+    for (int i = 0; i < leadInChunks && i <= lastChunk; ++i) {
+        chunks.insert(i);
+    }
+    foreach (int position, request.cuePositions) {
+        int firstChunk = position / kSamplesPerChunk;
+        for (int i = firstChunk; i < firstChunk + cueChunks && i <= lastChunk; ++i) {
+            chunks.insert(i);
+        }
+    }
+
+    QList<int> sortedChunks = chunks.toList();
+    qSort(sortedChunks);
+    return sortedChunks;
+}
+
+void TrackPrestager::stageTrack(const PrestageRequest& request) {
+    SoundSourceProxy soundSourceProxy(request.pTrack);
+    Mixxx::SoundSourcePointer pSoundSource(soundSourceProxy.open());
+    if (pSoundSource.isNull() || pSoundSource->length() <= 0) {
+        qWarning() << "TrackPrestager: Failed to open file:" << request.location;
+        return;
+    }
+
+    PrestagedTrackPointer pStaged(new PrestagedTrack(request.location));
+    pStaged->m_pSoundSource = pSoundSource;
+    pStaged->m_iNumSamples = pSoundSource->length();
+    pStaged->m_iSampleRate = pSoundSource->getSampleRate();
+
+    QList<int> chunks = chunksForRequest(request, pStaged->m_iNumSamples,
+                                         pStaged->m_iSampleRate);
+
+    QMutexLocker locker(&m_mutex);
+    if (m_bStop) {
+        return;
+    }
+    m_pCurrent = pStaged;
+    m_bAbortCurrent = false;
+
+    foreach (int chunk_number, chunks) {
+        if (m_bAbortCurrent) {
+            break;
+        }
+        // Make room in the pool. We never evict the track we are staging.
+        if (m_iStagedChunks + pStaged->chunkCount() >= m_iMaxChunks &&
+                !evictOldestLocked()) {
+            break;
+        }
+        locker.unlock();
+
+        int sample_position = CachingReaderWorker::sampleForChunk(chunk_number);
+        int samples_to_read = math_min(CachingReaderWorker::kSamplesPerChunk,
+                                       pStaged->m_iNumSamples - sample_position);
+        int samples_read = 0;
+        if (samples_to_read > 0) {
+            pSoundSource->seek(sample_position);
+            samples_read = pSoundSource->read(samples_to_read, m_pSample);
+        }
+        QVector<CSAMPLE> chunk;
+        if (samples_read > 0) {
+            chunk.resize(samples_read);
+            SampleUtil::convertS16ToFloat32(chunk.data(), m_pSample,
+                                            samples_read);
+        }
+
+        locker.relock();
+        if (samples_read <= 0) {
+            // End of the file, the remaining chunks can't be read either.
+            break;
+        }
+        pStaged->m_chunks.insert(chunk_number, chunk);
+    }
+
+    Counter("TrackPrestager staged chunks") += pStaged->chunkCount();
+    m_staged.append(pStaged);
+    m_iStagedChunks += pStaged->chunkCount();
+    m_pCurrent.clear();
+    m_currentFinished.wakeAll();
+}
+
+void TrackPrestager::run() {
+    QThread::currentThread()->setObjectName("TrackPrestager");
+
+    m_mutex.lock();
+    while (!m_bStop) {
+        if (m_requests.isEmpty()) {
+            m_requestAvailable.wait(&m_mutex);
+            continue;
+        }
+        PrestageRequest request = m_requests.takeLast();
+        m_mutex.unlock();
+
+        Event::start("TrackPrestager stage");
+        stageTrack(request);
+        Event::end("TrackPrestager stage");
+
+        m_mutex.lock();
+    }
+    m_mutex.unlock();
+}
@@ -0,0 +1,151 @@
+#ifndef TRACKPRESTAGER_H
+#define TRACKPRESTAGER_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "configobject.h"
+#include "soundsource.h"
+#include "trackinfoobject.h"
+#include "util/types.h"
+
+// A PrestagedTrack holds a speculatively opened SoundSource and a set of
+// chunks decoded from it ahead of time. The chunk numbering and size match
+// CachingReaderWorker so that the worker can hand the decoded chunks straight
+// to its CachingReader instead of seeking and decoding them again.
+class PrestagedTrack {
+  public:
+    PrestagedTrack(const QString& location)
+            : m_location(location),
+              m_iNumSamples(0),
+              m_iSampleRate(0) {
+    }
+
+    const QString& getLocation() const {
+        return m_location;
+    }
+
+    // Transfers ownership of the SoundSource to the caller. The staged track
+    // holds no reference to it afterwards.
+    Mixxx::SoundSourcePointer takeSoundSource() {
+        Mixxx::SoundSourcePointer pSoundSource = m_pSoundSource;
+        m_pSoundSource.clear();
+        return pSoundSource;
+    }
+
+    int getNumSamples() const {
+        return m_iNumSamples;
+    }
+
+    int getSampleRate() const {
+        return m_iSampleRate;
+    }
+
+    int chunkCount() const {
+        return m_chunks.size();
+    }
+
+    bool hasChunk(int chunk_number) const {
+        return m_chunks.contains(chunk_number);
+    }
+
+    // Copies the decoded chunk into pDest (which must hold at least
+    // CachingReaderWorker::kSamplesPerChunk samples) and releases it. Returns
+    // the number of samples copied or 0 if the chunk was not staged.
+    int takeChunk(int chunk_number, CSAMPLE* pDest);
+
+  private:
+    QString m_location;
+    Mixxx::SoundSourcePointer m_pSoundSource;
+    int m_iNumSamples;
+    int m_iSampleRate;
+    QHash<int, QVector<CSAMPLE> > m_chunks;
+
+    friend class TrackPrestager;
+};
+
+typedef QSharedPointer<PrestagedTrack> PrestagedTrackPointer;
+
+// TrackPrestager speculatively opens and decodes the beginning and the cue
+// regions of tracks that are likely to be loaded soon (the next Auto DJ queue
+// entry, the track selected in the library) into a bounded memory pool. When
+// one of these tracks is then loaded into a deck, sampler or preview deck the
+// CachingReaderWorker takes the staged SoundSource and chunks over with
+// takeStagedTrack() instead of starting cold.
+//
+// Staging happens in a low priority background thread. The pool is evicted
+// in least-recently-requested order once the configured memory limit is
+// reached.
+class TrackPrestager : public QThread {
+    Q_OBJECT
+  public:
+    static TrackPrestager* create(ConfigObject<ConfigValue>* pConfig);
+    // Returns NULL if no TrackPrestager has been created.
+    static TrackPrestager* instance();
+    static void destroy();
+
+    // Removes the staged data for pTrack from the pool and returns it, or a
+    // null pointer if nothing was staged. If the track is currently being
+    // staged this blocks until the staging thread has finished decoding its
+    // current chunk. Called from the CachingReaderWorker threads.
+    PrestagedTrackPointer takeStagedTrack(const TrackPointer& pTrack);
+
+    void stop();
+
+  public slots:
+    // Requests pTrack to be staged. Tracks that are already loaded into a
+    // player are ignored. Must be called from the main thread.
+    void slotPrestageTrack(TrackPointer pTrack);
+
+  protected:
+    void run();
+
+  private:
+    TrackPrestager(ConfigObject<ConfigValue>* pConfig);
+    virtual ~TrackPrestager();
+
+    struct PrestageRequest {
+        QString location;
+        TrackPointer pTrack;
+        // Cue and hotcue positions in samples. Copied in the main thread since
+        // the cue list of a TrackInfoObject is not thread-safe.
+        QList<int> cuePositions;
+    };
+
+    // Returns the sorted list of chunk numbers to decode for the request.
+    QList<int> chunksForRequest(const PrestageRequest& request,
+                                int numSamples, int sampleRate) const;
+    void stageTrack(const PrestageRequest& request);
+    // Evicts the least recently requested staged track. Must hold m_mutex.
+    // Returns false if there was nothing to evict.
+    bool evictOldestLocked();
+    // Must hold m_mutex.
+    int indexOfStagedLocked(const QString& location) const;
+
+    ConfigObject<ConfigValue>* m_pConfig;
+
+    // Guards all members below.
+    QMutex m_mutex;
+    QWaitCondition m_requestAvailable;
+    QWaitCondition m_currentFinished;
+    QList<PrestageRequest> m_requests;
+    // Staged tracks, least recently requested first.
+    QList<PrestagedTrackPointer> m_staged;
+    // The track the staging thread is decoding right now, if any.
+    PrestagedTrackPointer m_pCurrent;
+    bool m_bAbortCurrent;
+    int m_iStagedChunks;
+    int m_iMaxChunks;
+    bool m_bStop;
+
+    // Temporary buffer for reading from SoundSources.
+    SAMPLE* m_pSample;
+};
+
+#endif /* TRACKPRESTAGER_H */
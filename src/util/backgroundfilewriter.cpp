@@ -0,0 +1,186 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtDebug>
+
+#ifdef __WINDOWS__
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+#include "util/backgroundfilewriter.h"
+
+namespace {
+
+// The minimum time between two writes of the same file. Settings are saved
+// from many places, often several times in a row.
+const qint64 kMinWriteIntervalMillis = 2000;
+
+bool syncFile(QFile* pFile) {
+    if (!pFile->flush()) {
+        return false;
+    }
+#ifdef __WINDOWS__
+    return _commit(pFile->handle()) == 0;
+#else
+    return fsync(pFile->handle()) == 0;
+#endif
+}
+
+}  // anonymous namespace
+
+// static
+QMutex BackgroundFileWriter::s_instanceMutex;
+// static
+BackgroundFileWriter* BackgroundFileWriter::s_pInstance = NULL;
+
+BackgroundFileWriter::BackgroundFileWriter()
+        : m_bWriting(false),
+          m_bFlushRequested(false) {
+    setObjectName("BackgroundFileWriter");
+    m_clock.start();
+}
+
+BackgroundFileWriter::~BackgroundFileWriter() {
+}
+
+// static
+BackgroundFileWriter* BackgroundFileWriter::instance() {
+    QMutexLocker locker(&s_instanceMutex);
+    if (s_pInstance == NULL) {
+        // Lives until the process exits. Everything queued is written by
+        // flush(), which the owners of the files call before they go away.
+        s_pInstance = new BackgroundFileWriter();
+        s_pInstance->start(QThread::LowPriority);
+    }
+    return s_pInstance;
+}
+
+// static
+void BackgroundFileWriter::write(const QString& path, const QByteArray& data) {
+    BackgroundFileWriter* pWriter = instance();
+    QMutexLocker locker(&pWriter->m_mutex);
+    if (!pWriter->m_queuedData.contains(path)) {
+        pWriter->m_queuedPaths.append(path);
+    }
+    pWriter->m_queuedData.insert(path, data);
+    pWriter->m_queuedCondition.wakeAll();
+}
+
+// static
+void BackgroundFileWriter::flush() {
+    QMutexLocker instanceLocker(&s_instanceMutex);
+    BackgroundFileWriter* pWriter = s_pInstance;
+    instanceLocker.unlock();
+    if (pWriter == NULL) {
+        return;
+    }
+
+    QMutexLocker locker(&pWriter->m_mutex);
+    while (!pWriter->m_queuedPaths.isEmpty() || pWriter->m_bWriting) {
+        pWriter->m_bFlushRequested = true;
+        pWriter->m_queuedCondition.wakeAll();
+        pWriter->m_writtenCondition.wait(&pWriter->m_mutex);
+    }
+}
+
+// static
+bool BackgroundFileWriter::writeAtomically(const QString& path,
+                                           const QByteArray& data) {
+    QFileInfo info(path);
+    if (!info.absoluteDir().exists()) {
+        QDir().mkpath(info.absolutePath());
+    }
+
+    const QString tempPath = path + ".tmp";
+    QFile file(tempPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "BackgroundFileWriter: could not open" << tempPath;
+        return false;
+    }
+    if (file.write(data) != data.size() || !syncFile(&file)) {
+        qWarning() << "BackgroundFileWriter: could not write" << tempPath
+                   << file.errorString();
+        file.close();
+        QFile::remove(tempPath);
+        return false;
+    }
+    file.close();
+
+#ifdef __WINDOWS__
+    // QFile::rename() does not replace existing files.
+    QFile::remove(path);
+    if (!QFile::rename(tempPath, path)) {
+        qWarning() << "BackgroundFileWriter: could not rename" << tempPath;
+        return false;
+    }
+#else
+    // rename() replaces path atomically.
+    if (::rename(QFile::encodeName(tempPath).constData(),
+                 QFile::encodeName(path).constData()) != 0) {
+        qWarning() << "BackgroundFileWriter: could not rename" << tempPath;
+        QFile::remove(tempPath);
+        return false;
+    }
+    // Sync the directory so that the rename itself survives a power loss.
+    int dirFd = ::open(QFile::encodeName(info.absolutePath()).constData(),
+                       O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        ::close(dirFd);
+    }
+#endif
+    return true;
+}
+
+QString BackgroundFileWriter::nextWritablePath(qint64* pWaitMillis) const {
+    const qint64 now = m_clock.elapsed();
+    qint64 waitMillis = kMinWriteIntervalMillis;
+    foreach (const QString& path, m_queuedPaths) {
+        if (m_bFlushRequested || !m_lastWriteMillis.contains(path)) {
+            return path;
+        }
+        const qint64 wait = m_lastWriteMillis.value(path) +
+                kMinWriteIntervalMillis - now;
+        if (wait <= 0) {
+            return path;
+        }
+        waitMillis = qMin(waitMillis, wait);
+    }
+    *pWaitMillis = waitMillis;
+    return QString();
+}
+
+void BackgroundFileWriter::run() {
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        if (m_queuedPaths.isEmpty()) {
+            m_bFlushRequested = false;
+            m_writtenCondition.wakeAll();
+            m_queuedCondition.wait(&m_mutex);
+            continue;
+        }
+
+        qint64 waitMillis = 0;
+        const QString path = nextWritablePath(&waitMillis);
+        if (path.isEmpty()) {
+            m_queuedCondition.wait(&m_mutex, static_cast<unsigned long>(waitMillis));
+            continue;
+        }
+
+        m_queuedPaths.removeOne(path);
+        const QByteArray data = m_queuedData.take(path);
+        m_bWriting = true;
+        locker.unlock();
+
+        writeAtomically(path, data);
+
+        locker.relock();
+        m_bWriting = false;
+        m_lastWriteMillis.insert(path, m_clock.elapsed());
+    }
+}
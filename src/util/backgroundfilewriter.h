@@ -0,0 +1,61 @@
+#ifndef BACKGROUNDFILEWRITER_H
+#define BACKGROUNDFILEWRITER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+// BackgroundFileWriter writes whole files behind the back of the caller.
+//
+// write() only queues the new contents of a file and returns. A thread writes
+// them with writeAtomically(), so a crash or power loss leaves either the old
+// or the new file, never a truncated one. Writes of the same file are rate
+// limited: if a file is queued again shortly after it was written, only the
+// latest contents are written once the interval has passed.
+class BackgroundFileWriter : public QThread {
+  public:
+    // Queues data to be written to path, replacing anything that was queued
+    // for path before.
+    static void write(const QString& path, const QByteArray& data);
+
+    // Blocks until everything that was queued has been written. Call before
+    // reading a file that may have been queued, and at shutdown.
+    static void flush();
+
+    // Writes data to a temporary file next to path, syncs it to disk and
+    // renames it over path. Creates the directory of path if necessary.
+    static bool writeAtomically(const QString& path, const QByteArray& data);
+
+  protected:
+    void run();
+
+  private:
+    BackgroundFileWriter();
+    virtual ~BackgroundFileWriter();
+
+    static BackgroundFileWriter* instance();
+
+    // Returns the first queued path that may be written now, or an empty
+    // string and the milliseconds until one may be written.
+    QString nextWritablePath(qint64* pWaitMillis) const;
+
+    static QMutex s_instanceMutex;
+    static BackgroundFileWriter* s_pInstance;
+
+    QMutex m_mutex;
+    QWaitCondition m_queuedCondition;
+    QWaitCondition m_writtenCondition;
+    QList<QString> m_queuedPaths;
+    QHash<QString, QByteArray> m_queuedData;
+    QHash<QString, qint64> m_lastWriteMillis;
+    QElapsedTimer m_clock;
+    bool m_bWriting;
+    bool m_bFlushRequested;
+};
+
+#endif /* BACKGROUNDFILEWRITER_H */
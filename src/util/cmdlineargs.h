@@ -39,6 +39,9 @@ class CmdlineArgs {
             } else if (argv[i] == QString("--timelinePath") && i+1 < argc) {
                 m_timelinePath = QString::fromLocal8Bit(argv[i+1]);
                 i++;
+            } else if (argv[i] == QString("--recordSessionPath") && i+1 < argc) {
+                m_recordSessionPath = QString::fromLocal8Bit(argv[i+1]);
+                i++;
             } else if (QString::fromLocal8Bit(argv[i]).contains("--midiDebug", Qt::CaseInsensitive) ||
                        QString::fromLocal8Bit(argv[i]).contains("--controllerDebug", Qt::CaseInsensitive)) {
                 m_midiDebug = true;
@@ -64,6 +67,8 @@ class CmdlineArgs {
     const QString& getResourcePath() const { return m_resourcePath; }
     const QString& getPluginPath() const { return m_pluginPath; }
     const QString& getTimelinePath() const { return m_timelinePath; }
+    bool getRecordSessionEnabled() const { return !m_recordSessionPath.isEmpty(); }
+    const QString& getRecordSessionPath() const { return m_recordSessionPath; }
 
   private:
     CmdlineArgs() :
@@ -85,6 +90,7 @@ class CmdlineArgs {
     QString m_resourcePath;
     QString m_pluginPath;
     QString m_timelinePath;
+    QString m_recordSessionPath;
 };
 
 #endif /* CMDLINEARGS_H */
@@ -0,0 +1,193 @@
+#include <math.h>
+
+#include <QMutexLocker>
+
+#include "util/fft.h"
+#include "util/assert.h"
+#include "util/math.h"
+
+// static
+QMutex FFT::s_planMutex;
+// static
+QHash<int, FFTPlanPointer> FFT::s_plans;
+
+FFTPlan::FFTPlan(int size)
+        : size(size),
+          bitReverse(size / 2),
+          twiddleReal(math_max(size / 2 - 1, 1)),
+          twiddleImag(math_max(size / 2 - 1, 1)),
+          splitReal(size / 2 + 1),
+          splitImag(size / 2 + 1) {
+    const int points = size / 2;
+    int bits = 0;
+    while ((1 << bits) < points) {
+        ++bits;
+    }
+    for (int i = 0; i < points; ++i) {
+        int reversed = 0;
+        for (int bit = 0; bit < bits; ++bit) {
+            if (i & (1 << bit)) {
+                reversed |= 1 << (bits - 1 - bit);
+            }
+        }
+        bitReverse[i] = reversed;
+    }
+    for (int half = 1; half < points; half *= 2) {
+        for (int i = 0; i < half; ++i) {
+            const double angle = -M_PI * i / half;
+            twiddleReal[half - 1 + i] = static_cast<float>(cos(angle));
+            twiddleImag[half - 1 + i] = static_cast<float>(sin(angle));
+        }
+    }
+    for (int k = 0; k <= points; ++k) {
+        const double angle = -2 * M_PI * k / size;
+        splitReal[k] = static_cast<float>(cos(angle));
+        splitImag[k] = static_cast<float>(sin(angle));
+    }
+}
+
+FFT::FFT(int size)
+        : m_pPlan(plan(size)),
+          m_size(size),
+          m_real(size / 2),
+          m_imag(size / 2),
+          m_binReal(size / 2 + 1),
+          m_binImag(size / 2 + 1) {
+}
+
+// static
+FFTPlanPointer FFT::plan(int size) {
+    DEBUG_ASSERT(size > 1 && (size & (size - 1)) == 0);
+    QMutexLocker locker(&s_planMutex);
+    FFTPlanPointer pPlan = s_plans.value(size);
+    if (pPlan.isNull()) {
+        pPlan = FFTPlanPointer(new FFTPlan(size));
+        s_plans.insert(size, pPlan);
+    }
+    return pPlan;
+}
+
+void FFT::forward(const float* pIn, float* pReal, float* pImag) {
+    const int points = m_size / 2;
+    const int* pBitReverse = m_pPlan->bitReverse.constData();
+    float* pWorkReal = m_real.data();
+    float* pWorkImag = m_imag.data();
+    for (int i = 0; i < points; ++i) {
+        pWorkReal[pBitReverse[i]] = pIn[2 * i];
+        pWorkImag[pBitReverse[i]] = pIn[2 * i + 1];
+    }
+    transform();
+
+    // Bin k of the even samples is (Z[k] + conj(Z[points - k])) / 2, of the
+    // odd samples -i (Z[k] - conj(Z[points - k])) / 2.
+    pReal[0] = pWorkReal[0] + pWorkImag[0];
+    pImag[0] = 0.0f;
+    pReal[points] = pWorkReal[0] - pWorkImag[0];
+    pImag[points] = 0.0f;
+    const float* pSplitReal = m_pPlan->splitReal.constData();
+    const float* pSplitImag = m_pPlan->splitImag.constData();
+    for (int k = 1; k < points; ++k) {
+        const int mirror = points - k;
+        const float evenReal = 0.5f * (pWorkReal[k] + pWorkReal[mirror]);
+        const float evenImag = 0.5f * (pWorkImag[k] - pWorkImag[mirror]);
+        const float oddReal = 0.5f * (pWorkImag[k] + pWorkImag[mirror]);
+        const float oddImag = -0.5f * (pWorkReal[k] - pWorkReal[mirror]);
+        pReal[k] = evenReal + pSplitReal[k] * oddReal - pSplitImag[k] * oddImag;
+        pImag[k] = evenImag + pSplitReal[k] * oddImag + pSplitImag[k] * oddReal;
+    }
+}
+
+void FFT::inverse(const float* pReal, const float* pImag, float* pOut) {
+    const int points = m_size / 2;
+    const int* pBitReverse = m_pPlan->bitReverse.constData();
+    const float* pSplitReal = m_pPlan->splitReal.constData();
+    const float* pSplitImag = m_pPlan->splitImag.constData();
+    float* pWorkReal = m_real.data();
+    float* pWorkImag = m_imag.data();
+    // Undo the separation, then run the forward transform on the complex
+    // conjugate, which conjugates the inverse transform.
+    for (int k = 0; k < points; ++k) {
+        const int mirror = points - k;
+        const float evenReal = pReal[k] + pReal[mirror];
+        const float evenImag = pImag[k] - pImag[mirror];
+        const float differenceReal = pReal[k] - pReal[mirror];
+        const float differenceImag = pImag[k] + pImag[mirror];
+        const float oddReal = pSplitReal[k] * differenceReal +
+                pSplitImag[k] * differenceImag;
+        const float oddImag = pSplitReal[k] * differenceImag -
+                pSplitImag[k] * differenceReal;
+        pWorkReal[pBitReverse[k]] = evenReal - oddImag;
+        pWorkImag[pBitReverse[k]] = -(evenImag + oddReal);
+    }
+    transform();
+    for (int i = 0; i < points; ++i) {
+        pOut[2 * i] = pWorkReal[i];
+        pOut[2 * i + 1] = -pWorkImag[i];
+    }
+}
+
+void FFT::magnitudes(const float* pIn, float* pMagnitudes) {
+    forward(pIn, m_binReal.data(), m_binImag.data());
+    const float* pReal = m_binReal.constData();
+    const float* pImag = m_binImag.constData();
+    const int bins = this->bins();
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < bins; ++i) {
+        pMagnitudes[i] = sqrtf(pReal[i] * pReal[i] + pImag[i] * pImag[i]);
+    }
+}
+
+void FFT::transform() {
+    const int points = m_size / 2;
+    float* pReal = m_real.data();
+    float* pImag = m_imag.data();
+
+    int half = 1;
+    if (points >= 4) {
+        // The first two stages as one radix-4 butterfly. Their twiddle
+        // factors are 1 and -i.
+        for (int start = 0; start < points; start += 4) {
+            float* r = pReal + start;
+            float* i = pImag + start;
+            const float r0 = r[0] + r[1];
+            const float i0 = i[0] + i[1];
+            const float r1 = r[0] - r[1];
+            const float i1 = i[0] - i[1];
+            const float r2 = r[2] + r[3];
+            const float i2 = i[2] + i[3];
+            const float r3 = r[2] - r[3];
+            const float i3 = i[2] - i[3];
+            r[0] = r0 + r2;
+            i[0] = i0 + i2;
+            r[2] = r0 - r2;
+            i[2] = i0 - i2;
+            r[1] = r1 + i3;
+            i[1] = i1 - r3;
+            r[3] = r1 - i3;
+            i[3] = i1 + r3;
+        }
+        half = 4;
+    }
+
+    for (; half < points; half *= 2) {
+        const float* pTwiddleReal = m_pPlan->twiddleReal.constData() + half - 1;
+        const float* pTwiddleImag = m_pPlan->twiddleImag.constData() + half - 1;
+        for (int start = 0; start < points; start += half * 2) {
+            float* pEvenReal = pReal + start;
+            float* pEvenImag = pImag + start;
+            float* pOddReal = pEvenReal + half;
+            float* pOddImag = pEvenImag + half;
+            // note: LOOP VECTORIZED.
+            for (int i = 0; i < half; ++i) {
+                const float tr = pTwiddleReal[i] * pOddReal[i] -
+                        pTwiddleImag[i] * pOddImag[i];
+                const float ti = pTwiddleReal[i] * pOddImag[i] +
+                        pTwiddleImag[i] * pOddReal[i];
+                pOddReal[i] = pEvenReal[i] - tr;
+                pOddImag[i] = pEvenImag[i] - ti;
+                pEvenReal[i] += tr;
+                pEvenImag[i] += ti;
+            }
+        }
+    }
+}
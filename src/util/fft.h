@@ -0,0 +1,86 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+
+// The tables of one transform size. A plan never changes after it is built,
+// so all FFT instances of that size share it, from any thread.
+struct FFTPlan {
+    explicit FFTPlan(int size);
+
+    int size;
+    // The bit reversal permutation of the size / 2 point complex transform.
+    QVector<int> bitReverse;
+    // The twiddle factors of the complex transform. The stage that combines
+    // transforms of length half finds its half factors at index half - 1.
+    QVector<float> twiddleReal;
+    QVector<float> twiddleImag;
+    // exp(-2 pi i k / size) for k from 0 to size / 2, separates the real
+    // spectrum from the complex one.
+    QVector<float> splitReal;
+    QVector<float> splitImag;
+};
+
+typedef QSharedPointer<const FFTPlan> FFTPlanPointer;
+
+// Fast Fourier transform of real input for any power of two size.
+//
+// The even and odd samples are transformed as the real and imaginary parts
+// of a complex sequence of half the length and separated afterwards, so a
+// real transform costs about as much as a complex one of half its size. The
+// real and imaginary parts live in separate arrays and the twiddle factors
+// of a stage are stored contiguously, so every stage is a plain loop over
+// the butterflies that the compiler vectorizes. The first two stages, which
+// need no multiplications, are done together as radix-4 butterflies.
+//
+// Plans are cached by size and shared. An FFT only owns its work buffers:
+// use one instance per thread, creating more of a size is cheap.
+class FFT {
+  public:
+    // size has to be a power of two, at least 2.
+    explicit FFT(int size);
+
+    int size() const {
+        return m_size;
+    }
+
+    // The number of bins of the spectrum, from DC to Nyquist.
+    int bins() const {
+        return m_size / 2 + 1;
+    }
+
+    // Transforms size() samples of pIn into bins() complex bins.
+    void forward(const float* pIn, float* pReal, float* pImag);
+
+    // Transforms bins() complex bins back into size() samples. The
+    // transforms are not normalized, a forward and inverse transform scale
+    // the signal by size().
+    void inverse(const float* pReal, const float* pImag, float* pOut);
+
+    // Transforms size() samples of pIn and writes the magnitudes of the
+    // bins() bins to pMagnitudes.
+    void magnitudes(const float* pIn, float* pMagnitudes);
+
+    // Returns the plan for size, building it when it is first asked for.
+    static FFTPlanPointer plan(int size);
+
+  private:
+    // The in-place complex transform of the work buffers, which hold the
+    // input in bit reversed order.
+    void transform();
+
+    FFTPlanPointer m_pPlan;
+    int m_size;
+    QVector<float> m_real;
+    QVector<float> m_imag;
+    QVector<float> m_binReal;
+    QVector<float> m_binImag;
+
+    static QMutex s_planMutex;
+    static QHash<int, FFTPlanPointer> s_plans;
+};
+
+#endif /* FFT_H */
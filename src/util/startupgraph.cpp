@@ -0,0 +1,219 @@
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QtDebug>
+
+#include "util/startupgraph.h"
+#include "util/assert.h"
+#include "util/math.h"
+#include "util/threadcputimer.h"
+
+namespace {
+
+qint64 toMillis(qint64 nanos) {
+    return nanos / 1000000;
+}
+
+}  // namespace
+
+// Runs one worker phase on a thread of the pool.
+class StartupGraph::Worker : public QRunnable {
+  public:
+    Worker(StartupGraph* pGraph, int phase)
+            : m_pGraph(pGraph),
+              m_phase(phase) {
+    }
+
+    void run() {
+        m_pGraph->runPhase(m_phase);
+    }
+
+  private:
+    StartupGraph* m_pGraph;
+    int m_phase;
+};
+
+// static
+QMutex StartupGraph::s_reportMutex;
+// static
+QString StartupGraph::s_lastReport;
+
+StartupGraph::StartupGraph()
+        : m_iDonePhases(0),
+          m_totalNanos(0),
+          m_mainWaitNanos(0) {
+    // The worker phases mostly wait for devices or disks, so run all of them
+    // at once even on few cores.
+    m_workers.setMaxThreadCount(math_max(4, QThread::idealThreadCount()));
+}
+
+StartupGraph::~StartupGraph() {
+    m_workers.waitForDone();
+    for (int i = 0; i < m_phases.size(); ++i) {
+        delete m_phases[i].pTask;
+    }
+}
+
+int StartupGraph::addPhase(const QString& name, Thread thread, Task* pTask,
+                           const QList<int>& dependencies) {
+    const int id = m_phases.size();
+    Phase phase;
+    phase.name = name;
+    phase.thread = thread;
+    phase.pTask = pTask;
+    phase.state = WAITING;
+    phase.startNanos = 0;
+    phase.finishNanos = 0;
+    phase.cpuNanos = 0;
+    foreach (int dependency, dependencies) {
+        DEBUG_ASSERT_AND_HANDLE(dependency >= 0 && dependency < id) {
+            qWarning() << "StartupGraph: phase" << name
+                       << "depends on a phase that was not added before it";
+            continue;
+        }
+        phase.dependencies.append(dependency);
+    }
+    m_phases.append(phase);
+    return id;
+}
+
+void StartupGraph::run() {
+    m_timer.start();
+    QMutexLocker locker(&m_mutex);
+    startReadyWorkerPhases();
+    while (m_iDonePhases < m_phases.size()) {
+        int next = -1;
+        for (int i = 0; i < m_phases.size(); ++i) {
+            if (m_phases[i].thread == MAIN_THREAD &&
+                    m_phases[i].state == WAITING && isReady(i)) {
+                next = i;
+                break;
+            }
+        }
+        if (next < 0) {
+            // Every phase the main thread could run next waits for a worker.
+            PerformanceTimer waited;
+            waited.start();
+            m_phaseDone.wait(&m_mutex);
+            m_mainWaitNanos += waited.elapsed();
+            continue;
+        }
+        m_phases[next].state = RUNNING;
+        locker.unlock();
+        runPhase(next);
+        locker.relock();
+    }
+    m_totalNanos = m_timer.elapsed();
+    locker.unlock();
+
+    writeReport();
+}
+
+bool StartupGraph::isReady(int phase) const {
+    foreach (int dependency, m_phases[phase].dependencies) {
+        if (m_phases[dependency].state != DONE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void StartupGraph::startReadyWorkerPhases() {
+    for (int i = 0; i < m_phases.size(); ++i) {
+        if (m_phases[i].thread == WORKER_THREAD &&
+                m_phases[i].state == WAITING && isReady(i)) {
+            m_phases[i].state = RUNNING;
+            m_workers.start(new Worker(this, i));
+        }
+    }
+}
+
+void StartupGraph::runPhase(int phase) {
+    QMutexLocker locker(&m_mutex);
+    m_phases[phase].startNanos = m_timer.elapsed();
+    Task* pTask = m_phases[phase].pTask;
+    locker.unlock();
+
+    ThreadCpuTimer cpuTimer;
+    cpuTimer.start();
+    pTask->run();
+    const qint64 cpuNanos = cpuTimer.elapsed();
+
+    locker.relock();
+    m_phases[phase].finishNanos = m_timer.elapsed();
+    m_phases[phase].cpuNanos = cpuNanos;
+    m_phases[phase].state = DONE;
+    ++m_iDonePhases;
+    startReadyWorkerPhases();
+    m_phaseDone.wakeAll();
+}
+
+QStringList StartupGraph::criticalPath() const {
+    // Follow the dependencies that finished last, back from the phase that
+    // finished last.
+    int phase = -1;
+    for (int i = 0; i < m_phases.size(); ++i) {
+        if (phase < 0 || m_phases[i].finishNanos > m_phases[phase].finishNanos) {
+            phase = i;
+        }
+    }
+    QStringList path;
+    while (phase >= 0) {
+        path.prepend(m_phases[phase].name);
+        int latest = -1;
+        foreach (int dependency, m_phases[phase].dependencies) {
+            if (latest < 0 || m_phases[dependency].finishNanos >
+                    m_phases[latest].finishNanos) {
+                latest = dependency;
+            }
+        }
+        phase = latest;
+    }
+    return path;
+}
+
+void StartupGraph::writeReport() {
+    int nameWidth = 5;
+    foreach (const Phase& phase, m_phases) {
+        nameWidth = math_max(nameWidth, phase.name.size());
+    }
+
+    QStringList lines;
+    lines.append(QString("Startup took %1 ms, the main thread waited %2 ms "
+                         "for workers.")
+                 .arg(toMillis(m_totalNanos))
+                 .arg(toMillis(m_mainWaitNanos)));
+    lines.append(QString("%1  %2  %3  %4  %5")
+                 .arg("Phase", -nameWidth)
+                 .arg("Thread", -6)
+                 .arg("Start ms", 8)
+                 .arg("Wall ms", 8)
+                 .arg("CPU ms", 8));
+    foreach (const Phase& phase, m_phases) {
+        lines.append(QString("%1  %2  %3  %4  %5")
+                     .arg(phase.name, -nameWidth)
+                     .arg(phase.thread == MAIN_THREAD ? "main" : "worker", -6)
+                     .arg(toMillis(phase.startNanos), 8)
+                     .arg(toMillis(phase.finishNanos - phase.startNanos), 8)
+                     .arg(toMillis(phase.cpuNanos), 8));
+    }
+    lines.append("Critical path: " + criticalPath().join(" > "));
+    m_report = lines.join("\n");
+
+    foreach (const QString& line, lines) {
+        qDebug() << qPrintable(line);
+    }
+
+    QMutexLocker locker(&s_reportMutex);
+    s_lastReport = m_report;
+}
+
+QString StartupGraph::report() const {
+    return m_report;
+}
+
+// static
+QString StartupGraph::lastReport() {
+    QMutexLocker locker(&s_reportMutex);
+    return s_lastReport;
+}
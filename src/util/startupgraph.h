@@ -0,0 +1,123 @@
+#ifndef STARTUPGRAPH_H
+#define STARTUPGRAPH_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "util/performancetimer.h"
+
+// Runs the phases of application startup in the order given by their
+// dependencies, and measures them.
+//
+// A phase runs either in the main thread, for anything that creates
+// QObjects, controls or widgets, or on a worker thread, for slow work that
+// touches none of these like enumerating devices or parsing files. Worker
+// phases start as soon as their dependencies are done. The main thread runs
+// its phases in the order they were added, skipping ahead to the next ready
+// one while a phase still waits for a worker. A phase can only depend on
+// phases added before it, so the graph has no cycles.
+//
+// run() returns once every phase is done. The report lists the wall and CPU
+// time of each phase and the chain of phases startup had to wait for. It is
+// written to the log and kept for the developer tools.
+class StartupGraph {
+  public:
+    enum Thread {
+        MAIN_THREAD,
+        WORKER_THREAD
+    };
+
+    StartupGraph();
+    virtual ~StartupGraph();
+
+    // Adds a phase that calls (pObject->*method)(). Returns the id other
+    // phases refer to it by.
+    template <class T>
+    int addPhase(const QString& name, Thread thread,
+                 T* pObject, void (T::*method)(),
+                 const QList<int>& dependencies = QList<int>()) {
+        return addPhase(name, thread, new MethodTask<T>(pObject, method),
+                        dependencies);
+    }
+
+    // Runs all phases. Call from the main thread.
+    void run();
+
+    // The timing report of this graph, empty until run() has returned.
+    QString report() const;
+
+    // The report of the last graph that ran.
+    static QString lastReport();
+
+  private:
+    class Task {
+      public:
+        virtual ~Task() {}
+        virtual void run() = 0;
+    };
+
+    template <class T>
+    class MethodTask : public Task {
+      public:
+        MethodTask(T* pObject, void (T::*method)())
+                : m_pObject(pObject),
+                  m_method(method) {
+        }
+        void run() {
+            (m_pObject->*m_method)();
+        }
+      private:
+        T* m_pObject;
+        void (T::*m_method)();
+    };
+
+    class Worker;
+
+    enum State {
+        WAITING,
+        RUNNING,
+        DONE
+    };
+
+    struct Phase {
+        QString name;
+        Thread thread;
+        Task* pTask;
+        QList<int> dependencies;
+        State state;
+        // Nanoseconds since run() started.
+        qint64 startNanos;
+        qint64 finishNanos;
+        qint64 cpuNanos;
+    };
+
+    int addPhase(const QString& name, Thread thread, Task* pTask,
+                 const QList<int>& dependencies);
+    // Call with m_mutex held.
+    bool isReady(int phase) const;
+    void startReadyWorkerPhases();
+    void runPhase(int phase);
+    QStringList criticalPath() const;
+    void writeReport();
+
+    QList<Phase> m_phases;
+    int m_iDonePhases;
+    PerformanceTimer m_timer;
+    qint64 m_totalNanos;
+    qint64 m_mainWaitNanos;
+    QString m_report;
+
+    // Protects the state of the phases while run() is running.
+    mutable QMutex m_mutex;
+    QWaitCondition m_phaseDone;
+    QThreadPool m_workers;
+
+    static QMutex s_reportMutex;
+    static QString s_lastReport;
+};
+
+#endif /* STARTUPGRAPH_H */
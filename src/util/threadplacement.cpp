@@ -0,0 +1,498 @@
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThread>
+#include <QtDebug>
+
+#include "util/threadplacement.h"
+#include "util/math.h"
+#include "util/rlimit.h"
+
+#ifdef __LINUX__
+extern "C" {
+    #include <errno.h>
+    #include <sched.h>
+    #include <string.h>
+    #include <unistd.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+}
+#endif
+
+namespace {
+
+const char* kSysfsCpuPath = "/sys/devices/system/cpu";
+
+// Makes core ids unique across packages.
+const int kMaxCoresPerPackage = 65536;
+
+// PortAudio runs its ALSA callback at 82. We only change the callback if the
+// host API did not make it realtime already.
+const int kCallbackPriority = 80;
+const int kRealtimeWorkerPriority = 70;
+const int kBackgroundNice = 5;
+const int kIdleNice = 19;
+
+struct PlacedThread {
+    QString name;
+    ThreadPlacement::Role role;
+    qint64 tid;
+    QStringList problems;
+};
+
+QMutex s_mutex;
+bool s_bEnabled = false;
+bool s_bRealtimeScheduling = false;
+QList<ThreadPlacement::Cpu> s_topology;
+QList<int> s_isolatedCpus;
+QList<int> s_realtimeCpus;
+QList<int> s_backgroundCpus;
+int s_iNextWorkerCpu = 0;
+QList<PlacedThread> s_threads;
+
+QString readFirstLine(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QString();
+    }
+    return QString::fromLatin1(file.readLine()).trimmed();
+}
+
+QString formatCpuList(const QList<int>& cpus) {
+    if (cpus.isEmpty()) {
+        return "none";
+    }
+    QStringList ranges;
+    int i = 0;
+    while (i < cpus.size()) {
+        int j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            ++j;
+        }
+        ranges.append(i == j ? QString::number(cpus[i]) :
+                      QString("%1-%2").arg(cpus[i]).arg(cpus[j]));
+        i = j + 1;
+    }
+    return ranges.join(",");
+}
+
+#ifdef __LINUX__
+QString errnoString() {
+    return QString::fromLocal8Bit(strerror(errno));
+}
+
+bool setCurrentThreadAffinity(const QList<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    foreach (int cpu, cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+int allowedRealtimePriority(ThreadPlacement::Role role) {
+    // root may use any priority regardless of RLIMIT_RTPRIO.
+    const int limit = geteuid() == 0 ? 99 : RLimit::getCurRtPrio();
+    if (role == ThreadPlacement::AUDIO_CALLBACK) {
+        return math_min(kCallbackPriority, limit);
+    }
+    // Always leave room for the callback above its workers.
+    return math_min(kRealtimeWorkerPriority, limit - 10);
+}
+
+void applyScheduling(ThreadPlacement::Role role, QStringList* pProblems) {
+    switch (role) {
+    case ThreadPlacement::AUDIO_CALLBACK:
+    case ThreadPlacement::REALTIME_WORKER: {
+        if (!s_bRealtimeScheduling) {
+            break;
+        }
+        int policy = sched_getscheduler(0);
+        if (role == ThreadPlacement::AUDIO_CALLBACK &&
+                (policy == SCHED_FIFO || policy == SCHED_RR)) {
+            // The host API made the callback realtime already.
+            break;
+        }
+        struct sched_param param;
+        param.sched_priority = allowedRealtimePriority(role);
+        if (param.sched_priority <= 0) {
+            pProblems->append("SCHED_FIFO not permitted by RLIMIT_RTPRIO");
+            break;
+        }
+        if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+            pProblems->append("SCHED_FIFO: " + errnoString());
+        }
+        break;
+    }
+    case ThreadPlacement::BACKGROUND:
+        // On Linux the nice value is per thread.
+        if (setpriority(PRIO_PROCESS, 0, kBackgroundNice) != 0) {
+            pProblems->append("nice: " + errnoString());
+        }
+        break;
+    case ThreadPlacement::IDLE: {
+#ifdef SCHED_IDLE
+        struct sched_param param;
+        param.sched_priority = 0;
+        if (sched_setscheduler(0, SCHED_IDLE, &param) == 0) {
+            break;
+        }
+#endif
+        if (setpriority(PRIO_PROCESS, 0, kIdleNice) != 0) {
+            pProblems->append("nice: " + errnoString());
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+QString policyName(int policy) {
+    switch (policy) {
+    case SCHED_OTHER:
+        return "OTHER";
+    case SCHED_FIFO:
+        return "FIFO";
+    case SCHED_RR:
+        return "RR";
+#ifdef SCHED_BATCH
+    case SCHED_BATCH:
+        return "BATCH";
+#endif
+#ifdef SCHED_IDLE
+    case SCHED_IDLE:
+        return "IDLE";
+#endif
+    default:
+        return QString::number(policy);
+    }
+}
+
+// Describes the actual scheduling and affinity of tid. Returns false if the
+// thread does not exist anymore.
+bool describeThread(qint64 tid, QString* pDescription) {
+    int policy = sched_getscheduler(tid);
+    if (policy < 0) {
+        return errno != ESRCH;
+    }
+    struct sched_param param;
+    param.sched_priority = 0;
+    sched_getparam(tid, &param);
+    errno = 0;
+    int nice = getpriority(PRIO_PROCESS, tid);
+    bool niceOk = errno == 0;
+
+    QList<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(tid, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.append(cpu);
+            }
+        }
+    }
+
+    QString scheduling = policyName(policy);
+    if (policy == SCHED_FIFO || policy == SCHED_RR) {
+        scheduling += QString(" %1").arg(param.sched_priority);
+    } else if (niceOk) {
+        scheduling += QString(" nice %1").arg(nice);
+    }
+    *pDescription = QString("%1, CPUs %2").arg(scheduling, formatCpuList(cpus));
+    return true;
+}
+#endif // __LINUX__
+
+}  // anonymous namespace
+
+// static
+void ThreadPlacement::configure(ConfigObject<ConfigValue>* pConfig) {
+    QMutexLocker locker(&s_mutex);
+    s_bEnabled = pConfig->getValueString(
+            ConfigKey("[ThreadPlacement]", "Enabled"), "1").toInt() != 0;
+    s_bRealtimeScheduling = pConfig->getValueString(
+            ConfigKey("[ThreadPlacement]", "RealtimeScheduling"), "1").toInt() != 0;
+
+#ifdef __LINUX__
+    s_topology = readTopology(kSysfsCpuPath);
+    s_isolatedCpus = parseCpuList(
+            readFirstLine(QString(kSysfsCpuPath) + "/isolated"));
+
+    // "auto" uses the CPUs isolated from the scheduler with isolcpus=,
+    // "none" disables pinning.
+    QString setting = pConfig->getValueString(
+            ConfigKey("[ThreadPlacement]", "RealtimeCpus"), "auto").trimmed();
+    QList<int> requested;
+    if (setting == "auto") {
+        requested = s_isolatedCpus;
+    } else if (setting != "none") {
+        requested = parseCpuList(setting);
+    }
+
+    QList<int> realtimeCpus;
+    foreach (const Cpu& cpu, s_topology) {
+        if (requested.contains(cpu.id)) {
+            realtimeCpus.append(cpu.id);
+        }
+    }
+    // The callback and its workers share buffers, keep them on one node.
+    s_realtimeCpus = restrictToFirstNode(s_topology, realtimeCpus);
+    // Without any other CPU there is nowhere to move background work to.
+    if (s_realtimeCpus.size() == s_topology.size()) {
+        s_realtimeCpus.clear();
+    }
+
+    s_backgroundCpus.clear();
+    if (!s_realtimeCpus.isEmpty()) {
+        s_backgroundCpus = backgroundCpus(s_topology, s_realtimeCpus);
+        if (s_backgroundCpus.isEmpty()) {
+            // Every core has a realtime CPU; at least use the siblings.
+            foreach (const Cpu& cpu, s_topology) {
+                if (!s_realtimeCpus.contains(cpu.id)) {
+                    s_backgroundCpus.append(cpu.id);
+                }
+            }
+        }
+    }
+    s_iNextWorkerCpu = 0;
+
+    qDebug() << "ThreadPlacement: realtime CPUs"
+             << formatCpuList(s_realtimeCpus) << "background CPUs"
+             << formatCpuList(s_backgroundCpus);
+#endif
+}
+
+// static
+void ThreadPlacement::placeCurrentThread(Role role, const QString& name) {
+    PlacedThread thread;
+    thread.name = name.isEmpty() ? QThread::currentThread()->objectName() : name;
+    thread.role = role;
+    thread.tid = 0;
+
+    QMutexLocker locker(&s_mutex);
+#ifdef __LINUX__
+    thread.tid = syscall(SYS_gettid);
+    if (s_bEnabled) {
+        QList<int> cpus;
+        if (role == AUDIO_CALLBACK || role == REALTIME_WORKER) {
+            // The callback gets the first realtime CPU to itself if there is
+            // more than one. The kernel does not balance threads across
+            // isolated CPUs, so we spread the workers over the rest.
+            if (s_realtimeCpus.size() == 1) {
+                cpus = s_realtimeCpus;
+            } else if (!s_realtimeCpus.isEmpty()) {
+                if (role == AUDIO_CALLBACK) {
+                    cpus.append(s_realtimeCpus.first());
+                } else {
+                    int index = 1 + s_iNextWorkerCpu++ % (s_realtimeCpus.size() - 1);
+                    cpus.append(s_realtimeCpus[index]);
+                }
+            }
+        } else {
+            cpus = s_backgroundCpus;
+        }
+        if (!cpus.isEmpty() && !setCurrentThreadAffinity(cpus)) {
+            thread.problems.append("affinity: " + errnoString());
+        }
+        applyScheduling(role, &thread.problems);
+    }
+
+    // Threads are placed again when they are reused, e.g. the callback thread
+    // when the sound device is reopened.
+    for (int i = 0; i < s_threads.size(); ++i) {
+        if (s_threads[i].tid == thread.tid) {
+            s_threads.removeAt(i);
+            break;
+        }
+    }
+#endif
+    if (!thread.problems.isEmpty()) {
+        qWarning() << "ThreadPlacement:" << thread.name << "runs as"
+                   << roleName(role) << "without" << thread.problems.join(", ");
+    }
+    s_threads.append(thread);
+}
+
+// static
+QString ThreadPlacement::report() {
+    QMutexLocker locker(&s_mutex);
+    QStringList lines;
+#ifdef __LINUX__
+    QList<int> cores;
+    QList<int> nodes;
+    foreach (const Cpu& cpu, s_topology) {
+        if (!cores.contains(cpu.core)) {
+            cores.append(cpu.core);
+        }
+        if (!nodes.contains(cpu.node)) {
+            nodes.append(cpu.node);
+        }
+    }
+    lines.append(QString("CPUs: %1 (%2 cores, %3 NUMA nodes)")
+                 .arg(s_topology.size()).arg(cores.size()).arg(nodes.size()));
+    lines.append("Isolated CPUs: " + formatCpuList(s_isolatedCpus));
+    lines.append("Realtime CPUs: " + formatCpuList(s_realtimeCpus));
+    lines.append("Background CPUs: " + formatCpuList(s_backgroundCpus));
+    lines.append(QString("RLIMIT_RTPRIO: %1 (max %2)")
+                 .arg(RLimit::getCurRtPrio()).arg(RLimit::getMaxRtPrio()));
+    if (!s_bEnabled) {
+        lines.append("Thread placement is disabled.");
+    }
+#else
+    lines.append("Thread placement is not supported on this platform.");
+#endif
+    lines.append(QString());
+
+    QList<PlacedThread>::iterator it = s_threads.begin();
+    while (it != s_threads.end()) {
+        QString description;
+#ifdef __LINUX__
+        if (!describeThread(it->tid, &description)) {
+            it = s_threads.erase(it);
+            continue;
+        }
+#endif
+        QString line = QString("%1 [%2, tid %3]: %4").arg(
+                it->name, roleName(it->role), QString::number(it->tid),
+                description);
+        if (!it->problems.isEmpty()) {
+            line += " (" + it->problems.join(", ") + ")";
+        }
+        lines.append(line);
+        ++it;
+    }
+    return lines.join("\n");
+}
+
+// static
+QString ThreadPlacement::roleName(Role role) {
+    switch (role) {
+    case AUDIO_CALLBACK:
+        return "audio callback";
+    case REALTIME_WORKER:
+        return "realtime worker";
+    case BACKGROUND:
+        return "background";
+    case IDLE:
+        return "idle";
+    default:
+        return "unknown";
+    }
+}
+
+// static
+QList<int> ThreadPlacement::parseCpuList(const QString& list) {
+    QList<int> cpus;
+    foreach (QString range, list.split(',', QString::SkipEmptyParts)) {
+        range = range.trimmed();
+        int dash = range.indexOf('-');
+        bool firstOk = false;
+        bool lastOk = false;
+        int first = range.left(dash < 0 ? range.size() : dash).toInt(&firstOk);
+        int last = dash < 0 ? first : range.mid(dash + 1).toInt(&lastOk);
+        if (!firstOk || (dash >= 0 && !lastOk)) {
+            continue;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            if (!cpus.contains(cpu)) {
+                cpus.append(cpu);
+            }
+        }
+    }
+    qSort(cpus);
+    return cpus;
+}
+
+// static
+QList<ThreadPlacement::Cpu> ThreadPlacement::readTopology(
+        const QString& sysfsCpuPath) {
+    QDir dir(sysfsCpuPath);
+    QList<int> ids = parseCpuList(readFirstLine(dir.filePath("online")));
+    if (ids.isEmpty()) {
+        foreach (const QString& entry,
+                 dir.entryList(QStringList() << "cpu*", QDir::Dirs)) {
+            bool ok = false;
+            int id = entry.mid(3).toInt(&ok);
+            if (ok) {
+                ids.append(id);
+            }
+        }
+        qSort(ids);
+    }
+
+    QList<Cpu> cpus;
+    foreach (int id, ids) {
+        QDir cpuDir(dir.filePath(QString("cpu%1").arg(id)));
+        Cpu cpu;
+        cpu.id = id;
+        bool ok = false;
+        cpu.package = readFirstLine(
+                cpuDir.filePath("topology/physical_package_id")).toInt(&ok);
+        if (!ok || cpu.package < 0) {
+            cpu.package = 0;
+        }
+        int coreId = readFirstLine(cpuDir.filePath("topology/core_id")).toInt(&ok);
+        if (!ok) {
+            // Without topology every CPU is a core of its own.
+            coreId = id;
+        }
+        cpu.core = cpu.package * kMaxCoresPerPackage + coreId;
+        cpu.node = 0;
+        QStringList nodes = cpuDir.entryList(QStringList() << "node*",
+                                             QDir::Dirs | QDir::NoDotAndDotDot);
+        if (!nodes.isEmpty()) {
+            cpu.node = nodes.first().mid(4).toInt();
+        }
+        cpus.append(cpu);
+    }
+    return cpus;
+}
+
+// static
+QList<int> ThreadPlacement::backgroundCpus(const QList<Cpu>& topology,
+                                           const QList<int>& realtimeCpus) {
+    QList<int> realtimeCores;
+    foreach (const Cpu& cpu, topology) {
+        if (realtimeCpus.contains(cpu.id)) {
+            realtimeCores.append(cpu.core);
+        }
+    }
+    QList<int> cpus;
+    foreach (const Cpu& cpu, topology) {
+        if (!realtimeCores.contains(cpu.core)) {
+            cpus.append(cpu.id);
+        }
+    }
+    return cpus;
+}
+
+// static
+QList<int> ThreadPlacement::restrictToFirstNode(const QList<Cpu>& topology,
+                                                const QList<int>& cpus) {
+    if (cpus.isEmpty()) {
+        return cpus;
+    }
+    int node = -1;
+    foreach (const Cpu& cpu, topology) {
+        if (cpu.id == cpus.first()) {
+            node = cpu.node;
+            break;
+        }
+    }
+    QList<int> result;
+    foreach (int id, cpus) {
+        foreach (const Cpu& cpu, topology) {
+            if (cpu.id == id && cpu.node == node) {
+                result.append(id);
+                break;
+            }
+        }
+    }
+    return result;
+}
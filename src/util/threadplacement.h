@@ -0,0 +1,81 @@
+#ifndef THREADPLACEMENT_H
+#define THREADPLACEMENT_H
+
+#include <QList>
+#include <QString>
+
+#include "configobject.h"
+
+// ThreadPlacement decides which CPUs and scheduling class the threads of Mixxx
+// run with, so that background work like analysis never competes with the
+// audio callback for a core.
+//
+// The audio callback and the threads it depends on (realtime workers) are
+// pinned to the realtime CPUs: by default the CPUs isolated with isolcpus=, or
+// the ones listed in [ThreadPlacement],RealtimeCpus, restricted to the NUMA
+// node of the first one. The callback gets the first of them, the workers are
+// spread over the others. Where RLIMIT_RTPRIO permits they run with
+// SCHED_FIFO, the workers below the callback. Background threads are moved to
+// the CPUs that do not share a physical core with a realtime CPU and are
+// niced, or run with SCHED_IDLE if they can be delayed arbitrarily.
+//
+// Every thread calls placeCurrentThread() itself when it starts. Placement is
+// currently only implemented on Linux; elsewhere the QThread priorities the
+// threads are started with still apply.
+class ThreadPlacement {
+  public:
+    enum Role {
+        // The sound API callback that processes the engine.
+        AUDIO_CALLBACK = 0,
+        // Threads the callback hands work to and that must keep up with it:
+        // EngineWorkerScheduler, EngineTaskPool, CachingReaderWorker and
+        // VinylControlProcessor.
+        REALTIME_WORKER,
+        // Threads that drain engine output without a deadline, like
+        // EngineSideChain.
+        BACKGROUND,
+        // Threads that may be delayed arbitrarily, like AnalyserQueue.
+        IDLE,
+        NUM_ROLES
+    };
+
+    struct Cpu {
+        int id;
+        // The physical core, unique across packages.
+        int core;
+        int package;
+        int node;
+    };
+
+    // Reads the CPU topology and the configuration. Must be called before any
+    // thread calls placeCurrentThread().
+    static void configure(ConfigObject<ConfigValue>* pConfig);
+
+    // Moves the calling thread to the CPUs and scheduling class of role and
+    // registers it for report(). name defaults to the QThread's objectName.
+    static void placeCurrentThread(Role role, const QString& name = QString());
+
+    // Returns a human readable description of the topology and of the actual
+    // placement of every registered thread.
+    static QString report();
+
+    static QString roleName(Role role);
+
+    // Parses a sysfs CPU list like "0-3,6,8-9".
+    static QList<int> parseCpuList(const QString& list);
+    // Reads the online CPUs from a sysfs cpu directory, normally
+    // /sys/devices/system/cpu.
+    static QList<Cpu> readTopology(const QString& sysfsCpuPath);
+    // Returns the CPUs of topology that share no physical core with any of
+    // realtimeCpus.
+    static QList<int> backgroundCpus(const QList<Cpu>& topology,
+                                     const QList<int>& realtimeCpus);
+    // Returns the CPUs of cpus that are on the same NUMA node as the first.
+    static QList<int> restrictToFirstNode(const QList<Cpu>& topology,
+                                          const QList<int>& cpus);
+
+  private:
+    ThreadPlacement() {}
+};
+
+#endif /* THREADPLACEMENT_H */
@@ -9,6 +9,7 @@
 #include "controlpushbutton.h"
 #include "util/timer.h"
 #include "util/event.h"
+#include "util/threadplacement.h"
 #include "sampleutil.h"
 
 #define SIGNAL_QUALITY_FIFO_SIZE 256
@@ -78,6 +79,7 @@ void VinylControlProcessor::requestReloadConfig() {
 void VinylControlProcessor::run() {
     unsigned static id = 0; //the id of this thread, for debugging purposes //XXX copypasta (should factor this out somehow), -kousu 2/2009
     QThread::currentThread()->setObjectName(QString("VinylControlProcessor %1").arg(++id));
+    ThreadPlacement::placeCurrentThread(ThreadPlacement::REALTIME_WORKER);
 
     while (!m_bQuit) {
         Event::start("VinylControlProcessor");
@@ -0,0 +1,124 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "waveform/waveformfilterbank.h"
+
+#define MIXXX
+#include <fidlib.h>
+
+namespace {
+
+// The FIR part of the biquad sections fidlib designs for the Bessel filters,
+// these are the constants EngineFilterIIR<>::processSample() has built in.
+const double kLowPassFeedforward[] = { 2.0, 2.0 };
+const double kBandPassFeedforward[] = { -2.0, -2.0, 2.0, 2.0 };
+const double kHighPassFeedforward[] = { -2.0, -2.0 };
+
+}  // namespace
+
+template<int LANES>
+inline void WaveformFilterBank::Sections<LANES>::process(double* x) {
+    for (int section = 0; section < kSections; ++section) {
+        // note: LOOP VECTORIZED.
+        for (int lane = 0; lane < LANES; ++lane) {
+            const double w = x[lane]
+                    - feedback2[section][lane] * state2[section][lane]
+                    - feedback1[section][lane] * state1[section][lane];
+            x[lane] = state2[section][lane]
+                    + feedforward1[section][lane] * state1[section][lane]
+                    + w;
+            state2[section][lane] = state1[section][lane];
+            state1[section][lane] = w;
+        }
+    }
+}
+
+WaveformFilterBank::WaveformFilterBank(int sampleRate, double lowMidCorner,
+                                       double midHighCorner) {
+    setSections(Low, "LpBe4", 2, kLowPassFeedforward,
+                sampleRate, lowMidCorner, 0);
+    setSections(Mid, "BpBe4", 4, kBandPassFeedforward,
+                sampleRate, lowMidCorner, midHighCorner);
+    setSections(High, "HpBe4", 2, kHighPassFeedforward,
+                sampleRate, midHighCorner, 0);
+    reset();
+}
+
+void WaveformFilterBank::setSections(FilterIndex filter, const char* spec,
+                                     int sections, const double* feedforward1,
+                                     int sampleRate, double freq0,
+                                     double freq1) {
+    // fidlib lists the feedback coefficients of each section oldest sample
+    // first, with the gain of all sections merged into one.
+    double coef[kSections * 4];
+    double gain = fid_design_coef(coef, sections * 2, spec, sampleRate,
+                                  freq0, freq1, 0);
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        int lane = WaveformFilterBank::lane(filter,
+                                            static_cast<ChannelIndex>(channel));
+        m_gain[lane] = gain;
+        for (int section = 0; section < sections; ++section) {
+            if (section < kSections) {
+                m_head.feedback2[section][lane] = coef[section * 2];
+                m_head.feedback1[section][lane] = coef[section * 2 + 1];
+                m_head.feedforward1[section][lane] = feedforward1[section];
+            } else {
+                int tail = section - kSections;
+                m_bandPassTail.feedback2[tail][channel] = coef[section * 2];
+                m_bandPassTail.feedback1[tail][channel] = coef[section * 2 + 1];
+                m_bandPassTail.feedforward1[tail][channel] = feedforward1[section];
+            }
+        }
+    }
+}
+
+void WaveformFilterBank::reset() {
+    memset(m_head.state1, 0, sizeof(m_head.state1));
+    memset(m_head.state2, 0, sizeof(m_head.state2));
+    memset(m_bandPassTail.state1, 0, sizeof(m_bandPassTail.state1));
+    memset(m_bandPassTail.state2, 0, sizeof(m_bandPassTail.state2));
+}
+
+void WaveformFilterBank::process(const CSAMPLE* pIn, int frames,
+                                 CSAMPLE* pPeaks) {
+    // Work on local copies, so the filter state can stay in registers
+    // instead of being written back for every frame.
+    Sections<kFilterLanes> head = m_head;
+    Sections<ChannelCount> bandPassTail = m_bandPassTail;
+    double peaks[kLanes];
+    for (int lane = 0; lane < kLanes; ++lane) {
+        peaks[lane] = pPeaks[lane];
+    }
+
+    const int midLeft = lane(Mid, Left);
+    for (int frame = 0; frame < frames; ++frame) {
+        double x[kLanes];
+        for (int lane = 0; lane < kLanes; lane += ChannelCount) {
+            x[lane + Left] = pIn[frame * 2];
+            x[lane + Right] = pIn[frame * 2 + 1];
+        }
+        // note: LOOP VECTORIZED.
+        for (int lane = 0; lane < kFilterLanes; ++lane) {
+            x[lane] *= m_gain[lane];
+        }
+        head.process(x);
+        bandPassTail.process(x + midLeft);
+        // The unfiltered lanes are left as they are.
+        // note: LOOP VECTORIZED.
+        for (int lane = 0; lane < kLanes; ++lane) {
+            const double peak = fabs(x[lane]);
+            peaks[lane] = peak > peaks[lane] ? peak : peaks[lane];
+        }
+    }
+
+    memcpy(m_head.state1, head.state1, sizeof(head.state1));
+    memcpy(m_head.state2, head.state2, sizeof(head.state2));
+    memcpy(m_bandPassTail.state1, bandPassTail.state1,
+           sizeof(bandPassTail.state1));
+    memcpy(m_bandPassTail.state2, bandPassTail.state2,
+           sizeof(bandPassTail.state2));
+    for (int lane = 0; lane < kLanes; ++lane) {
+        pPeaks[lane] = static_cast<CSAMPLE>(peaks[lane]);
+    }
+}
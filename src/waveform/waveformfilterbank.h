@@ -0,0 +1,66 @@
+#ifndef WAVEFORMFILTERBANK_H
+#define WAVEFORMFILTERBANK_H
+
+#include "util/types.h"
+#include "waveform/waveform.h"
+
+// Splits a stereo signal into the bands of the waveform in a single pass.
+//
+// The 4th order Bessel low, band and high pass filters of both channels run
+// side by side as the lanes of a cascade of biquad sections, so every step
+// of the inner loop is the same operation over all lanes and the compiler
+// vectorizes it. The peaks of the filtered and the unfiltered signal are
+// recorded in the same loop, no intermediate buffers are written.
+class WaveformFilterBank {
+  public:
+    // The low, mid and high lanes of both channels, followed by the lanes of
+    // the unfiltered signal.
+    static const int kLanes = (FilterCount + 1) * ChannelCount;
+
+    WaveformFilterBank(int sampleRate, double lowMidCorner,
+                       double midHighCorner);
+
+    static inline int lane(FilterIndex filter, ChannelIndex channel) {
+        return filter * ChannelCount + channel;
+    }
+    static inline int overallLane(ChannelIndex channel) {
+        return FilterCount * ChannelCount + channel;
+    }
+
+    // Clears the filter state.
+    void reset();
+
+    // Filters frames of interleaved stereo samples and raises pPeaks[lane] to
+    // the largest absolute value of each lane.
+    void process(const CSAMPLE* pIn, int frames, CSAMPLE* pPeaks);
+
+  private:
+    static const int kFilterLanes = FilterCount * ChannelCount;
+    static const int kSections = 2;
+
+    // Two biquad sections over LANES lanes. Each section computes
+    //   w = x - feedback2 * w[n-2] - feedback1 * w[n-1]
+    //   y = w + feedforward1 * w[n-1] + w[n-2]
+    template<int LANES>
+    struct Sections {
+        inline void process(double* x);
+
+        double feedback1[kSections][LANES];
+        double feedback2[kSections][LANES];
+        double feedforward1[kSections][LANES];
+        double state1[kSections][LANES];
+        double state2[kSections][LANES];
+    };
+
+    void setSections(FilterIndex filter, const char* spec, int sections,
+                     const double* feedforward1, int sampleRate,
+                     double freq0, double freq1);
+
+    double m_gain[kFilterLanes];
+    // The first two sections of all filters.
+    Sections<kFilterLanes> m_head;
+    // The last two sections of the band pass.
+    Sections<ChannelCount> m_bandPassTail;
+};
+
+#endif // WAVEFORMFILTERBANK_H
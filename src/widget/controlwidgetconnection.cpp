@@ -61,7 +61,10 @@ ControlParameterWidgetConnection::~ControlParameterWidgetConnection() {
 }
 
 void ControlParameterWidgetConnection::Init() {
-    slotControlValueChanged(m_pControl->get());
+    // The widget must show the initial value right away.
+    if (m_directionOption & DIR_TO_WIDGET) {
+        updateWidget(m_pControl->get());
+    }
 }
 
 QString ControlParameterWidgetConnection::toDebugString() const {
@@ -75,11 +78,24 @@ QString ControlParameterWidgetConnection::toDebugString() const {
 
 void ControlParameterWidgetConnection::slotControlValueChanged(double value) {
     if (m_directionOption & DIR_TO_WIDGET) {
-        double parameter = getControlParameterForValue(value);
-        m_pWidget->onConnectedControlChanged(parameter, value);
+        if (!scheduleRepaint()) {
+            updateWidget(value);
+        }
     }
 }
 
+void ControlParameterWidgetConnection::onScheduledRepaint() {
+    // The direction may have changed since the update was scheduled.
+    if (m_directionOption & DIR_TO_WIDGET) {
+        updateWidget(m_pControl->get());
+    }
+}
+
+void ControlParameterWidgetConnection::updateWidget(double value) {
+    double parameter = getControlParameterForValue(value);
+    m_pWidget->onConnectedControlChanged(parameter, value);
+}
+
 void ControlParameterWidgetConnection::resetControl() {
     if (m_directionOption & DIR_FROM_WIDGET) {
         m_pControl->reset();
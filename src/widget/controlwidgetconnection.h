@@ -7,6 +7,7 @@
 #include <QByteArray>
 
 #include "controlobjectslave.h"
+#include "widget/repaintscheduler.h"
 
 class WBaseWidget;
 class ValueTransformer;
@@ -42,7 +43,10 @@ class ControlWidgetConnection : public QObject {
     QScopedPointer<ValueTransformer> m_pValueTransformer;
 };
 
-class ControlParameterWidgetConnection : public ControlWidgetConnection {
+// Updates of the control are passed to the widget at most once per GUI tick,
+// see RepaintScheduler.
+class ControlParameterWidgetConnection : public ControlWidgetConnection,
+                                         public RepaintScheduler::Client {
     Q_OBJECT
   public:
     enum EmitOption {
@@ -113,10 +117,14 @@ class ControlParameterWidgetConnection : public ControlWidgetConnection {
     void setControlParameterDown(double v);
     void setControlParameterUp(double v);
 
+    virtual void onScheduledRepaint();
+
   private slots:
     virtual void slotControlValueChanged(double v);
 
   private:
+    void updateWidget(double value);
+
     DirectionOption m_directionOption;
     EmitOption m_emitOption;
 };
@@ -0,0 +1,91 @@
+#include "widget/repaintscheduler.h"
+
+#include "controlobjectslave.h"
+#include "util/counter.h"
+#include "util/timer.h"
+
+// static
+RepaintScheduler* RepaintScheduler::s_pInstance = NULL;
+
+RepaintScheduler::Client::Client()
+        : m_bScheduled(false) {
+}
+
+RepaintScheduler::Client::~Client() {
+    if (m_bScheduled) {
+        RepaintScheduler* pScheduler = RepaintScheduler::instance();
+        if (pScheduler != NULL) {
+            pScheduler->unschedule(this);
+        }
+    }
+}
+
+bool RepaintScheduler::Client::scheduleRepaint() {
+    if (m_bScheduled) {
+        // Already waiting for the next tick, this update is coalesced.
+        Counter coalesced("RepaintScheduler coalesced updates");
+        coalesced.increment();
+        return true;
+    }
+    RepaintScheduler* pScheduler = RepaintScheduler::instance();
+    if (pScheduler == NULL) {
+        return false;
+    }
+    pScheduler->schedule(this);
+    return true;
+}
+
+// static
+void RepaintScheduler::create() {
+    if (s_pInstance == NULL) {
+        s_pInstance = new RepaintScheduler();
+    }
+}
+
+// static
+void RepaintScheduler::destroy() {
+    delete s_pInstance;
+    s_pInstance = NULL;
+}
+
+RepaintScheduler::RepaintScheduler()
+        : m_pGuiTickTime(new ControlObjectSlave("[Master]", "guiTickTime",
+                                                this)) {
+    m_pGuiTickTime->connectValueChanged(SLOT(slotGuiTick(double)));
+}
+
+RepaintScheduler::~RepaintScheduler() {
+    // Clients that outlive us update themselves directly from now on.
+    foreach (Client* pClient, m_scheduled) {
+        pClient->m_bScheduled = false;
+    }
+    foreach (Client* pClient, m_processing) {
+        pClient->m_bScheduled = false;
+    }
+}
+
+void RepaintScheduler::schedule(Client* pClient) {
+    pClient->m_bScheduled = true;
+    m_scheduled.append(pClient);
+}
+
+void RepaintScheduler::unschedule(Client* pClient) {
+    pClient->m_bScheduled = false;
+    m_scheduled.removeOne(pClient);
+    m_processing.removeOne(pClient);
+}
+
+void RepaintScheduler::slotGuiTick(double) {
+    if (m_scheduled.isEmpty()) {
+        return;
+    }
+    ScopedTimer t("RepaintScheduler::slotGuiTick");
+    // Clients may schedule themselves again or be deleted by the repaint of
+    // another client, so work on our own list.
+    m_processing.swap(m_scheduled);
+    while (!m_processing.isEmpty()) {
+        Client* pClient = m_processing.takeFirst();
+        pClient->m_bScheduled = false;
+        pClient->onScheduledRepaint();
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef REPAINTSCHEDULER_H
+#define REPAINTSCHEDULER_H
+
+#include <QList>
+#include <QObject>
+
+class ControlObjectSlave;
+
+// RepaintScheduler coalesces the control updates of skin widgets into a
+// single pass per GUI tick. Controls like playposition or the VU meters change
+// far more often than the display can show, so instead of reformatting and
+// repainting a widget on every valueChanged signal the widget schedules itself
+// and reads the latest value once when the next tick arrives.
+//
+// The tick is the [Master],guiTickTime control that GuiTick sets from the
+// VSyncThread, so the pass runs in the GUI thread at the waveform frame rate.
+// All methods must be called from the GUI thread.
+class RepaintScheduler : public QObject {
+    Q_OBJECT
+  public:
+    // Must be called after GuiTick has been created.
+    static void create();
+    static void destroy();
+    // Returns NULL if there is no scheduler.
+    static RepaintScheduler* instance() {
+        return s_pInstance;
+    }
+
+    class Client {
+      public:
+        Client();
+        virtual ~Client();
+
+        // Called by the scheduler once per tick if scheduleRepaint() was
+        // called since the last tick.
+        virtual void onScheduledRepaint() = 0;
+
+      protected:
+        // Schedules onScheduledRepaint() for the next tick. Returns false if
+        // there is no scheduler (e.g. in tests), in which case the caller must
+        // update itself right away.
+        bool scheduleRepaint();
+
+      private:
+        bool m_bScheduled;
+        friend class RepaintScheduler;
+    };
+
+  private slots:
+    void slotGuiTick(double);
+
+  private:
+    RepaintScheduler();
+    virtual ~RepaintScheduler();
+
+    void schedule(Client* pClient);
+    void unschedule(Client* pClient);
+
+    ControlObjectSlave* m_pGuiTickTime;
+    // Clients waiting for the next tick.
+    QList<Client*> m_scheduled;
+    // Clients of the tick that is currently processed.
+    QList<Client*> m_processing;
+
+    static RepaintScheduler* s_pInstance;
+};
+
+#endif /* REPAINTSCHEDULER_H */
@@ -48,7 +48,8 @@ WNumberPos::WNumberPos(const char* group, QWidget* parent)
     // set to a valid value.
     m_pTrackSampleRate->emitValueChanged();
 
-    slotSetValue(m_pVisualPlaypos->get());
+    m_dOldValue = m_pVisualPlaypos->get();
+    updateText();
 }
 
 WNumberPos::~WNumberPos() {
@@ -86,7 +87,17 @@ void WNumberPos::setValue(double dValue) {
 
 void WNumberPos::slotSetValue(double dValue) {
     m_dOldValue = dValue;
+    if (!scheduleRepaint()) {
+        updateText();
+    }
+}
 
+void WNumberPos::onScheduledRepaint() {
+    updateText();
+}
+
+void WNumberPos::updateText() {
+    const double dValue = m_dOldValue;
     double valueMillis = 0.0;
     if (m_dTrackSamples > 0 && m_dTrackSampleRate > 0) {
         double dDuration = m_dTrackSamples / m_dTrackSampleRate / 2.0;
@@ -122,5 +133,5 @@ void WNumberPos::setRemain(bool bRemain)
         m_qsText = "";
 
     // Have the widget redraw itself with its current value.
-    slotSetValue(m_dOldValue);
+    updateText();
 }
@@ -6,10 +6,13 @@
 #include <QMouseEvent>
 
 #include "wnumber.h"
+#include "widget/repaintscheduler.h"
 
 class ControlObjectThread;
 
-class WNumberPos : public WNumber {
+// The displayed time is only formatted once per GUI tick, no matter how often
+// playposition changes in between.
+class WNumberPos : public WNumber, public RepaintScheduler::Client {
     Q_OBJECT
   public:
     WNumberPos(const char *group, QWidget *parent=0);
@@ -18,6 +21,8 @@ class WNumberPos : public WNumber {
     // Set if the display shows remaining time (true) or position (false)
     void setRemain(bool bRemain);
 
+    virtual void onScheduledRepaint();
+
   protected:
     void mousePressEvent(QMouseEvent* pEvent);
 
@@ -29,6 +34,8 @@ class WNumberPos : public WNumber {
     void slotSetTrackSamples(double dSamples);
 
   private:
+    void updateText();
+
     // Old value set
     double m_dOldValue;
     double m_dTrackSamples;